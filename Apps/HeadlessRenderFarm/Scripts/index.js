@@ -0,0 +1,132 @@
+/// <reference path="../../node_modules/babylonjs/babylon.module.d.ts" />
+/// <reference path="../../node_modules/babylonjs-loaders/babylonjs.loaders.module.d.ts" />
+
+/**
+ * Renders each job into an image file and resolves once all of them are written.
+ *
+ * Jobs are rendered one per frame. The pixels of a job are read back, encoded and written while the following jobs
+ * render, with at most `options.maxInFlight` jobs between rendering and writing at any time.
+ */
+async function runJobsAsync(jobs, options) {
+    const { width, height, mimeType, quality, maxInFlight } = options;
+
+    const engine = new BABYLON.NativeEngine();
+
+    // Create a scene with a white background and an environment so that reflections look good.
+    const scene = new BABYLON.Scene(engine);
+    scene.clearColor.set(1, 1, 1, 1);
+    scene.createDefaultEnvironment({ createSkybox: false, createGround: false });
+    scene.imageProcessingConfiguration.toneMappingEnabled = true;
+    scene.imageProcessingConfiguration.toneMappingType = BABYLON.ImageProcessingConfiguration.TONEMAPPING_ACES;
+
+    // Every job renders into the same texture, which is read back into one of the pooled buffers.
+    const outputTexture = new BABYLON.RenderTargetTexture("outputTexture", { width: width, height: height }, scene, {
+        generateDepthBuffer: true,
+        generateStencilBuffer: true,
+        samples: 4,
+    });
+
+    const buffers = [];
+    for (let i = 0; i < maxInFlight; i++) {
+        buffers.push(new Uint8Array(width * height * 4));
+    }
+
+    let loadedUrl = null;
+    let rootMesh = null;
+
+    // Loads the asset of a job unless it is already loaded, and points the camera at it.
+    async function prepareJobAsync(job) {
+        if (job.url !== loadedUrl) {
+            if (rootMesh) {
+                rootMesh.dispose(false, true);
+            }
+
+            const result = await BABYLON.SceneLoader.ImportMeshAsync(null, job.url, undefined, scene);
+            rootMesh = result.meshes[0];
+            loadedUrl = job.url;
+
+            if (scene.activeCamera) {
+                scene.activeCamera.dispose();
+            }
+
+            scene.createDefaultCamera(true, true);
+            scene.activeCamera.outputRenderTarget = outputTexture;
+        }
+
+        scene.activeCamera.alpha = job.alpha;
+        scene.activeCamera.beta = job.beta;
+
+        await scene.whenReadyAsync();
+    }
+
+    // Encodes and writes the pixels of a job. The encoder copies the pixels before it returns, so their buffer goes
+    // back to the pool right away, while the image is encoded.
+    async function writeJobAsync(job, pixels) {
+        let encoding;
+        try {
+            encoding = _native.EncodeImageAsync(pixels, width, height, mimeType, true, quality);
+        } finally {
+            buffers.push(pixels);
+        }
+
+        const blob = await encoding;
+        await writeFileAsync(job.output, await blob.arrayBuffer());
+    }
+
+    return new Promise((resolve, reject) => {
+        let nextJob = 0;
+        let written = 0;
+        let prepared = null;
+        let preparing = false;
+
+        const fail = (error) => {
+            engine.stopRenderLoop();
+            reject(error);
+        };
+
+        const prepareNextJob = () => {
+            if (preparing || prepared !== null || nextJob >= jobs.length) {
+                return;
+            }
+
+            preparing = true;
+            const job = jobs[nextJob++];
+            prepareJobAsync(job).then(() => {
+                preparing = false;
+                prepared = job;
+            }, fail);
+        };
+
+        if (jobs.length === 0) {
+            resolve();
+            return;
+        }
+
+        prepareNextJob();
+
+        engine.runRenderLoop(() => {
+            // Wait for a buffer when as many jobs as allowed are still being read back, encoded or written.
+            if (prepared === null || buffers.length === 0) {
+                return;
+            }
+
+            const job = prepared;
+            prepared = null;
+
+            scene.render();
+
+            // The read back completes in a later frame, so the next job can be prepared and rendered meanwhile.
+            outputTexture
+                .readPixels(0, 0, buffers.pop())
+                .then((pixels) => writeJobAsync(job, pixels))
+                .then(() => {
+                    if (++written === jobs.length) {
+                        engine.stopRenderLoop();
+                        resolve();
+                    }
+                }, fail);
+
+            prepareNextJob();
+        });
+    });
+}
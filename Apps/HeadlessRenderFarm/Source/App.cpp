@@ -0,0 +1,378 @@
+// Renders batches of images of 3D assets without a window, reusing one graphics device and JavaScript runtime for all of
+// them, and reports the throughput.
+//
+// Usage: HeadlessRenderFarm <jobs file> [--width <pixels>] [--height <pixels>] [--format png|jpeg|webp]
+//                           [--quality <0 to 1>] [--in-flight <jobs>] [--noop]
+//
+// Each line of the jobs file is `<asset url> <camera alpha> <camera beta> <output path>`, where the url and the path are
+// quoted if they contain spaces.
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Graphics/Device.h>
+#include <Babylon/JsRuntime.h>
+#include <Babylon/Plugins/NativeEncoding.h>
+#include <Babylon/Plugins/NativeEngine.h>
+#include <Babylon/Polyfills/Blob.h>
+#include <Babylon/Polyfills/Console.h>
+#include <Babylon/Polyfills/Window.h>
+#include <Babylon/Polyfills/XMLHttpRequest.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <arcana/threading/task.h>
+#include <arcana/threading/task_schedulers.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct Job
+    {
+        std::string Url{};
+        double Alpha{};
+        double Beta{};
+        std::string Output{};
+    };
+
+    struct Options
+    {
+        std::string JobsPath{};
+        uint32_t Width{1024};
+        uint32_t Height{1024};
+        std::string Format{"png"};
+        std::optional<double> Quality{};
+        uint32_t MaxInFlight{3};
+        bool Noop{};
+    };
+
+    Options ParseOptions(int argc, char* argv[])
+    {
+        Options options{};
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg{argv[i]};
+            const auto value{[&]() -> std::string {
+                if (i + 1 == argc)
+                {
+                    throw std::runtime_error{"Missing value for " + arg};
+                }
+                return argv[++i];
+            }};
+
+            if (arg == "--width")
+            {
+                options.Width = static_cast<uint32_t>(std::stoul(value()));
+            }
+            else if (arg == "--height")
+            {
+                options.Height = static_cast<uint32_t>(std::stoul(value()));
+            }
+            else if (arg == "--format")
+            {
+                options.Format = value();
+            }
+            else if (arg == "--quality")
+            {
+                options.Quality = std::stod(value());
+            }
+            else if (arg == "--in-flight")
+            {
+                options.MaxInFlight = std::max<uint32_t>(static_cast<uint32_t>(std::stoul(value())), 1);
+            }
+            else if (arg == "--noop")
+            {
+                options.Noop = true;
+            }
+            else if (options.JobsPath.empty())
+            {
+                options.JobsPath = arg;
+            }
+            else
+            {
+                throw std::runtime_error{"Unexpected argument " + arg};
+            }
+        }
+
+        if (options.JobsPath.empty())
+        {
+            throw std::runtime_error{"Missing jobs file"};
+        }
+
+        return options;
+    }
+
+    // Reads a field of a job, which is quoted if it contains spaces. Quotes do not escape anything else, so that Windows
+    // paths keep their backslashes.
+    bool ReadField(std::istream& stream, std::string& field)
+    {
+        stream >> std::ws;
+        if (stream.peek() != '"')
+        {
+            return static_cast<bool>(stream >> field);
+        }
+
+        // The end of the line is reached before the closing quote if it is missing.
+        stream.get();
+        return std::getline(stream, field, '"') && !stream.eof() && !field.empty();
+    }
+
+    std::vector<Job> ReadJobs(const std::string& path)
+    {
+        std::ifstream file{path};
+        if (!file)
+        {
+            throw std::runtime_error{"Cannot open " + path};
+        }
+
+        std::vector<Job> jobs{};
+        std::string line{};
+        for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber)
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+            {
+                continue;
+            }
+
+            Job job{};
+            std::istringstream stream{line};
+            if (!ReadField(stream, job.Url) || !(stream >> job.Alpha >> job.Beta) || !ReadField(stream, job.Output))
+            {
+                throw std::runtime_error{"Invalid job on line " + std::to_string(lineNumber) + " of " + path};
+            }
+
+            jobs.push_back(std::move(job));
+        }
+
+        return jobs;
+    }
+
+    // Writes files on the thread pool. The promise and the buffer of each pending write stay on the JavaScript thread,
+    // which the thread pool only refers to by an id. Must outlive the runtime, which can still dispatch the completion
+    // of writes to it.
+    class FileWriter
+    {
+    public:
+        FileWriter() = default;
+
+        // No copy or move semantics
+        FileWriter(const FileWriter&) = delete;
+        FileWriter& operator=(const FileWriter&) = delete;
+
+        Napi::Value WriteFileAsync(const Napi::CallbackInfo& info)
+        {
+            auto path{info[0].As<Napi::String>().Utf8Value()};
+            auto buffer{info[1].As<Napi::ArrayBuffer>()};
+
+            auto& runtime{Babylon::JsRuntime::GetFromJavaScript(info.Env())};
+            const uint32_t id{m_nextId++};
+            auto deferred{Napi::Promise::Deferred::New(info.Env())};
+            m_pendingWrites.emplace(id, PendingWrite{deferred, Napi::Persistent(buffer)});
+
+            arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation_source::none(), [path{std::move(path)}, data{static_cast<const char*>(buffer.Data())}, size{buffer.ByteLength()}]() {
+                std::ofstream file{path, std::ios::binary};
+                file.write(data, static_cast<std::streamsize>(size));
+                if (!file)
+                {
+                    throw std::runtime_error{"Cannot write " + path};
+                }
+            }).then(arcana::inline_scheduler, arcana::cancellation_source::none(), [this, &runtime, id](const arcana::expected<void, std::exception_ptr>& result) {
+                std::string error{};
+                if (result.has_error())
+                {
+                    try
+                    {
+                        std::rethrow_exception(result.error());
+                    }
+                    catch (const std::exception& exception)
+                    {
+                        error = exception.what();
+                    }
+                }
+
+                runtime.Dispatch([this, id, error](Napi::Env env) {
+                    auto it{m_pendingWrites.find(id)};
+                    if (it == m_pendingWrites.end())
+                    {
+                        return;
+                    }
+
+                    if (error.empty())
+                    {
+                        it->second.Deferred.Resolve(env.Undefined());
+                    }
+                    else
+                    {
+                        it->second.Deferred.Reject(Napi::Error::New(env, error).Value());
+                    }
+
+                    m_pendingWrites.erase(it);
+                });
+            });
+
+            return deferred.Promise();
+        }
+
+        // Drops the writes still pending, whose promises and buffers belong to the JavaScript thread. Called from the
+        // JavaScript thread before the runtime is destroyed.
+        void Clear()
+        {
+            m_pendingWrites.clear();
+        }
+
+    private:
+        struct PendingWrite
+        {
+            Napi::Promise::Deferred Deferred;
+            Napi::Reference<Napi::ArrayBuffer> Buffer;
+        };
+
+        uint32_t m_nextId{};
+        std::unordered_map<uint32_t, PendingWrite> m_pendingWrites{};
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    Options options{};
+    std::vector<Job> jobs{};
+    try
+    {
+        options = ParseOptions(argc, argv);
+        jobs = ReadJobs(options.JobsPath);
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        std::cerr << "Usage: HeadlessRenderFarm <jobs file> [--width <pixels>] [--height <pixels>] [--format png|jpeg|webp] [--quality <0 to 1>] [--in-flight <jobs>] [--noop]" << std::endl;
+        return 1;
+    }
+
+    // Without a window the device renders into an offscreen back buffer of the given size, or uses the noop renderer
+    // without one. Frames are not synchronized with a display, so they render as fast as the jobs allow.
+    Babylon::Graphics::Configuration config{};
+    config.Width = options.Noop ? 0 : options.Width;
+    config.Height = options.Noop ? 0 : options.Height;
+    config.VSync = false;
+
+    Babylon::Graphics::Device device{config};
+    Babylon::Graphics::DeviceUpdate update{device.GetUpdate("update")};
+
+    device.StartRenderingCurrentFrame();
+    update.Start();
+
+    std::promise<int> exitCode{};
+
+    Babylon::AppRuntime::Options runtimeOptions{};
+    runtimeOptions.UnhandledExceptionHandler = [&exitCode](const Napi::Error& error) {
+        std::cerr << "[Uncaught Error] " << error.Get("stack").As<Napi::String>().Utf8Value() << std::endl;
+        exitCode.set_value(1);
+    };
+
+    FileWriter fileWriter{};
+    Babylon::AppRuntime runtime{runtimeOptions};
+
+    runtime.Dispatch([&device, &fileWriter](Napi::Env env) {
+        device.AddToJavaScript(env);
+
+        Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+            std::cout << message << std::endl;
+        });
+
+        Babylon::Polyfills::Blob::Initialize(env);
+        Babylon::Polyfills::Window::Initialize(env);
+        Babylon::Polyfills::XMLHttpRequest::Initialize(env);
+        Babylon::Plugins::NativeEngine::Initialize(env);
+        Babylon::Plugins::NativeEncoding::Initialize(env);
+
+        env.Global().Set("writeFileAsync", Napi::Function::New(env, [&fileWriter](const Napi::CallbackInfo& info) {
+            return fileWriter.WriteFileAsync(info);
+        }, "writeFileAsync"));
+    });
+
+    Babylon::ScriptLoader loader{runtime};
+    loader.LoadScript("app:///Scripts/babylon.max.js");
+    loader.LoadScript("app:///Scripts/babylonjs.loaders.js");
+    loader.LoadScript("app:///Scripts/index.js");
+
+    const auto start{std::chrono::steady_clock::now()};
+
+    loader.Dispatch([&options, &jobs, &exitCode](Napi::Env env) {
+        auto jsJobs{Napi::Array::New(env, jobs.size())};
+        for (uint32_t index = 0; index < jobs.size(); ++index)
+        {
+            auto jsJob{Napi::Object::New(env)};
+            jsJob.Set("url", jobs[index].Url);
+            jsJob.Set("alpha", jobs[index].Alpha);
+            jsJob.Set("beta", jobs[index].Beta);
+            jsJob.Set("output", jobs[index].Output);
+            jsJobs.Set(index, jsJob);
+        }
+
+        auto jsOptions{Napi::Object::New(env)};
+        jsOptions.Set("width", options.Width);
+        jsOptions.Set("height", options.Height);
+        jsOptions.Set("mimeType", "image/" + options.Format);
+        jsOptions.Set("quality", options.Quality ? Napi::Value::From(env, *options.Quality) : env.Undefined());
+        jsOptions.Set("maxInFlight", options.MaxInFlight);
+
+        auto jsPromise{env.Global().Get("runJobsAsync").As<Napi::Function>().Call({jsJobs, jsOptions}).As<Napi::Promise>()};
+
+        auto jsOnFulfilled{Napi::Function::New(env, [&exitCode](const Napi::CallbackInfo&) {
+            exitCode.set_value(0);
+        })};
+
+        auto jsOnRejected{Napi::Function::New(env, [&exitCode](const Napi::CallbackInfo& info) {
+            auto console{info.Env().Global().Get("console").As<Napi::Object>()};
+            console.Get("error").As<Napi::Function>().Call(console, {info[0]});
+            exitCode.set_value(1);
+        })};
+
+        jsPromise.Get("then").As<Napi::Function>().Call(jsPromise, {jsOnFulfilled, jsOnRejected});
+    });
+
+    // Keep rendering frames until all the jobs are written, since read backs complete over the following frames.
+    auto exitCodeFuture{exitCode.get_future()};
+    while (exitCodeFuture.wait_for(0ms) != std::future_status::ready)
+    {
+        update.Finish();
+        device.FinishRenderingCurrentFrame();
+        device.StartRenderingCurrentFrame();
+        update.Start();
+    }
+
+    const std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+    // A failed job leaves the other writes pending.
+    std::promise<void> cleared{};
+    loader.Dispatch([&fileWriter, &cleared](Napi::Env) {
+        fileWriter.Clear();
+        cleared.set_value();
+    });
+    cleared.get_future().wait();
+
+    update.Finish();
+    device.FinishRenderingCurrentFrame();
+
+    const int result{exitCodeFuture.get()};
+    if (result == 0)
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << jobs.size() << " images in " << elapsed.count() << " s, "
+                  << jobs.size() / elapsed.count() << " images/s" << std::endl;
+    }
+
+    return result;
+}
@@ -0,0 +1,247 @@
+// Times the NativeEngine image operations used when loading textures against the conversions they replace, and checks
+// that their results match.
+//
+// Usage: ImageOpsBenchmark [iterations]
+
+#include "ImageOps.h"
+
+#include <bimg/bimg.h>
+#include <bx/allocator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t WIDTH{2048};
+    constexpr uint32_t HEIGHT{1536};
+    constexpr size_t PIXEL_COUNT{static_cast<size_t>(WIDTH) * HEIGHT};
+
+    using Image = std::vector<uint8_t>;
+
+    struct Benchmark
+    {
+        std::string Name{};
+
+        // Both write the converted source image to the output.
+        std::function<void(const Image&, Image&)> Baseline{};
+        std::function<void(const Image&, Image&)> Optimized{};
+
+        size_t SourceBytesPerPixel{};
+
+        // Whether the results match, where they are expected to differ. By default, they must be equal.
+        std::function<bool(const Image&, const Image&)> Matches{};
+    };
+
+    // The per-pixel conversion previously used for grayscale images.
+    using TransformFn = void (*)(const uint8_t*, uint8_t*);
+    void TransformImage(const Image& source, size_t sourceBytesPerPixel, Image& destination, TransformFn transformFn)
+    {
+        destination.resize(PIXEL_COUNT * 4);
+        for (size_t index = 0; index < PIXEL_COUNT; ++index)
+        {
+            transformFn(source.data() + index * sourceBytesPerPixel, destination.data() + index * 4);
+        }
+    }
+
+    // The per-pixel reorientation previously used for images with an orientation, which maps each pixel through a
+    // std::function and copies the result from a temporary buffer.
+    void ReorientImage(Image& image, uint32_t width, uint32_t height, bimg::Orientation::Enum orientation)
+    {
+        std::function<std::pair<uint32_t, uint32_t>(uint32_t, uint32_t)> mapPixel{};
+        uint32_t newWidth{width};
+        switch (orientation)
+        {
+            case bimg::Orientation::R90:
+                mapPixel = [height](uint32_t x, uint32_t y) { return std::make_pair(height - y - 1, x); };
+                newWidth = height;
+                break;
+            case bimg::Orientation::R180:
+                mapPixel = [width, height](uint32_t x, uint32_t y) { return std::make_pair(width - x - 1, height - y - 1); };
+                break;
+            case bimg::Orientation::HFlipR270:
+                mapPixel = [](uint32_t x, uint32_t y) { return std::make_pair(y, x); };
+                newWidth = height;
+                break;
+            default:
+                mapPixel = [](uint32_t x, uint32_t y) { return std::make_pair(x, y); };
+                break;
+        }
+
+        auto* pixels{reinterpret_cast<uint32_t*>(image.data())};
+        std::vector<uint32_t> buffer(image.size() / sizeof(uint32_t));
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const auto mappedPixel{mapPixel(x, y)};
+                buffer[static_cast<size_t>(mappedPixel.second) * newWidth + mappedPixel.first] = pixels[static_cast<size_t>(y) * width + x];
+            }
+        }
+
+        std::memcpy(image.data(), buffer.data(), image.size());
+    }
+
+    // The row flip previously used, which copies each pair of rows through a temporary row.
+    void FlipImage(Image& image, uint32_t height)
+    {
+        const size_t rowPitch{image.size() / height};
+        std::vector<uint8_t> buffer(rowPitch);
+        for (size_t row = 0; row < height / 2; row++)
+        {
+            uint8_t* frontPtr{image.data() + (row * rowPitch)};
+            uint8_t* backPtr{image.data() + ((height - row - 1) * rowPitch)};
+
+            std::memcpy(buffer.data(), frontPtr, rowPitch);
+            std::memcpy(frontPtr, backPtr, rowPitch);
+            std::memcpy(backPtr, buffer.data(), rowPitch);
+        }
+    }
+
+    Benchmark CreateReorientBenchmark(std::string name, bimg::Orientation::Enum orientation)
+    {
+        return {
+            std::move(name),
+            [orientation](const Image& source, Image& destination) {
+                destination = source;
+                ReorientImage(destination, WIDTH, HEIGHT, orientation);
+            },
+            [orientation](const Image& source, Image& destination) {
+                destination = source;
+                uint32_t width{WIDTH};
+                uint32_t height{HEIGHT};
+                Babylon::ImageOps::ReorientImage({reinterpret_cast<uint32_t*>(destination.data()), PIXEL_COUNT}, width, height, orientation);
+            },
+            4,
+        };
+    }
+
+    std::vector<Benchmark> CreateBenchmarks(bx::AllocatorI& allocator)
+    {
+        return {
+            {
+                "R8 to RGBA8",
+                [](const Image& source, Image& destination) {
+                    TransformImage(source, 1, destination, [](const uint8_t* src, uint8_t* dst) { dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 1; });
+                },
+                [](const Image& source, Image& destination) {
+                    destination.resize(PIXEL_COUNT * 4);
+                    Babylon::ImageOps::ExpandR8ToRGBA8(source.data(), destination.data(), PIXEL_COUNT);
+                },
+                1,
+                // The previous conversion wrote an alpha of 1 rather than opaque.
+                [](const Image& expected, const Image& actual) {
+                    if (expected.size() != actual.size())
+                    {
+                        return false;
+                    }
+
+                    for (size_t index = 0; index < expected.size(); index += 4)
+                    {
+                        if (!std::equal(&expected[index], &expected[index + 3], &actual[index]) || actual[index + 3] != 0xFF)
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                },
+            },
+            {
+                "RG8 to RGBA8",
+                [](const Image& source, Image& destination) {
+                    TransformImage(source, 2, destination, [](const uint8_t* src, uint8_t* dst) { dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; });
+                },
+                [](const Image& source, Image& destination) {
+                    destination.resize(PIXEL_COUNT * 4);
+                    Babylon::ImageOps::ExpandRG8ToRGBA8(source.data(), destination.data(), PIXEL_COUNT);
+                },
+                2,
+            },
+            {
+                "RGB8 to RGBA8",
+                [&allocator](const Image& source, Image& destination) {
+                    destination.resize(PIXEL_COUNT * 4);
+                    bimg::imageConvert(&allocator, destination.data(), bimg::TextureFormat::RGBA8, source.data(), bimg::TextureFormat::RGB8, WIDTH, HEIGHT, 1);
+                },
+                [](const Image& source, Image& destination) {
+                    destination.resize(PIXEL_COUNT * 4);
+                    Babylon::ImageOps::ExpandRGB8ToRGBA8(source.data(), destination.data(), PIXEL_COUNT);
+                },
+                3,
+            },
+            CreateReorientBenchmark("Reorient R90", bimg::Orientation::R90),
+            CreateReorientBenchmark("Reorient R180", bimg::Orientation::R180),
+            CreateReorientBenchmark("Reorient HFlipR270", bimg::Orientation::HFlipR270),
+            {
+                "Flip",
+                [](const Image& source, Image& destination) {
+                    destination = source;
+                    FlipImage(destination, HEIGHT);
+                },
+                [](const Image& source, Image& destination) {
+                    destination = source;
+                    Babylon::ImageOps::FlipImage(destination, HEIGHT);
+                },
+                4,
+            },
+        };
+    }
+
+    double Time(const std::function<void(const Image&, Image&)>& operation, const Image& source, Image& destination, int iterations)
+    {
+        const auto start{std::chrono::steady_clock::now()};
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            operation(source, destination);
+        }
+        const std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+        return elapsed.count() / iterations;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations{argc > 1 ? std::max(std::atoi(argv[1]), 1) : 20};
+
+    std::cout << WIDTH << "x" << HEIGHT << " images, " << iterations << " iterations" << std::endl;
+
+    std::mt19937 random{42};
+    Image source(PIXEL_COUNT * 4);
+    std::generate(source.begin(), source.end(), [&]() { return static_cast<uint8_t>(random()); });
+
+    bx::DefaultAllocator allocator{};
+    bool success{true};
+
+    for (const auto& benchmark : CreateBenchmarks(allocator))
+    {
+        const Image input{source.begin(), source.begin() + PIXEL_COUNT * benchmark.SourceBytesPerPixel};
+
+        Image expected{};
+        Image actual{};
+        benchmark.Baseline(input, expected);
+        benchmark.Optimized(input, actual);
+
+        const bool matches{benchmark.Matches ? benchmark.Matches(expected, actual) : expected == actual};
+        success = success && matches;
+
+        const double baselineTime{Time(benchmark.Baseline, input, expected, iterations)};
+        const double optimizedTime{Time(benchmark.Optimized, input, actual, iterations)};
+
+        std::cout << std::endl << benchmark.Name << (matches ? "" : "  MISMATCH") << std::endl;
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  " << std::left << std::setw(10) << "baseline" << std::right << std::setw(10) << baselineTime << " ms" << std::endl
+                  << "  " << std::left << std::setw(10) << "ImageOps" << std::right << std::setw(10) << optimizedTime << " ms"
+                  << std::setprecision(2) << std::setw(8) << baselineTime / optimizedTime << "x" << std::endl;
+    }
+
+    return success ? 0 : 1;
+}
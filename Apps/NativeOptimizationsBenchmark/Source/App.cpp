@@ -0,0 +1,357 @@
+// Times the NativeOptimizations kernels available on this CPU on fixed size meshes, and checks that the results of the
+// vectorized kernels match the scalar ones. Then times the mesh processing functions on a grid, and checks that they
+// improve the vertex cache efficiency and reduce the triangle count.
+//
+// Usage: NativeOptimizationsBenchmark [iterations]
+
+#include "Kernels.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Babylon::Plugins::NativeOptimizations::Kernels;
+    using Babylon::Plugins::NativeOptimizations::SkinningData;
+
+    constexpr size_t VERTEX_COUNT{100000};
+    constexpr size_t INDEX_COUNT{VERTEX_COUNT * 6};
+    constexpr size_t BONE_COUNT{64};
+    constexpr float TOLERANCE{1e-4f};
+    constexpr uint32_t GRID_SIZE{300};
+    constexpr size_t ANALYZED_CACHE_SIZE{16};
+
+    struct Mesh
+    {
+        std::vector<float> Positions{};
+        std::vector<float> Normals4{};
+        std::vector<uint16_t> Indices16{};
+        std::vector<uint32_t> Indices32{};
+        std::vector<float> Matrix{};
+        std::vector<float> BoneMatrices{};
+        std::vector<float> BoneIndices{};
+        std::vector<float> BoneWeights{};
+        std::vector<float> BoneIndicesExtra{};
+        std::vector<float> BoneWeightsExtra{};
+    };
+
+    // Transform with a small perspective component so that the division by w is exercised.
+    void GenerateMatrix(std::mt19937& random, float* matrix)
+    {
+        std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+        for (size_t index = 0; index < 16; ++index)
+        {
+            matrix[index] = distribution(random);
+        }
+
+        matrix[3] *= 0.01f;
+        matrix[7] *= 0.01f;
+        matrix[11] *= 0.01f;
+        matrix[15] = 2.0f;
+    }
+
+    Mesh GenerateMesh()
+    {
+        std::mt19937 random{42};
+        std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+        std::uniform_int_distribution<uint32_t> vertexDistribution{0, 65535};
+        std::uniform_int_distribution<uint32_t> boneDistribution{0, BONE_COUNT - 1};
+
+        Mesh mesh{};
+        mesh.Positions.resize(VERTEX_COUNT * 3);
+        std::generate(mesh.Positions.begin(), mesh.Positions.end(), [&]() { return distribution(random); });
+
+        mesh.Normals4.resize(VERTEX_COUNT * 4);
+        std::generate(mesh.Normals4.begin(), mesh.Normals4.end(), [&]() { return distribution(random); });
+
+        mesh.Indices16.resize(INDEX_COUNT);
+        std::generate(mesh.Indices16.begin(), mesh.Indices16.end(), [&]() { return static_cast<uint16_t>(vertexDistribution(random)); });
+        mesh.Indices32.assign(mesh.Indices16.begin(), mesh.Indices16.end());
+
+        mesh.Matrix.resize(16);
+        GenerateMatrix(random, mesh.Matrix.data());
+
+        mesh.BoneMatrices.resize(BONE_COUNT * 16);
+        for (size_t bone = 0; bone < BONE_COUNT; ++bone)
+        {
+            GenerateMatrix(random, mesh.BoneMatrices.data() + bone * 16);
+        }
+
+        // Most vertices use 2 to 4 influences, and half of them have 4 more.
+        for (size_t vertex = 0; vertex < VERTEX_COUNT; ++vertex)
+        {
+            const size_t influenceCount{2 + vertex % 3};
+            const bool extra{vertex % 2 == 0};
+            for (size_t influence = 0; influence < 4; ++influence)
+            {
+                mesh.BoneIndices.push_back(static_cast<float>(boneDistribution(random)));
+                mesh.BoneWeights.push_back(influence < influenceCount ? 0.25f : 0.0f);
+                mesh.BoneIndicesExtra.push_back(static_cast<float>(boneDistribution(random)));
+                mesh.BoneWeightsExtra.push_back(extra ? 0.125f : 0.0f);
+            }
+        }
+
+        return mesh;
+    }
+
+    struct Benchmark
+    {
+        std::string Name{};
+
+        // Runs the kernel on a fresh copy of the inputs and returns the output, untimed.
+        std::function<std::vector<float>(const Kernels&)> Run{};
+
+        // Runs the kernel on inputs that can be reused across iterations.
+        std::function<void(const Kernels&)> Time{};
+    };
+
+    std::vector<float> MinAndMax(const std::function<void(float*, float*)>& extract)
+    {
+        std::vector<float> result{HUGE_VALF, HUGE_VALF, HUGE_VALF, -HUGE_VALF, -HUGE_VALF, -HUGE_VALF};
+        extract(result.data(), result.data() + 3);
+        return result;
+    }
+
+    std::vector<Benchmark> CreateBenchmarks(const Mesh& mesh, std::vector<float>& scratch)
+    {
+        const SkinningData skinning{mesh.BoneMatrices.data(), mesh.BoneIndices.data(), mesh.BoneWeights.data(), mesh.BoneIndicesExtra.data(), mesh.BoneWeightsExtra.data()};
+
+        return {
+            {
+                "TransformCoordinates",
+                [&mesh](const Kernels& kernels) {
+                    auto data{mesh.Positions};
+                    kernels.TransformCoordinates(data.data(), VERTEX_COUNT, 3, mesh.Matrix.data());
+                    return data;
+                },
+                [&mesh, &scratch](const Kernels& kernels) {
+                    scratch.assign(mesh.Positions.begin(), mesh.Positions.end());
+                    kernels.TransformCoordinates(scratch.data(), VERTEX_COUNT, 3, mesh.Matrix.data());
+                },
+            },
+            {
+                "TransformNormals (stride 4)",
+                [&mesh](const Kernels& kernels) {
+                    auto data{mesh.Normals4};
+                    kernels.TransformNormals(data.data(), VERTEX_COUNT, 4, mesh.Matrix.data());
+                    return data;
+                },
+                [&mesh, &scratch](const Kernels& kernels) {
+                    scratch.assign(mesh.Normals4.begin(), mesh.Normals4.end());
+                    kernels.TransformNormals(scratch.data(), VERTEX_COUNT, 4, mesh.Matrix.data());
+                },
+            },
+            {
+                "ExtractMinAndMax",
+                [&mesh](const Kernels& kernels) {
+                    return MinAndMax([&](float* minimum, float* maximum) { kernels.ExtractMinAndMax(mesh.Positions.data(), VERTEX_COUNT, 3, minimum, maximum); });
+                },
+                [&mesh](const Kernels& kernels) {
+                    MinAndMax([&](float* minimum, float* maximum) { kernels.ExtractMinAndMax(mesh.Positions.data(), VERTEX_COUNT, 3, minimum, maximum); });
+                },
+            },
+            {
+                "ExtractMinAndMaxIndexed16",
+                [&mesh](const Kernels& kernels) {
+                    return MinAndMax([&](float* minimum, float* maximum) { kernels.ExtractMinAndMaxIndexed16(mesh.Positions.data(), mesh.Indices16.data(), INDEX_COUNT, minimum, maximum); });
+                },
+                [&mesh](const Kernels& kernels) {
+                    MinAndMax([&](float* minimum, float* maximum) { kernels.ExtractMinAndMaxIndexed16(mesh.Positions.data(), mesh.Indices16.data(), INDEX_COUNT, minimum, maximum); });
+                },
+            },
+            {
+                "ExtractMinAndMaxIndexed32",
+                [&mesh](const Kernels& kernels) {
+                    return MinAndMax([&](float* minimum, float* maximum) { kernels.ExtractMinAndMaxIndexed32(mesh.Positions.data(), mesh.Indices32.data(), INDEX_COUNT, minimum, maximum); });
+                },
+                [&mesh](const Kernels& kernels) {
+                    MinAndMax([&](float* minimum, float* maximum) { kernels.ExtractMinAndMaxIndexed32(mesh.Positions.data(), mesh.Indices32.data(), INDEX_COUNT, minimum, maximum); });
+                },
+            },
+            {
+                "ApplySkeleton (coordinates)",
+                [&mesh, skinning](const Kernels& kernels) {
+                    auto data{mesh.Positions};
+                    kernels.ApplySkeleton(data.data(), VERTEX_COUNT, false, skinning);
+                    return data;
+                },
+                [&mesh, &scratch, skinning](const Kernels& kernels) {
+                    scratch.assign(mesh.Positions.begin(), mesh.Positions.end());
+                    kernels.ApplySkeleton(scratch.data(), VERTEX_COUNT, false, skinning);
+                },
+            },
+            {
+                "ApplySkeleton (normals)",
+                [&mesh, skinning](const Kernels& kernels) {
+                    auto data{mesh.Positions};
+                    kernels.ApplySkeleton(data.data(), VERTEX_COUNT, true, skinning);
+                    return data;
+                },
+                [&mesh, &scratch, skinning](const Kernels& kernels) {
+                    scratch.assign(mesh.Positions.begin(), mesh.Positions.end());
+                    kernels.ApplySkeleton(scratch.data(), VERTEX_COUNT, true, skinning);
+                },
+            },
+        };
+    }
+
+    // A wavy grid whose triangles are shuffled, like the ones of a scanned mesh that was not optimized.
+    void GenerateGrid(std::vector<float>& positions, std::vector<uint32_t>& indices)
+    {
+        for (uint32_t y = 0; y <= GRID_SIZE; ++y)
+        {
+            for (uint32_t x = 0; x <= GRID_SIZE; ++x)
+            {
+                const float u{static_cast<float>(x) / GRID_SIZE};
+                const float v{static_cast<float>(y) / GRID_SIZE};
+                positions.insert(positions.end(), {u, 0.05f * std::sin(u * 20) * std::cos(v * 20), v});
+            }
+        }
+
+        std::vector<uint32_t> quads(GRID_SIZE * GRID_SIZE);
+        std::iota(quads.begin(), quads.end(), 0);
+        std::shuffle(quads.begin(), quads.end(), std::mt19937{42});
+
+        for (const uint32_t quad : quads)
+        {
+            const uint32_t a{quad / GRID_SIZE * (GRID_SIZE + 1) + quad % GRID_SIZE};
+            const uint32_t b{a + 1};
+            const uint32_t c{a + GRID_SIZE + 1};
+            const uint32_t d{c + 1};
+            indices.insert(indices.end(), {a, c, b, b, c, d});
+        }
+    }
+
+    template<typename FunctionT>
+    double TimeMilliseconds(FunctionT function)
+    {
+        const auto start{std::chrono::steady_clock::now()};
+        function();
+        const std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+        return elapsed.count();
+    }
+
+    bool RunMeshProcessing()
+    {
+        using namespace Babylon::Plugins::NativeOptimizations;
+
+        std::vector<float> positions{};
+        std::vector<uint32_t> indices{};
+        GenerateGrid(positions, indices);
+        const size_t vertexCount{positions.size() / 3};
+
+        std::cout << std::endl << "Mesh processing (" << vertexCount << " vertices, " << indices.size() << " indices)" << std::endl;
+
+        const float initialAcmr{AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, ANALYZED_CACHE_SIZE)};
+        const double cacheTime{TimeMilliseconds([&]() { OptimizeVertexCache(indices.data(), indices.data(), indices.size(), vertexCount); })};
+        const float cacheAcmr{AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, ANALYZED_CACHE_SIZE)};
+        const double overdrawTime{TimeMilliseconds([&]() { OptimizeOverdraw(indices.data(), indices.data(), indices.size(), positions.data(), 3, vertexCount, 1.05f); })};
+        const float overdrawAcmr{AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, ANALYZED_CACHE_SIZE)};
+
+        std::vector<uint32_t> lod{};
+        const double simplifyTime{TimeMilliseconds([&]() { lod = Simplify(indices.data(), indices.size(), positions.data(), 3, vertexCount, indices.size() / 4, 0.01f); })};
+
+        std::vector<uint32_t> remap(vertexCount);
+        size_t usedVertexCount{};
+        const double fetchTime{TimeMilliseconds([&]() {
+            usedVertexCount = OptimizeVertexFetch(lod.data(), lod.size(), remap.data(), vertexCount);
+            RemapVertexBuffer(reinterpret_cast<uint8_t*>(positions.data()), vertexCount, 3 * sizeof(float), remap.data());
+        })};
+
+        std::vector<uint16_t> narrowed(lod.size());
+        const bool narrows{NarrowIndices(narrowed.data(), lod.data(), lod.size())};
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  OptimizeVertexCache  " << std::setw(10) << cacheTime << " ms  ACMR " << initialAcmr << " -> " << cacheAcmr << std::endl
+                  << "  OptimizeOverdraw     " << std::setw(10) << overdrawTime << " ms  ACMR " << overdrawAcmr << std::endl
+                  << "  Simplify             " << std::setw(10) << simplifyTime << " ms  " << indices.size() << " -> " << lod.size() << " indices" << std::endl
+                  << "  OptimizeVertexFetch  " << std::setw(10) << fetchTime << " ms  " << usedVertexCount << " vertices used" << std::endl;
+
+        const bool success{cacheAcmr < initialAcmr && overdrawAcmr < initialAcmr && !lod.empty() && lod.size() <= indices.size() / 4 && narrows};
+        std::cout << (success ? "" : "  MISMATCH\n");
+        return success;
+    }
+
+    bool Matches(const std::vector<float>& expected, const std::vector<float>& actual)
+    {
+        if (expected.size() != actual.size())
+        {
+            return false;
+        }
+
+        for (size_t index = 0; index < expected.size(); ++index)
+        {
+            if (std::abs(expected[index] - actual[index]) > TOLERANCE * std::max(1.0f, std::abs(expected[index])))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int iterations{argc > 1 ? std::max(std::atoi(argv[1]), 1) : 50};
+
+    std::vector<const Kernels*> kernelSets{&Babylon::Plugins::NativeOptimizations::GetScalarKernels()};
+    if (&Babylon::Plugins::NativeOptimizations::GetBaselineKernels() != kernelSets.front())
+    {
+        kernelSets.push_back(&Babylon::Plugins::NativeOptimizations::GetBaselineKernels());
+    }
+
+    if (const auto avx2Kernels{Babylon::Plugins::NativeOptimizations::GetAvx2Kernels()})
+    {
+        kernelSets.push_back(avx2Kernels);
+    }
+
+    std::cout << "Selected kernels: " << Babylon::Plugins::NativeOptimizations::GetKernels().Name << std::endl;
+    std::cout << VERTEX_COUNT << " vertices, " << INDEX_COUNT << " indices, " << iterations << " iterations" << std::endl;
+
+    const Mesh mesh{GenerateMesh()};
+    std::vector<float> scratch{};
+    bool success{true};
+
+    for (const auto& benchmark : CreateBenchmarks(mesh, scratch))
+    {
+        std::cout << std::endl << benchmark.Name << std::endl;
+
+        const auto expected{benchmark.Run(*kernelSets.front())};
+        double scalarTime{};
+
+        for (const auto* kernels : kernelSets)
+        {
+            const bool matches{Matches(expected, benchmark.Run(*kernels))};
+            success = success && matches;
+
+            const auto start{std::chrono::steady_clock::now()};
+            for (int iteration = 0; iteration < iterations; ++iteration)
+            {
+                benchmark.Time(*kernels);
+            }
+            const std::chrono::duration<double, std::milli> elapsed{std::chrono::steady_clock::now() - start};
+
+            const double time{elapsed.count() / iterations};
+            scalarTime = kernels == kernelSets.front() ? time : scalarTime;
+
+            std::cout << "  " << std::left << std::setw(8) << kernels->Name << std::right << std::fixed << std::setprecision(3)
+                      << std::setw(10) << time << " ms" << std::setprecision(2) << std::setw(8) << scalarTime / time << "x"
+                      << (matches ? "" : "  MISMATCH") << std::endl;
+        }
+    }
+
+    success = RunMeshProcessing() && success;
+
+    return success ? 0 : 1;
+}
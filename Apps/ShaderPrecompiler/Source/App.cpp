@@ -0,0 +1,104 @@
+// Compiles the programs listed in a shader manifest, recorded with Babylon::ShaderCache::RecordMisses, and writes them to
+// a cache file that can be loaded with Babylon::ShaderCache::Deserialize or Babylon::ShaderCache::Open.
+//
+// Usage: ShaderPrecompiler <manifest> <output cache>
+//
+// The cache file only matches builds that use the same GRAPHICS_API as this tool. The sources are patched for the renderer
+// caps stored in the manifest, as NativeEngine does at runtime.
+
+#include <fstream>
+
+#include <Babylon/ShaderCache.h>
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+#include "ShaderCompilerCommon.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: ShaderPrecompiler <manifest> <output cache>" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        std::ifstream manifestStream{argv[1], std::ios::binary};
+        if (!manifestStream)
+        {
+            std::cerr << "Failed to open manifest " << argv[1] << std::endl;
+            return 1;
+        }
+
+        const auto manifest{Babylon::ShaderCacheImpl::ReadManifest(manifestStream)};
+        const auto& programs{manifest.Programs};
+
+        Babylon::ShaderCache::Enabled(true);
+        auto& cache{*Babylon::ShaderCacheImpl::GetImpl()};
+
+        std::atomic<size_t> nextProgram{0};
+        std::atomic<size_t> failureCount{0};
+        std::mutex outputMutex{};
+
+        const auto compilePrograms{[&]() {
+            Babylon::ShaderCompiler compiler{};
+            for (size_t index = nextProgram++; index < programs.size(); index = nextProgram++)
+            {
+                const auto& [vertexSource, fragmentSource] = programs[index];
+                if (cache.GetShader(vertexSource, fragmentSource))
+                {
+                    continue;
+                }
+
+                try
+                {
+                    cache.AddShader(vertexSource, fragmentSource, compiler.Compile(
+                        Babylon::ShaderCompilerCommon::ProcessShaderCoordinates(vertexSource, manifest.HomogeneousDepth),
+                        Babylon::ShaderCompilerCommon::ProcessSamplerFlip(fragmentSource, manifest.OriginBottomLeft)));
+                }
+                catch (const std::exception& exception)
+                {
+                    std::scoped_lock lock{outputMutex};
+                    std::cerr << "Failed to compile program " << index << ": " << exception.what() << std::endl;
+                    ++failureCount;
+                }
+            }
+        }};
+
+        std::vector<std::thread> threads{};
+        const size_t threadCount{std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), programs.size())};
+        for (size_t index = 0; index < threadCount; ++index)
+        {
+            threads.emplace_back(compilePrograms);
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::ofstream output{argv[2], std::ios::binary};
+        if (!output)
+        {
+            std::cerr << "Failed to create cache file " << argv[2] << std::endl;
+            return 1;
+        }
+
+        const auto programCount{Babylon::ShaderCache::Serialize(output)};
+        std::cout << "Wrote " << programCount << " of " << programs.size() << " programs to " << argv[2] << std::endl;
+
+        return failureCount == 0 ? 0 : 1;
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+}
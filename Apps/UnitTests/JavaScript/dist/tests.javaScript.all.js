@@ -28515,12 +28515,76 @@ describe("PostProcesses", function () {
     });*/
 });
 
+describe("NativeEngine", function () {
+  this.timeout(0);
+
+  it("should apply uniforms set with COMMAND_SETUNIFORMS", function (done) {
+    var engine = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_4__.NativeEngine();
+    var scene = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_4__.Scene(engine);
+    scene.createDefaultCamera();
+
+    var plane = _babylonjs_core__WEBPACK_IMPORTED_MODULE_4__.MeshBuilder.CreatePlane("plane", { size: 1 }, scene);
+    var material = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_4__.ShaderMaterial("batchedUniforms", scene, {
+      vertexSource: "\n        precision highp float;\n        attribute vec3 position;\n        void main() {\n          gl_Position = vec4(position.xy * 2.0, 0.0, 1.0);\n        }",
+      fragmentSource: "\n        precision highp float;\n        uniform vec4 color;\n        uniform float scale;\n        uniform vec2 offset;\n        uniform vec4 colors[2];\n        uniform mat4 transform;\n        void main() {\n          gl_FragColor = transform * (color * scale) + colors[0] + colors[1] + vec4(offset, 0.0, 0.0);\n        }"
+    }, { attributes: ["position"], uniforms: ["color", "scale", "offset", "colors", "transform"] });
+    material.backFaceCulling = false;
+    plane.material = material;
+
+    // The material does not set any of these uniforms, so the output only depends on the values of the batch.
+    material.onBindObservable.add(function () {
+      var effect = material.getEffect();
+      var encoder = engine._commandBufferEncoder;
+      encoder.startEncodingCommand(_native.Engine.COMMAND_SETUNIFORMS);
+      encoder.encodeCommandArgAsUInt32(5);
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("color"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOAT4);
+      [0.5, 0.25, 0, 0.5].forEach(function (value) {return encoder.encodeCommandArgAsFloat32(value);});
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("scale"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOAT);
+      encoder.encodeCommandArgAsFloat32(2);
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("offset"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOAT2);
+      encoder.encodeCommandArgAsFloat32(0);
+      encoder.encodeCommandArgAsFloat32(0.25);
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("colors"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOATARRAY4);
+      encoder.encodeCommandArgAsFloat32s(new Float32Array([0, 0, 0, 0, 0, 0, 0.5, 0]));
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("transform"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_MATRIX);
+      encoder.encodeCommandArgAsFloat32s(new Float32Array([1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1]));
+      encoder.finishEncodingCommand();
+    });
+
+    var renderTarget = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_4__.RenderTargetTexture("renderTarget", 4, scene);
+    renderTarget.renderList = [plane];
+    scene.customRenderTargets.push(renderTarget);
+
+    scene.executeWhenReady(function () {
+      scene.onAfterRenderObservable.addOnce(function () {
+        renderTarget.readPixels().then(function (pixels) {
+          engine.stopRenderLoop();
+          var data = new Uint8Array(pixels.buffer, pixels.byteOffset, pixels.byteLength);
+          var center = (2 * 4 + 2) * 4;
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(Math.abs(data[center] - 255)).to.be.lessThan(3);
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(Math.abs(data[center + 1] - 191)).to.be.lessThan(3);
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(Math.abs(data[center + 2] - 128)).to.be.lessThan(3);
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(Math.abs(data[center + 3] - 255)).to.be.lessThan(3);
+          engine.dispose();
+          done();
+        }).catch(done);
+      });
+      engine.runRenderLoop(function () {return scene.render();});
+    });
+  });
+});
+
 describe("NativeEncoding", function () {
   this.timeout(0);function
 
-  expectValidPNG(_x) {return _expectValidPNG.apply(this, arguments);}function _expectValidPNG() {_expectValidPNG = (0,_babel_runtime_helpers_asyncToGenerator__WEBPACK_IMPORTED_MODULE_0__["default"])(/*#__PURE__*/_babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().mark(function _callee3(blob) {var arrayBuffer, pngSignature;return _babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().wrap(function (_context3) {while (1) switch (_context3.prev = _context3.next) {case 0:
-            (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(blob).to.be.instanceOf(Blob);_context3.next = 1;return (
-              blob.arrayBuffer());case 1:arrayBuffer = _context3.sent;
+  expectValidPNG(_x) {return _expectValidPNG.apply(this, arguments);}function _expectValidPNG() {_expectValidPNG = (0,_babel_runtime_helpers_asyncToGenerator__WEBPACK_IMPORTED_MODULE_0__["default"])(/*#__PURE__*/_babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().mark(function _callee4(blob) {var arrayBuffer, pngSignature;return _babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().wrap(function (_context4) {while (1) switch (_context4.prev = _context4.next) {case 0:
+            (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(blob).to.be.instanceOf(Blob);_context4.next = 1;return (
+              blob.arrayBuffer());case 1:arrayBuffer = _context4.sent;
             (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(arrayBuffer.byteLength).to.be.greaterThan(0);
 
             pngSignature = new Uint8Array(arrayBuffer.slice(0, 4));
@@ -28528,7 +28592,7 @@ describe("NativeEncoding", function () {
             (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(pngSignature[1]).to.equal(80); // 'P'
             (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(pngSignature[2]).to.equal(78); // 'N'
             (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(pngSignature[3]).to.equal(71); // 'G'
-          case 2:case "end":return _context3.stop();}}, _callee3);}));return _expectValidPNG.apply(this, arguments);}
+          case 2:case "end":return _context4.stop();}}, _callee4);}));return _expectValidPNG.apply(this, arguments);}
 
   it("should encode a PNG", /*#__PURE__*/(0,_babel_runtime_helpers_asyncToGenerator__WEBPACK_IMPORTED_MODULE_0__["default"])(/*#__PURE__*/_babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().mark(function _callee() {var pixelData, result;return _babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().wrap(function (_context) {while (1) switch (_context.prev = _context.next) {case 0:
           pixelData = new Uint8Array(4).fill(255);_context.next = 1;return (
@@ -28546,6 +28610,17 @@ describe("NativeEncoding", function () {
             )));case 1:results = _context2.sent;_context2.next = 2;return (
             Promise.all(results.map(function (b) {return expectValidPNG(b);})));case 2:case "end":return _context2.stop();}}, _callee2);}))
   );
+
+  it("should encode a JPEG", /*#__PURE__*/(0,_babel_runtime_helpers_asyncToGenerator__WEBPACK_IMPORTED_MODULE_0__["default"])(/*#__PURE__*/_babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().mark(function _callee3() {var pixelData, result, jpegSignature, _t;return _babel_runtime_regenerator__WEBPACK_IMPORTED_MODULE_1___default().wrap(function (_context3) {while (1) switch (_context3.prev = _context3.next) {case 0:
+          pixelData = new Uint8Array(16 * 16 * 4).fill(255);_context3.next = 1;return (
+            _native.EncodeImageAsync(pixelData, 16, 16, "image/jpeg", false, 0.8));case 1:result = _context3.sent;
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(result.type).to.equal("image/jpeg");_t =
+
+          Uint8Array;_context3.next = 2;return result.arrayBuffer();case 2:jpegSignature = new _t(_context3.sent, 0, 3);
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(jpegSignature[0]).to.equal(0xFF); // SOI marker
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(jpegSignature[1]).to.equal(0xD8);
+          (0,chai__WEBPACK_IMPORTED_MODULE_3__.expect)(jpegSignature[2]).to.equal(0xFF);case 3:case "end":return _context3.stop();}}, _callee3);}))
+  );
 });
 
 mocha.run(function (failures) {
@@ -0,0 +1,134 @@
+/******/ (() => { // webpackBootstrap
+/******/ 	"use strict";
+/******/ 	var __webpack_modules__ = ({
+
+/***/ "@babylonjs/core":
+/*!**************************!*\
+  !*** external "BABYLON" ***!
+  \**************************/
+/***/ ((module) => {
+
+module.exports = BABYLON;
+
+/***/ })
+
+/******/ 	});
+/************************************************************************/
+/******/ 	// The module cache
+/******/ 	var __webpack_module_cache__ = {};
+/******/ 	
+/******/ 	// The require function
+/******/ 	function __webpack_require__(moduleId) {
+/******/ 		// Check if module is in cache
+/******/ 		var cachedModule = __webpack_module_cache__[moduleId];
+/******/ 		if (cachedModule !== undefined) {
+/******/ 			return cachedModule.exports;
+/******/ 		}
+/******/ 		// Create a new module (and put it into the cache)
+/******/ 		var module = __webpack_module_cache__[moduleId] = {
+/******/ 			// no module.id needed
+/******/ 			// no module.loaded needed
+/******/ 			exports: {}
+/******/ 		};
+/******/ 	
+/******/ 		// Execute the module function
+/******/ 		__webpack_modules__[moduleId](module, module.exports, __webpack_require__);
+/******/ 	
+/******/ 		// Return the exports of the module
+/******/ 		return module.exports;
+/******/ 	}
+/******/ 	
+/************************************************************************/
+/******/ 	/* webpack/runtime/compat get default export */
+/******/ 	(() => {
+/******/ 		// getDefaultExport function for compatibility with non-harmony modules
+/******/ 		__webpack_require__.n = (module) => {
+/******/ 			var getter = module && module.__esModule ?
+/******/ 				() => (module['default']) :
+/******/ 				() => (module);
+/******/ 			__webpack_require__.d(getter, { a: getter });
+/******/ 			return getter;
+/******/ 		};
+/******/ 	})();
+/******/ 	
+/******/ 	/* webpack/runtime/define property getters */
+/******/ 	(() => {
+/******/ 		// define getter functions for harmony exports
+/******/ 		__webpack_require__.d = (exports, definition) => {
+/******/ 			for(var key in definition) {
+/******/ 				if(__webpack_require__.o(definition, key) && !__webpack_require__.o(exports, key)) {
+/******/ 					Object.defineProperty(exports, key, { enumerable: true, get: definition[key] });
+/******/ 				}
+/******/ 			}
+/******/ 		};
+/******/ 	})();
+/******/ 	
+/******/ 	/* webpack/runtime/hasOwnProperty shorthand */
+/******/ 	(() => {
+/******/ 		__webpack_require__.o = (obj, prop) => (Object.prototype.hasOwnProperty.call(obj, prop))
+/******/ 	})();
+/******/ 	
+/******/ 	/* webpack/runtime/make namespace object */
+/******/ 	(() => {
+/******/ 		// define __esModule on exports
+/******/ 		__webpack_require__.r = (exports) => {
+/******/ 			if(typeof Symbol !== 'undefined' && Symbol.toStringTag) {
+/******/ 				Object.defineProperty(exports, Symbol.toStringTag, { value: 'Module' });
+/******/ 			}
+/******/ 			Object.defineProperty(exports, '__esModule', { value: true });
+/******/ 		};
+/******/ 	})();
+/******/ 	
+/************************************************************************/
+var __webpack_exports__ = {};
+// This entry needs to be wrapped in an IIFE because it needs to be isolated against other modules in the chunk.
+(() => {
+/*!***************************************************!*\
+  !*** ./src/tests.nativeEngine.drawPerformance.ts ***!
+  \***************************************************/
+__webpack_require__.r(__webpack_exports__);
+/* harmony import */ var _babylonjs_core__WEBPACK_IMPORTED_MODULE_0__ = __webpack_require__(/*! @babylonjs/core */ "@babylonjs/core");
+/* harmony import */ var _babylonjs_core__WEBPACK_IMPORTED_MODULE_0___default = /*#__PURE__*/__webpack_require__.n(_babylonjs_core__WEBPACK_IMPORTED_MODULE_0__);
+
+
+
+
+// Renders a grid of individual boxes sharing one material so that each frame issues many draws that only differ
+// by their world matrix. Used to measure the per-draw CPU cost of the engine.
+var gridSize = 32;
+
+var engine = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_0__.NativeEngine();
+var scene = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_0__.Scene(engine);
+var material = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_0__.StandardMaterial("material", scene);
+
+for (var x = 0; x < gridSize; ++x) {
+  for (var y = 0; y < gridSize; ++y) {
+    var box = _babylonjs_core__WEBPACK_IMPORTED_MODULE_0__.MeshBuilder.CreateBox("box".concat(x, "_").concat(y), { size: 0.5 }, scene);
+    box.position = new _babylonjs_core__WEBPACK_IMPORTED_MODULE_0__.Vector3(x - gridSize / 2, y - gridSize / 2, 0);
+    box.material = material;
+  }
+}
+
+// Time spent on the JavaScript thread for each frame, including command submission.
+var frameStart = 0;
+engine.onBeginFrameObservable.add(function () {
+  frameStart = _babylonjs_core__WEBPACK_IMPORTED_MODULE_0__.PrecisionDate.Now;
+});
+engine.onEndFrameObservable.add(function () {
+  reportFrameTime(_babylonjs_core__WEBPACK_IMPORTED_MODULE_0__.PrecisionDate.Now - frameStart);
+
+  // The native stats are those of the previous frame, whose commands have all been executed by now.
+  var stats = {};
+  engine._engine.populateFrameStats(stats);
+  reportFrameStats(stats.drawCount, stats.uniformSubmitCount, stats.uniformSkipCount);
+});
+
+scene.createDefaultCameraOrLight(true, true, true);
+scene.executeWhenReady(function () {
+  engine.runRenderLoop(function () {return scene.render();});
+  setSceneReady(gridSize * gridSize);
+});
+})();
+
+/******/ })()
+;
\ No newline at end of file
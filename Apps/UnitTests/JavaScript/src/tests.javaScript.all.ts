@@ -17,7 +17,8 @@ import {
   ShaderMaterial,
   Scene,
   Vector2,
-  BlurPostProcess
+  BlurPostProcess,
+  RenderTargetTexture
 } from "@babylonjs/core";
 import { GradientMaterial } from "@babylonjs/materials";
 
@@ -295,6 +296,84 @@ describe("PostProcesses", function () {
     });*/
 });
 
+describe("NativeEngine", function () {
+  this.timeout(0);
+
+  it("should apply uniforms set with COMMAND_SETUNIFORMS", function (done) {
+    const engine = new NativeEngine();
+    const scene = new Scene(engine);
+    scene.createDefaultCamera();
+
+    const plane = MeshBuilder.CreatePlane("plane", { size: 1 }, scene);
+    const material = new ShaderMaterial("batchedUniforms", scene, {
+      vertexSource: `
+        precision highp float;
+        attribute vec3 position;
+        void main() {
+          gl_Position = vec4(position.xy * 2.0, 0.0, 1.0);
+        }`,
+      fragmentSource: `
+        precision highp float;
+        uniform vec4 color;
+        uniform float scale;
+        uniform vec2 offset;
+        uniform vec4 colors[2];
+        uniform mat4 transform;
+        void main() {
+          gl_FragColor = transform * (color * scale) + colors[0] + colors[1] + vec4(offset, 0.0, 0.0);
+        }`,
+    }, { attributes: ["position"], uniforms: ["color", "scale", "offset", "colors", "transform"] });
+    material.backFaceCulling = false;
+    plane.material = material;
+
+    // The material does not set any of these uniforms, so the output only depends on the values of the batch.
+    material.onBindObservable.add(() => {
+      const effect = material.getEffect()!;
+      const encoder = (engine as any)._commandBufferEncoder;
+      encoder.startEncodingCommand(_native.Engine.COMMAND_SETUNIFORMS);
+      encoder.encodeCommandArgAsUInt32(5);
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("color"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOAT4);
+      [0.5, 0.25, 0, 0.5].forEach((value) => encoder.encodeCommandArgAsFloat32(value));
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("scale"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOAT);
+      encoder.encodeCommandArgAsFloat32(2);
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("offset"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOAT2);
+      encoder.encodeCommandArgAsFloat32(0);
+      encoder.encodeCommandArgAsFloat32(0.25);
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("colors"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_FLOATARRAY4);
+      encoder.encodeCommandArgAsFloat32s(new Float32Array([0, 0, 0, 0, 0, 0, 0.5, 0]));
+      encoder.encodeCommandArgAsNativeData(effect.getUniform("transform"));
+      encoder.encodeCommandArgAsUInt32(_native.Engine.UNIFORM_TYPE_MATRIX);
+      encoder.encodeCommandArgAsFloat32s(new Float32Array([1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1]));
+      encoder.finishEncodingCommand();
+    });
+
+    const renderTarget = new RenderTargetTexture("renderTarget", 4, scene);
+    renderTarget.renderList = [plane];
+    scene.customRenderTargets.push(renderTarget);
+
+    scene.executeWhenReady(() => {
+      scene.onAfterRenderObservable.addOnce(() => {
+        renderTarget.readPixels()!.then((pixels) => {
+          engine.stopRenderLoop();
+          const data = new Uint8Array(pixels.buffer, pixels.byteOffset, pixels.byteLength);
+          const center = (2 * 4 + 2) * 4;
+          expect(Math.abs(data[center] - 255)).to.be.lessThan(3);
+          expect(Math.abs(data[center + 1] - 191)).to.be.lessThan(3);
+          expect(Math.abs(data[center + 2] - 128)).to.be.lessThan(3);
+          expect(Math.abs(data[center + 3] - 255)).to.be.lessThan(3);
+          engine.dispose();
+          done();
+        }).catch(done);
+      });
+      engine.runRenderLoop(() => scene.render());
+    });
+  });
+});
+
 describe("NativeEncoding", function () {
   this.timeout(0);
 
@@ -326,6 +405,17 @@ describe("NativeEncoding", function () {
     ));
     await Promise.all(results.map(b => expectValidPNG(b)));
   });
+
+  it("should encode a JPEG", async function () {
+    const pixelData = new Uint8Array(16 * 16 * 4).fill(255);
+    const result = await _native.EncodeImageAsync(pixelData, 16, 16, "image/jpeg", false, 0.8);
+    expect(result.type).to.equal("image/jpeg");
+
+    const jpegSignature = new Uint8Array(await result.arrayBuffer(), 0, 3);
+    expect(jpegSignature[0]).to.equal(0xFF); // SOI marker
+    expect(jpegSignature[1]).to.equal(0xD8);
+    expect(jpegSignature[2]).to.equal(0xFF);
+  });
 });
 
 mocha.run((failures) => {
@@ -0,0 +1,41 @@
+import { MeshBuilder, NativeEngine, PrecisionDate, Scene, StandardMaterial, Vector3 } from "@babylonjs/core";
+
+declare const setSceneReady: (drawCount: number) => void;
+declare const reportFrameTime: (milliseconds: number) => void;
+declare const reportFrameStats: (drawCount: number, uniformSubmitCount: number, uniformSkipCount: number) => void;
+
+// Renders a grid of individual boxes sharing one material so that each frame issues many draws that only differ
+// by their world matrix. Used to measure the per-draw CPU cost of the engine.
+const gridSize = 32;
+
+const engine = new NativeEngine();
+const scene = new Scene(engine);
+const material = new StandardMaterial("material", scene);
+
+for (let x = 0; x < gridSize; ++x) {
+    for (let y = 0; y < gridSize; ++y) {
+        const box = MeshBuilder.CreateBox(`box${x}_${y}`, { size: 0.5 }, scene);
+        box.position = new Vector3(x - gridSize / 2, y - gridSize / 2, 0);
+        box.material = material;
+    }
+}
+
+// Time spent on the JavaScript thread for each frame, including command submission.
+let frameStart = 0;
+engine.onBeginFrameObservable.add(() => {
+    frameStart = PrecisionDate.Now;
+});
+engine.onEndFrameObservable.add(() => {
+    reportFrameTime(PrecisionDate.Now - frameStart);
+
+    // The native stats are those of the previous frame, whose commands have all been executed by now.
+    const stats: any = {};
+    (engine as any)._engine.populateFrameStats(stats);
+    reportFrameStats(stats.drawCount, stats.uniformSubmitCount, stats.uniformSkipCount);
+});
+
+scene.createDefaultCameraOrLight(true, true, true);
+scene.executeWhenReady(() => {
+    engine.runRenderLoop(() => scene.render());
+    setSceneReady(gridSize * gridSize);
+});
@@ -8,6 +8,7 @@ module.exports = {
   entry: {
     "tests.javaScript.all": './src/tests.javaScript.all.ts',
     "tests.nativeEngine.shaderCache": './src/tests.nativeEngine.shaderCache.ts',
+    "tests.nativeEngine.drawPerformance": './src/tests.nativeEngine.drawPerformance.ts',
   },
   externals: {
     "@babylonjs/core": "BABYLON",
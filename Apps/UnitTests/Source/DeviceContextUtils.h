@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Graphics/Device.h>
+#include <Babylon/Graphics/DeviceContext.h>
+
+#include <exception>
+#include <future>
+#include <optional>
+
+extern Babylon::Graphics::Configuration g_deviceConfig;
+
+// Calls the callback on the JavaScript thread of a new runtime with the context of a new device, while the device is
+// recording a frame. Used to test NativeEngine internals that require a device context. Exceptions thrown by the
+// callback are rethrown on the calling thread.
+template<typename CallableT>
+void RunWithDeviceContext(CallableT callback)
+{
+    Babylon::Graphics::Device device{g_deviceConfig};
+    Babylon::Graphics::DeviceUpdate update{device.GetUpdate("update")};
+
+    device.StartRenderingCurrentFrame();
+    update.Start();
+
+    std::promise<void> done{};
+    std::exception_ptr exception{};
+
+    {
+        Babylon::AppRuntime runtime{};
+        runtime.Dispatch([&device, &done, &callback](Napi::Env env) {
+            device.AddToJavaScript(env);
+
+            try
+            {
+                callback(Babylon::Graphics::DeviceContext::GetFromJavaScript(env));
+                done.set_value();
+            }
+            catch (...)
+            {
+                done.set_exception(std::current_exception());
+            }
+        });
+
+        try
+        {
+            done.get_future().get();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+    }
+
+    update.Finish();
+    device.FinishRenderingCurrentFrame();
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+// A new device whose context is used directly from the calling thread, which renders its frames. Used to test the
+// NativeEngine and device context internals that run when frames are rendered.
+class RenderingDevice final
+{
+public:
+    RenderingDevice()
+    {
+        m_device.StartRenderingCurrentFrame();
+        m_update.Start();
+
+        std::promise<Babylon::Graphics::DeviceContext*> deviceContext{};
+        m_runtime.emplace();
+        m_runtime->Dispatch([this, &deviceContext](Napi::Env env) {
+            m_device.AddToJavaScript(env);
+            deviceContext.set_value(&Babylon::Graphics::DeviceContext::GetFromJavaScript(env));
+        });
+
+        m_deviceContext = deviceContext.get_future().get();
+    }
+
+    ~RenderingDevice()
+    {
+        m_runtime.reset();
+        m_update.Finish();
+        m_device.FinishRenderingCurrentFrame();
+    }
+
+    Babylon::Graphics::DeviceContext& Context()
+    {
+        return *m_deviceContext;
+    }
+
+    void RenderFrame()
+    {
+        m_update.Finish();
+        m_device.FinishRenderingCurrentFrame();
+        m_device.StartRenderingCurrentFrame();
+        m_update.Start();
+    }
+
+private:
+    Babylon::Graphics::Device m_device{g_deviceConfig};
+    Babylon::Graphics::DeviceUpdate m_update{m_device.GetUpdate("update")};
+    std::optional<Babylon::AppRuntime> m_runtime{};
+    Babylon::Graphics::DeviceContext* m_deviceContext{};
+};
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "DracoDecoder.h"
+
+#include <draco/compression/encode.h>
+#include <draco/mesh/triangle_soup_mesh_builder.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    using Babylon::Plugins::NativeOptimizations::DracoAttribute;
+    using Babylon::Plugins::NativeOptimizations::DracoMesh;
+
+    // The two triangles of a unit quad, with an RGB color per corner.
+    constexpr size_t FACE_COUNT{2};
+    const std::array<std::array<float, 3>, FACE_COUNT * 3> POSITIONS{{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}}};
+    const std::array<std::array<uint8_t, 3>, FACE_COUNT * 3> COLORS{{{255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {0, 255, 0}, {255, 255, 255}, {0, 0, 255}}};
+
+    // Encodes the quad without quantization, so that it decodes to the same values.
+    std::vector<uint8_t> EncodeQuad()
+    {
+        draco::TriangleSoupMeshBuilder builder{};
+        builder.Start(FACE_COUNT);
+        const int position{builder.AddAttribute(draco::GeometryAttribute::POSITION, 3, draco::DT_FLOAT32)};
+        const int color{builder.AddAttribute(draco::GeometryAttribute::COLOR, 3, draco::DT_UINT8)};
+        for (uint32_t face = 0; face < FACE_COUNT; ++face)
+        {
+            builder.SetAttributeValuesForFace(position, draco::FaceIndex{face}, POSITIONS[face * 3].data(), POSITIONS[face * 3 + 1].data(), POSITIONS[face * 3 + 2].data());
+            builder.SetAttributeValuesForFace(color, draco::FaceIndex{face}, COLORS[face * 3].data(), COLORS[face * 3 + 1].data(), COLORS[face * 3 + 2].data());
+        }
+
+        const auto mesh{builder.Finalize()};
+        draco::Encoder encoder{};
+        encoder.SetEncodingMethod(draco::MESH_SEQUENTIAL_ENCODING);
+
+        draco::EncoderBuffer buffer{};
+        if (!encoder.EncodeMeshToBuffer(*mesh, &buffer).ok())
+        {
+            throw std::runtime_error{"Failed to encode the Draco mesh."};
+        }
+
+        return {buffer.data(), buffer.data() + buffer.size()};
+    }
+
+    const DracoAttribute& GetAttribute(const DracoMesh& mesh, const std::string& kind)
+    {
+        const auto attribute{std::find_if(mesh.Attributes.begin(), mesh.Attributes.end(), [&kind](const DracoAttribute& attribute) { return attribute.Kind == kind; })};
+        if (attribute == mesh.Attributes.end())
+        {
+            throw std::runtime_error{"Missing attribute " + kind};
+        }
+
+        return *attribute;
+    }
+
+    template<typename T, size_t SizeT>
+    std::array<T, SizeT> GetValue(const DracoAttribute& attribute, uint16_t vertex)
+    {
+        std::array<T, SizeT> value{};
+        std::memcpy(value.data(), attribute.Data.data() + static_cast<size_t>(vertex) * attribute.ByteStride, sizeof(value));
+        return value;
+    }
+}
+
+TEST(DracoDecoder, DecodesPaddedVertices)
+{
+    const auto encoded{EncodeQuad()};
+    const auto mesh{Babylon::Plugins::NativeOptimizations::DecodeDraco(encoded.data(), encoded.size(), {})};
+
+    ASSERT_EQ(mesh.Indices16.size(), FACE_COUNT * 3);
+    EXPECT_TRUE(mesh.Indices32.empty());
+
+    const auto& position{GetAttribute(mesh, "position")};
+    EXPECT_EQ(position.Size, 3u);
+    EXPECT_EQ(position.ComponentType, Babylon::Plugins::NativeOptimizations::COMPONENT_TYPE_FLOAT);
+    EXPECT_EQ(position.ByteStride, 12u);
+    EXPECT_EQ(position.Data.size(), mesh.VertexCount * position.ByteStride);
+
+    // Colors of 3 bytes are padded to 4 bytes per vertex.
+    const auto& color{GetAttribute(mesh, "color")};
+    EXPECT_EQ(color.Size, 3u);
+    EXPECT_EQ(color.ComponentType, Babylon::Plugins::NativeOptimizations::COMPONENT_TYPE_UNSIGNED_BYTE);
+    EXPECT_EQ(color.ByteStride, 4u);
+    ASSERT_EQ(color.Data.size(), mesh.VertexCount * color.ByteStride);
+
+    // The corners of every face have the encoded values, whatever the order of the vertices.
+    for (size_t corner = 0; corner < mesh.Indices16.size(); ++corner)
+    {
+        const uint16_t vertex{mesh.Indices16[corner]};
+        ASSERT_LT(vertex, mesh.VertexCount);
+        EXPECT_EQ((GetValue<float, 3>(position, vertex)), POSITIONS[corner]) << "corner " << corner;
+        EXPECT_EQ((GetValue<uint8_t, 3>(color, vertex)), COLORS[corner]) << "corner " << corner;
+        EXPECT_EQ(color.Data[static_cast<size_t>(vertex) * color.ByteStride + 3], std::byte{0}) << "corner " << corner;
+    }
+}
+
+TEST(DracoDecoder, RejectsInvalidData)
+{
+    const auto encoded{EncodeQuad()};
+    EXPECT_THROW(Babylon::Plugins::NativeOptimizations::DecodeDraco(encoded.data(), encoded.size() / 2, {}), std::runtime_error);
+    EXPECT_THROW(Babylon::Plugins::NativeOptimizations::DecodeDraco(encoded.data(), encoded.size(), {{"position", 42}}), std::runtime_error);
+}
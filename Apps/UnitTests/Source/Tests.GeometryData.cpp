@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "DeviceContextUtils.h"
+#include "GeometryData.h"
+
+#include <array>
+#include <memory>
+
+namespace
+{
+    // Returns a flag that is set once the reference of the data is released.
+    std::shared_ptr<bool> WatchReference(Babylon::GeometryData& data)
+    {
+        auto released{std::make_shared<bool>(false)};
+        data.WhenReferenceReleased().then(arcana::inline_scheduler, arcana::cancellation::none(), [released](const arcana::expected<void, std::exception_ptr>&) {
+            *released = true;
+        });
+        return released;
+    }
+}
+
+TEST(GeometryData, CopiesAreCountedUntilReleased)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        const std::array<uint8_t, 64> bytes{};
+        const auto residentBytes{deviceContext.GetGeometryResidentBytes()};
+
+        {
+            Babylon::GeometryData data{deviceContext, bytes, false};
+            EXPECT_EQ(deviceContext.GetGeometryResidentBytes(), residentBytes + bytes.size());
+
+            data.Release();
+            EXPECT_EQ(deviceContext.GetGeometryResidentBytes(), residentBytes);
+        }
+
+        {
+            Babylon::GeometryData data{deviceContext, bytes, false};
+        }
+        EXPECT_EQ(deviceContext.GetGeometryResidentBytes(), residentBytes);
+
+        // References are owned by JavaScript, and are not counted.
+        Babylon::GeometryData reference{deviceContext, bytes, true};
+        EXPECT_EQ(deviceContext.GetGeometryResidentBytes(), residentBytes);
+    });
+}
+
+TEST(GeometryData, CopiesAreCountedUntilUploaded)
+{
+    RenderingDevice device{};
+    auto& deviceContext{device.Context()};
+    const std::array<uint8_t, 64> bytes{};
+    const auto residentBytes{deviceContext.GetGeometryResidentBytes()};
+
+    Babylon::GeometryData data{deviceContext, bytes, false};
+    const auto handle{bgfx::createIndexBuffer(data.MakeMemory(false))};
+    data.Release();
+    EXPECT_EQ(deviceContext.GetGeometryResidentBytes(), residentBytes + bytes.size());
+
+    // bgfx releases the memory once the renderer has created the buffer, which may happen during the next frame.
+    device.RenderFrame();
+    device.RenderFrame();
+    EXPECT_EQ(deviceContext.GetGeometryResidentBytes(), residentBytes);
+
+    bgfx::destroy(handle);
+}
+
+TEST(GeometryData, ReferencesAreReleased)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        const std::array<uint8_t, 64> bytes{};
+
+        Babylon::GeometryData released{deviceContext, bytes, true};
+        const auto releasedFlag{WatchReference(released)};
+        EXPECT_FALSE(*releasedFlag);
+        released.Release();
+        EXPECT_TRUE(*releasedFlag);
+
+        std::shared_ptr<bool> destroyedFlag{};
+        {
+            Babylon::GeometryData destroyed{deviceContext, bytes, true};
+            destroyedFlag = WatchReference(destroyed);
+            EXPECT_FALSE(*destroyedFlag);
+        }
+        EXPECT_TRUE(*destroyedFlag);
+    });
+}
+
+TEST(GeometryData, ReferencesAreReleasedWhenUploaded)
+{
+    RenderingDevice device{};
+    const std::array<uint8_t, 64> bytes{};
+
+    Babylon::GeometryData data{device.Context(), bytes, true};
+    const auto released{WatchReference(data)};
+    const auto handle{bgfx::createIndexBuffer(data.MakeMemory(false))};
+
+    // The ArrayBuffer is still read by bgfx after the data has handed it over.
+    data.Release();
+    EXPECT_FALSE(*released);
+
+    device.RenderFrame();
+    device.RenderFrame();
+    EXPECT_TRUE(*released);
+
+    bgfx::destroy(handle);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "ImageOps.h"
+
+#include <Babylon/Graphics/DeviceContext.h>
+
+#include <vector>
+
+TEST(ImageOps, FlipUncompressedImage)
+{
+    std::vector<uint8_t> image{1, 2, 3, 4, 5, 6};
+    EXPECT_TRUE(Babylon::ImageOps::FlipImage({image.data(), image.size()}, bimg::TextureFormat::RG8, 3));
+    EXPECT_EQ(image, (std::vector<uint8_t>{5, 6, 3, 4, 1, 2}));
+}
+
+TEST(ImageOps, FlipBc1Image)
+{
+    // A 4x8 level: two blocks of two 16 bit endpoints and a byte of indices per row.
+    std::vector<uint8_t> image{
+        0x11, 0x22, 0x33, 0x44, 0x00, 0x55, 0xAA, 0xFF,
+        0x55, 0x66, 0x77, 0x88, 0x01, 0x02, 0x03, 0x04};
+    EXPECT_TRUE(Babylon::ImageOps::FlipImage({image.data(), image.size()}, bimg::TextureFormat::BC1, 8));
+    EXPECT_EQ(image, (std::vector<uint8_t>{
+        0x55, 0x66, 0x77, 0x88, 0x04, 0x03, 0x02, 0x01,
+        0x11, 0x22, 0x33, 0x44, 0xFF, 0xAA, 0x55, 0x00}));
+
+    // A level shorter than a block only uses its first rows.
+    std::vector<uint8_t> smallImage{0x11, 0x22, 0x33, 0x44, 0x00, 0x55, 0xAA, 0xFF};
+    EXPECT_TRUE(Babylon::ImageOps::FlipImage({smallImage.data(), smallImage.size()}, bimg::TextureFormat::BC1, 2));
+    EXPECT_EQ(smallImage, (std::vector<uint8_t>{0x11, 0x22, 0x33, 0x44, 0x55, 0x00, 0xAA, 0xFF}));
+
+    // Levels taller than a block must be a whole number of blocks tall.
+    EXPECT_FALSE(Babylon::ImageOps::FlipImage({image.data(), image.size()}, bimg::TextureFormat::BC1, 6));
+}
+
+TEST(ImageOps, FlipEtc1Image)
+{
+    // Individual colors 1 and 2, 3 and 4, 5 and 6, tables 1 and 2, sub-blocks one above the other, and a single index
+    // bit set for the top left pixel.
+    std::vector<uint8_t> image{0x12, 0x34, 0x56, (1 << 5) | (2 << 2) | 1, 0x00, 0x00, 0x00, 0x01};
+    EXPECT_TRUE(Babylon::ImageOps::FlipImage({image.data(), image.size()}, bimg::TextureFormat::ETC1, 4));
+
+    // The sub-blocks are swapped, and the index bit moves to the bottom left pixel.
+    EXPECT_EQ(image, (std::vector<uint8_t>{0x21, 0x43, 0x65, (2 << 5) | (1 << 2) | 1, 0x00, 0x00, 0x00, 0x08}));
+
+    // Differential colors of which the second is 4 less than the first cannot be swapped.
+    std::vector<uint8_t> differential{(10 << 3) | 4, 5 << 3, 5 << 3, (1 << 5) | (2 << 2) | 2 | 1, 0x00, 0x00, 0x00, 0x01};
+    const auto unchanged{differential};
+    EXPECT_FALSE(Babylon::ImageOps::FlipImage({differential.data(), differential.size()}, bimg::TextureFormat::ETC1, 4));
+    EXPECT_EQ(differential, unchanged);
+}
+
+TEST(ImageOps, CannotFlipAstcImage)
+{
+    EXPECT_FALSE(Babylon::ImageOps::CanFlipImage(bimg::TextureFormat::ASTC4x4));
+    EXPECT_TRUE(Babylon::ImageOps::CanFlipImage(bimg::TextureFormat::RGBA8));
+}
+
+TEST(ImageOps, DownsampleImage)
+{
+    // A 3x2 RGBA8 image, whose last column is dropped.
+    const std::vector<uint8_t> pixels{
+        0, 10, 20, 255, 4, 14, 24, 255, 100, 100, 100, 100,
+        8, 18, 28, 255, 12, 22, 32, 251, 100, 100, 100, 100};
+
+    auto& allocator{Babylon::Graphics::DeviceContext::GetDefaultAllocator()};
+    bimg::ImageContainer* image{bimg::imageAlloc(&allocator, bimg::TextureFormat::RGBA8, 3, 2, 1, 1, false, false, pixels.data())};
+    bimg::ImageContainer* level{Babylon::ImageOps::DownsampleImage(allocator, *image)};
+    ASSERT_EQ(level->m_width, 1u);
+    ASSERT_EQ(level->m_height, 1u);
+    ASSERT_EQ(level->m_numMips, 1u);
+
+    const auto* data{static_cast<const uint8_t*>(level->m_data)};
+    EXPECT_EQ(std::vector<uint8_t>(data, data + 4), (std::vector<uint8_t>{6, 16, 26, 254}));
+
+    // A single pixel image stays a single pixel.
+    bimg::ImageContainer* smallestLevel{Babylon::ImageOps::DownsampleImage(allocator, *level)};
+    EXPECT_EQ(smallestLevel->m_width, 1u);
+    EXPECT_EQ(std::vector<uint8_t>(static_cast<const uint8_t*>(smallestLevel->m_data), static_cast<const uint8_t*>(smallestLevel->m_data) + 4), (std::vector<uint8_t>{6, 16, 26, 254}));
+
+    bimg::imageFree(smallestLevel);
+    bimg::imageFree(level);
+    bimg::imageFree(image);
+}
+
+TEST(ImageOps, ExpandToRGBA8)
+{
+    // The pixel counts cover the SSE2 and NEON loops along with the pixels left after them.
+    for (size_t pixelCount : {1, 7, 8, 15, 16, 17, 33, 100})
+    {
+        std::vector<uint8_t> source(pixelCount * 3);
+        for (size_t index = 0; index < source.size(); ++index)
+        {
+            source[index] = static_cast<uint8_t>(index * 7 + 3);
+        }
+
+        std::vector<uint8_t> expectedR8(pixelCount * 4);
+        std::vector<uint8_t> expectedRG8(pixelCount * 4);
+        std::vector<uint8_t> expectedRGB8(pixelCount * 4);
+        for (size_t index = 0; index < pixelCount; ++index)
+        {
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                expectedR8[index * 4 + channel] = source[index];
+                expectedRG8[index * 4 + channel] = source[index * 2];
+                expectedRGB8[index * 4 + channel] = source[index * 3 + channel];
+            }
+            expectedR8[index * 4 + 3] = 0xFF;
+            expectedRG8[index * 4 + 3] = source[index * 2 + 1];
+            expectedRGB8[index * 4 + 3] = 0xFF;
+        }
+
+        std::vector<uint8_t> destination(pixelCount * 4);
+        Babylon::ImageOps::ExpandR8ToRGBA8(source.data(), destination.data(), pixelCount);
+        EXPECT_EQ(destination, expectedR8) << pixelCount << " pixels";
+        Babylon::ImageOps::ExpandRG8ToRGBA8(source.data(), destination.data(), pixelCount);
+        EXPECT_EQ(destination, expectedRG8) << pixelCount << " pixels";
+        Babylon::ImageOps::ExpandRGB8ToRGBA8(source.data(), destination.data(), pixelCount);
+        EXPECT_EQ(destination, expectedRGB8) << pixelCount << " pixels";
+    }
+}
+
+TEST(ImageOps, ScratchBuffersAreBounded)
+{
+    Babylon::ImageOps::TrimScratchBuffers();
+
+    {
+        // Buffers too large to be pooled are freed.
+        Babylon::ImageOps::ScratchBuffer buffer{64 * 1024 * 1024};
+    }
+    EXPECT_EQ(Babylon::ImageOps::GetScratchBufferBytes(), 0u);
+
+    {
+        Babylon::ImageOps::ScratchBuffer first{16 * 1024 * 1024};
+        Babylon::ImageOps::ScratchBuffer second{16 * 1024 * 1024};
+        Babylon::ImageOps::ScratchBuffer third{1024};
+    }
+    EXPECT_EQ(Babylon::ImageOps::GetScratchBufferBytes(), 32u * 1024 * 1024);
+
+    // Buffers are taken from the pool while in use.
+    {
+        Babylon::ImageOps::ScratchBuffer buffer{1024};
+        EXPECT_EQ(Babylon::ImageOps::GetScratchBufferBytes(), 16u * 1024 * 1024);
+    }
+
+    Babylon::ImageOps::TrimScratchBuffers();
+    EXPECT_EQ(Babylon::ImageOps::GetScratchBufferBytes(), 0u);
+}
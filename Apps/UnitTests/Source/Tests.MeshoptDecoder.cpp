@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "MeshoptDecoder.h"
+
+#include <meshoptimizer.h>
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    using Babylon::Plugins::NativeOptimizations::MeshoptFilter;
+    using Babylon::Plugins::NativeOptimizations::MeshoptMode;
+
+    // The four triangles of a 3x3 grid of vertices, whose vertices have 4 floats.
+    constexpr size_t VERTEX_COUNT{9};
+    constexpr size_t VERTEX_STRIDE{16};
+    const std::vector<uint32_t> INDICES{0, 1, 3, 1, 4, 3, 1, 2, 4, 2, 5, 4, 3, 4, 6, 4, 7, 6};
+
+    std::vector<uint8_t> GetVertices()
+    {
+        std::vector<uint8_t> vertices(VERTEX_COUNT * VERTEX_STRIDE);
+        for (size_t vertex = 0; vertex < VERTEX_COUNT; ++vertex)
+        {
+            const std::array<float, 4> values{static_cast<float>(vertex % 3), static_cast<float>(vertex / 3), 0.0f, 1.0f};
+            std::memcpy(vertices.data() + vertex * VERTEX_STRIDE, values.data(), VERTEX_STRIDE);
+        }
+        return vertices;
+    }
+
+    std::vector<uint8_t> EncodeVertices(const std::vector<uint8_t>& vertices)
+    {
+        std::vector<uint8_t> encoded(meshopt_encodeVertexBufferBound(VERTEX_COUNT, VERTEX_STRIDE));
+        encoded.resize(meshopt_encodeVertexBuffer(encoded.data(), encoded.size(), vertices.data(), VERTEX_COUNT, VERTEX_STRIDE));
+        return encoded;
+    }
+
+    std::vector<uint8_t> EncodeTriangles()
+    {
+        std::vector<uint8_t> encoded(meshopt_encodeIndexBufferBound(INDICES.size(), VERTEX_COUNT));
+        encoded.resize(meshopt_encodeIndexBuffer(encoded.data(), encoded.size(), INDICES.data(), INDICES.size()));
+        return encoded;
+    }
+
+    std::vector<uint8_t> EncodeIndices()
+    {
+        std::vector<uint8_t> encoded(meshopt_encodeIndexSequenceBound(INDICES.size(), VERTEX_COUNT));
+        encoded.resize(meshopt_encodeIndexSequence(encoded.data(), encoded.size(), INDICES.data(), INDICES.size()));
+        return encoded;
+    }
+
+    std::vector<uint8_t> Decode(const std::vector<uint8_t>& encoded, size_t count, size_t stride, MeshoptMode mode, MeshoptFilter filter = MeshoptFilter::None)
+    {
+        std::vector<uint8_t> decoded(Babylon::Plugins::NativeOptimizations::GetMeshoptDecodedSize(count, stride, mode, filter));
+        Babylon::Plugins::NativeOptimizations::DecodeMeshopt(decoded.data(), count, stride, encoded.data(), encoded.size(), mode, filter);
+        return decoded;
+    }
+
+    template<typename T>
+    std::vector<uint32_t> GetIndices(const std::vector<uint8_t>& decoded)
+    {
+        std::vector<T> indices(decoded.size() / sizeof(T));
+        std::memcpy(indices.data(), decoded.data(), decoded.size());
+        return {indices.begin(), indices.end()};
+    }
+}
+
+TEST(MeshoptDecoder, RoundTrips)
+{
+    const auto vertices{GetVertices()};
+    EXPECT_EQ(Decode(EncodeVertices(vertices), VERTEX_COUNT, VERTEX_STRIDE, MeshoptMode::Attributes), vertices);
+
+    // Indices decode to 16 or 32 bits whatever the size they were encoded from.
+    const auto triangles{EncodeTriangles()};
+    EXPECT_EQ(GetIndices<uint16_t>(Decode(triangles, INDICES.size(), 2, MeshoptMode::Triangles)), INDICES);
+    EXPECT_EQ(GetIndices<uint32_t>(Decode(triangles, INDICES.size(), 4, MeshoptMode::Triangles)), INDICES);
+
+    const auto indices{EncodeIndices()};
+    EXPECT_EQ(GetIndices<uint16_t>(Decode(indices, INDICES.size(), 2, MeshoptMode::Indices)), INDICES);
+    EXPECT_EQ(GetIndices<uint32_t>(Decode(indices, INDICES.size(), 4, MeshoptMode::Indices)), INDICES);
+}
+
+TEST(MeshoptDecoder, RejectsInvalidCountAndStride)
+{
+    using Babylon::Plugins::NativeOptimizations::GetMeshoptDecodedSize;
+
+    // Triangles must be whole.
+    EXPECT_THROW(GetMeshoptDecodedSize(INDICES.size() - 1, 4, MeshoptMode::Triangles, MeshoptFilter::None), std::runtime_error);
+    EXPECT_EQ(GetMeshoptDecodedSize(INDICES.size() - 1, 4, MeshoptMode::Indices, MeshoptFilter::None), (INDICES.size() - 1) * 4);
+
+    // Strides other than the ones of the extension.
+    EXPECT_THROW(GetMeshoptDecodedSize(VERTEX_COUNT, 0, MeshoptMode::Attributes, MeshoptFilter::None), std::runtime_error);
+    EXPECT_THROW(GetMeshoptDecodedSize(VERTEX_COUNT, 6, MeshoptMode::Attributes, MeshoptFilter::None), std::runtime_error);
+    EXPECT_THROW(GetMeshoptDecodedSize(VERTEX_COUNT, 260, MeshoptMode::Attributes, MeshoptFilter::None), std::runtime_error);
+    EXPECT_THROW(GetMeshoptDecodedSize(INDICES.size(), 8, MeshoptMode::Triangles, MeshoptFilter::None), std::runtime_error);
+
+    // The decoded size overflows.
+    EXPECT_THROW(GetMeshoptDecodedSize(std::numeric_limits<size_t>::max() / 4 + 1, 4, MeshoptMode::Attributes, MeshoptFilter::None), std::runtime_error);
+
+    // The checks run before anything is decoded, so the destination is left untouched.
+    const auto triangles{EncodeTriangles()};
+    std::vector<uint8_t> destination(INDICES.size() * 4);
+    EXPECT_THROW(Babylon::Plugins::NativeOptimizations::DecodeMeshopt(destination.data(), INDICES.size() - 1, 4, triangles.data(), triangles.size(), MeshoptMode::Triangles, MeshoptFilter::None), std::runtime_error);
+    EXPECT_EQ(destination, std::vector<uint8_t>(INDICES.size() * 4));
+
+    // Data that is too short to hold the elements.
+    const auto encoded{EncodeVertices(GetVertices())};
+    EXPECT_THROW(Decode({encoded.begin(), encoded.begin() + encoded.size() / 2}, VERTEX_COUNT, VERTEX_STRIDE, MeshoptMode::Attributes), std::runtime_error);
+}
+
+TEST(MeshoptDecoder, RejectsUnknownModesAndFilters)
+{
+    using Babylon::Plugins::NativeOptimizations::GetMeshoptDecodedSize;
+    using Babylon::Plugins::NativeOptimizations::ParseMeshoptFilter;
+    using Babylon::Plugins::NativeOptimizations::ParseMeshoptMode;
+
+    EXPECT_EQ(ParseMeshoptMode("TRIANGLES"), MeshoptMode::Triangles);
+    EXPECT_THROW(ParseMeshoptMode("POINTS"), std::runtime_error);
+
+    EXPECT_EQ(ParseMeshoptFilter(""), MeshoptFilter::None);
+    EXPECT_EQ(ParseMeshoptFilter("OCTAHEDRAL"), MeshoptFilter::Octahedral);
+    EXPECT_THROW(ParseMeshoptFilter("COLOR"), std::runtime_error);
+    EXPECT_THROW(ParseMeshoptFilter("octahedral"), std::runtime_error);
+
+    // Filters only apply to attributes of the strides they were made for.
+    EXPECT_THROW(GetMeshoptDecodedSize(INDICES.size(), 4, MeshoptMode::Triangles, MeshoptFilter::Exponential), std::runtime_error);
+    EXPECT_THROW(GetMeshoptDecodedSize(VERTEX_COUNT, 16, MeshoptMode::Attributes, MeshoptFilter::Octahedral), std::runtime_error);
+    EXPECT_THROW(GetMeshoptDecodedSize(VERTEX_COUNT, 4, MeshoptMode::Attributes, MeshoptFilter::Quaternion), std::runtime_error);
+    EXPECT_EQ(GetMeshoptDecodedSize(VERTEX_COUNT, 8, MeshoptMode::Attributes, MeshoptFilter::Quaternion), VERTEX_COUNT * 8);
+}
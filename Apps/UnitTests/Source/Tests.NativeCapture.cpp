@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Graphics/Device.h>
+#include <Babylon/Plugins/NativeCapture.h>
+#include <Babylon/ScriptLoader.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+
+extern Babylon::Graphics::Configuration g_deviceConfig;
+
+namespace
+{
+    // Frames are dropped until the JavaScript thread has allocated the pool, so enough frames are rendered for the
+    // script to receive the frames it waits for.
+    constexpr size_t MAX_FRAME_COUNT{100};
+
+    // Renders frames of a new device until the script, which captures them, passes the number of frames it received
+    // without errors to setResult, or a negative number if it failed.
+    int32_t RunCaptureScript(const std::string& script)
+    {
+        Babylon::Graphics::Device device{g_deviceConfig};
+        Babylon::Graphics::DeviceUpdate update{device.GetUpdate("update")};
+
+        // Only the first result counts, as frames can still be received after it.
+        std::promise<int32_t> result{};
+        auto resultFuture{result.get_future()};
+        bool resultSet{false};
+        auto setResult{[&result, &resultSet](int32_t value) {
+            if (!resultSet)
+            {
+                resultSet = true;
+                result.set_value(value);
+            }
+        }};
+
+        device.StartRenderingCurrentFrame();
+        update.Start();
+
+        {
+            Babylon::AppRuntime::Options options{};
+            options.UnhandledExceptionHandler = [&setResult](const Napi::Error& error) {
+                ADD_FAILURE() << error.Get("stack").As<Napi::String>().Utf8Value();
+                setResult(-1);
+            };
+
+            Babylon::AppRuntime runtime{options};
+            runtime.Dispatch([&device, &setResult](Napi::Env env) {
+                device.AddToJavaScript(env);
+                Babylon::Plugins::NativeCapture::Initialize(env);
+
+                env.Global().Set("setResult", Napi::Function::New(env, [&setResult](const Napi::CallbackInfo& info) {
+                    setResult(info[0].As<Napi::Number>().Int32Value());
+                }));
+            });
+
+            Babylon::ScriptLoader loader{runtime};
+            loader.Eval(script, "");
+
+            for (size_t frame = 0; frame < MAX_FRAME_COUNT && resultFuture.wait_for(std::chrono::milliseconds{10}) != std::future_status::ready; ++frame)
+            {
+                update.Finish();
+                device.FinishRenderingCurrentFrame();
+                device.StartRenderingCurrentFrame();
+                update.Start();
+            }
+
+            // The capture stops before the device renders its last frame.
+            std::promise<void> disposed{};
+            loader.Eval("capture.dispose();", "");
+            loader.Dispatch([&disposed](Napi::Env) { disposed.set_value(); });
+            disposed.get_future().wait();
+        }
+
+        update.Finish();
+        device.FinishRenderingCurrentFrame();
+
+        return resultFuture.wait_for(std::chrono::seconds{0}) == std::future_status::ready ? resultFuture.get() : 0;
+    }
+}
+
+TEST(NativeCapture, PooledFramesAreDelivered)
+{
+#ifdef USE_NOOP_METAL_DEVICE
+    GTEST_SKIP() << "The noop Metal device does not capture frames.";
+#endif
+
+    // Two slots, of which frames hold on to the first one, so that every other frame goes to the second one.
+    const auto received{RunCaptureScript(R"(
+        var capture = new NativeCapture();
+        capture.setFramePoolSize(2);
+        var count = 0;
+        var held = null;
+        capture.addCallback(function (frame) {
+            if (frame.data.byteLength === 0 || (frame.slot !== 0 && frame.slot !== 1)) {
+                setResult(-1);
+                return;
+            }
+            if (held === null) {
+                held = frame.slot;
+            } else if (frame.slot === held) {
+                setResult(-1);
+                return;
+            } else {
+                capture.releaseFrame(frame.slot);
+            }
+            if (++count === 3) {
+                setResult(count);
+            }
+        });
+    )")};
+
+    EXPECT_EQ(received, 3);
+}
+
+TEST(NativeCapture, PooledFramesSurviveReplacedData)
+{
+#ifdef USE_NOOP_METAL_DEVICE
+    GTEST_SKIP() << "The noop Metal device does not capture frames.";
+#endif
+
+    // A single slot whose ArrayBuffer is dropped by every frame, which must not prevent the next frames from being
+    // copied to the slot, nor leave them without data.
+    const auto received{RunCaptureScript(R"(
+        var capture = new NativeCapture();
+        capture.setFramePoolSize(1);
+        var count = 0;
+        capture.addCallback(function (frame) {
+            if (!(frame.data instanceof ArrayBuffer) || frame.data.byteLength === 0) {
+                setResult(-1);
+                return;
+            }
+            frame.data = null;
+            capture.releaseFrame(frame.slot);
+            if (++count === 3) {
+                setResult(count);
+            }
+        });
+    )")};
+
+    EXPECT_EQ(received, 3);
+}
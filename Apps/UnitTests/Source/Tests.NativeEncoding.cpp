@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include "ImageEncoder.h"
+
+#include <bimg/decode.h>
+#include <bx/allocator.h>
+#include <miniz.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    using namespace Babylon::Plugins::NativeEncoding;
+
+    // An RGBA8 image with a smooth gradient, whose size is not a multiple of the JPEG blocks.
+    std::vector<std::byte> CreatePixels(uint32_t width, uint32_t height)
+    {
+        std::vector<std::byte> pixels(static_cast<size_t>(width) * height * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                std::byte* pixel{&pixels[(static_cast<size_t>(y) * width + x) * 4]};
+                pixel[0] = static_cast<std::byte>(x * 255 / (width - 1));
+                pixel[1] = static_cast<std::byte>(y * 255 / (height - 1));
+                pixel[2] = static_cast<std::byte>(128);
+                pixel[3] = static_cast<std::byte>(255);
+            }
+        }
+        return pixels;
+    }
+
+    std::vector<std::byte> Encode(const ImageEncoder& encoder)
+    {
+        std::vector<std::vector<std::byte>> bands(encoder.BandCount());
+        for (size_t band = 0; band < bands.size(); ++band)
+        {
+            encoder.EncodeBand(band, bands[band]);
+        }
+        return encoder.Join(std::move(bands));
+    }
+
+    // Decodes the image, and returns the largest difference of a color channel from the pixels, whose rows are expected
+    // in the opposite order when flipped.
+    int Decode(const std::vector<std::byte>& encoded, const std::vector<std::byte>& pixels, uint32_t width, uint32_t height, bool flipped)
+    {
+        bx::DefaultAllocator allocator{};
+        bimg::ImageContainer* image{bimg::imageParse(&allocator, encoded.data(), static_cast<uint32_t>(encoded.size()), bimg::TextureFormat::RGBA8)};
+        if (image == nullptr)
+        {
+            ADD_FAILURE() << "The image could not be decoded.";
+            return 255;
+        }
+
+        EXPECT_EQ(image->m_width, width);
+        EXPECT_EQ(image->m_height, height);
+
+        int maxDifference{};
+        if (image->m_width == width && image->m_height == height)
+        {
+            const auto* decoded{static_cast<const uint8_t*>(image->m_data)};
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                const uint32_t sourceY{flipped ? height - y - 1 : y};
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (size_t channel = 0; channel < 3; ++channel)
+                    {
+                        const int expected{std::to_integer<int>(pixels[(static_cast<size_t>(sourceY) * width + x) * 4 + channel])};
+                        const int actual{decoded[(static_cast<size_t>(y) * width + x) * 4 + channel]};
+                        maxDifference = std::max(maxDifference, std::abs(expected - actual));
+                    }
+                }
+            }
+        }
+
+        bimg::imageFree(image);
+        return maxDifference;
+    }
+
+    uint32_t ReadUint32(const std::byte* data)
+    {
+        return std::to_integer<uint32_t>(data[0]) << 24 | std::to_integer<uint32_t>(data[1]) << 16 | std::to_integer<uint32_t>(data[2]) << 8 | std::to_integer<uint32_t>(data[3]);
+    }
+
+    // Checks the CRC of every chunk of a PNG image, and returns the number of IDAT chunks and the zlib stream they hold.
+    std::pair<size_t, std::vector<std::byte>> ReadImageData(const std::vector<std::byte>& encoded)
+    {
+        size_t chunkCount{};
+        std::vector<std::byte> imageData{};
+        for (size_t offset = 8; offset + 12 <= encoded.size();)
+        {
+            const uint32_t length{ReadUint32(encoded.data() + offset)};
+            if (offset + 12 + length > encoded.size())
+            {
+                ADD_FAILURE() << "The chunk at " << offset << " is truncated.";
+                break;
+            }
+
+            const auto* type{encoded.data() + offset + 4};
+            const auto crc{static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(type), length + 4))};
+            EXPECT_EQ(ReadUint32(type + 4 + length), crc) << "chunk at " << offset;
+
+            if (std::memcmp(type, "IDAT", 4) == 0)
+            {
+                ++chunkCount;
+                imageData.insert(imageData.end(), type + 4, type + 4 + length);
+            }
+
+            offset += 12 + length;
+        }
+
+        return {chunkCount, imageData};
+    }
+
+    // The rows of the image as PNG filters them, each with a leading filter type of none.
+    std::vector<unsigned char> GetFilteredRows(const std::vector<std::byte>& pixels, uint32_t width, uint32_t height, bool flipped)
+    {
+        const size_t rowSize{static_cast<size_t>(width) * 4};
+        std::vector<unsigned char> rows{};
+        rows.reserve((rowSize + 1) * height);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const auto* row{reinterpret_cast<const unsigned char*>(pixels.data()) + (flipped ? height - y - 1 : y) * rowSize};
+            rows.push_back(0);
+            rows.insert(rows.end(), row, row + rowSize);
+        }
+        return rows;
+    }
+}
+
+TEST(NativeEncoding, PngRoundTrips)
+{
+    constexpr uint32_t width{37};
+    constexpr uint32_t height{301};
+    const auto pixels{CreatePixels(width, height)};
+
+    // The image is small enough to be a single band by default, so the bands that are joined into one zlib stream, and
+    // whose checksums are combined, are forced. 7 bands do not divide the rows evenly.
+    for (size_t bandCount : {1, 2, 7})
+    {
+        for (bool flipped : {false, true})
+        {
+            SCOPED_TRACE(testing::Message() << bandCount << " bands" << (flipped ? ", flipped" : ""));
+
+            const auto encoder{CreatePngEncoder({pixels.data(), width, height, flipped}, bandCount)};
+            ASSERT_EQ(encoder->BandCount(), bandCount);
+
+            const auto encoded{Encode(*encoder)};
+            EXPECT_EQ(Decode(encoded, pixels, width, height, flipped), 0);
+
+            // Each band writes an IDAT chunk, and the trailer writes one more with the checksum of the zlib stream.
+            const auto [chunkCount, imageData] = ReadImageData(encoded);
+            EXPECT_EQ(chunkCount, bandCount + 1);
+            ASSERT_GE(imageData.size(), 6u);
+
+            const auto rows{GetFilteredRows(pixels, width, height, flipped)};
+            const auto checksum{static_cast<uint32_t>(mz_adler32(MZ_ADLER32_INIT, rows.data(), rows.size()))};
+            EXPECT_EQ(ReadUint32(imageData.data() + imageData.size() - 4), checksum);
+
+            // The bands inflate as a single zlib stream, whose checksum is verified by inflating it.
+            std::vector<unsigned char> inflated(rows.size());
+            auto inflatedSize{static_cast<mz_ulong>(inflated.size())};
+            ASSERT_EQ(mz_uncompress(inflated.data(), &inflatedSize, reinterpret_cast<const unsigned char*>(imageData.data()), static_cast<mz_ulong>(imageData.size())), MZ_OK);
+            EXPECT_EQ(inflatedSize, rows.size());
+            EXPECT_TRUE(inflated == rows);
+        }
+    }
+}
+
+TEST(NativeEncoding, JpegDecodesToTheImage)
+{
+    constexpr uint32_t width{37};
+    constexpr uint32_t height{301};
+    const auto pixels{CreatePixels(width, height)};
+
+    for (bool flipped : {false, true})
+    {
+        // Chroma is subsampled below a quality of 0.9.
+        for (double quality : {0.5, 0.92})
+        {
+            const auto encoder{CreateJpegEncoder({pixels.data(), width, height, flipped}, quality)};
+            EXPECT_STREQ(encoder->MimeType(), "image/jpeg");
+            EXPECT_LE(Decode(Encode(*encoder), pixels, width, height, flipped), quality < 0.9 ? 20 : 8) << "quality " << quality;
+        }
+    }
+}
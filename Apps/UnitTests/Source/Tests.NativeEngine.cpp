@@ -8,7 +8,9 @@
 #include <Babylon/ScriptLoader.h>
 #include <Babylon/ShaderCache.h>
 
+#include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <optional>
 #include <future>
 #include <iostream>
@@ -80,7 +82,140 @@ TEST(NativeEngine, ShaderCache)
         auto deserializedCount = Babylon::ShaderCache::Deserialize(file);
         EXPECT_EQ(deserializedCount, shaderCount);
     }
+    {
+        static const char* shaderCacheOpenFileName = "shaderCacheOpen.bin";
+        std::remove(shaderCacheOpenFileName);
+        EXPECT_EQ(Babylon::ShaderCache::Open(shaderCacheOpenFileName), shaderCount);
+        EXPECT_EQ(Babylon::ShaderCache::Open(shaderCacheOpenFileName), shaderCount);
+    }
 
     update.Finish();
     device.FinishRenderingCurrentFrame();
 }
+
+namespace
+{
+    void RunDrawPerformance(const Babylon::Graphics::Configuration& config)
+    {
+        constexpr uint32_t frameCount{120};
+
+        Babylon::Graphics::Device device{config};
+        Babylon::Graphics::DeviceUpdate update{device.GetUpdate("update")};
+
+        device.StartRenderingCurrentFrame();
+        update.Start();
+
+        std::promise<void> scriptIsDone{};
+        std::promise<uint32_t> sceneIsReady{};
+
+        std::atomic<bool> measuring{false};
+        std::atomic<uint64_t> jsFrameTimeMicroseconds{0};
+        std::atomic<uint32_t> jsFrameCount{0};
+        std::atomic<uint64_t> nativeDrawCount{0};
+        std::atomic<uint64_t> uniformSubmitCount{0};
+        std::atomic<uint64_t> uniformSkipCount{0};
+
+        Babylon::AppRuntime runtime{};
+        runtime.Dispatch([&device, &sceneIsReady, &measuring, &jsFrameTimeMicroseconds, &jsFrameCount, &nativeDrawCount, &uniformSubmitCount, &uniformSkipCount](Napi::Env env) {
+            device.AddToJavaScript(env);
+
+            Babylon::Polyfills::Console::Initialize(env, [](const char* message, auto) {
+                std::cout << message << std::endl;
+                std::cout.flush();
+            });
+            Babylon::Polyfills::Window::Initialize(env);
+            Babylon::Plugins::NativeEngine::Initialize(env);
+
+            env.Global().Set("setSceneReady",
+                Napi::Function::New(
+                    env, [&sceneIsReady](const Napi::CallbackInfo& info) {
+                        sceneIsReady.set_value(info[0].As<Napi::Number>().Uint32Value());
+                    },
+                    "setSceneReady"));
+
+            env.Global().Set("reportFrameTime",
+                Napi::Function::New(
+                    env, [&measuring, &jsFrameTimeMicroseconds, &jsFrameCount](const Napi::CallbackInfo& info) {
+                        if (measuring)
+                        {
+                            jsFrameTimeMicroseconds += static_cast<uint64_t>(info[0].As<Napi::Number>().DoubleValue() * 1000.0);
+                            ++jsFrameCount;
+                        }
+                    },
+                    "reportFrameTime"));
+
+            env.Global().Set("reportFrameStats",
+                Napi::Function::New(
+                    env, [&measuring, &nativeDrawCount, &uniformSubmitCount, &uniformSkipCount](const Napi::CallbackInfo& info) {
+                        if (measuring)
+                        {
+                            nativeDrawCount += info[0].As<Napi::Number>().Int64Value();
+                            uniformSubmitCount += info[1].As<Napi::Number>().Int64Value();
+                            uniformSkipCount += info[2].As<Napi::Number>().Int64Value();
+                        }
+                    },
+                    "reportFrameStats"));
+        });
+
+        Babylon::ScriptLoader loader{runtime};
+        loader.LoadScript("app:///Assets/babylon.max.js");
+        loader.LoadScript("app:///Assets/tests.nativeEngine.drawPerformance.js");
+        loader.Dispatch([&scriptIsDone](Napi::Env) {
+            scriptIsDone.set_value();
+        });
+
+        scriptIsDone.get_future().get();
+
+        auto sceneIsReadyFuture = sceneIsReady.get_future();
+        while (sceneIsReadyFuture.wait_for(16ms) != std::future_status::ready)
+        {
+            update.Finish();
+            device.FinishRenderingCurrentFrame();
+            device.StartRenderingCurrentFrame();
+            update.Start();
+        }
+
+        const uint32_t drawCount{sceneIsReadyFuture.get()};
+
+        measuring = true;
+        const auto start{std::chrono::high_resolution_clock::now()};
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            update.Finish();
+            device.FinishRenderingCurrentFrame();
+            device.StartRenderingCurrentFrame();
+            update.Start();
+        }
+        const std::chrono::duration<double> elapsed{std::chrono::high_resolution_clock::now() - start};
+        measuring = false;
+
+        std::cout << "Rendered " << frameCount << " frames of " << drawCount << " draws in " << elapsed.count() << "s ("
+                  << (frameCount * drawCount) / elapsed.count() << " draws/sec)" << std::endl;
+
+        if (jsFrameCount > 0)
+        {
+            std::cout << "JavaScript thread time per frame: " << (jsFrameTimeMicroseconds / 1000.0) / jsFrameCount << "ms" << std::endl;
+        }
+
+        update.Finish();
+        device.FinishRenderingCurrentFrame();
+
+        // Every box shares one material and only differs by its world matrix, so most uniform values must be skipped as
+        // unchanged rather than submitted again for every draw.
+        EXPECT_GE(nativeDrawCount, drawCount);
+        EXPECT_GT(uniformSubmitCount, 0u);
+        EXPECT_GT(uniformSkipCount, uniformSubmitCount);
+    }
+}
+
+TEST(NativeEngine, DrawPerformance)
+{
+    RunDrawPerformance(g_deviceConfig);
+}
+
+TEST(NativeEngine, DrawPerformanceThreadedCommandSubmission)
+{
+    Babylon::Graphics::Configuration config{g_deviceConfig};
+    config.ThreadedCommandSubmission = true;
+    RunDrawPerformance(config);
+}
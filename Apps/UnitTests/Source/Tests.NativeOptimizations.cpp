@@ -0,0 +1,453 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/AppRuntime.h>
+#include <Babylon/Plugins/NativeOptimizations.h>
+
+#include "Kernels.h"
+#include "MeshOptimizer.h"
+#include "Parallel.h"
+
+#include <arcana/threading/task_schedulers.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    using Babylon::Plugins::NativeOptimizations::Kernels;
+    using Babylon::Plugins::NativeOptimizations::SkinningData;
+
+    constexpr size_t VertexCount{37};
+    constexpr size_t BoneCount{5};
+
+    std::vector<float> RandomFloats(std::mt19937& random, size_t count, float minimum, float maximum)
+    {
+        std::uniform_real_distribution<float> distribution{minimum, maximum};
+        std::vector<float> values(count);
+        for (auto& value : values)
+        {
+            value = distribution(random);
+        }
+        return values;
+    }
+
+    // The SIMD kernels may fuse or reorder operations, so they are compared with a tolerance relative to the magnitude.
+    void ExpectNear(const std::vector<float>& actual, const std::vector<float>& expected)
+    {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t index = 0; index < actual.size(); ++index)
+        {
+            EXPECT_NEAR(actual[index], expected[index], 1e-4f * std::max(1.0f, std::abs(expected[index]))) << "at index " << index;
+        }
+    }
+
+    // Runs every kernel of `kernels` and of the scalar kernels on the same data, and checks that the results match.
+    void ExpectSameAsScalar(const Kernels& kernels)
+    {
+        SCOPED_TRACE(kernels.Name);
+
+        const auto& scalar{Babylon::Plugins::NativeOptimizations::GetScalarKernels()};
+        std::mt19937 random{42};
+
+        // Positions of stride 4 to check that the fourth component is left untouched.
+        const auto positions{RandomFloats(random, VertexCount * 4, -100.0f, 100.0f)};
+        const auto matrix{RandomFloats(random, 16, -2.0f, 2.0f)};
+
+        {
+            auto expected{positions};
+            auto actual{positions};
+            scalar.TransformCoordinates(expected.data(), VertexCount, 4, matrix.data());
+            kernels.TransformCoordinates(actual.data(), VertexCount, 4, matrix.data());
+            ExpectNear(actual, expected);
+        }
+
+        {
+            auto expected{positions};
+            auto actual{positions};
+            scalar.TransformNormals(expected.data(), VertexCount, 4, matrix.data());
+            kernels.TransformNormals(actual.data(), VertexCount, 4, matrix.data());
+            ExpectNear(actual, expected);
+        }
+
+        {
+            std::vector<float> expected{1e9f, 1e9f, 1e9f, -1e9f, -1e9f, -1e9f};
+            std::vector<float> actual{expected};
+            scalar.ExtractMinAndMax(positions.data(), VertexCount, 4, expected.data(), expected.data() + 3);
+            kernels.ExtractMinAndMax(positions.data(), VertexCount, 4, actual.data(), actual.data() + 3);
+            EXPECT_EQ(actual, expected);
+        }
+
+        {
+            const std::vector<uint16_t> indices16{3, 0, 7, 7, 12, 1};
+            const std::vector<uint32_t> indices32{indices16.begin(), indices16.end()};
+            const auto vec3Positions{RandomFloats(random, 13 * 3, -100.0f, 100.0f)};
+
+            std::vector<float> expected{1e9f, 1e9f, 1e9f, -1e9f, -1e9f, -1e9f};
+            std::vector<float> actual16{expected};
+            std::vector<float> actual32{expected};
+            scalar.ExtractMinAndMaxIndexed16(vec3Positions.data(), indices16.data(), indices16.size(), expected.data(), expected.data() + 3);
+            kernels.ExtractMinAndMaxIndexed16(vec3Positions.data(), indices16.data(), indices16.size(), actual16.data(), actual16.data() + 3);
+            kernels.ExtractMinAndMaxIndexed32(vec3Positions.data(), indices32.data(), indices32.size(), actual32.data(), actual32.data() + 3);
+            EXPECT_EQ(actual16, expected);
+            EXPECT_EQ(actual32, expected);
+        }
+
+        {
+            const auto vec3Positions{RandomFloats(random, VertexCount * 3, -100.0f, 100.0f)};
+            const auto matrices{RandomFloats(random, BoneCount * 16, -2.0f, 2.0f)};
+
+            // Whole bone indices with some zero weights, as Babylon.js stores them.
+            std::uniform_int_distribution<int> boneDistribution{0, static_cast<int>(BoneCount) - 1};
+            std::vector<float> indices(VertexCount * 8);
+            for (auto& index : indices)
+            {
+                index = static_cast<float>(boneDistribution(random));
+            }
+            auto weights{RandomFloats(random, VertexCount * 8, 0.0f, 1.0f)};
+            for (size_t index = 0; index < weights.size(); index += 3)
+            {
+                weights[index] = 0.0f;
+            }
+
+            for (const bool extra : {false, true})
+            {
+                SkinningData skinning{matrices.data(), indices.data(), weights.data()};
+                if (extra)
+                {
+                    skinning.IndicesExtra = indices.data() + VertexCount * 4;
+                    skinning.WeightsExtra = weights.data() + VertexCount * 4;
+                }
+
+                for (const bool normals : {false, true})
+                {
+                    auto expected{vec3Positions};
+                    auto actual{vec3Positions};
+                    scalar.ApplySkeleton(expected.data(), VertexCount, normals, skinning);
+                    kernels.ApplySkeleton(actual.data(), VertexCount, normals, skinning);
+                    ExpectNear(actual, expected);
+                }
+            }
+        }
+    }
+
+    // Calls the callback on the JavaScript thread of a new runtime with the NativeOptimizations plugin, with the native
+    // object that the plugin adds its functions to. If the callback returns a promise, waits for it to settle as well.
+    template<typename CallableT>
+    void RunWithNativeOptimizations(CallableT callback)
+    {
+        std::promise<void> done{};
+
+        Babylon::AppRuntime runtime{};
+        runtime.Dispatch([&done, &callback](Napi::Env env) {
+            try
+            {
+                Babylon::Plugins::NativeOptimizations::Initialize(env);
+                auto nativeObject{env.Global().Get("_native").As<Napi::Object>()};
+
+                if constexpr (std::is_void_v<std::invoke_result_t<CallableT, Napi::Env, Napi::Object>>)
+                {
+                    callback(env, nativeObject);
+                    done.set_value();
+                }
+                else
+                {
+                    auto promise{callback(env, nativeObject).template As<Napi::Object>()};
+                    promise.Get("then").As<Napi::Function>().Call(promise, {
+                        Napi::Function::New(env, [&done](const Napi::CallbackInfo&) {
+                            done.set_value();
+                        }),
+                        Napi::Function::New(env, [&done](const Napi::CallbackInfo& info) {
+                            done.set_exception(std::make_exception_ptr(std::runtime_error{info[0].ToString().Utf8Value()}));
+                        }),
+                    });
+                }
+            }
+            catch (...)
+            {
+                done.set_exception(std::current_exception());
+            }
+        });
+
+        done.get_future().get();
+    }
+
+    Napi::Float32Array CreateFloat32Array(Napi::Env env, const std::vector<float>& values)
+    {
+        auto array{Napi::Float32Array::New(env, values.size())};
+        std::copy(values.begin(), values.end(), array.Data());
+        return array;
+    }
+
+    // A flat grid of `size` by `size` quads of two triangles, with positions of stride 3.
+    struct Grid
+    {
+        std::vector<float> Positions{};
+        std::vector<uint32_t> Indices{};
+        size_t VertexCount{};
+    };
+
+    Grid CreateGrid(uint32_t size)
+    {
+        Grid grid{};
+        grid.VertexCount = static_cast<size_t>(size + 1) * (size + 1);
+        for (uint32_t y = 0; y <= size; ++y)
+        {
+            for (uint32_t x = 0; x <= size; ++x)
+            {
+                grid.Positions.insert(grid.Positions.end(), {static_cast<float>(x), static_cast<float>(y), 0});
+            }
+        }
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const uint32_t vertex{y * (size + 1) + x};
+                grid.Indices.insert(grid.Indices.end(), {vertex, vertex + 1, vertex + size + 1, vertex + 1, vertex + size + 2, vertex + size + 1});
+            }
+        }
+
+        return grid;
+    }
+
+    // The triangles of the indices, each rotated to start with its smallest index, in sorted order.
+    std::vector<std::array<uint32_t, 3>> GetTriangles(const std::vector<uint32_t>& indices)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles{};
+        for (size_t index = 0; index < indices.size(); index += 3)
+        {
+            std::array<uint32_t, 3> triangle{indices[index], indices[index + 1], indices[index + 2]};
+            std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+            triangles.push_back(triangle);
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
+
+// The baseline kernels are SSE2 or NEON depending on the target, so this covers the NEON kernels on ARM test runs.
+TEST(NativeOptimizations, BaselineKernelsMatchScalar)
+{
+    ExpectSameAsScalar(Babylon::Plugins::NativeOptimizations::GetBaselineKernels());
+}
+
+TEST(NativeOptimizations, Avx2KernelsMatchScalar)
+{
+    const auto* kernels{Babylon::Plugins::NativeOptimizations::GetAvx2Kernels()};
+    if (kernels == nullptr)
+    {
+        GTEST_SKIP() << "AVX2 kernels are not supported.";
+    }
+
+    ExpectSameAsScalar(*kernels);
+}
+
+TEST(NativeOptimizations, ParallelForRunsEveryItemOnce)
+{
+    constexpr size_t count{100000};
+    std::vector<std::atomic<int>> visits(count);
+
+    Babylon::Plugins::NativeOptimizations::ParallelFor(count, 1000, [&visits](size_t, size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index)
+        {
+            ++visits[index];
+        }
+    });
+
+    EXPECT_TRUE(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& visit) { return visit == 1; }));
+}
+
+TEST(NativeOptimizations, ParallelForRethrows)
+{
+    EXPECT_THROW(Babylon::Plugins::NativeOptimizations::ParallelFor(100000, 1000, [](size_t, size_t, size_t end) {
+        if (end == 100000)
+        {
+            throw std::runtime_error{"chunk"};
+        }
+    }),
+        std::runtime_error);
+}
+
+TEST(NativeOptimizations, ParallelForDoesNotWaitForBusyThreadPool)
+{
+    // Occupies the thread pool until ParallelFor has returned, which it can only do by running every chunk itself.
+    std::promise<void> release{};
+    std::shared_future<void> released{release.get_future()};
+    for (size_t task = 0; task < std::thread::hardware_concurrency() * 4; ++task)
+    {
+        arcana::threadpool_scheduler([released]() { released.wait(); });
+    }
+
+    std::atomic<size_t> itemCount{};
+    Babylon::Plugins::NativeOptimizations::ParallelFor(100000, 1000, [&itemCount](size_t, size_t begin, size_t end) {
+        itemCount += end - begin;
+    });
+
+    release.set_value();
+    EXPECT_EQ(itemCount, 100000u);
+}
+
+TEST(NativeOptimizations, ApplySkeletonRejectsOutOfBoundsInfluences)
+{
+    RunWithNativeOptimizations([](Napi::Env env, Napi::Object nativeObject) {
+        auto applySkeleton{nativeObject.Get("_ApplySkeleton").As<Napi::Function>()};
+
+        // One vertex with two bones.
+        auto data{CreateFloat32Array(env, {1, 2, 3})};
+        auto matrices{CreateFloat32Array(env, std::vector<float>(32))};
+        auto applyWithInfluences = [&](const std::vector<float>& indices, const std::vector<float>& weights) {
+            applySkeleton.Call({data, Napi::String::New(env, "position"), matrices, CreateFloat32Array(env, indices), CreateFloat32Array(env, weights), env.Null(), env.Null()});
+        };
+
+        EXPECT_NO_THROW(applyWithInfluences({0, 1, 0, 0}, {0.5f, 0.5f, 0, 0}));
+
+        // Influences without weight are never read, whatever their index.
+        EXPECT_NO_THROW(applyWithInfluences({0, 1, 2, -1}, {0.5f, 0.5f, 0, 0}));
+
+        EXPECT_THROW(applyWithInfluences({0, 2, 0, 0}, {0.5f, 0.5f, 0, 0}), Napi::Error);
+        EXPECT_THROW(applyWithInfluences({-1, 0, 0, 0}, {0.5f, 0.5f, 0, 0}), Napi::Error);
+        EXPECT_THROW(applyWithInfluences({std::nanf(""), 0, 0, 0}, {1, 0, 0, 0}), Napi::Error);
+    });
+}
+
+TEST(NativeOptimizations, ApplySkeletonMatchesScalar)
+{
+    // Enough vertices to be split into several chunks.
+    constexpr size_t vertexCount{20000};
+    std::mt19937 random{7};
+
+    const auto positions{RandomFloats(random, vertexCount * 3, -100.0f, 100.0f)};
+    const auto matrices{RandomFloats(random, BoneCount * 16, -2.0f, 2.0f)};
+    std::vector<float> indices(vertexCount * 4);
+    for (size_t index = 0; index < indices.size(); ++index)
+    {
+        indices[index] = static_cast<float>(index % BoneCount);
+    }
+    const auto weights{RandomFloats(random, vertexCount * 4, 0.0f, 1.0f)};
+
+    auto expected{positions};
+    Babylon::Plugins::NativeOptimizations::GetScalarKernels().ApplySkeleton(expected.data(), vertexCount, false, {matrices.data(), indices.data(), weights.data()});
+
+    for (const char* function : {"_ApplySkeleton", "_ApplySkeletonAsync"})
+    {
+        SCOPED_TRACE(function);
+
+        // The data is an external array buffer over `actual`, so that it can be checked once the runtime is gone.
+        std::vector<float> actual{positions};
+        RunWithNativeOptimizations([&](Napi::Env env, Napi::Object nativeObject) {
+            auto data{Napi::Float32Array::New(env, actual.size(), Napi::ArrayBuffer::New(env, actual.data(), actual.size() * sizeof(float)), 0)};
+            auto result{nativeObject.Get(function).As<Napi::Function>().Call({data, Napi::String::New(env, "position"), CreateFloat32Array(env, matrices), CreateFloat32Array(env, indices), CreateFloat32Array(env, weights), env.Null(), env.Null()})};
+            if (result.IsPromise())
+            {
+                return result;
+            }
+
+            auto promiseConstructor{env.Global().Get("Promise").As<Napi::Object>()};
+            return promiseConstructor.Get("resolve").As<Napi::Function>().Call(promiseConstructor, {});
+        });
+
+        ExpectNear(actual, expected);
+    }
+}
+
+TEST(NativeOptimizations, OptimizeIndicesKeepsTriangles)
+{
+    auto grid{CreateGrid(32)};
+
+    // Shuffles the triangles, so that consecutive ones rarely share vertices.
+    std::mt19937 random{3};
+    std::vector<std::array<uint32_t, 3>> shuffled(grid.Indices.size() / 3);
+    std::memcpy(shuffled.data(), grid.Indices.data(), grid.Indices.size() * sizeof(uint32_t));
+    std::shuffle(shuffled.begin(), shuffled.end(), random);
+    std::memcpy(grid.Indices.data(), shuffled.data(), grid.Indices.size() * sizeof(uint32_t));
+
+    const auto triangles{GetTriangles(grid.Indices)};
+    const float shuffledAcmr{Babylon::Plugins::NativeOptimizations::AnalyzeVertexCache(grid.Indices.data(), grid.Indices.size(), grid.VertexCount, 16)};
+
+    Babylon::Plugins::NativeOptimizations::OptimizeVertexCache(grid.Indices.data(), grid.Indices.data(), grid.Indices.size(), grid.VertexCount);
+    const float optimizedAcmr{Babylon::Plugins::NativeOptimizations::AnalyzeVertexCache(grid.Indices.data(), grid.Indices.size(), grid.VertexCount, 16)};
+    EXPECT_LT(optimizedAcmr, shuffledAcmr);
+    EXPECT_EQ(GetTriangles(grid.Indices), triangles);
+
+    Babylon::Plugins::NativeOptimizations::OptimizeOverdraw(grid.Indices.data(), grid.Indices.data(), grid.Indices.size(), grid.Positions.data(), 3, grid.VertexCount, 1.05f);
+    EXPECT_EQ(GetTriangles(grid.Indices), triangles);
+}
+
+TEST(NativeOptimizations, OptimizeIndicesRejectsInvalidIndices)
+{
+    auto grid{CreateGrid(2)};
+    const auto indices{grid.Indices};
+
+    grid.Indices.back() = static_cast<uint32_t>(grid.VertexCount);
+    EXPECT_THROW(Babylon::Plugins::NativeOptimizations::OptimizeVertexCache(grid.Indices.data(), grid.Indices.data(), grid.Indices.size(), grid.VertexCount), std::runtime_error);
+
+    grid.Indices = indices;
+    EXPECT_THROW(Babylon::Plugins::NativeOptimizations::OptimizeVertexCache(grid.Indices.data(), grid.Indices.data(), grid.Indices.size() - 1, grid.VertexCount), std::runtime_error);
+    EXPECT_THROW(Babylon::Plugins::NativeOptimizations::OptimizeOverdraw(grid.Indices.data(), grid.Indices.data(), grid.Indices.size(), grid.Positions.data(), 2, grid.VertexCount, 1.05f), std::runtime_error);
+    EXPECT_EQ(grid.Indices, indices);
+}
+
+TEST(NativeOptimizations, OptimizeVertexFetchAndRemap)
+{
+    // Two triangles that use 4 of 6 vertices, out of order. Each vertex is a float of its original index.
+    std::vector<uint32_t> indices{5, 2, 4, 4, 2, 0};
+    std::vector<float> vertices{0, 1, 2, 3, 4, 5};
+    std::vector<uint32_t> remap(vertices.size());
+
+    const size_t usedVertexCount{Babylon::Plugins::NativeOptimizations::OptimizeVertexFetch(indices.data(), indices.size(), remap.data(), vertices.size())};
+    EXPECT_EQ(usedVertexCount, 4u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1, 2, 2, 1, 3}));
+    EXPECT_EQ(remap[1], ~0u);
+    EXPECT_EQ(remap[3], ~0u);
+
+    Babylon::Plugins::NativeOptimizations::RemapVertexBuffer(reinterpret_cast<uint8_t*>(vertices.data()), vertices.size(), sizeof(float), remap.data());
+    EXPECT_EQ(std::vector<float>(vertices.begin(), vertices.begin() + usedVertexCount), (std::vector<float>{5, 2, 4, 0}));
+}
+
+TEST(NativeOptimizations, RemapVertexBufferValidatesBeforeWriting)
+{
+    const std::vector<float> vertices{0, 1, 2, 3};
+    for (const auto& remap : {std::vector<uint32_t>{3, 2, 1, 4}, std::vector<uint32_t>{1, 0, ~0u, 1}})
+    {
+        auto remapped{vertices};
+        EXPECT_THROW(Babylon::Plugins::NativeOptimizations::RemapVertexBuffer(reinterpret_cast<uint8_t*>(remapped.data()), remapped.size(), sizeof(float), remap.data()), std::runtime_error);
+        EXPECT_EQ(remapped, vertices);
+    }
+}
+
+TEST(NativeOptimizations, SimplifyKeepsBorders)
+{
+    const auto grid{CreateGrid(16)};
+
+    // The interior of a flat grid can be removed without error, but its border vertices must stay.
+    const auto simplified{Babylon::Plugins::NativeOptimizations::Simplify(grid.Indices.data(), grid.Indices.size(), grid.Positions.data(), 3, grid.VertexCount, 0, 0.01f)};
+    EXPECT_LT(simplified.size(), grid.Indices.size() / 4);
+    EXPECT_EQ(simplified.size() % 3, 0u);
+
+    std::vector<bool> used(grid.VertexCount);
+    for (uint32_t index : simplified)
+    {
+        ASSERT_LT(index, grid.VertexCount);
+        used[index] = true;
+    }
+
+    for (uint32_t i = 0; i <= 16; ++i)
+    {
+        EXPECT_TRUE(used[i]) << "bottom border vertex " << i;
+        EXPECT_TRUE(used[16 * 17 + i]) << "top border vertex " << i;
+    }
+
+    // Nothing is removed once the target index count is met.
+    const auto unchanged{Babylon::Plugins::NativeOptimizations::Simplify(grid.Indices.data(), grid.Indices.size(), grid.Positions.data(), 3, grid.VertexCount, grid.Indices.size(), 0)};
+    EXPECT_EQ(unchanged, grid.Indices);
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <Babylon/ShaderCache.h>
+#include "ShaderCompiler.h"
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    constexpr const char* CACHE_FILE_NAME{"shaderCacheTest.bin"};
+
+    Babylon::ShaderCompiler::BgfxShaderInfo MakeShaderInfo(uint8_t seed)
+    {
+        Babylon::ShaderCompiler::BgfxShaderInfo shaderInfo{};
+        shaderInfo.VertexBytes = {seed, 1, 2, 3};
+        shaderInfo.FragmentBytes = {seed, 4, 5, 6, 7};
+        shaderInfo.VertexAttributeLocations["position"] = seed;
+        shaderInfo.UniformStages["world"] = 1;
+        return shaderInfo;
+    }
+
+    std::string VertexSource(uint8_t seed)
+    {
+        return "vertex" + std::to_string(seed);
+    }
+
+    std::string FragmentSource(uint8_t seed)
+    {
+        return "fragment" + std::to_string(seed);
+    }
+
+    // Enables a new, empty cache, as if the app was started again.
+    Babylon::ShaderCacheImpl& ResetCache()
+    {
+        Babylon::ShaderCache::Enabled(false);
+        Babylon::ShaderCache::Enabled(true);
+        return *Babylon::ShaderCacheImpl::GetImpl();
+    }
+
+    void AddShader(Babylon::ShaderCacheImpl& cache, uint8_t seed)
+    {
+        cache.AddShader(VertexSource(seed), FragmentSource(seed), MakeShaderInfo(seed));
+    }
+
+    void ExpectShader(Babylon::ShaderCacheImpl& cache, uint8_t seed)
+    {
+        const auto* shaderInfo{cache.GetShader(VertexSource(seed), FragmentSource(seed))};
+        ASSERT_NE(shaderInfo, nullptr);
+
+        const auto expected{MakeShaderInfo(seed)};
+        EXPECT_EQ(shaderInfo->VertexBytes, expected.VertexBytes);
+        EXPECT_EQ(shaderInfo->FragmentBytes, expected.FragmentBytes);
+        EXPECT_EQ(shaderInfo->VertexAttributeLocations, expected.VertexAttributeLocations);
+        EXPECT_EQ(shaderInfo->UniformStages, expected.UniformStages);
+    }
+
+    class ShaderCacheTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            std::remove(CACHE_FILE_NAME);
+        }
+
+        void TearDown() override
+        {
+            Babylon::ShaderCache::Enabled(false);
+            std::remove(CACHE_FILE_NAME);
+        }
+    };
+}
+
+TEST_F(ShaderCacheTest, AppendThenReopen)
+{
+    auto& cache{ResetCache()};
+    EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 0u);
+    AddShader(cache, 1);
+    AddShader(cache, 2);
+
+    auto& reopenedCache{ResetCache()};
+    EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 2u);
+    ExpectShader(reopenedCache, 1);
+    ExpectShader(reopenedCache, 2);
+    EXPECT_EQ(reopenedCache.GetShader(VertexSource(3), FragmentSource(3)), nullptr);
+}
+
+TEST_F(ShaderCacheTest, LazyLookup)
+{
+    auto& cache{ResetCache()};
+    Babylon::ShaderCache::Open(CACHE_FILE_NAME);
+    AddShader(cache, 1);
+    Babylon::ShaderCache::Enabled(false);
+
+    // Corrupts the size of the vertex bytes at the start of the only record, which follows the header of an empty index.
+    {
+        std::fstream file{CACHE_FILE_NAME, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(16 + 24);
+        const uint32_t size{0xFFFFFFFF};
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+
+    // The entry is indexed without being decoded, so the corruption is only found on lookup, where it is a miss.
+    auto& reopenedCache{ResetCache()};
+    EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 1u);
+    EXPECT_EQ(reopenedCache.GetShader(VertexSource(1), FragmentSource(1)), nullptr);
+
+    AddShader(reopenedCache, 1);
+    ExpectShader(reopenedCache, 1);
+}
+
+TEST_F(ShaderCacheTest, RecoverFromTornRecord)
+{
+    auto& cache{ResetCache()};
+    Babylon::ShaderCache::Open(CACHE_FILE_NAME);
+    AddShader(cache, 1);
+    AddShader(cache, 2);
+    Babylon::ShaderCache::Enabled(false);
+
+    // Cuts the last record short, as if the app exited while appending it.
+    std::filesystem::resize_file(CACHE_FILE_NAME, std::filesystem::file_size(CACHE_FILE_NAME) - 3);
+
+    auto& reopenedCache{ResetCache()};
+    EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 1u);
+    ExpectShader(reopenedCache, 1);
+    EXPECT_EQ(reopenedCache.GetShader(VertexSource(2), FragmentSource(2)), nullptr);
+
+    // The file is rewritten without the torn record, so records appended afterwards are found again.
+    AddShader(reopenedCache, 2);
+    AddShader(reopenedCache, 3);
+
+    auto& recoveredCache{ResetCache()};
+    EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 3u);
+    ExpectShader(recoveredCache, 1);
+    ExpectShader(recoveredCache, 2);
+    ExpectShader(recoveredCache, 3);
+}
+
+TEST_F(ShaderCacheTest, RewriteCorruptIndex)
+{
+    for (const uint64_t entryOffset : {uint64_t{0}, uint64_t{0xFFFFFFFFFFFFFFF0}})
+    {
+        SCOPED_TRACE(entryOffset);
+
+        // Serializes a shader to the index of a new file, then corrupts either the index count in the header or the
+        // offset of the only entry, so that it wraps around when its size is added.
+        auto& cache{ResetCache()};
+        AddShader(cache, 1);
+        {
+            std::ofstream stream{CACHE_FILE_NAME, std::ios::binary | std::ios::trunc};
+            EXPECT_EQ(Babylon::ShaderCache::Serialize(stream), 1u);
+        }
+        Babylon::ShaderCache::Enabled(false);
+
+        {
+            std::fstream file{CACHE_FILE_NAME, std::ios::binary | std::ios::in | std::ios::out};
+            if (entryOffset == 0)
+            {
+                const uint32_t indexCount{0xFFFFFFFF};
+                file.seekp(8);
+                file.write(reinterpret_cast<const char*>(&indexCount), sizeof(indexCount));
+            }
+            else
+            {
+                file.seekp(16 + 16);
+                file.write(reinterpret_cast<const char*>(&entryOffset), sizeof(entryOffset));
+            }
+        }
+
+        // The file is invalid, so it is rewritten empty instead of failing to open.
+        auto& reopenedCache{ResetCache()};
+        EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 0u);
+        EXPECT_EQ(reopenedCache.GetShader(VertexSource(1), FragmentSource(1)), nullptr);
+
+        AddShader(reopenedCache, 1);
+        auto& recoveredCache{ResetCache()};
+        EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 1u);
+        ExpectShader(recoveredCache, 1);
+    }
+}
+
+TEST_F(ShaderCacheTest, OpenAppendsShadersCachedInMemory)
+{
+    auto& cache{ResetCache()};
+    Babylon::ShaderCache::Open(CACHE_FILE_NAME);
+    AddShader(cache, 1);
+
+    // Shaders compiled before the file is opened are written to it as well.
+    auto& secondCache{ResetCache()};
+    AddShader(secondCache, 2);
+    EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 2u);
+
+    auto& reopenedCache{ResetCache()};
+    EXPECT_EQ(Babylon::ShaderCache::Open(CACHE_FILE_NAME), 2u);
+    ExpectShader(reopenedCache, 1);
+    ExpectShader(reopenedCache, 2);
+}
+
+TEST(ShaderCache, ManifestRoundTrip)
+{
+    for (const bool homogeneousDepth : {false, true})
+    {
+        std::stringstream stream{};
+        Babylon::ShaderCacheImpl::WriteManifestHeader(stream, homogeneousDepth, !homogeneousDepth);
+        Babylon::ShaderCacheImpl::WriteManifestEntry(stream, VertexSource(1), FragmentSource(1));
+        Babylon::ShaderCacheImpl::WriteManifestEntry(stream, "", FragmentSource(2));
+        Babylon::ShaderCacheImpl::WriteManifestEntry(stream, VertexSource(3), FragmentSource(3));
+
+        // Cuts the last entry short, as if the app exited while recording it.
+        auto data{stream.str()};
+        data.resize(data.size() - 2);
+        std::stringstream truncatedStream{data};
+
+        const auto manifest{Babylon::ShaderCacheImpl::ReadManifest(truncatedStream)};
+        EXPECT_EQ(manifest.HomogeneousDepth, homogeneousDepth);
+        EXPECT_EQ(manifest.OriginBottomLeft, !homogeneousDepth);
+        ASSERT_EQ(manifest.Programs.size(), 2u);
+        EXPECT_EQ(manifest.Programs[0], std::make_pair(VertexSource(1), FragmentSource(1)));
+        EXPECT_EQ(manifest.Programs[1], std::make_pair(std::string{}, FragmentSource(2)));
+    }
+
+    std::stringstream invalidStream{"not a manifest"};
+    EXPECT_THROW(Babylon::ShaderCacheImpl::ReadManifest(invalidStream), std::runtime_error);
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include "ShaderCompilationService.h"
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Babylon::ShaderCompilationService;
+
+    std::future<ShaderCompilationService::ShaderInfoPtr> AsFuture(arcana::task<ShaderCompilationService::ShaderInfoPtr, std::exception_ptr> task)
+    {
+        auto promise{std::make_shared<std::promise<ShaderCompilationService::ShaderInfoPtr>>()};
+        auto future{promise->get_future()};
+        task.then(arcana::inline_scheduler, arcana::cancellation::none(), [promise](const arcana::expected<ShaderCompilationService::ShaderInfoPtr, std::exception_ptr>& result) {
+            if (result.has_error())
+            {
+                promise->set_exception(result.error());
+            }
+            else
+            {
+                promise->set_value(result.value());
+            }
+        });
+        return future;
+    }
+
+    // Records the order in which programs are compiled, and holds the first one until released so that the following
+    // requests stay queued.
+    class CompileRecorder
+    {
+    public:
+        ShaderCompilationService::CompileFunction Compile(std::string name, bool block = false)
+        {
+            return [this, name, block](Babylon::ShaderCompiler&) {
+                if (block)
+                {
+                    m_started.set_value();
+                    m_release.get_future().wait();
+                }
+
+                std::scoped_lock lock{m_mutex};
+                m_order.push_back(name);
+
+                Babylon::ShaderCompiler::BgfxShaderInfo shaderInfo{};
+                shaderInfo.VertexBytes.assign(name.begin(), name.end());
+                return shaderInfo;
+            };
+        }
+
+        void WaitForStart()
+        {
+            m_started.get_future().wait();
+        }
+
+        void Release()
+        {
+            m_release.set_value();
+        }
+
+        std::vector<std::string> Order()
+        {
+            std::scoped_lock lock{m_mutex};
+            return m_order;
+        }
+
+    private:
+        std::promise<void> m_started{};
+        std::promise<void> m_release{};
+        std::mutex m_mutex{};
+        std::vector<std::string> m_order{};
+    };
+}
+
+TEST(ShaderCompilationService, Deduplication)
+{
+    ShaderCompilationService service{1};
+    CompileRecorder recorder{};
+
+    auto blocking{AsFuture(service.CompileAsync("blocking", "blocking", 0, recorder.Compile("blocking", true)))};
+    recorder.WaitForStart();
+
+    auto first{AsFuture(service.CompileAsync("vertex", "fragment", 0, recorder.Compile("first")))};
+    auto second{AsFuture(service.CompileAsync("vertex", "fragment", 0, recorder.Compile("second")))};
+    auto other{AsFuture(service.CompileAsync("vertex", "otherFragment", 0, recorder.Compile("other")))};
+    recorder.Release();
+
+    const auto firstResult{first.get()};
+    EXPECT_EQ(firstResult, second.get());
+    EXPECT_NE(firstResult, other.get());
+    blocking.get();
+
+    EXPECT_EQ(recorder.Order(), (std::vector<std::string>{"blocking", "first", "other"}));
+
+    const auto stats{service.GetStats()};
+    EXPECT_EQ(stats.CompileCount, 3u);
+    EXPECT_EQ(stats.DeduplicatedCount, 1u);
+}
+
+TEST(ShaderCompilationService, Priority)
+{
+    ShaderCompilationService service{1};
+    CompileRecorder recorder{};
+
+    std::vector<std::future<ShaderCompilationService::ShaderInfoPtr>> results{};
+    results.push_back(AsFuture(service.CompileAsync("blocking", "", 0, recorder.Compile("blocking", true))));
+    recorder.WaitForStart();
+
+    results.push_back(AsFuture(service.CompileAsync("low", "", -1, recorder.Compile("low"))));
+    results.push_back(AsFuture(service.CompileAsync("normal", "", 0, recorder.Compile("normal"))));
+    results.push_back(AsFuture(service.CompileAsync("high", "", 1, recorder.Compile("high"))));
+    results.push_back(AsFuture(service.CompileAsync("normalToo", "", 0, recorder.Compile("normalToo"))));
+
+    // A more urgent request for a queued program promotes it.
+    results.push_back(AsFuture(service.CompileAsync("low", "", 2, recorder.Compile("promoted"))));
+
+    EXPECT_EQ(service.GetStats().QueueDepth, 4u);
+    recorder.Release();
+
+    for (auto& result : results)
+    {
+        result.get();
+    }
+
+    EXPECT_EQ(recorder.Order(), (std::vector<std::string>{"blocking", "low", "high", "normal", "normalToo"}));
+}
+
+TEST(ShaderCompilationService, Metrics)
+{
+    ShaderCompilationService service{1};
+    CompileRecorder recorder{};
+
+    auto blocking{AsFuture(service.CompileAsync("blocking", "", 0, recorder.Compile("blocking", true)))};
+    recorder.WaitForStart();
+
+    auto queued{AsFuture(service.CompileAsync("queued", "", 0, recorder.Compile("queued")))};
+    EXPECT_EQ(service.GetStats().QueueDepth, 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    recorder.Release();
+    blocking.get();
+    queued.get();
+
+    const auto stats{service.GetStats()};
+    EXPECT_EQ(stats.QueueDepth, 0u);
+    EXPECT_EQ(stats.CompileCount, 2u);
+    EXPECT_EQ(stats.DeduplicatedCount, 0u);
+    EXPECT_GE(stats.MaxCompileTime.count(), 10.0);
+    EXPECT_GE(stats.TotalCompileTime.count(), stats.MaxCompileTime.count());
+    EXPECT_GE(stats.TotalWaitTime.count(), 10.0);
+}
+
+TEST(ShaderCompilationService, CompileRunsQueuedJob)
+{
+    ShaderCompilationService service{1};
+    CompileRecorder recorder{};
+
+    auto blocking{AsFuture(service.CompileAsync("blocking", "", 0, recorder.Compile("blocking", true)))};
+    recorder.WaitForStart();
+
+    // The synchronous request takes over the queued job instead of waiting behind the blocked worker.
+    auto queued{AsFuture(service.CompileAsync("queued", "", 0, recorder.Compile("queued")))};
+    const auto result{service.Compile("queued", "", recorder.Compile("sync"))};
+    EXPECT_EQ(queued.get(), result);
+
+    recorder.Release();
+    blocking.get();
+
+    EXPECT_EQ(recorder.Order(), (std::vector<std::string>{"queued", "blocking"}));
+    EXPECT_EQ(service.GetStats().DeduplicatedCount, 1u);
+}
+
+TEST(ShaderCompilationService, Shared)
+{
+    auto service{ShaderCompilationService::GetShared()};
+    EXPECT_EQ(service, ShaderCompilationService::GetShared());
+
+    std::weak_ptr<ShaderCompilationService> weakService{service};
+    service.reset();
+    EXPECT_TRUE(weakService.expired());
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "DeviceContextUtils.h"
+#include "TextureCache.h"
+
+#include <array>
+#include <vector>
+
+namespace
+{
+    using Babylon::TextureCache;
+
+    TextureCache::Key MakeKey(const std::vector<uint8_t>& bytes)
+    {
+        const gsl::span<const uint8_t> image{bytes.data(), bytes.size()};
+        return TextureCache::MakeKey({&image, 1}, false, false, false, true);
+    }
+
+    TextureCache::AcquireResult Acquire(TextureCache& cache, const std::vector<uint8_t>& bytes, std::vector<TextureCache::TexturePtr>& results)
+    {
+        return cache.Acquire(MakeKey(bytes), [&results](const TextureCache::TexturePtr& texture) {
+            results.push_back(texture);
+        });
+    }
+}
+
+TEST(TextureCache, MakeKey)
+{
+    const std::vector<uint8_t> bytes{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17};
+    std::vector<uint8_t> otherBytes{bytes};
+    otherBytes.back() = 0;
+
+    EXPECT_EQ(MakeKey(bytes), MakeKey(std::vector<uint8_t>{bytes}));
+    EXPECT_NE(MakeKey(bytes), MakeKey(otherBytes));
+
+    // The faces of a cube are hashed in order.
+    const gsl::span<const uint8_t> first{bytes.data(), bytes.size()};
+    const gsl::span<const uint8_t> second{otherBytes.data(), otherBytes.size()};
+    const std::array<gsl::span<const uint8_t>, 2> faces{first, second};
+    const std::array<gsl::span<const uint8_t>, 2> swappedFaces{second, first};
+    EXPECT_NE(TextureCache::MakeKey(faces, true, false, false, true), TextureCache::MakeKey(swappedFaces, true, false, false, true));
+
+    // Load options are part of the key.
+    EXPECT_NE(TextureCache::MakeKey(faces, true, false, false, true), TextureCache::MakeKey(faces, true, true, false, true));
+}
+
+TEST(TextureCache, AcquireAndComplete)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        TextureCache cache{};
+        cache.SetEnabled(true);
+
+        const std::vector<uint8_t> bytes{1, 2, 3, 4};
+        std::vector<TextureCache::TexturePtr> results{};
+
+        // The first acquire loads the texture, and the next ones wait for it.
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::Load);
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::Cached);
+        EXPECT_TRUE(results.empty());
+
+        auto texture{std::make_shared<Babylon::Graphics::Texture>(deviceContext)};
+        cache.Complete(MakeKey(bytes), texture);
+        EXPECT_EQ(results, (std::vector<TextureCache::TexturePtr>{texture, texture}));
+
+        // Loaded textures are returned right away.
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::Cached);
+        EXPECT_EQ(results.size(), 3u);
+        EXPECT_EQ(results.back(), texture);
+
+        const auto stats{cache.GetStats()};
+        EXPECT_EQ(stats.Hits, 2u);
+        EXPECT_EQ(stats.Misses, 1u);
+        EXPECT_EQ(stats.Entries, 1u);
+
+        // Textures that are no longer used are loaded again.
+        results.clear();
+        texture.reset();
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::Load);
+
+        // Failed loads are not cached.
+        cache.Complete(MakeKey(bytes), nullptr);
+        EXPECT_EQ(results, (std::vector<TextureCache::TexturePtr>{nullptr}));
+        EXPECT_EQ(cache.GetStats().Entries, 0u);
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::Load);
+    });
+}
+
+TEST(TextureCache, SetEnabled)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        TextureCache cache{};
+        EXPECT_FALSE(cache.IsEnabled());
+
+        const std::vector<uint8_t> bytes{1, 2, 3, 4};
+        std::vector<TextureCache::TexturePtr> results{};
+        const auto texture{std::make_shared<Babylon::Graphics::Texture>(deviceContext)};
+
+        // Textures are loaded without the cache while it is disabled.
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::LoadUncached);
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::LoadUncached);
+        EXPECT_TRUE(results.empty());
+        EXPECT_EQ(cache.GetStats().Misses, 0u);
+
+        cache.SetEnabled(true);
+        EXPECT_TRUE(cache.IsEnabled());
+        EXPECT_EQ(Acquire(cache, bytes, results), TextureCache::AcquireResult::Load);
+        cache.Complete(MakeKey(bytes), texture);
+        EXPECT_EQ(cache.GetStats().Entries, 1u);
+
+        // Disabling the cache drops the loaded entries, but loads in progress still call their callbacks.
+        const std::vector<uint8_t> otherBytes{5, 6, 7, 8};
+        EXPECT_EQ(Acquire(cache, otherBytes, results), TextureCache::AcquireResult::Load);
+        cache.SetEnabled(false);
+        EXPECT_EQ(cache.GetStats().Entries, 0u);
+
+        results.clear();
+        cache.Complete(MakeKey(otherBytes), texture);
+        EXPECT_EQ(results, (std::vector<TextureCache::TexturePtr>{texture}));
+        EXPECT_EQ(cache.GetStats().Entries, 0u);
+    });
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "DeviceContextUtils.h"
+
+#include <vector>
+
+TEST(TextureMemory, NewTexturesAreNotDowngradedBeforeUse)
+{
+    RenderingDevice device{};
+    auto& deviceContext{device.Context()};
+
+    // Every texture is over a budget of a byte. Enough frames are rendered first for a texture that was never used to
+    // count as idle.
+    deviceContext.SetTextureMemoryBudget(1);
+    for (uint32_t frame = 0; frame < 100; ++frame)
+    {
+        device.RenderFrame();
+    }
+
+    std::vector<uint8_t> downgrades{};
+    Babylon::Graphics::Texture texture{deviceContext};
+    texture.SetReloadCallback([&downgrades](Babylon::Graphics::Texture&, uint8_t skippedMips) {
+        downgrades.push_back(skippedMips);
+    });
+    texture.Create2D(64, 64, true, 1, bgfx::TextureFormat::RGBA8, BGFX_TEXTURE_NONE);
+
+    device.RenderFrame();
+    EXPECT_TRUE(downgrades.empty());
+
+    // The texture is downgraded once it has not been used for long enough.
+    for (uint32_t frame = 0; frame < 70; ++frame)
+    {
+        device.RenderFrame();
+    }
+
+    EXPECT_EQ(downgrades, (std::vector<uint8_t>{1}));
+}
+
+TEST(TextureMemory, ReloadSourcesAreLimitedToAQuarterOfTheBudget)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        EXPECT_FALSE(deviceContext.AddTextureReloadSource(1));
+
+        deviceContext.SetTextureMemoryBudget(4000);
+        EXPECT_TRUE(deviceContext.AddTextureReloadSource(600));
+        EXPECT_TRUE(deviceContext.AddTextureReloadSource(400));
+        EXPECT_FALSE(deviceContext.AddTextureReloadSource(1));
+        EXPECT_EQ(deviceContext.GetTextureMemoryStats().ReloadSourceBytes, 1000u);
+
+        deviceContext.RemoveTextureReloadSource(600);
+        EXPECT_TRUE(deviceContext.AddTextureReloadSource(1));
+        EXPECT_EQ(deviceContext.GetTextureMemoryStats().ReloadSourceBytes, 401u);
+
+        deviceContext.RemoveTextureReloadSource(401);
+        EXPECT_EQ(deviceContext.GetTextureMemoryStats().ReloadSourceBytes, 0u);
+    });
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "DeviceContextUtils.h"
+#include "TextureStreamer.h"
+
+#include <arcana/threading/task_schedulers.h>
+
+namespace
+{
+    bimg::ImageContainer* CreateImage(uint16_t size)
+    {
+        return bimg::imageAlloc(&Babylon::Graphics::DeviceContext::GetDefaultAllocator(), bimg::TextureFormat::RGBA8, size, size, 1, 1, false, true);
+    }
+
+    // Counts the frames rendered until the task completes.
+    class ReadyFrame final
+    {
+    public:
+        ReadyFrame(arcana::task<void, std::exception_ptr> task, const uint32_t& frame)
+        {
+            task.then(arcana::inline_scheduler, arcana::cancellation::none(), [this, &frame](arcana::expected<void, std::exception_ptr> result) {
+                m_failed = result.has_error();
+                m_frame = frame;
+            });
+        }
+
+        bool IsReady() const
+        {
+            return m_frame != 0;
+        }
+
+        uint32_t Frame() const
+        {
+            return m_frame;
+        }
+
+        bool Failed() const
+        {
+            return m_failed;
+        }
+
+    private:
+        uint32_t m_frame{};
+        bool m_failed{};
+    };
+}
+
+TEST(TextureStreamer, ReadyBeforeLargestLevels)
+{
+    RenderingDevice device{};
+
+    Babylon::TextureStreamer streamer{device.Context()};
+    Babylon::Graphics::Texture texture{device.Context()};
+
+    // A budget of a byte uploads a single level per frame. The levels of a 1024x1024 texture up to 256x256 are uploaded
+    // first, to a texture of that size, then all of the levels again to the full texture.
+    streamer.SetBudget(1);
+    uint32_t frame{1};
+    ReadyFrame ready{streamer.Stream2D(&texture, CreateImage(1024), false), frame};
+
+    for (; frame <= 9; ++frame)
+    {
+        EXPECT_FALSE(ready.IsReady());
+        device.RenderFrame();
+    }
+
+    ASSERT_TRUE(ready.IsReady());
+    EXPECT_FALSE(ready.Failed());
+    EXPECT_EQ(ready.Frame(), 9u);
+    EXPECT_EQ(texture.Width(), 256);
+    EXPECT_EQ(texture.Height(), 256);
+    EXPECT_TRUE(texture.HasMips());
+
+    for (; frame <= 20; ++frame)
+    {
+        EXPECT_EQ(texture.Width(), 256);
+        device.RenderFrame();
+    }
+
+    EXPECT_EQ(texture.Width(), 1024);
+    EXPECT_EQ(texture.Height(), 1024);
+    EXPECT_TRUE(texture.HasMips());
+    EXPECT_EQ(streamer.GetPendingBytes(), 0u);
+
+    streamer.Cancel(&texture);
+}
+
+TEST(TextureStreamer, ReadyLevelsComeBeforeLargestLevels)
+{
+    RenderingDevice device{};
+
+    Babylon::TextureStreamer streamer{device.Context()};
+    Babylon::Graphics::Texture largeTexture{device.Context()};
+    Babylon::Graphics::Texture smallTexture{device.Context()};
+
+    streamer.SetBudget(1);
+    uint32_t frame{1};
+    ReadyFrame largeReady{streamer.Stream2D(&largeTexture, CreateImage(1024), false), frame};
+
+    // The small texture is queued after the large one, so it is ready after the 9 levels that the large one needs to be
+    // ready, but before the largest levels of the large one. It has no larger levels of its own.
+    const auto request{streamer.CreateRequest(&smallTexture, false, 8, false)};
+    for (uint8_t mip = 0; mip < 8; ++mip)
+    {
+        streamer.QueueImage(request, 0, mip, bimg::imageAlloc(&Babylon::Graphics::DeviceContext::GetDefaultAllocator(), bimg::TextureFormat::RGBA8, static_cast<uint16_t>(128 >> mip), static_cast<uint16_t>(128 >> mip), 1, 1, false, false));
+    }
+
+    ReadyFrame smallReady{streamer.WhenReady(request), frame};
+
+    for (; frame <= 17; ++frame)
+    {
+        device.RenderFrame();
+    }
+
+    ASSERT_TRUE(largeReady.IsReady());
+    ASSERT_TRUE(smallReady.IsReady());
+    EXPECT_EQ(largeReady.Frame(), 9u);
+    EXPECT_EQ(smallReady.Frame(), 17u);
+    EXPECT_EQ(smallTexture.Width(), 128);
+    EXPECT_EQ(largeTexture.Width(), 256);
+
+    streamer.Cancel(&largeTexture);
+    streamer.Cancel(&smallTexture);
+    EXPECT_EQ(streamer.GetPendingBytes(), 0u);
+}
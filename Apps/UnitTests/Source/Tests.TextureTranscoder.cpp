@@ -0,0 +1,20 @@
+#include <gtest/gtest.h>
+
+#include "DeviceContextUtils.h"
+#include "TextureTranscoder.h"
+
+#include <array>
+#include <stdexcept>
+
+TEST(TextureTranscoder, RejectsInvalidKtx2)
+{
+    // The KTX2 identifier followed by a truncated header.
+    const std::array<uint8_t, 16> data{0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n', 0, 0, 0, 0};
+    EXPECT_TRUE(Babylon::TextureTranscoder::IsKtx2(data));
+    EXPECT_FALSE(Babylon::TextureTranscoder::IsKtx2(gsl::make_span(data).subspan(1)));
+
+    // Transcoding selects the target format from the renderer caps, so it needs a device.
+    RunWithDeviceContext([&data](Babylon::Graphics::DeviceContext&) {
+        EXPECT_THROW(Babylon::TextureTranscoder::TranscodeKtx2(Babylon::Graphics::DeviceContext::GetDefaultAllocator(), data, false, false, false), std::runtime_error);
+    });
+}
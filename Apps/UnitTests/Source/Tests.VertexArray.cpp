@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "DeviceContextUtils.h"
+#include "VertexArray.h"
+#include "VertexLayoutCache.h"
+
+#include <array>
+
+namespace
+{
+    // Vertices of a vec3 position at offset 0 and a vec2 texture coordinate at offset 12, interleaved with a stride of 20.
+    constexpr uint32_t STRIDE{20};
+    constexpr uint32_t TEXCOORD_OFFSET{12};
+
+    uint32_t GetLayoutHash(bool texCoord)
+    {
+        bgfx::VertexLayout layout{};
+        layout.begin();
+        layout.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float);
+        if (texCoord)
+        {
+            layout.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float);
+        }
+
+        layout.m_stride = STRIDE;
+        layout.m_offset[bgfx::Attrib::Position] = 0;
+        layout.m_offset[bgfx::Attrib::TexCoord0] = texCoord ? TEXCOORD_OFFSET : 0;
+        layout.end();
+        return layout.m_hash;
+    }
+
+    void RecordPosition(Babylon::VertexArray& vertexArray, Babylon::VertexBuffer& vertexBuffer)
+    {
+        vertexArray.RecordVertexBuffer(&vertexBuffer, bgfx::Attrib::Position, 0, STRIDE, 3, bgfx::AttribType::Float, false, 0);
+    }
+
+    void RecordTexCoord(Babylon::VertexArray& vertexArray, Babylon::VertexBuffer& vertexBuffer)
+    {
+        vertexArray.RecordVertexBuffer(&vertexBuffer, bgfx::Attrib::TexCoord0, TEXCOORD_OFFSET, STRIDE, 2, bgfx::AttribType::Float, false, 0);
+    }
+}
+
+TEST(VertexArray, LayoutsAreAcquiredWhenRecorded)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        const std::array<uint8_t, STRIDE * 3> bytes{};
+        Babylon::VertexBuffer vertexBuffer{deviceContext, bytes, false};
+        Babylon::VertexArray vertexArray{deviceContext};
+
+        // The layout of the recorded attributes is acquired without drawing, and replaced as more attributes are recorded.
+        RecordPosition(vertexArray, vertexBuffer);
+        EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(false)), 1u);
+
+        RecordTexCoord(vertexArray, vertexBuffer);
+        EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(false)), 0u);
+        EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(true)), 1u);
+
+        // Recording an attribute again fails, and keeps the layout.
+        EXPECT_THROW(RecordTexCoord(vertexArray, vertexBuffer), std::runtime_error);
+        EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(true)), 1u);
+
+        vertexArray.Dispose();
+        EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(true)), 0u);
+    });
+}
+
+TEST(VertexArray, IdenticalLayoutsAreShared)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        const std::array<uint8_t, STRIDE * 3> bytes{};
+        Babylon::VertexBuffer firstBuffer{deviceContext, bytes, false};
+        Babylon::VertexBuffer secondBuffer{deviceContext, bytes, false};
+
+        Babylon::VertexArray first{deviceContext};
+        RecordPosition(first, firstBuffer);
+        RecordTexCoord(first, firstBuffer);
+
+        {
+            // Vertex arrays of different buffers with the same layout share it until the last of them is disposed.
+            Babylon::VertexArray second{deviceContext};
+            RecordPosition(second, secondBuffer);
+            RecordTexCoord(second, secondBuffer);
+            EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(true)), 2u);
+        }
+
+        EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(true)), 1u);
+
+        first.Dispose();
+        EXPECT_EQ(Babylon::VertexLayoutCache::GetReferences(deviceContext, GetLayoutHash(true)), 0u);
+    });
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "DeviceContextUtils.h"
+#include "VertexBuffer.h"
+
+#include <array>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+TEST(VertexBuffer, IdIsNotReusedWithAddress)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        const std::array<uint8_t, 16> bytes{};
+
+        // Constructs both buffers in the same storage, as happens when the allocator reuses the memory of a freed buffer,
+        // so that caches keyed on the buffer address would mistake the second buffer for the first.
+        std::aligned_storage_t<sizeof(Babylon::VertexBuffer), alignof(Babylon::VertexBuffer)> storage{};
+
+        auto* first{new (&storage) Babylon::VertexBuffer{deviceContext, bytes, true}};
+        const auto firstId{first->GetId()};
+        first->~VertexBuffer();
+
+        auto* second{new (&storage) Babylon::VertexBuffer{deviceContext, bytes, true}};
+        EXPECT_EQ(static_cast<void*>(first), static_cast<void*>(second));
+        EXPECT_NE(second->GetId(), firstId);
+        second->~VertexBuffer();
+    });
+}
+
+TEST(VertexBuffer, CopyInstanceData)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        // Two instances of a vec2 at offset 0 and a float at offset 8, interleaved with a stride of 16 bytes.
+        const std::array<float, 8> values{1, 2, 3, 0, 4, 5, 6, 0};
+        Babylon::VertexBuffer buffer{deviceContext, {reinterpret_cast<const uint8_t*>(values.data()), sizeof(values)}, false};
+
+        std::map<bgfx::Attrib::Enum, Babylon::VertexBuffer::InstanceInfo> instances{};
+        instances[bgfx::Attrib::TexCoord7] = {&buffer, 0, 16, 8};
+        instances[bgfx::Attrib::TexCoord6] = {&buffer, 8, 16, 4};
+
+        EXPECT_EQ(Babylon::VertexBuffer::GetInstanceCount(instances), 2u);
+        EXPECT_EQ(Babylon::VertexBuffer::GetInstanceStride(instances), 12u);
+
+        std::vector<float> instanceData(3);
+        Babylon::VertexBuffer::CopyInstanceData(reinterpret_cast<uint8_t*>(instanceData.data()), instances, 1, 1);
+
+        // bgfx lays out instance attributes in reverse order on Direct3D.
+#if D3D11 || D3D12
+        EXPECT_EQ(instanceData, (std::vector<float>{4, 5, 6}));
+#else
+        EXPECT_EQ(instanceData, (std::vector<float>{6, 4, 5}));
+#endif
+    });
+}
+
+TEST(VertexBuffer, TransientByteStrideIsValidated)
+{
+    RunWithDeviceContext([](Babylon::Graphics::DeviceContext& deviceContext) {
+        EXPECT_THROW((Babylon::VertexBuffer{deviceContext, 0u}), std::runtime_error);
+        EXPECT_THROW((Babylon::VertexBuffer{deviceContext, 65536u}), std::runtime_error);
+        EXPECT_NO_THROW((Babylon::VertexBuffer{deviceContext, 65535u}));
+    });
+}
+
+TEST(VertexBuffer, TransientIsDrawnInTheFrameItIsAllocatedIn)
+{
+    RenderingDevice device{};
+    auto& deviceContext{device.Context()};
+
+    // Three vertices of a vec3 position.
+    const std::array<float, 9> positions{0, 0, 0, 1, 0, 0, 0, 1, 0};
+    const gsl::span<const uint8_t> bytes{reinterpret_cast<const uint8_t*>(positions.data()), sizeof(positions)};
+    Babylon::VertexBuffer buffer{deviceContext, 12u};
+
+    // The vertices are copied, so the source can change once they are allocated.
+    EXPECT_TRUE(buffer.AllocateTransient(bytes));
+    EXPECT_THROW(buffer.AllocateTransient(bytes.first(bytes.size() - 1)), std::runtime_error);
+
+    {
+        auto token{deviceContext.GetUpdate("update").GetUpdateToken()};
+        bgfx::Encoder* encoder{token.GetEncoder()};
+        EXPECT_NO_THROW(buffer.Set(encoder, 0, 0, 3, BGFX_INVALID_HANDLE));
+        encoder->discard();
+    }
+
+    // The transient memory is gone once the frame ends.
+    device.RenderFrame();
+
+    {
+        auto token{deviceContext.GetUpdate("update").GetUpdateToken()};
+        bgfx::Encoder* encoder{token.GetEncoder()};
+        EXPECT_THROW(buffer.Set(encoder, 0, 0, 3, BGFX_INVALID_HANDLE), std::runtime_error);
+        encoder->discard();
+    }
+}
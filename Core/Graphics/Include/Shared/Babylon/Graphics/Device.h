@@ -3,6 +3,7 @@
 #include <Babylon/JsRuntime.h>
 #include <Babylon/Graphics/Platform.h>
 #include <Babylon/Graphics/RendererType.h>
+#include <Babylon/Graphics/TextureMemoryStats.h>
 
 #include <future>
 #include <memory>
@@ -56,6 +57,15 @@ namespace Babylon::Graphics
         // Format to use when creating the depth/stencil texture for the back buffer.
         // Specify DepthStencilFormat::None to not create a depth/stencil texture.
         DepthStencilFormat BackBufferDepthStencilFormat{DepthStencilFormat::Depth24Stencil8};
+
+        // When enabled, submitted rendering commands are decoded and encoded on a dedicated worker thread
+        // so that the JavaScript thread can continue without waiting for them.
+        // @remarks Errors raised by the commands are reported by the next submit instead of the current one.
+        bool ThreadedCommandSubmission{};
+
+        // When disabled, frames are not synchronized with the display refresh rate.
+        // @remarks Useful for headless rendering, where presenting frames should not throttle rendering.
+        bool VSync{true};
     };
 
     class Device;
@@ -142,6 +152,12 @@ namespace Babylon::Graphics
 
         PlatformInfo GetPlatformInfo() const;
 
+        TextureMemoryStats GetTextureMemoryStats() const;
+
+        // Bytes that textures should stay within, or 0 for no budget. When over budget, the least recently used textures
+        // that can be reloaded are downgraded to lower levels, and restored once they are used again and fit.
+        void SetTextureMemoryBudget(uint64_t bytes);
+
     private:
         std::unique_ptr<DeviceImpl> m_impl{};
     };
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Babylon::Graphics
+{
+    struct TextureMemoryStats
+    {
+        // Number of textures tracked by the device.
+        size_t TextureCount{};
+
+        // Bytes used by render target textures.
+        uint64_t RenderTargetBytes{};
+
+        // Bytes used by 2D and 2D array textures that are not render targets.
+        uint64_t SampledBytes{};
+
+        // Bytes used by cube textures that are not render targets.
+        uint64_t CubeBytes{};
+
+        // Bytes used by all textures.
+        uint64_t TotalBytes{};
+
+        // Bytes that textures should stay within, or 0 when there is no budget.
+        uint64_t BudgetBytes{};
+
+        // Number of textures currently loaded without their largest levels to stay within the budget.
+        size_t DowngradedCount{};
+
+        // Bytes of encoded data kept to reload the textures that can be downgraded.
+        uint64_t ReloadSourceBytes{};
+    };
+}
@@ -4,12 +4,16 @@
 #include <bx/allocator.h>
 #include "continuation_scheduler.h"
 #include "SafeTimespanGuarantor.h"
+#include "Texture.h"
+
+#include <Babylon/Graphics/TextureMemoryStats.h>
 
 #include <napi/env.h>
 
 #include <bgfx/bgfx.h>
 #include <bgfx/platform.h>
 
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
@@ -27,6 +31,10 @@ namespace Babylon::Graphics
         bool HasMips{};
         uint16_t NumLayers{};
         bgfx::TextureFormat::Enum Format{};
+        bool CubeMap{};
+        uint64_t Flags{};
+        uint32_t Size{};
+        Texture* Owner{};
     };
 
     class UpdateToken final
@@ -110,6 +118,11 @@ namespace Babylon::Graphics
         //Note: This is an index that changes when bgfx gets reset. It should be used to validate that resource handles created using bgfx remain valid on destruction.
         uintptr_t GetDeviceId() const;
 
+        bool GetThreadedCommandSubmission() const;
+
+        // Number of the frame currently being recorded, which changes every time a frame is submitted to bgfx.
+        uint64_t GetFrameNumber() const;
+
         using CaptureCallbackTicketT = arcana::ticketed_collection<std::function<void(const BgfxCallback::CaptureData&)>>::ticket;
         CaptureCallbackTicketT AddCaptureCallback(std::function<void(const BgfxCallback::CaptureData&)> callback);
 
@@ -121,14 +134,51 @@ namespace Babylon::Graphics
         TextureInfo GetTextureInfo(bgfx::TextureHandle handle);
         static bx::AllocatorI& GetDefaultAllocator() { return m_allocator; }
 
+        // Called by textures as they are created and disposed.
+        void AddTexture(Texture& texture);
+        void RemoveTexture(Texture& texture);
+        void SetTextureReloadCallback(Texture& texture, Texture::ReloadCallback callback);
+
+        TextureMemoryStats GetTextureMemoryStats();
+
+        // Bytes that textures should stay within, or 0 for no budget. Only textures with a reload callback can be
+        // downgraded, so the budget is a target rather than a limit.
+        void SetTextureMemoryBudget(uint64_t bytes);
+        uint64_t GetTextureMemoryBudget();
+
+        // Accounts for the encoded data kept to reload a texture, which is limited to a quarter of the budget so that
+        // keeping it does not use up much of the memory saved by downgrading. Returns false, without accounting for the
+        // data, when it would exceed the limit, in which case the data should not be kept.
+        bool AddTextureReloadSource(size_t bytes);
+        void RemoveTextureReloadSource(size_t bytes);
+
+        // Accounts for the CPU copies of the vertex and index data of the device, from any thread.
+        void AddGeometryResidentBytes(size_t bytes);
+        void RemoveGeometryResidentBytes(size_t bytes);
+        size_t GetGeometryResidentBytes() const;
+
+        // Downgrades the least recently used textures while over budget and restores the downgraded ones that are used
+        // again once they fit. Called once per frame from the render thread.
+        void UpdateTextureResidency();
+
     private:
         friend UpdateToken;
 
+        void AddTextureLocked(uint16_t handleIndex, TextureInfo info);
+        void RemoveTextureLocked(std::unordered_map<uint16_t, TextureInfo>::iterator it);
+
         DeviceImpl& m_graphicsImpl;
 
         std::unordered_map<uint16_t, TextureInfo> m_textureHandleToInfo{};
         std::mutex m_textureHandleToInfoMutex{};
 
+        // Guarded by the texture mutex. The budget and downgraded count are only filled in when the stats are read.
+        TextureMemoryStats m_textureMemoryStats{};
+        uint64_t m_textureMemoryBudget{};
+        size_t m_downgradedTextureCount{};
+
+        std::atomic<size_t> m_geometryResidentBytes{};
+
         static inline bx::DefaultAllocator m_allocator{};
     };
 }
@@ -2,6 +2,10 @@
 
 #include <bgfx/bgfx.h>
 
+#include <atomic>
+#include <functional>
+#include <memory>
+
 namespace Babylon::Graphics
 {
     class DeviceContext;
@@ -22,10 +26,23 @@ namespace Babylon::Graphics
         void Create2D(uint16_t width, uint16_t height, bool hasMips, uint16_t numLayers, bgfx::TextureFormat::Enum format, uint64_t flags);
         void Update2D(uint16_t layer, uint8_t mip, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const bgfx::Memory* mem, uint16_t pitch = UINT16_MAX);
 
+        // Creates a 2D texture with mips whose first level is updated with Update2D and whose other levels are generated
+        // from it on the GPU by GenerateMips. Only supported for the formats and flags accepted by CanGenerateMips.
+        void Create2DWithGeneratedMips(uint16_t width, uint16_t height, bgfx::TextureFormat::Enum format, uint64_t flags);
+        static bool CanGenerateMips(bgfx::TextureFormat::Enum format, uint64_t flags);
+
+        // Generates the mips of a texture created with Create2DWithGeneratedMips from its first level when the frame is
+        // rendered, filtering sRGB textures in linear space.
+        void GenerateMips(bgfx::Encoder& encoder);
+
         void CreateCube(uint16_t size, bool hasMips, uint16_t numLayers, bgfx::TextureFormat::Enum format, uint64_t flags);
         void UpdateCube(uint16_t layer, uint8_t side, uint8_t mip, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const bgfx::Memory* mem, uint16_t pitch = UINT16_MAX);
 
-        void Attach(bgfx::TextureHandle handle, bool ownsHandle, uint16_t width, uint16_t height, bool hasMips, uint16_t numLayers, bgfx::TextureFormat::Enum format, uint64_t flags);
+        void Attach(bgfx::TextureHandle handle, bool ownsHandle, uint16_t width, uint16_t height, bool hasMips, uint16_t numLayers, bgfx::TextureFormat::Enum format, uint64_t flags, bool cubeMap = false);
+
+        // Uses the handle of another texture, which is kept alive until this one is disposed. Sampler flags are not shared.
+        void AttachShared(std::shared_ptr<Texture> texture);
+        bool IsShared() const;
 
         bgfx::TextureHandle Handle() const;
         uint16_t Width() const;
@@ -36,8 +53,22 @@ namespace Babylon::Graphics
         uint64_t Flags() const;
         uint32_t SamplerFlags() const;
         void SamplerFlags(uint32_t);
+        bool IsCubeMap() const;
+
+        // Reloads the texture without its largest levels, or with all of them when skippedMips is 0, by creating it again
+        // at the reduced size. The device context calls it from the render thread to keep textures within the texture
+        // memory budget, so it must only schedule the reload and not call back into the device context. Textures without
+        // one are never downgraded.
+        using ReloadCallback = std::function<void(Texture& texture, uint8_t skippedMips)>;
+        void SetReloadCallback(ReloadCallback callback);
+
+        // Records that the texture is used by the given frame, so that recently used textures are downgraded last.
+        void MarkUsed(uint64_t frameNumber);
+        uint64_t LastUsedFrame() const;
 
     private:
+        friend class DeviceContext;
+
         bgfx::TextureHandle m_handle{bgfx::kInvalidHandle};
         bool m_ownsHandle{false};
         uint16_t m_width{0};
@@ -47,6 +78,15 @@ namespace Babylon::Graphics
         bgfx::TextureFormat::Enum m_format{bgfx::TextureFormat::Enum::Unknown};
         uint64_t m_flags{BGFX_TEXTURE_NONE};
         uint32_t m_samplerFlags{BGFX_SAMPLER_NONE};
+        bool m_cubeMap{false};
+        std::shared_ptr<Texture> m_sharedTexture{};
+        std::atomic<uint64_t> m_lastUsedFrame{0};
+
+        // Residency state, guarded by the texture mutex of the device context.
+        ReloadCallback m_reloadCallback{};
+        uint8_t m_skippedMips{0};
+        bool m_reloadPending{false};
+
         uintptr_t m_deviceID;
         DeviceContext& m_deviceContext;
     };
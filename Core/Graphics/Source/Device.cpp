@@ -113,4 +113,14 @@ namespace Babylon::Graphics
     {
         return m_impl->GetPlatformInfo();
     }
+
+    TextureMemoryStats Device::GetTextureMemoryStats() const
+    {
+        return m_impl->GetContext().GetTextureMemoryStats();
+    }
+
+    void Device::SetTextureMemoryBudget(uint64_t bytes)
+    {
+        m_impl->GetContext().SetTextureMemoryBudget(bytes);
+    }
 }
@@ -4,6 +4,9 @@
 
 #include <napi/pointer.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace Babylon::Graphics
 {
     UpdateToken::UpdateToken(DeviceContext& context, SafeTimespanGuarantor& guarantor)
@@ -18,6 +21,19 @@ namespace Babylon::Graphics
     }
 }
 
+namespace
+{
+    uint64_t& GetCategoryBytes(Babylon::Graphics::TextureMemoryStats& stats, const Babylon::Graphics::TextureInfo& info)
+    {
+        if ((info.Flags & BGFX_TEXTURE_RT_MASK) != 0)
+        {
+            return stats.RenderTargetBytes;
+        }
+
+        return info.CubeMap ? stats.CubeBytes : stats.SampledBytes;
+    }
+}
+
 namespace Babylon::Graphics
 {
     DeviceContext& DeviceContext::GetFromJavaScript(Napi::Env env)
@@ -110,23 +126,263 @@ namespace Babylon::Graphics
     {
         std::scoped_lock lock{m_textureHandleToInfoMutex};
         TextureInfo textureInfo{width, height, hasMips, numLayers, format};
-        m_textureHandleToInfo.emplace(handle.idx, textureInfo);
+        AddTextureLocked(handle.idx, textureInfo);
     }
 
     void DeviceContext::RemoveTexture(bgfx::TextureHandle handle)
     {
         std::scoped_lock lock{m_textureHandleToInfoMutex};
-        m_textureHandleToInfo.erase(handle.idx);
+        auto it{m_textureHandleToInfo.find(handle.idx)};
+        if (it != m_textureHandleToInfo.end())
+        {
+            RemoveTextureLocked(it);
+        }
     }
 
     TextureInfo DeviceContext::GetTextureInfo(bgfx::TextureHandle handle)
     {
         std::scoped_lock lock{m_textureHandleToInfoMutex};
-        return m_textureHandleToInfo[handle.idx];
+        const auto it{m_textureHandleToInfo.find(handle.idx)};
+        return it != m_textureHandleToInfo.end() ? it->second : TextureInfo{};
+    }
+
+    void DeviceContext::AddTexture(Texture& texture)
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+        TextureInfo textureInfo{texture.Width(), texture.Height(), texture.HasMips(), texture.NumLayers(), texture.Format(), texture.IsCubeMap(), texture.Flags()};
+        textureInfo.Owner = &texture;
+        texture.m_reloadPending = false;
+        AddTextureLocked(texture.Handle().idx, textureInfo);
+
+        // New textures count as used by the current frame so that they are not downgraded before they are ever used.
+        // Downgraded textures keep their last use, since counting them as used would restore them right away.
+        const uint64_t frameNumber{GetFrameNumber()};
+        if (texture.m_skippedMips == 0 && texture.LastUsedFrame() < frameNumber)
+        {
+            texture.MarkUsed(frameNumber);
+        }
+    }
+
+    void DeviceContext::RemoveTexture(Texture& texture)
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+
+        // The handle may have been reused by another texture if the device was reset.
+        auto it{m_textureHandleToInfo.find(texture.Handle().idx)};
+        if (it != m_textureHandleToInfo.end() && it->second.Owner == &texture)
+        {
+            RemoveTextureLocked(it);
+        }
+    }
+
+    void DeviceContext::SetTextureReloadCallback(Texture& texture, Texture::ReloadCallback callback)
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+        texture.m_reloadCallback = std::move(callback);
+    }
+
+    TextureMemoryStats DeviceContext::GetTextureMemoryStats()
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+
+        TextureMemoryStats stats{m_textureMemoryStats};
+        stats.BudgetBytes = m_textureMemoryBudget;
+        stats.DowngradedCount = 0;
+        for (const auto& [handleIndex, textureInfo] : m_textureHandleToInfo)
+        {
+            if (textureInfo.Owner != nullptr && textureInfo.Owner->m_skippedMips > 0)
+            {
+                ++stats.DowngradedCount;
+            }
+        }
+
+        return stats;
+    }
+
+    void DeviceContext::SetTextureMemoryBudget(uint64_t bytes)
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+        m_textureMemoryBudget = bytes;
+    }
+
+    uint64_t DeviceContext::GetTextureMemoryBudget()
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+        return m_textureMemoryBudget;
+    }
+
+    bool DeviceContext::AddTextureReloadSource(size_t bytes)
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+        if (m_textureMemoryStats.ReloadSourceBytes + bytes > m_textureMemoryBudget / 4)
+        {
+            return false;
+        }
+
+        m_textureMemoryStats.ReloadSourceBytes += bytes;
+        return true;
+    }
+
+    void DeviceContext::RemoveTextureReloadSource(size_t bytes)
+    {
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+        m_textureMemoryStats.ReloadSourceBytes -= bytes;
+    }
+
+    void DeviceContext::AddGeometryResidentBytes(size_t bytes)
+    {
+        m_geometryResidentBytes += bytes;
+    }
+
+    void DeviceContext::RemoveGeometryResidentBytes(size_t bytes)
+    {
+        m_geometryResidentBytes -= bytes;
+    }
+
+    size_t DeviceContext::GetGeometryResidentBytes() const
+    {
+        return m_geometryResidentBytes;
+    }
+
+    void DeviceContext::UpdateTextureResidency()
+    {
+        // Textures must not have been used for this many frames to be downgraded, so that the ones in use do not
+        // alternate between being downgraded and restored.
+        constexpr uint64_t MIN_IDLE_FRAMES{60};
+
+        std::scoped_lock lock{m_textureHandleToInfoMutex};
+
+        if (m_textureMemoryBudget == 0 && m_downgradedTextureCount == 0)
+        {
+            return;
+        }
+
+        const uint64_t frameNumber{GetFrameNumber()};
+        const uint64_t budget{m_textureMemoryBudget};
+        uint64_t totalBytes{m_textureMemoryStats.TotalBytes};
+
+        std::vector<std::pair<Texture*, uint64_t>> restores{};
+        std::vector<std::pair<Texture*, uint64_t>> downgrades{};
+        bool reloadPending{false};
+        m_downgradedTextureCount = 0;
+
+        for (const auto& [handleIndex, textureInfo] : m_textureHandleToInfo)
+        {
+            Texture* texture{textureInfo.Owner};
+            if (texture == nullptr || !texture->m_reloadCallback)
+            {
+                continue;
+            }
+
+            if (texture->m_skippedMips > 0)
+            {
+                ++m_downgradedTextureCount;
+            }
+
+            if (texture->m_reloadPending)
+            {
+                reloadPending = true;
+                continue;
+            }
+
+            const uint64_t lastUsedFrame{texture->LastUsedFrame()};
+            if (texture->m_skippedMips > 0 && lastUsedFrame + 1 >= frameNumber)
+            {
+                restores.emplace_back(texture, textureInfo.Size);
+            }
+            else if (budget != 0 && textureInfo.HasMips && (textureInfo.Flags & BGFX_TEXTURE_RT_MASK) == 0 &&
+                     std::max(textureInfo.Width, textureInfo.Height) > 1 && lastUsedFrame + MIN_IDLE_FRAMES < frameNumber)
+            {
+                downgrades.emplace_back(texture, textureInfo.Size);
+            }
+        }
+
+        const auto lastUsedFrame = [](const std::pair<Texture*, uint64_t>& entry) {
+            return entry.first->LastUsedFrame();
+        };
+
+        std::sort(restores.begin(), restores.end(), [&lastUsedFrame](const auto& a, const auto& b) {
+            return lastUsedFrame(a) > lastUsedFrame(b);
+        });
+
+        for (const auto& [texture, size] : restores)
+        {
+            // Each level is about four times the size of the next one, which estimates the size with all of them.
+            const uint64_t restoredSize{size << (2 * texture->m_skippedMips)};
+            if (budget == 0 || totalBytes - size + restoredSize <= budget)
+            {
+                totalBytes = totalBytes - size + restoredSize;
+                texture->m_skippedMips = 0;
+                texture->m_reloadPending = true;
+                texture->m_reloadCallback(*texture, 0);
+            }
+        }
+
+        // Wait for pending reloads to complete before downgrading more textures, since the total does not include them yet.
+        if (budget == 0 || reloadPending || totalBytes <= budget)
+        {
+            return;
+        }
+
+        std::sort(downgrades.begin(), downgrades.end(), [&lastUsedFrame](const auto& a, const auto& b) {
+            return lastUsedFrame(a) < lastUsedFrame(b);
+        });
+
+        for (const auto& [texture, size] : downgrades)
+        {
+            if (totalBytes <= budget)
+            {
+                break;
+            }
+
+            totalBytes -= size * 3 / 4;
+            ++texture->m_skippedMips;
+            texture->m_reloadPending = true;
+            texture->m_reloadCallback(*texture, texture->m_skippedMips);
+        }
+    }
+
+    void DeviceContext::AddTextureLocked(uint16_t handleIndex, TextureInfo info)
+    {
+        bgfx::TextureInfo bgfxInfo{};
+        bgfx::calcTextureSize(bgfxInfo, info.Width, info.Height, 1, info.CubeMap, info.HasMips, std::max<uint16_t>(info.NumLayers, 1), info.Format);
+        info.Size = bgfxInfo.storageSize;
+
+        auto it{m_textureHandleToInfo.find(handleIndex)};
+        if (it != m_textureHandleToInfo.end())
+        {
+            RemoveTextureLocked(it);
+        }
+
+        GetCategoryBytes(m_textureMemoryStats, info) += info.Size;
+        m_textureMemoryStats.TotalBytes += info.Size;
+        ++m_textureMemoryStats.TextureCount;
+
+        m_textureHandleToInfo.emplace(handleIndex, info);
+    }
+
+    void DeviceContext::RemoveTextureLocked(std::unordered_map<uint16_t, TextureInfo>::iterator it)
+    {
+        const TextureInfo& info{it->second};
+        GetCategoryBytes(m_textureMemoryStats, info) -= info.Size;
+        m_textureMemoryStats.TotalBytes -= info.Size;
+        --m_textureMemoryStats.TextureCount;
+
+        m_textureHandleToInfo.erase(it);
     }
 
     uintptr_t DeviceContext::GetDeviceId() const
     {
        return m_graphicsImpl.GetId();
     }
+
+    bool DeviceContext::GetThreadedCommandSubmission() const
+    {
+        return m_graphicsImpl.GetThreadedCommandSubmission();
+    }
+
+    uint64_t DeviceContext::GetFrameNumber() const
+    {
+        return m_graphicsImpl.GetFrameNumber();
+    }
 }
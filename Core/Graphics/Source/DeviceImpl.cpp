@@ -32,6 +32,7 @@ namespace Babylon::Graphics
         : m_bgfxCallback{[this](const auto& data) { CaptureCallback(data); }}
         , m_context{*this}
         , m_bgfxId{0}
+        , m_threadedCommandSubmission{config.ThreadedCommandSubmission}
     {
         std::scoped_lock lock{m_state.Mutex};
         m_state.Bgfx.Initialized = false;
@@ -53,7 +54,7 @@ namespace Babylon::Graphics
         // init.resolution
         //
 
-        init.resolution.reset = BGFX_RESET_VSYNC | BGFX_RESET_MAXANISOTROPY | BGFX_RESET_FLIP_AFTER_RENDER;
+        init.resolution.reset = (config.VSync ? BGFX_RESET_VSYNC : 0) | BGFX_RESET_MAXANISOTROPY | BGFX_RESET_FLIP_AFTER_RENDER;
         init.resolution.maxFrameLatency = 1;
 
         UpdateSize(config.Width, config.Height);
@@ -326,6 +327,8 @@ namespace Babylon::Graphics
 
         m_afterRenderDispatcher.tick(*m_cancellationSource);
 
+        m_context.UpdateTextureResidency();
+
         m_rendering = false;
     }
 
@@ -433,17 +436,34 @@ namespace Babylon::Graphics
 
     void DeviceImpl::RequestScreenShots()
     {
+        std::vector<std::function<void(std::vector<uint8_t>)>> callbacks{};
         std::function<void(std::vector<uint8_t>)> callback;
         while (m_screenShotCallbacks.try_pop(callback, *m_cancellationSource))
         {
-            m_bgfxCallback.AddScreenShotCallback(std::move(callback));
+            callbacks.push_back(std::move(callback));
+        }
+
+        if (callbacks.empty())
+        {
+            return;
+        }
+
+        // All the requests made during a frame get the same image, so capture it once and share it between them.
+        m_bgfxCallback.AddScreenShotCallback([callbacks{std::move(callbacks)}](std::vector<uint8_t> data) {
+            for (size_t i = 0; i + 1 < callbacks.size(); ++i)
+            {
+                callbacks[i](data);
+            }
+
+            callbacks.back()(std::move(data));
+        });
+
 #if D3D12
-            // D3D12 capture is immediate but needs an extra frame swap because back buffer is captured.
-            // Because of previous swapchain flip, back buffer is not what's just been rendered.
-            bgfx::frame();
+        // D3D12 capture is immediate but needs an extra frame swap because back buffer is captured.
+        // Because of previous swapchain flip, back buffer is not what's just been rendered.
+        bgfx::frame();
 #endif
-            bgfx::requestScreenShot(BGFX_INVALID_HANDLE, "DeviceImpl::RequestScreenShot");
-        }
+        bgfx::requestScreenShot(BGFX_INVALID_HANDLE, "DeviceImpl::RequestScreenShot");
     }
 
     void DeviceImpl::Frame()
@@ -470,6 +490,7 @@ namespace Babylon::Graphics
         }
 
         m_nextViewId.store(0);
+        m_frameNumber.fetch_add(1);
     }
 
     bgfx::Encoder* DeviceImpl::GetEncoderForThread()
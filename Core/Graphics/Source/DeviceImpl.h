@@ -95,6 +95,10 @@ namespace Babylon::Graphics
 
         bgfx::ViewId AcquireNewViewId(bgfx::Encoder&);
 
+        bool GetThreadedCommandSubmission() const { return m_threadedCommandSubmission; }
+
+        uint64_t GetFrameNumber() const { return m_frameNumber.load(); }
+
         /* ********** END DEVICE CONTEXT CONTRACT ********** */
 
         // TODO: HACK
@@ -123,6 +127,7 @@ namespace Babylon::Graphics
         bool m_rendering{};
 
         std::atomic<bgfx::ViewId> m_nextViewId{0};
+        std::atomic<uint64_t> m_frameNumber{0};
 
         std::optional<arcana::cancellation_source> m_cancellationSource{};
 
@@ -168,5 +173,6 @@ namespace Babylon::Graphics
         DeviceContext m_context;
         uintptr_t m_bgfxId = 0;
         std::function<void()> m_renderResetCallback;
+        const bool m_threadedCommandSubmission{};
     };
 }
@@ -33,12 +33,21 @@ namespace Babylon::Graphics
 
     void Texture::Dispose()
     {
+        // Removed before the handle is destroyed, since another texture could be created with it right after.
+        m_deviceContext.RemoveTexture(*this);
+
         if (m_ownsHandle && bgfx::isValid(m_handle) && m_deviceID == m_deviceContext.GetDeviceId())
         {
             bgfx::destroy(m_handle);
             m_handle = BGFX_INVALID_HANDLE;
             m_ownsHandle = false;
         }
+
+        if (m_sharedTexture)
+        {
+            m_handle = BGFX_INVALID_HANDLE;
+            m_sharedTexture.reset();
+        }
     }
 
     bool Texture::IsValid() const
@@ -67,6 +76,9 @@ namespace Babylon::Graphics
         m_numLayers = numLayers;
         m_format = format;
         m_flags = flags;
+        m_cubeMap = false;
+
+        m_deviceContext.AddTexture(*this);
     }
 
     void Texture::Update2D(uint16_t layer, uint8_t mip, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const bgfx::Memory* mem, uint16_t pitch)
@@ -74,6 +86,64 @@ namespace Babylon::Graphics
         bgfx::updateTexture2D(m_handle, layer, mip, x, y, width, height, mem, pitch);
     }
 
+    void Texture::Create2DWithGeneratedMips(uint16_t width, uint16_t height, bgfx::TextureFormat::Enum format, uint64_t flags)
+    {
+        Dispose();
+
+        // The texture is a render target only so that the backend can generate its mips. It is not cleared like other
+        // render targets, since its first level is updated and the others are generated from it.
+        m_handle = bgfx::createTexture2D(width, height, true, 1, format, flags | BGFX_TEXTURE_RT | BGFX_TEXTURE_BLIT_DST);
+        if (!bgfx::isValid(m_handle))
+        {
+            throw std::runtime_error{"Failed to create texture"};
+        }
+
+        m_ownsHandle = true;
+        m_width = width;
+        m_height = height;
+        m_hasMips = true;
+        m_numLayers = 1;
+        m_format = format;
+        m_flags = flags;
+        m_cubeMap = false;
+
+        m_deviceContext.AddTexture(*this);
+    }
+
+    bool Texture::CanGenerateMips(bgfx::TextureFormat::Enum format, uint64_t flags)
+    {
+        const uint32_t formatCaps{bgfx::getCaps()->formats[format]};
+        const uint32_t sampleCaps{(flags & BGFX_TEXTURE_SRGB) ? BGFX_CAPS_FORMAT_TEXTURE_2D_SRGB : BGFX_CAPS_FORMAT_TEXTURE_2D};
+        return (formatCaps & (BGFX_CAPS_FORMAT_TEXTURE_MIP_AUTOGEN | sampleCaps)) == (BGFX_CAPS_FORMAT_TEXTURE_MIP_AUTOGEN | sampleCaps) &&
+               bgfx::isTextureValid(0, false, 1, format, flags | BGFX_TEXTURE_RT);
+    }
+
+    void Texture::GenerateMips(bgfx::Encoder& encoder)
+    {
+        assert(m_hasMips && !m_cubeMap);
+
+        // bgfx generates the mips of a frame buffer attachment from its first level when it resolves the frame buffer,
+        // which happens once the view rendering to it is done, so touching an otherwise empty view is enough. Attachments
+        // are initialized to write to the first level and to generate mips on resolve.
+        bgfx::Attachment attachment{};
+        attachment.init(m_handle);
+        const bgfx::FrameBufferHandle frameBuffer{bgfx::createFrameBuffer(1, &attachment)};
+        if (!bgfx::isValid(frameBuffer))
+        {
+            throw std::runtime_error{"Failed to create frame buffer"};
+        }
+
+        const bgfx::ViewId viewId{m_deviceContext.AcquireNewViewId(encoder)};
+        bgfx::setViewMode(viewId, bgfx::ViewMode::Sequential);
+        bgfx::setViewClear(viewId, BGFX_CLEAR_NONE);
+        bgfx::setViewFrameBuffer(viewId, frameBuffer);
+        bgfx::setViewRect(viewId, 0, 0, m_width, m_height);
+        encoder.touch(viewId);
+
+        // The frame buffer is only destroyed after the frame is rendered, and the texture is not destroyed with it.
+        bgfx::destroy(frameBuffer);
+    }
+
     void Texture::CreateCube(uint16_t size, bool hasMips, uint16_t numLayers, bgfx::TextureFormat::Enum format, uint64_t flags)
     {
         Dispose();
@@ -86,6 +156,9 @@ namespace Babylon::Graphics
         m_numLayers = numLayers;
         m_format = format;
         m_flags = flags;
+        m_cubeMap = true;
+
+        m_deviceContext.AddTexture(*this);
     }
 
     void Texture::UpdateCube(uint16_t layer, uint8_t side, uint8_t mip, uint16_t x, uint16_t y, uint16_t width, uint16_t height, const bgfx::Memory* mem, uint16_t pitch)
@@ -93,7 +166,7 @@ namespace Babylon::Graphics
         bgfx::updateTextureCube(m_handle, layer, side, mip, x, y, width, height, mem, pitch);
     }
 
-    void Texture::Attach(bgfx::TextureHandle handle, bool ownsHandle, uint16_t width, uint16_t height, bool hasMips, uint16_t numLayers, bgfx::TextureFormat::Enum format, uint64_t flags)
+    void Texture::Attach(bgfx::TextureHandle handle, bool ownsHandle, uint16_t width, uint16_t height, bool hasMips, uint16_t numLayers, bgfx::TextureFormat::Enum format, uint64_t flags, bool cubeMap)
     {
         Dispose();
 
@@ -106,6 +179,25 @@ namespace Babylon::Graphics
         m_numLayers = numLayers;
         m_format = format;
         m_flags = flags;
+        m_cubeMap = cubeMap;
+
+        // Textures that are not owned are accounted for by their owner.
+        if (ownsHandle)
+        {
+            m_deviceContext.AddTexture(*this);
+        }
+    }
+
+    void Texture::AttachShared(std::shared_ptr<Texture> texture)
+    {
+        Attach(texture->Handle(), false, texture->Width(), texture->Height(), texture->HasMips(), texture->NumLayers(), texture->Format(), texture->Flags());
+        m_cubeMap = texture->IsCubeMap();
+        m_sharedTexture = std::move(texture);
+    }
+
+    bool Texture::IsShared() const
+    {
+        return m_sharedTexture != nullptr;
     }
 
     bgfx::TextureHandle Texture::Handle() const
@@ -152,4 +244,24 @@ namespace Babylon::Graphics
     {
         m_samplerFlags = value;
     }
+
+    bool Texture::IsCubeMap() const
+    {
+        return m_cubeMap;
+    }
+
+    void Texture::SetReloadCallback(ReloadCallback callback)
+    {
+        m_deviceContext.SetTextureReloadCallback(*this, std::move(callback));
+    }
+
+    void Texture::MarkUsed(uint64_t frameNumber)
+    {
+        m_lastUsedFrame.store(frameNumber, std::memory_order_relaxed);
+    }
+
+    uint64_t Texture::LastUsedFrame() const
+    {
+        return m_lastUsedFrame.load(std::memory_order_relaxed);
+    }
 }
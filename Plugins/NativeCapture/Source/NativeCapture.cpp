@@ -7,6 +7,10 @@
 
 #include <arcana/containers/ticketed_collection.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace
@@ -143,6 +147,8 @@ namespace Babylon::Plugins::Internal
                 JS_CLASS_NAME,
                 {
                     NativeCapture::InstanceMethod("addCallback", &NativeCapture::AddCallback),
+                    NativeCapture::InstanceMethod("setFramePoolSize", &NativeCapture::SetFramePoolSize),
+                    NativeCapture::InstanceMethod("releaseFrame", &NativeCapture::ReleaseFrame),
                     NativeCapture::InstanceMethod("dispose", &NativeCapture::Dispose),
                 });
 
@@ -196,29 +202,78 @@ namespace Babylon::Plugins::Internal
             m_callbacks.push_back(Napi::Persistent(listener));
         }
 
+        // Frames are copied into a fixed pool of native-owned ArrayBuffers instead of being copied twice through a new
+        // vector. Each frame is passed to the callbacks in its own object, whose slot must be passed to releaseFrame once
+        // the frame is no longer used. Frames are dropped while all of the ArrayBuffers are in use. A size of 0 disables
+        // the pool.
+        void SetFramePoolSize(const Napi::CallbackInfo& info)
+        {
+            const auto size{info[0].As<Napi::Number>().Uint32Value()};
+
+            std::unique_lock lock{m_framePoolMutex};
+            WaitForFrameCopies(lock);
+            if (std::any_of(m_framePool.begin(), m_framePool.end(), [](const FrameSlot& slot) { return slot.State != FrameSlotState::Free; }))
+            {
+                throw Napi::Error::New(info.Env(), "The frame pool cannot be resized while frames are in use.");
+            }
+
+            m_framePool.clear();
+            m_framePool.resize(size);
+            m_framePoolEnabled = size > 0;
+        }
+
+        void ReleaseFrame(const Napi::CallbackInfo& info)
+        {
+            const auto index{info[0].As<Napi::Number>().Uint32Value()};
+
+            std::scoped_lock lock{m_framePoolMutex};
+            if (index < m_framePool.size() && m_framePool[index].State == FrameSlotState::InUse)
+            {
+                m_framePool[index].State = FrameSlotState::Free;
+            }
+        }
+
+        // Waits until the capture thread is done writing to the ArrayBuffers of the pool, which must not be freed before.
+        void WaitForFrameCopies(std::unique_lock<std::mutex>& lock)
+        {
+            m_framePoolCondition.wait(lock, [this]() {
+                return std::none_of(m_framePool.begin(), m_framePool.end(), [](const FrameSlot& slot) { return slot.State == FrameSlotState::Copying; });
+            });
+        }
+
+        static void SetFrameInfo(Napi::Env env, Napi::Object jsData, uint32_t width, uint32_t height, bgfx::TextureFormat::Enum format, bool yFlip)
+        {
+            jsData.Set("width", static_cast<double>(width));
+            jsData.Set("height", static_cast<double>(height));
+            constexpr auto FORMAT_MEMBER_NAME = "format";
+            switch (format)
+            {
+                case bgfx::TextureFormat::RGBA8:
+                    jsData.Set(FORMAT_MEMBER_NAME, "RGBA8");
+                    break;
+                case bgfx::TextureFormat::BGRA8:
+                    jsData.Set(FORMAT_MEMBER_NAME, "BGRA8");
+                    break;
+                default:
+                    jsData.Set(FORMAT_MEMBER_NAME, env.Undefined());
+                    break;
+            }
+            jsData.Set("yFlip", yFlip);
+        }
+
         void CaptureDataReceived(uint32_t width, uint32_t height, bgfx::TextureFormat::Enum format, bool yFlip, gsl::span<const uint8_t> data)
         {
+            if (PooledCaptureDataReceived(width, height, format, yFlip, data))
+            {
+                return;
+            }
+
             std::vector<uint8_t> bytes{};
             bytes.resize(data.size());
             std::memcpy(bytes.data(), data.data(), data.size());
             m_runtime.Dispatch([this, width, height, format, yFlip, bytes{std::move(bytes)}](Napi::Env env) mutable {
                 Napi::Object jsData = m_jsData.Value();
-                jsData.Set("width", static_cast<double>(width));
-                jsData.Set("height", static_cast<double>(height));
-                constexpr auto FORMAT_MEMBER_NAME = "format";
-                switch (format)
-                {
-                    case bgfx::TextureFormat::RGBA8:
-                        jsData.Set(FORMAT_MEMBER_NAME, "RGBA8");
-                        break;
-                    case bgfx::TextureFormat::BGRA8:
-                        jsData.Set(FORMAT_MEMBER_NAME, "BGRA8");
-                        break;
-                    default:
-                        jsData.Set(FORMAT_MEMBER_NAME, env.Undefined());
-                        break;
-                }
-                jsData.Set("yFlip", yFlip);
+                SetFrameInfo(env, jsData, width, height, format, yFlip);
 
                 auto jsBytes = jsData.Get("data").As<Napi::ArrayBuffer>();
                 if (static_cast<size_t>(bytes.size()) != jsBytes.ByteLength())
@@ -236,10 +291,151 @@ namespace Babylon::Plugins::Internal
             });
         }
 
+        // Returns false if the frame pool is disabled. Called from the thread that captured the frame.
+        bool PooledCaptureDataReceived(uint32_t width, uint32_t height, bgfx::TextureFormat::Enum format, bool yFlip, gsl::span<const uint8_t> data)
+        {
+            uint32_t index{};
+            std::shared_ptr<std::vector<uint8_t>> destination{};
+            {
+                std::scoped_lock lock{m_framePoolMutex};
+                if (!m_framePoolEnabled)
+                {
+                    return false;
+                }
+
+                const auto slot{std::find_if(m_framePool.begin(), m_framePool.end(), [&data](const FrameSlot& frameSlot) { return frameSlot.State == FrameSlotState::Free && frameSlot.Size == data.size(); })};
+                if (slot == m_framePool.end())
+                {
+                    ++m_droppedFrameCount;
+
+                    // The ArrayBuffers are created by the JavaScript thread, and created again when the size of the frames changes.
+                    const bool allocated{std::any_of(m_framePool.begin(), m_framePool.end(), [&data](const FrameSlot& frameSlot) { return frameSlot.Size == data.size(); })};
+                    if (!allocated && !m_framePoolAllocationPending)
+                    {
+                        m_framePoolAllocationPending = true;
+                        m_runtime.Dispatch([this, size{data.size()}](Napi::Env env) {
+                            AllocateFramePool(env, size);
+                        });
+                    }
+
+                    return true;
+                }
+
+                slot->State = FrameSlotState::Copying;
+                index = static_cast<uint32_t>(std::distance(m_framePool.begin(), slot));
+                destination = slot->Data;
+            }
+
+            // The slot shares the ownership of its memory with the ArrayBuffer, so the memory is still valid if JavaScript
+            // drops or detaches the ArrayBuffer. The pool is neither resized nor cleared while a slot is being copied to,
+            // and JavaScript does not use the ArrayBuffer until the frame is dispatched, so it is written without holding
+            // the lock.
+            std::memcpy(destination->data(), data.data(), data.size());
+
+            {
+                std::scoped_lock lock{m_framePoolMutex};
+                m_framePool[index].State = FrameSlotState::InUse;
+            }
+            m_framePoolCondition.notify_all();
+
+            m_runtime.Dispatch([this, index, width, height, format, yFlip](Napi::Env env) {
+                Napi::Object jsData{};
+                uint64_t droppedFrameCount{};
+                {
+                    // The pool is cleared when disposed.
+                    std::scoped_lock lock{m_framePoolMutex};
+                    if (index >= m_framePool.size())
+                    {
+                        return;
+                    }
+
+                    auto& slot{m_framePool[index]};
+                    jsData = slot.JsData.Value();
+                    droppedFrameCount = m_droppedFrameCount;
+
+                    // The ArrayBuffer is set again in case JavaScript replaced it, and created again over the same memory
+                    // in case JavaScript detached it.
+                    auto buffer{slot.Buffer.Value()};
+                    if (buffer.ByteLength() != slot.Size)
+                    {
+                        buffer = CreateFrameBuffer(env, slot.Data);
+                        slot.Buffer = Napi::Persistent(buffer);
+                    }
+                    jsData.Set("data", buffer);
+                }
+
+                // The slot is released here unless a callback receives the frame, which then releases it, so that it is
+                // not lost when there are no callbacks or a callback throws.
+                bool delivered{false};
+                auto releaseUndelivered{gsl::finally([this, index, &delivered]() {
+                    if (!delivered)
+                    {
+                        std::scoped_lock lock{m_framePoolMutex};
+                        if (index < m_framePool.size())
+                        {
+                            m_framePool[index].State = FrameSlotState::Free;
+                        }
+                    }
+                })};
+
+                SetFrameInfo(env, jsData, width, height, format, yFlip);
+                jsData.Set("droppedFrames", static_cast<double>(droppedFrameCount));
+
+                for (const auto& callback : m_callbacks)
+                {
+                    callback.Call({jsData});
+                }
+
+                delivered = !m_callbacks.empty();
+            });
+
+            return true;
+        }
+
+        // The memory is owned by native code rather than JavaScript, and freed once both the slot and the ArrayBuffer are
+        // done with it.
+        static Napi::ArrayBuffer CreateFrameBuffer(Napi::Env env, const std::shared_ptr<std::vector<uint8_t>>& data)
+        {
+            return Napi::ArrayBuffer::New(env, data->data(), data->size(), [data](Napi::Env, void*) {});
+        }
+
+        void AllocateFramePool(Napi::Env env, size_t size)
+        {
+            std::scoped_lock lock{m_framePoolMutex};
+            m_framePoolAllocationPending = false;
+
+            for (uint32_t index = 0; index < m_framePool.size(); ++index)
+            {
+                // Frames still in use keep their ArrayBuffer, and get a new one once released and frames are dropped.
+                auto& slot{m_framePool[index]};
+                if (slot.State != FrameSlotState::Free || slot.Size == size)
+                {
+                    continue;
+                }
+
+                auto data{std::make_shared<std::vector<uint8_t>>(size)};
+                auto buffer{CreateFrameBuffer(env, data)};
+                auto jsData{Napi::Object::New(env)};
+                jsData.Set("data", buffer);
+                jsData.Set("slot", static_cast<double>(index));
+
+                slot.JsData = Napi::Persistent(jsData);
+                slot.Buffer = Napi::Persistent(buffer);
+                slot.Data = std::move(data);
+                slot.Size = size;
+            }
+        }
+
         void Dispose()
         {
             m_frameProviderTicket.reset();
             m_callbacks.clear();
+
+            // A frame captured before the ticket was reset can still be copying to the pool.
+            std::unique_lock lock{m_framePoolMutex};
+            WaitForFrameCopies(lock);
+            m_framePool.clear();
+            m_framePoolEnabled = false;
         }
 
         void Dispose(const Napi::CallbackInfo&)
@@ -251,6 +447,34 @@ namespace Babylon::Plugins::Internal
         std::vector<Napi::FunctionReference> m_callbacks{};
         Napi::ObjectReference m_jsData{};
         std::optional<FrameProviderTicket> m_frameProviderTicket{};
+
+        enum class FrameSlotState
+        {
+            Free,
+            // The capture thread is writing the frame to the ArrayBuffer.
+            Copying,
+            // The frame is dispatched to JavaScript and used until passed to releaseFrame.
+            InUse,
+        };
+
+        struct FrameSlot
+        {
+            // Only used from the JavaScript thread.
+            Napi::ObjectReference JsData{};
+            Napi::Reference<Napi::ArrayBuffer> Buffer{};
+
+            // Shared with the ArrayBuffer of JsData, which JavaScript can drop or detach.
+            std::shared_ptr<std::vector<uint8_t>> Data{};
+            size_t Size{};
+            FrameSlotState State{};
+        };
+
+        std::mutex m_framePoolMutex{};
+        std::condition_variable m_framePoolCondition{};
+        std::vector<FrameSlot> m_framePool{};
+        bool m_framePoolEnabled{};
+        bool m_framePoolAllocationPending{};
+        uint64_t m_droppedFrameCount{};
     };
 }
 
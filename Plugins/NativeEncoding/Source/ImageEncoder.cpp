@@ -0,0 +1,70 @@
+#include "ImageEncoder.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    namespace
+    {
+        // Larger than the trailer of any format, so that writing it does not grow the joined bands again.
+        constexpr size_t MAX_TRAILER_SIZE{32};
+    }
+
+    std::vector<std::byte> ImageEncoder::Join(std::vector<std::vector<std::byte>> bands) const
+    {
+        auto output{std::move(bands.front())};
+
+        size_t size{output.size()};
+        for (size_t band = 1; band < bands.size(); ++band)
+        {
+            size += bands[band].size();
+        }
+
+        output.reserve(size + MAX_TRAILER_SIZE);
+        for (size_t band = 1; band < bands.size(); ++band)
+        {
+            output.insert(output.end(), bands[band].begin(), bands[band].end());
+        }
+
+        WriteTrailer(output);
+        return output;
+    }
+
+    size_t ImageEncoder::GetBandCount(uint32_t rows, uint32_t minRowsPerBand)
+    {
+        const size_t threadCount{std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+        return std::clamp<size_t>(rows / std::max<uint32_t>(minRowsPerBand, 1), 1, threadCount);
+    }
+
+    std::pair<uint32_t, uint32_t> ImageEncoder::GetBandRows(uint32_t rows, size_t bandCount, size_t band)
+    {
+        const auto size{static_cast<uint32_t>(rows / bandCount)};
+        const auto remainder{static_cast<uint32_t>(rows % bandCount)};
+        const auto index{static_cast<uint32_t>(band)};
+        const uint32_t begin{index * size + std::min(index, remainder)};
+        return {begin, begin + size + (index < remainder ? 1 : 0)};
+    }
+
+    std::unique_ptr<ImageEncoder> CreateImageEncoder(std::string_view mimeType, const Image& image, std::optional<double> quality)
+    {
+        if (quality && !(*quality >= 0 && *quality <= 1))
+        {
+            quality.reset();
+        }
+
+        if (mimeType == "image/jpeg")
+        {
+            return CreateJpegEncoder(image, quality);
+        }
+
+#ifdef WEBP
+        if (mimeType == "image/webp")
+        {
+            return CreateWebPEncoder(image, quality);
+        }
+#endif
+
+        return CreatePngEncoder(image);
+    }
+}
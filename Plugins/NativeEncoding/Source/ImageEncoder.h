@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    // RGBA8 pixels, with rows stored from the bottom of the image up when FlipY is set.
+    struct Image
+    {
+        const std::byte* Data{};
+        uint32_t Width{};
+        uint32_t Height{};
+        bool FlipY{};
+
+        const std::byte* Row(uint32_t y) const
+        {
+            return Data + static_cast<size_t>(FlipY ? Height - y - 1 : y) * Width * 4;
+        }
+    };
+
+    // Encodes an image in horizontal bands of rows. Bands are encoded independently, possibly on different threads, and
+    // then joined in order into the first of them, whose buffer becomes the encoded image.
+    class ImageEncoder
+    {
+    public:
+        virtual ~ImageEncoder() = default;
+
+        virtual const char* MimeType() const = 0;
+        virtual size_t BandCount() const = 0;
+
+        // Appends the encoded band to the output. The first band also writes the file header.
+        virtual void EncodeBand(size_t band, std::vector<std::byte>& output) const = 0;
+
+        // Joins the encoded bands and writes the file trailer.
+        std::vector<std::byte> Join(std::vector<std::vector<std::byte>> bands) const;
+
+    protected:
+        // Number of bands to split `rows` rows into: at most one per hardware thread, and at least `minRowsPerBand` rows each.
+        static size_t GetBandCount(uint32_t rows, uint32_t minRowsPerBand);
+
+        // The [begin, end) rows of a band, with the remainder spread over the first bands.
+        static std::pair<uint32_t, uint32_t> GetBandRows(uint32_t rows, size_t bandCount, size_t band);
+
+        virtual void WriteTrailer(std::vector<std::byte>& output) const = 0;
+    };
+
+    // Quality is between 0 and 1 and only used by lossy formats, which use their default quality without one. The PNG
+    // encoder picks its number of bands from the size of the image and the hardware threads, unless one is given.
+    std::unique_ptr<ImageEncoder> CreatePngEncoder(const Image& image, std::optional<size_t> bandCount = {});
+    std::unique_ptr<ImageEncoder> CreateJpegEncoder(const Image& image, std::optional<double> quality);
+    std::unique_ptr<ImageEncoder> CreateWebPEncoder(const Image& image, std::optional<double> quality);
+
+    // Creates the encoder for a MIME type, falling back to PNG for unsupported types like browsers do.
+    std::unique_ptr<ImageEncoder> CreateImageEncoder(std::string_view mimeType, const Image& image, std::optional<double> quality);
+}
@@ -0,0 +1,591 @@
+#include "ImageEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    namespace
+    {
+        // Same default as canvas.toBlob.
+        constexpr double DEFAULT_QUALITY{0.92};
+
+        // Chroma is subsampled 2x2 below this quality.
+        constexpr double FULL_CHROMA_QUALITY{0.9};
+
+        constexpr uint32_t MAX_DIMENSION{65535};
+        constexpr uint32_t MAX_RESTART_INTERVAL{65535};
+
+        // Bands are separated by restart markers, which reset the DC prediction, so they are kept large enough for this to
+        // be negligible.
+        constexpr uint32_t MIN_ROWS_PER_BAND{64};
+
+        // Quantization tables of the JPEG specification (Annex K) in natural order, scaled by the quality.
+        constexpr uint8_t LUMINANCE_QUANTIZATION[64]{
+            16, 11, 10, 16, 24, 40, 51, 61,
+            12, 12, 14, 19, 26, 58, 60, 55,
+            14, 13, 16, 24, 40, 57, 69, 56,
+            14, 17, 22, 29, 51, 87, 80, 62,
+            18, 22, 37, 56, 68, 109, 103, 77,
+            24, 35, 55, 64, 81, 104, 113, 92,
+            49, 64, 78, 87, 103, 121, 120, 101,
+            72, 92, 95, 98, 112, 100, 103, 99};
+
+        constexpr uint8_t CHROMINANCE_QUANTIZATION[64]{
+            17, 18, 24, 47, 99, 99, 99, 99,
+            18, 21, 26, 66, 99, 99, 99, 99,
+            24, 26, 56, 99, 99, 99, 99, 99,
+            47, 66, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99,
+            99, 99, 99, 99, 99, 99, 99, 99};
+
+        // Huffman tables of the JPEG specification (Annex K), as the number of codes of each length followed by the values.
+        constexpr uint8_t LUMINANCE_DC_LENGTHS[16]{0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+        constexpr uint8_t LUMINANCE_DC_VALUES[12]{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+        constexpr uint8_t CHROMINANCE_DC_LENGTHS[16]{0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+        constexpr uint8_t CHROMINANCE_DC_VALUES[12]{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+        constexpr uint8_t LUMINANCE_AC_LENGTHS[16]{0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D};
+        constexpr uint8_t LUMINANCE_AC_VALUES[162]{
+            0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+            0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+            0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+            0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+            0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+            0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+            0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+            0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+            0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+            0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+            0xF9, 0xFA};
+
+        constexpr uint8_t CHROMINANCE_AC_LENGTHS[16]{0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+        constexpr uint8_t CHROMINANCE_AC_VALUES[162]{
+            0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+            0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+            0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+            0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+            0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+            0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+            0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+            0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+            0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+            0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+            0xF9, 0xFA};
+
+        // Scale factors of the AAN forward DCT, which are folded into the quantization.
+        constexpr float AAN_SCALE_FACTORS[8]{1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f};
+
+        struct HuffmanTable
+        {
+            std::array<uint16_t, 256> Codes{};
+            std::array<uint8_t, 256> Lengths{};
+        };
+
+        // Assigns the canonical code of each value from the number of codes of each length.
+        HuffmanTable CreateHuffmanTable(const uint8_t (&lengths)[16], const uint8_t* values)
+        {
+            HuffmanTable table{};
+            uint16_t code{0};
+            for (uint8_t length = 1; length <= 16; ++length)
+            {
+                for (uint8_t index = 0; index < lengths[length - 1]; ++index)
+                {
+                    table.Codes[*values] = code++;
+                    table.Lengths[*values] = length;
+                    ++values;
+                }
+
+                code <<= 1;
+            }
+
+            return table;
+        }
+
+        struct HuffmanTables
+        {
+            HuffmanTable LuminanceDC{CreateHuffmanTable(LUMINANCE_DC_LENGTHS, LUMINANCE_DC_VALUES)};
+            HuffmanTable LuminanceAC{CreateHuffmanTable(LUMINANCE_AC_LENGTHS, LUMINANCE_AC_VALUES)};
+            HuffmanTable ChrominanceDC{CreateHuffmanTable(CHROMINANCE_DC_LENGTHS, CHROMINANCE_DC_VALUES)};
+            HuffmanTable ChrominanceAC{CreateHuffmanTable(CHROMINANCE_AC_LENGTHS, CHROMINANCE_AC_VALUES)};
+        };
+
+        const HuffmanTables& GetHuffmanTables()
+        {
+            static const HuffmanTables tables{};
+            return tables;
+        }
+
+        // The position of each coefficient of a block in zigzag order.
+        std::array<uint8_t, 64> CreateZigZag()
+        {
+            std::array<uint8_t, 64> zigZag{};
+            uint8_t position{0};
+            for (int diagonal = 0; diagonal < 15; ++diagonal)
+            {
+                const int first{std::max(0, diagonal - 7)};
+                const int last{std::min(diagonal, 7)};
+                for (int offset = 0; offset <= last - first; ++offset)
+                {
+                    // Odd diagonals are walked down from the top row, and even ones up to it.
+                    const int row{diagonal % 2 == 1 ? first + offset : last - offset};
+                    zigZag[static_cast<size_t>(row * 8 + diagonal - row)] = position++;
+                }
+            }
+
+            return zigZag;
+        }
+
+        const std::array<uint8_t, 64>& GetZigZag()
+        {
+            static const auto zigZag{CreateZigZag()};
+            return zigZag;
+        }
+
+        // Writes entropy-coded data, stuffing a zero byte after each 0xFF byte.
+        class BitWriter final
+        {
+        public:
+            explicit BitWriter(std::vector<std::byte>& output)
+                : m_output{output}
+            {
+            }
+
+            void Write(uint32_t bits, uint32_t count)
+            {
+                m_buffer = (m_buffer << count) | (bits & ((1u << count) - 1));
+                m_count += count;
+                while (m_count >= 8)
+                {
+                    m_count -= 8;
+                    const auto byte{static_cast<std::byte>(m_buffer >> m_count)};
+                    m_output.push_back(byte);
+                    if (byte == std::byte{0xFF})
+                    {
+                        m_output.push_back(std::byte{0});
+                    }
+                }
+            }
+
+            void Write(const HuffmanTable& table, uint8_t value)
+            {
+                Write(table.Codes[value], table.Lengths[value]);
+            }
+
+            // Pads the last byte with one bits.
+            void Flush()
+            {
+                if (m_count > 0)
+                {
+                    Write(0xFF, 8 - m_count);
+                }
+            }
+
+        private:
+            std::vector<std::byte>& m_output;
+            uint32_t m_buffer{0};
+            uint32_t m_count{0};
+        };
+
+        // AAN forward DCT of 8 values, scaled by the AAN scale factors.
+        void ForwardDct(float* data, size_t stride)
+        {
+            float& d0{data[0]};
+            float& d1{data[stride]};
+            float& d2{data[stride * 2]};
+            float& d3{data[stride * 3]};
+            float& d4{data[stride * 4]};
+            float& d5{data[stride * 5]};
+            float& d6{data[stride * 6]};
+            float& d7{data[stride * 7]};
+
+            const float tmp0{d0 + d7};
+            const float tmp7{d0 - d7};
+            const float tmp1{d1 + d6};
+            const float tmp6{d1 - d6};
+            const float tmp2{d2 + d5};
+            const float tmp5{d2 - d5};
+            const float tmp3{d3 + d4};
+            const float tmp4{d3 - d4};
+
+            // Even part
+            float tmp10{tmp0 + tmp3};
+            const float tmp13{tmp0 - tmp3};
+            float tmp11{tmp1 + tmp2};
+            float tmp12{tmp1 - tmp2};
+
+            d0 = tmp10 + tmp11;
+            d4 = tmp10 - tmp11;
+
+            const float z1{(tmp12 + tmp13) * 0.707106781f};
+            d2 = tmp13 + z1;
+            d6 = tmp13 - z1;
+
+            // Odd part
+            tmp10 = tmp4 + tmp5;
+            tmp11 = tmp5 + tmp6;
+            tmp12 = tmp6 + tmp7;
+
+            const float z5{(tmp10 - tmp12) * 0.382683433f};
+            const float z2{tmp10 * 0.541196100f + z5};
+            const float z4{tmp12 * 1.306562965f + z5};
+            const float z3{tmp11 * 0.707106781f};
+
+            const float z11{tmp7 + z3};
+            const float z13{tmp7 - z3};
+
+            d5 = z13 + z2;
+            d3 = z13 - z2;
+            d1 = z11 + z4;
+            d7 = z11 - z4;
+        }
+
+        // The number of bits of the magnitude of a value, and the bits JPEG uses to encode the value with that many bits.
+        std::pair<uint8_t, uint32_t> GetMagnitude(int value)
+        {
+            const auto magnitude{static_cast<uint32_t>(value < 0 ? -value : value)};
+            uint8_t size{0};
+            while ((magnitude >> size) != 0)
+            {
+                ++size;
+            }
+
+            return {size, static_cast<uint32_t>(value < 0 ? value - 1 : value)};
+        }
+
+        // Quantization table in natural order for a quality between 1 and 100, as computed by libjpeg.
+        std::array<uint8_t, 64> ScaleQuantization(const uint8_t (&table)[64], int quality)
+        {
+            const int scale{quality < 50 ? 5000 / quality : 200 - quality * 2};
+
+            std::array<uint8_t, 64> scaled{};
+            for (size_t index = 0; index < 64; ++index)
+            {
+                scaled[index] = static_cast<uint8_t>(std::clamp((table[index] * scale + 50) / 100, 1, 255));
+            }
+
+            return scaled;
+        }
+
+        std::array<float, 64> GetDivisors(const std::array<uint8_t, 64>& quantization)
+        {
+            std::array<float, 64> divisors{};
+            for (size_t index = 0; index < 64; ++index)
+            {
+                divisors[index] = 1.0f / (quantization[index] * AAN_SCALE_FACTORS[index / 8] * AAN_SCALE_FACTORS[index % 8] * 8.0f);
+            }
+
+            return divisors;
+        }
+
+        struct Component
+        {
+            const std::array<float, 64>& Divisors;
+            const HuffmanTable& DC;
+            const HuffmanTable& AC;
+            int Predictor{0};
+        };
+
+        // Writes baseline JPEG images with YCbCr components, discarding alpha. The bands are groups of MCU rows separated by
+        // restart markers, so that they can be entropy coded independently.
+        class JpegEncoder final : public ImageEncoder
+        {
+        public:
+            JpegEncoder(const Image& image, double quality)
+                : m_image{image}
+                , m_subsample{quality < FULL_CHROMA_QUALITY}
+                , m_mcuSize{m_subsample ? 16u : 8u}
+                , m_luminanceQuantization{ScaleQuantization(LUMINANCE_QUANTIZATION, std::clamp(static_cast<int>(std::lround(quality * 100)), 1, 100))}
+                , m_chrominanceQuantization{ScaleQuantization(CHROMINANCE_QUANTIZATION, std::clamp(static_cast<int>(std::lround(quality * 100)), 1, 100))}
+                , m_luminanceDivisors{GetDivisors(m_luminanceQuantization)}
+                , m_chrominanceDivisors{GetDivisors(m_chrominanceQuantization)}
+            {
+                if (image.Width > MAX_DIMENSION || image.Height > MAX_DIMENSION)
+                {
+                    throw std::runtime_error{"Failed to encode JPEG image: dimensions are larger than 65535"};
+                }
+
+                m_mcuColumns = (image.Width + m_mcuSize - 1) / m_mcuSize;
+                m_mcuRows = (image.Height + m_mcuSize - 1) / m_mcuSize;
+
+                // Every band but the last must have the same number of MCUs, which is the restart interval.
+                const size_t bandCount{GetBandCount(m_mcuRows, MIN_ROWS_PER_BAND / m_mcuSize)};
+                m_mcuRowsPerBand = static_cast<uint32_t>((m_mcuRows + bandCount - 1) / bandCount);
+                m_mcuRowsPerBand = std::clamp(m_mcuRowsPerBand, 1u, std::max(MAX_RESTART_INTERVAL / m_mcuColumns, 1u));
+                m_bandCount = (m_mcuRows + m_mcuRowsPerBand - 1) / m_mcuRowsPerBand;
+            }
+
+            const char* MimeType() const override
+            {
+                return "image/jpeg";
+            }
+
+            size_t BandCount() const override
+            {
+                return m_bandCount;
+            }
+
+            void EncodeBand(size_t band, std::vector<std::byte>& output) const override
+            {
+                if (band == 0)
+                {
+                    WriteHeader(output);
+                }
+
+                const auto& tables{GetHuffmanTables()};
+                Component luminance{m_luminanceDivisors, tables.LuminanceDC, tables.LuminanceAC};
+                Component blueChrominance{m_chrominanceDivisors, tables.ChrominanceDC, tables.ChrominanceAC};
+                Component redChrominance{m_chrominanceDivisors, tables.ChrominanceDC, tables.ChrominanceAC};
+
+                BitWriter writer{output};
+                const auto beginRow{static_cast<uint32_t>(band * m_mcuRowsPerBand)};
+                const uint32_t endRow{std::min(beginRow + m_mcuRowsPerBand, m_mcuRows)};
+                for (uint32_t mcuRow = beginRow; mcuRow < endRow; ++mcuRow)
+                {
+                    for (uint32_t mcuColumn = 0; mcuColumn < m_mcuColumns; ++mcuColumn)
+                    {
+                        if (m_subsample)
+                        {
+                            EncodeSubsampledMcu(writer, mcuColumn * 16, mcuRow * 16, luminance, blueChrominance, redChrominance);
+                        }
+                        else
+                        {
+                            EncodeMcu(writer, mcuColumn * 8, mcuRow * 8, luminance, blueChrominance, redChrominance);
+                        }
+                    }
+                }
+
+                writer.Flush();
+
+                if (band + 1 < m_bandCount)
+                {
+                    output.push_back(std::byte{0xFF});
+                    output.push_back(static_cast<std::byte>(0xD0 + band % 8));
+                }
+            }
+
+        protected:
+            void WriteTrailer(std::vector<std::byte>& output) const override
+            {
+                WriteMarker(output, 0xD9);
+            }
+
+        private:
+            static void WriteMarker(std::vector<std::byte>& output, uint8_t marker)
+            {
+                output.push_back(std::byte{0xFF});
+                output.push_back(static_cast<std::byte>(marker));
+            }
+
+            static void WriteUint16(std::vector<std::byte>& output, size_t value)
+            {
+                output.push_back(static_cast<std::byte>(value >> 8));
+                output.push_back(static_cast<std::byte>(value));
+            }
+
+            static void WriteBytes(std::vector<std::byte>& output, const uint8_t* data, size_t size)
+            {
+                const auto* bytes{reinterpret_cast<const std::byte*>(data)};
+                output.insert(output.end(), bytes, bytes + size);
+            }
+
+            void WriteHeader(std::vector<std::byte>& output) const
+            {
+                WriteMarker(output, 0xD8);
+
+                // JFIF 1.1 with square pixels.
+                constexpr uint8_t JFIF[]{'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+                WriteMarker(output, 0xE0);
+                WriteUint16(output, 2 + sizeof(JFIF));
+                WriteBytes(output, JFIF, sizeof(JFIF));
+
+                const auto& zigZag{GetZigZag()};
+                WriteMarker(output, 0xDB);
+                WriteUint16(output, 2 + 2 * 65);
+                for (const auto* quantization : {&m_luminanceQuantization, &m_chrominanceQuantization})
+                {
+                    output.push_back(static_cast<std::byte>(quantization == &m_luminanceQuantization ? 0 : 1));
+
+                    uint8_t zigZagQuantization[64]{};
+                    for (size_t index = 0; index < 64; ++index)
+                    {
+                        zigZagQuantization[zigZag[index]] = (*quantization)[index];
+                    }
+
+                    WriteBytes(output, zigZagQuantization, sizeof(zigZagQuantization));
+                }
+
+                // Baseline frame with luminance (1), blue chrominance (2) and red chrominance (3) components.
+                const uint8_t luminanceSampling{static_cast<uint8_t>(m_subsample ? 0x22 : 0x11)};
+                const uint8_t frame[]{8, static_cast<uint8_t>(m_image.Height >> 8), static_cast<uint8_t>(m_image.Height), static_cast<uint8_t>(m_image.Width >> 8), static_cast<uint8_t>(m_image.Width),
+                    3, 1, luminanceSampling, 0, 2, 0x11, 1, 3, 0x11, 1};
+                WriteMarker(output, 0xC0);
+                WriteUint16(output, 2 + sizeof(frame));
+                WriteBytes(output, frame, sizeof(frame));
+
+                WriteMarker(output, 0xC4);
+                WriteUint16(output, 2 + 4 * 17 + 2 * sizeof(LUMINANCE_DC_VALUES) + 2 * sizeof(LUMINANCE_AC_VALUES));
+                const auto writeHuffmanTable{[&output](uint8_t tableClassAndId, const uint8_t(&lengths)[16], const uint8_t* values, size_t valueCount) {
+                    output.push_back(static_cast<std::byte>(tableClassAndId));
+                    WriteBytes(output, lengths, sizeof(lengths));
+                    WriteBytes(output, values, valueCount);
+                }};
+                writeHuffmanTable(0x00, LUMINANCE_DC_LENGTHS, LUMINANCE_DC_VALUES, sizeof(LUMINANCE_DC_VALUES));
+                writeHuffmanTable(0x10, LUMINANCE_AC_LENGTHS, LUMINANCE_AC_VALUES, sizeof(LUMINANCE_AC_VALUES));
+                writeHuffmanTable(0x01, CHROMINANCE_DC_LENGTHS, CHROMINANCE_DC_VALUES, sizeof(CHROMINANCE_DC_VALUES));
+                writeHuffmanTable(0x11, CHROMINANCE_AC_LENGTHS, CHROMINANCE_AC_VALUES, sizeof(CHROMINANCE_AC_VALUES));
+
+                if (m_bandCount > 1)
+                {
+                    WriteMarker(output, 0xDD);
+                    WriteUint16(output, 4);
+                    WriteUint16(output, m_mcuColumns * m_mcuRowsPerBand);
+                }
+
+                constexpr uint8_t SCAN[]{3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+                WriteMarker(output, 0xDA);
+                WriteUint16(output, 2 + sizeof(SCAN));
+                WriteBytes(output, SCAN, sizeof(SCAN));
+            }
+
+            // Converts a pixel to YCbCr, clamping coordinates outside of the image to its edges.
+            void GetPixel(uint32_t x, uint32_t y, float& luminance, float& blueChrominance, float& redChrominance) const
+            {
+                const auto* pixel{reinterpret_cast<const uint8_t*>(m_image.Row(std::min(y, m_image.Height - 1))) + std::min(x, m_image.Width - 1) * 4};
+                const auto red{static_cast<float>(pixel[0])};
+                const auto green{static_cast<float>(pixel[1])};
+                const auto blue{static_cast<float>(pixel[2])};
+
+                luminance = 0.299f * red + 0.587f * green + 0.114f * blue - 128.0f;
+                blueChrominance = -0.168736f * red - 0.331264f * green + 0.5f * blue;
+                redChrominance = 0.5f * red - 0.418688f * green - 0.081312f * blue;
+            }
+
+            void EncodeMcu(BitWriter& writer, uint32_t x, uint32_t y, Component& luminance, Component& blueChrominance, Component& redChrominance) const
+            {
+                float luminanceBlock[64];
+                float blueBlock[64];
+                float redBlock[64];
+                for (uint32_t row = 0; row < 8; ++row)
+                {
+                    for (uint32_t column = 0; column < 8; ++column)
+                    {
+                        const uint32_t index{row * 8 + column};
+                        GetPixel(x + column, y + row, luminanceBlock[index], blueBlock[index], redBlock[index]);
+                    }
+                }
+
+                EncodeBlock(writer, luminanceBlock, luminance);
+                EncodeBlock(writer, blueBlock, blueChrominance);
+                EncodeBlock(writer, redBlock, redChrominance);
+            }
+
+            void EncodeSubsampledMcu(BitWriter& writer, uint32_t x, uint32_t y, Component& luminance, Component& blueChrominance, Component& redChrominance) const
+            {
+                float luminanceBlocks[4][64];
+                float blueBlock[64]{};
+                float redBlock[64]{};
+                for (uint32_t row = 0; row < 16; ++row)
+                {
+                    for (uint32_t column = 0; column < 16; ++column)
+                    {
+                        float blue{};
+                        float red{};
+                        GetPixel(x + column, y + row, luminanceBlocks[(row / 8) * 2 + column / 8][(row % 8) * 8 + column % 8], blue, red);
+
+                        const uint32_t index{(row / 2) * 8 + column / 2};
+                        blueBlock[index] += blue * 0.25f;
+                        redBlock[index] += red * 0.25f;
+                    }
+                }
+
+                for (auto& luminanceBlock : luminanceBlocks)
+                {
+                    EncodeBlock(writer, luminanceBlock, luminance);
+                }
+
+                EncodeBlock(writer, blueBlock, blueChrominance);
+                EncodeBlock(writer, redBlock, redChrominance);
+            }
+
+            static void EncodeBlock(BitWriter& writer, float (&block)[64], Component& component)
+            {
+                for (size_t row = 0; row < 8; ++row)
+                {
+                    ForwardDct(block + row * 8, 1);
+                }
+
+                for (size_t column = 0; column < 8; ++column)
+                {
+                    ForwardDct(block + column, 8);
+                }
+
+                const auto& zigZag{GetZigZag()};
+                int coefficients[64];
+                for (size_t index = 0; index < 64; ++index)
+                {
+                    coefficients[zigZag[index]] = static_cast<int>(std::lround(block[index] * component.Divisors[index]));
+                }
+
+                const auto [dcSize, dcBits] = GetMagnitude(coefficients[0] - component.Predictor);
+                component.Predictor = coefficients[0];
+                writer.Write(component.DC, dcSize);
+                writer.Write(dcBits, dcSize);
+
+                size_t last{63};
+                while (last > 0 && coefficients[last] == 0)
+                {
+                    --last;
+                }
+
+                uint8_t run{0};
+                for (size_t index = 1; index <= last; ++index)
+                {
+                    if (coefficients[index] == 0)
+                    {
+                        ++run;
+                        continue;
+                    }
+
+                    for (; run >= 16; run -= 16)
+                    {
+                        writer.Write(component.AC, 0xF0);
+                    }
+
+                    const auto [acSize, acBits] = GetMagnitude(coefficients[index]);
+                    writer.Write(component.AC, static_cast<uint8_t>((run << 4) | acSize));
+                    writer.Write(acBits, acSize);
+                    run = 0;
+                }
+
+                if (last < 63)
+                {
+                    writer.Write(component.AC, 0x00);
+                }
+            }
+
+            const Image m_image;
+            const bool m_subsample;
+            const uint32_t m_mcuSize;
+            const std::array<uint8_t, 64> m_luminanceQuantization;
+            const std::array<uint8_t, 64> m_chrominanceQuantization;
+            const std::array<float, 64> m_luminanceDivisors;
+            const std::array<float, 64> m_chrominanceDivisors;
+
+            uint32_t m_mcuColumns{};
+            uint32_t m_mcuRows{};
+            uint32_t m_mcuRowsPerBand{};
+            size_t m_bandCount{};
+        };
+    }
+
+    std::unique_ptr<ImageEncoder> CreateJpegEncoder(const Image& image, std::optional<double> quality)
+    {
+        return std::make_unique<JpegEncoder>(image, quality.value_or(DEFAULT_QUALITY));
+    }
+}
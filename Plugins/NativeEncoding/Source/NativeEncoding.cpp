@@ -1,46 +1,20 @@
 #include <Babylon/Plugins/NativeEncoding.h>
 #include <Babylon/JsRuntime.h>
 #include <Babylon/JsRuntimeScheduler.h>
-#include <Babylon/Graphics/DeviceContext.h>
 
-#include <napi/napi.h>
+#include "ImageEncoder.h"
 
-#include <bimg/encode.h>
-#include <bx/readerwriter.h>
+#include <napi/napi.h>
 
 #include <arcana/threading/task.h>
 #include <arcana/threading/task_schedulers.h>
 
+#include <gsl/gsl>
+
 namespace Babylon::Plugins
 {
     namespace
     {
-        std::shared_ptr<std::vector<std::byte>> EncodePNG(const std::vector<std::byte>& pixelData, uint32_t width, uint32_t height, bool invertY)
-        {
-            auto memoryBlock{bx::MemoryBlock(&Graphics::DeviceContext::GetDefaultAllocator())};
-            auto writer{bx::MemoryWriter(&memoryBlock)};
-            auto err{bx::Error()};
-
-            bimg::imageWritePng(&writer, width, height, width * 4, pixelData.data(), bimg::TextureFormat::RGBA8, !invertY, &err);
-
-            auto byteLength{memoryBlock.getSize()};
-
-            if (!err.isOk())
-            {
-                throw std::runtime_error("Failed to encode PNG image: " + std::string(err.getMessage().getCPtr()));
-            }
-
-            if (byteLength == 0)
-            {
-                throw std::runtime_error("Failed to encode PNG image: output is empty");
-            }
-
-            auto result{std::make_shared<std::vector<std::byte>>(byteLength)};
-            std::memcpy(result->data(), memoryBlock.more(0), byteLength);
-
-            return result;
-        }
-
         Napi::Value EncodeImageAsync(const Napi::CallbackInfo& info)
         {
             auto buffer{info[0].As<Napi::TypedArray>()}; // ArrayBufferView
@@ -48,26 +22,59 @@ namespace Babylon::Plugins
             auto height{info[2].As<Napi::Number>().Uint32Value()};
             auto mimeType{info.Length() > 3 && !info[3].IsUndefined() ? info[3].As<Napi::String>().Utf8Value() : "image/png"};
             auto invertY{info.Length() > 4 && !info[4].IsUndefined() ? info[4].As<Napi::Boolean>().Value() : false};
+            auto quality{info.Length() > 5 && info[5].IsNumber() ? std::optional<double>{info[5].As<Napi::Number>().DoubleValue()} : std::nullopt};
 
             auto env{info.Env()};
             auto deferred{Napi::Promise::Deferred::New(env)};
 
-            if (buffer.ByteLength() != width * height * 4)
+            if (width == 0 || height == 0)
+            {
+                deferred.Reject(Napi::Error::New(env, "Image dimensions must be greater than zero.").Value());
+                return deferred.Promise();
+            }
+
+            if (buffer.ByteLength() != static_cast<size_t>(width) * height * 4)
             {
                 deferred.Reject(Napi::Error::New(env, "Buffer byte length does not match RGBA8 format (4 bytes per pixel) of provided dimensions.").Value());
                 return deferred.Promise();
             }
 
-            auto runtimeScheduler{std::make_shared<JsRuntimeScheduler>(JsRuntime::GetFromJavaScript(env))};
-            auto start = static_cast<std::byte*>(buffer.ArrayBuffer().Data()) + buffer.ByteOffset();
-            auto pixelData{std::vector<std::byte>(start, start + buffer.ByteLength())};
+            // The pixels are copied so that JavaScript can modify or detach the buffer as soon as this returns, like with
+            // canvas.toBlob, while the bands are encoded on the thread pool.
+            const auto pixelData{static_cast<const std::byte*>(buffer.ArrayBuffer().Data()) + buffer.ByteOffset()};
+            const auto pixels{std::make_shared<const std::vector<std::byte>>(pixelData, pixelData + buffer.ByteLength())};
+            const NativeEncoding::Image image{pixels->data(), width, height, !invertY};
+
+            std::shared_ptr<NativeEncoding::ImageEncoder> encoder{};
+            try
+            {
+                encoder = NativeEncoding::CreateImageEncoder(mimeType, image, quality);
+            }
+            catch (const std::exception& exception)
+            {
+                deferred.Reject(Napi::Error::New(env, exception.what()).Value());
+                return deferred.Promise();
+            }
+
+            // Bands are encoded in parallel and then joined into the buffer of the first one, which is handed to JavaScript.
+            std::vector<arcana::task<std::vector<std::byte>, std::exception_ptr>> tasks{};
+            tasks.reserve(encoder->BandCount());
+            for (size_t band = 0; band < encoder->BandCount(); ++band)
+            {
+                tasks.push_back(arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation_source::none(), [encoder, pixels, band]() {
+                    std::vector<std::byte> output{};
+                    encoder->EncodeBand(band, output);
+                    return output;
+                }));
+            }
 
-            arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation_source::none(),
-                [pixelData{std::move(pixelData)}, width, height, invertY]() {
-                    return EncodePNG(pixelData, width, height, invertY);
+            auto runtimeScheduler{std::make_shared<JsRuntimeScheduler>(JsRuntime::GetFromJavaScript(env))};
+            arcana::when_all(gsl::make_span(tasks))
+                .then(arcana::threadpool_scheduler, arcana::cancellation_source::none(), [encoder](std::vector<std::vector<std::byte>> bands) {
+                    return std::make_shared<std::vector<std::byte>>(encoder->Join(std::move(bands)));
                 })
                 .then(*runtimeScheduler, arcana::cancellation_source::none(),
-                    [runtimeScheduler, deferred, env](const arcana::expected<std::shared_ptr<std::vector<std::byte>>, std::exception_ptr>& result) {
+                    [runtimeScheduler, deferred, env, encoder](const arcana::expected<std::shared_ptr<std::vector<std::byte>>, std::exception_ptr>& result) {
                         // TODO: Crash risk on JS teardown - this async work isn't tied to any JS object lifetime,
                         // unlike other plugins that cancel / clean up pending work in their destructors.
                         if (result.has_error())
@@ -84,7 +91,7 @@ namespace Babylon::Plugins
                         blobParts.Set(uint32_t{0}, arrayBuffer);
 
                         auto options = Napi::Object::New(env);
-                        options.Set("type", Napi::String::New(env, "image/png"));
+                        options.Set("type", Napi::String::New(env, encoder->MimeType()));
 
                         auto blob = blobCtor.New({blobParts, options});
 
@@ -103,4 +110,4 @@ namespace Babylon::Plugins::NativeEncoding
         auto native{JsRuntime::NativeObject::GetFromJavaScript(env)};
         native.Set("EncodeImageAsync", Napi::Function::New(env, EncodeImageAsync, "EncodeImageAsync"));
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,215 @@
+#include "ImageEncoder.h"
+
+#include <miniz.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    namespace
+    {
+        constexpr uint8_t PNG_SIGNATURE[]{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        constexpr uint8_t ZLIB_HEADER[]{0x78, 0x9C};
+        constexpr uint8_t BIT_DEPTH{8};
+        constexpr uint8_t COLOR_TYPE_RGBA{6};
+        constexpr uint8_t FILTER_NONE{0};
+
+        // Each band is compressed on its own, so bands are kept large enough to still compress well.
+        constexpr size_t MIN_BAND_SIZE{256 * 1024};
+
+        void WriteBytes(std::vector<std::byte>& output, const void* data, size_t size)
+        {
+            const auto* bytes{static_cast<const std::byte*>(data)};
+            output.insert(output.end(), bytes, bytes + size);
+        }
+
+        void WriteUint32(std::vector<std::byte>& output, uint32_t value)
+        {
+            const uint8_t bytes[]{static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+            WriteBytes(output, bytes, sizeof(bytes));
+        }
+
+        // Writes a chunk whose data is appended to the output by writeData.
+        template<typename WriteDataT>
+        void WriteChunk(std::vector<std::byte>& output, const char (&type)[5], WriteDataT writeData)
+        {
+            const size_t start{output.size()};
+            WriteUint32(output, 0);
+            WriteBytes(output, type, 4);
+            writeData();
+
+            const auto length{static_cast<uint32_t>(output.size() - start - 8)};
+            const uint8_t lengthBytes[]{static_cast<uint8_t>(length >> 24), static_cast<uint8_t>(length >> 16), static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length)};
+            std::memcpy(output.data() + start, lengthBytes, sizeof(lengthBytes));
+
+            const auto crc{static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(output.data() + start + 4), length + 4))};
+            WriteUint32(output, crc);
+        }
+
+        // The Adler-32 checksum of two concatenated blocks of data from the checksums of each block.
+        uint32_t CombineAdler32(uint32_t first, uint32_t second, size_t secondSize)
+        {
+            constexpr uint32_t BASE{65521};
+            const auto remainder{static_cast<uint32_t>(secondSize % BASE)};
+
+            uint32_t sum1{first & 0xFFFF};
+            uint32_t sum2{(remainder * sum1) % BASE};
+            sum1 += (second & 0xFFFF) + BASE - 1;
+            sum2 += (first >> 16) + (second >> 16) + BASE - remainder;
+
+            sum1 = sum1 >= BASE ? sum1 - BASE : sum1;
+            sum1 = sum1 >= BASE ? sum1 - BASE : sum1;
+            sum2 = sum2 >= 2 * BASE ? sum2 - 2 * BASE : sum2;
+            sum2 = sum2 >= BASE ? sum2 - BASE : sum2;
+            return sum1 | (sum2 << 16);
+        }
+
+        // Writes the rows of each band as one or more raw deflate blocks. Bands other than the last end with a sync flush,
+        // which aligns them to a byte boundary, so that the concatenated bands are a single zlib stream.
+        class PngEncoder final : public ImageEncoder
+        {
+        public:
+            PngEncoder(const Image& image, std::optional<size_t> bandCount)
+                : m_image{image}
+                , m_bandCount{bandCount ? std::clamp<size_t>(*bandCount, 1, std::max<uint32_t>(image.Height, 1)) : GetBandCount(image.Height, static_cast<uint32_t>(MIN_BAND_SIZE / RowSize() + 1))}
+                , m_checksums(m_bandCount)
+            {
+            }
+
+            const char* MimeType() const override
+            {
+                return "image/png";
+            }
+
+            size_t BandCount() const override
+            {
+                return m_bandCount;
+            }
+
+            void EncodeBand(size_t band, std::vector<std::byte>& output) const override
+            {
+                if (band == 0)
+                {
+                    WriteBytes(output, PNG_SIGNATURE, sizeof(PNG_SIGNATURE));
+                    WriteChunk(output, "IHDR", [&]() {
+                        WriteUint32(output, m_image.Width);
+                        WriteUint32(output, m_image.Height);
+                        const uint8_t header[]{BIT_DEPTH, COLOR_TYPE_RGBA, 0, 0, 0};
+                        WriteBytes(output, header, sizeof(header));
+                    });
+                }
+
+                WriteChunk(output, "IDAT", [&]() {
+                    if (band == 0)
+                    {
+                        WriteBytes(output, ZLIB_HEADER, sizeof(ZLIB_HEADER));
+                    }
+
+                    Compress(band, output);
+                });
+            }
+
+        protected:
+            void WriteTrailer(std::vector<std::byte>& output) const override
+            {
+                uint32_t checksum{m_checksums[0]};
+                for (size_t band = 1; band < m_bandCount; ++band)
+                {
+                    const auto [begin, end] = GetBandRows(m_image.Height, m_bandCount, band);
+                    checksum = CombineAdler32(checksum, m_checksums[band], (end - begin) * (RowSize() + 1));
+                }
+
+                WriteChunk(output, "IDAT", [&]() { WriteUint32(output, checksum); });
+                WriteChunk(output, "IEND", []() {});
+            }
+
+        private:
+            size_t RowSize() const
+            {
+                return static_cast<size_t>(m_image.Width) * 4;
+            }
+
+            void Compress(size_t band, std::vector<std::byte>& output) const
+            {
+                const auto [begin, end] = GetBandRows(m_image.Height, m_bandCount, band);
+                const int finalFlush{band + 1 == m_bandCount ? MZ_FINISH : MZ_SYNC_FLUSH};
+
+                mz_stream stream{};
+                if (mz_deflateInit2(&stream, MZ_DEFAULT_LEVEL, MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS, 9, MZ_DEFAULT_STRATEGY) != MZ_OK)
+                {
+                    throw std::runtime_error{"Failed to encode PNG image: cannot initialize compression"};
+                }
+
+                auto endStream{gsl::finally([&stream]() { mz_deflateEnd(&stream); })};
+
+                // Compress straight into the output, which is only grown if the bound turns out to be too small.
+                const size_t start{output.size()};
+                output.resize(start + mz_deflateBound(&stream, static_cast<mz_ulong>((end - begin) * (RowSize() + 1))));
+
+                const auto deflateBytes{[&](const void* data, size_t size, int flush) {
+                    stream.next_in = static_cast<const unsigned char*>(data);
+                    stream.avail_in = static_cast<unsigned int>(size);
+
+                    while (true)
+                    {
+                        const size_t written{start + stream.total_out};
+                        if (written == output.size())
+                        {
+                            output.resize(written + written / 2);
+                        }
+
+                        stream.next_out = reinterpret_cast<unsigned char*>(output.data() + written);
+                        stream.avail_out = static_cast<unsigned int>(output.size() - written);
+
+                        const int status{mz_deflate(&stream, flush)};
+                        if (status == MZ_STREAM_END)
+                        {
+                            return;
+                        }
+
+                        if (status != MZ_OK)
+                        {
+                            throw std::runtime_error{"Failed to encode PNG image: compression failed"};
+                        }
+
+                        if (stream.avail_in == 0 && (flush == MZ_NO_FLUSH || stream.avail_out != 0))
+                        {
+                            return;
+                        }
+                    }
+                }};
+
+                uint32_t checksum{MZ_ADLER32_INIT};
+                for (uint32_t y = begin; y < end; ++y)
+                {
+                    const auto* row{reinterpret_cast<const unsigned char*>(m_image.Row(y))};
+                    checksum = static_cast<uint32_t>(mz_adler32(checksum, &FILTER_NONE, 1));
+                    checksum = static_cast<uint32_t>(mz_adler32(checksum, row, RowSize()));
+
+                    deflateBytes(&FILTER_NONE, 1, MZ_NO_FLUSH);
+                    deflateBytes(row, RowSize(), MZ_NO_FLUSH);
+                }
+
+                deflateBytes(nullptr, 0, finalFlush);
+
+                output.resize(start + stream.total_out);
+                m_checksums[band] = checksum;
+            }
+
+            const Image m_image;
+            const size_t m_bandCount;
+
+            // Adler-32 checksum of the uncompressed rows of each band, written by the band once it is compressed.
+            mutable std::vector<uint32_t> m_checksums;
+        };
+    }
+
+    std::unique_ptr<ImageEncoder> CreatePngEncoder(const Image& image, std::optional<size_t> bandCount)
+    {
+        return std::make_unique<PngEncoder>(image, bandCount);
+    }
+}
@@ -0,0 +1,98 @@
+#include "ImageEncoder.h"
+
+#include <webp/encode.h>
+
+#include <gsl/gsl>
+
+#include <stdexcept>
+#include <string>
+
+namespace Babylon::Plugins::NativeEncoding
+{
+    namespace
+    {
+        // Same default as canvas.toBlob, which also encodes losslessly at the maximum quality.
+        constexpr double DEFAULT_QUALITY{0.8};
+
+        // Encodes the whole image as a single band, using the threads of libwebp for lossy images instead.
+        class WebPEncoder final : public ImageEncoder
+        {
+        public:
+            WebPEncoder(const Image& image, double quality)
+                : m_image{image}
+                , m_quality{quality}
+            {
+            }
+
+            const char* MimeType() const override
+            {
+                return "image/webp";
+            }
+
+            size_t BandCount() const override
+            {
+                return 1;
+            }
+
+            void EncodeBand(size_t, std::vector<std::byte>& output) const override
+            {
+                WebPConfig config{};
+                if (!WebPConfigInit(&config))
+                {
+                    throw std::runtime_error{"Failed to encode WebP image: incompatible libwebp version"};
+                }
+
+                config.lossless = m_quality >= 1 ? 1 : 0;
+                config.quality = config.lossless ? config.quality : static_cast<float>(m_quality * 100);
+                config.thread_level = 1;
+
+                WebPPicture picture{};
+                if (!WebPPictureInit(&picture))
+                {
+                    throw std::runtime_error{"Failed to encode WebP image: incompatible libwebp version"};
+                }
+
+                auto freePicture{gsl::finally([&picture]() { WebPPictureFree(&picture); })};
+
+                picture.use_argb = config.lossless;
+                picture.width = static_cast<int>(m_image.Width);
+                picture.height = static_cast<int>(m_image.Height);
+
+                // A negative stride imports the rows of flipped images from the last one up.
+                const int stride{static_cast<int>(m_image.Width * 4)};
+                if (!WebPPictureImportRGBA(&picture, reinterpret_cast<const uint8_t*>(m_image.Row(0)), m_image.FlipY ? -stride : stride))
+                {
+                    throw std::runtime_error{"Failed to encode WebP image: cannot import pixels"};
+                }
+
+                // Write straight into the output instead of a WebPMemoryWriter that would need to be copied.
+                picture.custom_ptr = &output;
+                picture.writer = [](const uint8_t* data, size_t size, const WebPPicture* picture) {
+                    auto& output{*static_cast<std::vector<std::byte>*>(picture->custom_ptr)};
+                    const auto* bytes{reinterpret_cast<const std::byte*>(data)};
+                    output.insert(output.end(), bytes, bytes + size);
+                    return 1;
+                };
+
+                if (!WebPEncode(&config, &picture))
+                {
+                    throw std::runtime_error{"Failed to encode WebP image: error " + std::to_string(picture.error_code)};
+                }
+            }
+
+        protected:
+            void WriteTrailer(std::vector<std::byte>&) const override
+            {
+            }
+
+        private:
+            const Image m_image;
+            const double m_quality;
+        };
+    }
+
+    std::unique_ptr<ImageEncoder> CreateWebPEncoder(const Image& image, std::optional<double> quality)
+    {
+        return std::make_unique<WebPEncoder>(image, quality.value_or(DEFAULT_QUALITY));
+    }
+}
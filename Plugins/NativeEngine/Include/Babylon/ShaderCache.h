@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 #include <string_view>
 #include <memory>
 
@@ -10,5 +11,14 @@ namespace Babylon
         bool Enabled();
         uint32_t Serialize(std::ofstream& stream);
         uint32_t Deserialize(std::ifstream& stream);
+
+        // Uses the file at the given path as a persistent cache. Shaders already in the file are indexed and only loaded
+        // on first use, and shaders cached in memory but missing from the file, as well as newly compiled shaders, are
+        // appended to the file. Returns the number of shaders in the cache.
+        uint32_t Open(const std::string& path);
+
+        // Appends the sources of programs that are not found in the cache to the manifest file at the given path, so the
+        // ShaderPrecompiler tool can bake them into a cache file offline.
+        void RecordMisses(const std::string& manifestPath);
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,103 @@
+#include "CommandWorker.h"
+
+#include <arcana/tracing/trace_region.h>
+
+#include <utility>
+
+namespace Babylon
+{
+    CommandWorker::CommandWorker()
+        : m_thread{[this]() { ThreadProc(); }}
+    {
+    }
+
+    CommandWorker::~CommandWorker()
+    {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_exit = true;
+        }
+
+        m_condition.notify_all();
+        m_thread.join();
+    }
+
+    void CommandWorker::Run(std::function<void()> work)
+    {
+        {
+            std::unique_lock lock{m_mutex};
+            m_condition.wait(lock, [this]() { return !m_busy; });
+
+            // No more work is accepted after a failure until the failure has been reported, since the work most likely
+            // depends on the state the failed work left behind.
+            if (m_exception)
+            {
+                std::rethrow_exception(std::exchange(m_exception, nullptr));
+            }
+
+            m_work = std::move(work);
+            m_busy = true;
+        }
+
+        m_condition.notify_all();
+    }
+
+    void CommandWorker::Wait()
+    {
+        std::unique_lock lock{m_mutex};
+        m_condition.wait(lock, [this]() { return !m_busy; });
+
+        if (m_exception)
+        {
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+        }
+    }
+
+    bool CommandWorker::IsWorkerThread() const
+    {
+        return std::this_thread::get_id() == m_thread.get_id();
+    }
+
+    void CommandWorker::ThreadProc()
+    {
+        while (true)
+        {
+            std::function<void()> work{};
+
+            {
+                std::unique_lock lock{m_mutex};
+                m_condition.wait(lock, [this]() { return m_busy || m_exit; });
+                if (!m_busy)
+                {
+                    return;
+                }
+
+                work = std::move(m_work);
+            }
+
+            std::exception_ptr exception{};
+
+            try
+            {
+                arcana::trace_region region{"CommandWorker::Run"};
+                work();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            {
+                std::scoped_lock lock{m_mutex};
+                if (!m_exception)
+                {
+                    m_exception = exception;
+                }
+
+                m_busy = false;
+            }
+
+            m_condition.notify_all();
+        }
+    }
+}
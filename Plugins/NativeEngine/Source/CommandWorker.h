@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Babylon
+{
+    // Runs work items one at a time on a dedicated thread.
+    class CommandWorker final
+    {
+    public:
+        CommandWorker();
+        ~CommandWorker();
+
+        // No copy or move semantics
+        CommandWorker(const CommandWorker&) = delete;
+        CommandWorker(CommandWorker&&) = delete;
+
+        // Queues work on the worker thread once the previously queued work has completed. If that work failed, its
+        // exception is rethrown instead and the new work is not queued.
+        void Run(std::function<void()> work);
+
+        // Blocks until the queued work has completed and rethrows the exception it threw, if any.
+        void Wait();
+
+        bool IsWorkerThread() const;
+
+    private:
+        void ThreadProc();
+
+        std::mutex m_mutex{};
+        std::condition_variable m_condition{};
+        std::function<void()> m_work{};
+        std::exception_ptr m_exception{};
+        bool m_busy{};
+        bool m_exit{};
+
+        std::thread m_thread;
+    };
+}
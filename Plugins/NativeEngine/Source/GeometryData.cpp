@@ -0,0 +1,106 @@
+#include "GeometryData.h"
+#include <Babylon/Graphics/DeviceContext.h>
+
+namespace Babylon
+{
+    namespace
+    {
+        // A copy handed to bgfx, which stays counted until bgfx releases it.
+        struct UploadedCopy
+        {
+            std::vector<uint8_t> Bytes{};
+            Graphics::DeviceContext& Context;
+        };
+    }
+
+    GeometryData::GeometryData(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, bool reference)
+        : m_deviceContext{deviceContext}
+        , m_isReference{reference}
+    {
+        if (m_isReference)
+        {
+            m_reference = bytes;
+        }
+        else
+        {
+            SetCopy({bytes.data(), bytes.data() + bytes.size()});
+        }
+    }
+
+    GeometryData::~GeometryData()
+    {
+        Release();
+    }
+
+    const uint8_t* GeometryData::Data() const
+    {
+        return m_isReference ? m_reference.data() : m_copy.data();
+    }
+
+    size_t GeometryData::Size() const
+    {
+        return m_isReference ? m_reference.size() : m_copy.size();
+    }
+
+    uint8_t* GeometryData::MutableData()
+    {
+        return m_copy.data();
+    }
+
+    const bgfx::Memory* GeometryData::MakeMemory(bool retain)
+    {
+        if (retain)
+        {
+            return bgfx::copy(Data(), static_cast<uint32_t>(Size()));
+        }
+
+        if (m_isReference)
+        {
+            auto releaseFn = [](void*, void* userData) {
+                auto* referenceReleased = static_cast<arcana::task_completion_source<void, std::exception_ptr>*>(userData);
+                referenceReleased->complete();
+                delete referenceReleased;
+            };
+
+            const bgfx::Memory* memory{bgfx::makeRef(m_reference.data(), static_cast<uint32_t>(m_reference.size()), releaseFn, new arcana::task_completion_source<void, std::exception_ptr>{m_referenceReleased})};
+            m_reference = {};
+            m_isReference = false;
+            return memory;
+        }
+
+        auto releaseFn = [](void*, void* userData) {
+            auto* copy = static_cast<UploadedCopy*>(userData);
+            copy->Context.RemoveGeometryResidentBytes(copy->Bytes.size());
+            delete copy;
+        };
+
+        // bgfx is shut down before the device context is destroyed, so the copy is always released while it exists.
+        auto* copy = new UploadedCopy{std::move(m_copy), m_deviceContext};
+        m_copy.clear();
+        return bgfx::makeRef(copy->Bytes.data(), static_cast<uint32_t>(copy->Bytes.size()), releaseFn, copy);
+    }
+
+    void GeometryData::Release()
+    {
+        if (m_isReference)
+        {
+            m_reference = {};
+            m_isReference = false;
+            m_referenceReleased.complete();
+        }
+
+        SetCopy({});
+    }
+
+    arcana::task<void, std::exception_ptr> GeometryData::WhenReferenceReleased()
+    {
+        return m_referenceReleased.as_task();
+    }
+
+    void GeometryData::SetCopy(std::vector<uint8_t> bytes)
+    {
+        m_deviceContext.RemoveGeometryResidentBytes(m_copy.size());
+        m_copy = std::move(bytes);
+        m_deviceContext.AddGeometryResidentBytes(m_copy.size());
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+#include <arcana/threading/task.h>
+#include <gsl/gsl>
+
+#include <vector>
+
+namespace Babylon
+{
+    namespace Graphics
+    {
+        class DeviceContext;
+    }
+
+    // The CPU data of a vertex or index buffer. The data is either a copy, or a reference to the data of a JavaScript
+    // ArrayBuffer that must not change until the reference is released. Copies are counted in the resident geometry
+    // bytes of the device context until they are released, including while bgfx still has to upload them.
+    class GeometryData final
+    {
+    public:
+        GeometryData(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, bool reference);
+        ~GeometryData();
+
+        // No copy or move semantics
+        GeometryData(const GeometryData&) = delete;
+        GeometryData(GeometryData&&) = delete;
+
+        const uint8_t* Data() const;
+        size_t Size() const;
+
+        // Only copies can be written to.
+        uint8_t* MutableData();
+
+        // Hands the data to bgfx, without a copy unless the data is retained for later use on the CPU.
+        const bgfx::Memory* MakeMemory(bool retain);
+
+        // Releases the data, unless bgfx still has to upload it.
+        void Release();
+
+        // Completes once a referenced ArrayBuffer is no longer used, including by bgfx.
+        arcana::task<void, std::exception_ptr> WhenReferenceReleased();
+
+    private:
+        void SetCopy(std::vector<uint8_t> bytes);
+
+        Graphics::DeviceContext& m_deviceContext;
+        std::vector<uint8_t> m_copy{};
+        gsl::span<const uint8_t> m_reference{};
+        bool m_isReference{};
+        arcana::task_completion_source<void, std::exception_ptr> m_referenceReleased{};
+    };
+}
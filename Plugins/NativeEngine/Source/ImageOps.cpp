@@ -0,0 +1,693 @@
+#include "ImageOps.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMAGE_OPS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define IMAGE_OPS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Babylon::ImageOps
+{
+    namespace
+    {
+        // Buffers larger than this are freed rather than pooled. The pool lives as long as the process, so it keeps no more
+        // than a few buffers and a total size of a couple of 2048x2048 RGBA8 images, freeing the smallest ones first.
+        constexpr size_t MAX_POOLED_BUFFER_SIZE{16 * 1024 * 1024};
+        constexpr size_t MAX_POOLED_BUFFER_COUNT{4};
+        constexpr size_t MAX_POOLED_BYTES{32 * 1024 * 1024};
+
+        // Pixels are reoriented in square tiles so that the reads and writes of transposing orientations stay in cache.
+        constexpr uint32_t TILE_SIZE{32};
+
+        constexpr size_t FLIP_BUFFER_SIZE{4096};
+
+        struct PooledBuffer
+        {
+            std::unique_ptr<uint8_t[]> Data{};
+            size_t Capacity{};
+        };
+
+        std::mutex g_scratchBuffersMutex{};
+        std::vector<PooledBuffer> g_scratchBuffers{};
+        size_t g_scratchBytes{};
+
+        PooledBuffer AcquireBuffer(size_t size)
+        {
+            {
+                std::scoped_lock lock{g_scratchBuffersMutex};
+
+                // Take the smallest buffer that is large enough.
+                auto best{g_scratchBuffers.end()};
+                for (auto it = g_scratchBuffers.begin(); it != g_scratchBuffers.end(); ++it)
+                {
+                    if (it->Capacity >= size && (best == g_scratchBuffers.end() || it->Capacity < best->Capacity))
+                    {
+                        best = it;
+                    }
+                }
+
+                if (best != g_scratchBuffers.end())
+                {
+                    PooledBuffer buffer{std::move(*best)};
+                    g_scratchBuffers.erase(best);
+                    g_scratchBytes -= buffer.Capacity;
+                    return buffer;
+                }
+            }
+
+            return {std::unique_ptr<uint8_t[]>{new uint8_t[size]}, size};
+        }
+
+        void ReleaseBuffer(PooledBuffer buffer)
+        {
+            if (buffer.Capacity > MAX_POOLED_BUFFER_SIZE)
+            {
+                return;
+            }
+
+            // Buffers dropped from the pool are freed once the lock is released.
+            std::vector<PooledBuffer> freed{};
+            {
+                std::scoped_lock lock{g_scratchBuffersMutex};
+                g_scratchBytes += buffer.Capacity;
+                g_scratchBuffers.push_back(std::move(buffer));
+
+                while (g_scratchBuffers.size() > MAX_POOLED_BUFFER_COUNT || g_scratchBytes > MAX_POOLED_BYTES)
+                {
+                    auto smallest{std::min_element(g_scratchBuffers.begin(), g_scratchBuffers.end(), [](const PooledBuffer& a, const PooledBuffer& b) {
+                        return a.Capacity < b.Capacity;
+                    })};
+
+                    g_scratchBytes -= smallest->Capacity;
+                    freed.push_back(std::move(*smallest));
+                    g_scratchBuffers.erase(smallest);
+                }
+            }
+        }
+
+        constexpr bool IsTransposed(bimg::Orientation::Enum orientation)
+        {
+            return orientation == bimg::Orientation::R90 || orientation == bimg::Orientation::R270 ||
+                   orientation == bimg::Orientation::HFlipR90 || orientation == bimg::Orientation::HFlipR270;
+        }
+
+        // Returns where the pixel at x, y of the source image goes in the reoriented image.
+        template<bimg::Orientation::Enum Orientation>
+        std::pair<uint32_t, uint32_t> MapPixel(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+        {
+            if constexpr (Orientation == bimg::Orientation::R90)
+            {
+                return {height - y - 1, x};
+            }
+            else if constexpr (Orientation == bimg::Orientation::R180)
+            {
+                return {width - x - 1, height - y - 1};
+            }
+            else if constexpr (Orientation == bimg::Orientation::R270)
+            {
+                return {y, width - x - 1};
+            }
+            else if constexpr (Orientation == bimg::Orientation::HFlip)
+            {
+                return {width - x - 1, y};
+            }
+            else if constexpr (Orientation == bimg::Orientation::HFlipR90)
+            {
+                return {height - y - 1, width - x - 1};
+            }
+            else if constexpr (Orientation == bimg::Orientation::HFlipR270)
+            {
+                return {y, x};
+            }
+            else if constexpr (Orientation == bimg::Orientation::VFlip)
+            {
+                return {x, height - y - 1};
+            }
+            else
+            {
+                return {x, y};
+            }
+        }
+
+        template<bimg::Orientation::Enum Orientation>
+        void Reorient(const uint32_t* source, uint32_t* destination, uint32_t width, uint32_t height)
+        {
+            const uint32_t destinationWidth{IsTransposed(Orientation) ? height : width};
+
+            for (uint32_t tileY = 0; tileY < height; tileY += TILE_SIZE)
+            {
+                const uint32_t endY{std::min(tileY + TILE_SIZE, height)};
+                for (uint32_t tileX = 0; tileX < width; tileX += TILE_SIZE)
+                {
+                    const uint32_t endX{std::min(tileX + TILE_SIZE, width)};
+                    for (uint32_t y = tileY; y < endY; ++y)
+                    {
+                        const uint32_t* row{source + static_cast<size_t>(y) * width};
+                        for (uint32_t x = tileX; x < endX; ++x)
+                        {
+                            const auto [destinationX, destinationY]{MapPixel<Orientation>(x, y, width, height)};
+                            destination[static_cast<size_t>(destinationY) * destinationWidth + destinationX] = row[x];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Compressed blocks are 4x4 pixels. A level shorter than a block only uses its first rows, which are reversed among
+        // themselves. Otherwise whole blocks are flipped and their 4 rows reversed.
+        constexpr uint32_t BLOCK_SIZE{4};
+
+        // Reverses the first `rows` groups of `bits` bits of `value`, starting from bit `offset`.
+        uint64_t ReverseBitGroups(uint64_t value, uint32_t offset, uint32_t bits, uint32_t rows)
+        {
+            const uint64_t mask{(uint64_t{1} << bits) - 1};
+            uint64_t result{value};
+            for (uint32_t row = 0; row < rows; ++row)
+            {
+                const uint64_t group{(value >> (offset + row * bits)) & mask};
+                const uint32_t shift{offset + (rows - 1 - row) * bits};
+                result = (result & ~(mask << shift)) | (group << shift);
+            }
+            return result;
+        }
+
+        // BC1 color: 2 endpoints, then one byte of 2 bit indices per row.
+        void FlipBc1Block(uint8_t* block, uint32_t rows)
+        {
+            std::reverse(block + 4, block + 4 + rows);
+        }
+
+        // BC3 alpha: 2 endpoints, then 48 bits of 3 bit indices in little endian order, 12 bits per row.
+        void FlipBc3AlphaBlock(uint8_t* block, uint32_t rows)
+        {
+            uint64_t indices{};
+            std::memcpy(&indices, block + 2, 6);
+            indices = ReverseBitGroups(indices, 0, 12, rows);
+            std::memcpy(block + 2, &indices, 6);
+        }
+
+        // EAC alpha: base, multiplier and table, then 48 bits of 3 bit indices in big endian order, by column.
+        void FlipEacBlock(uint8_t* block, uint32_t rows)
+        {
+            uint64_t indices{};
+            for (size_t byte = 2; byte < 8; ++byte)
+            {
+                indices = (indices << 8) | block[byte];
+            }
+
+            // The first pixel of a column is in its most significant bits.
+            for (uint32_t column = 0; column < BLOCK_SIZE; ++column)
+            {
+                indices = ReverseBitGroups(indices, 36 - column * 12 + (BLOCK_SIZE - rows) * 3, 3, rows);
+            }
+
+            for (size_t byte = 7; byte >= 2; --byte)
+            {
+                block[byte] = static_cast<uint8_t>(indices);
+                indices >>= 8;
+            }
+        }
+
+        struct EtcColors
+        {
+            bool Differential{};
+            bool Horizontal{};
+            int Base[3]{};
+            int Other[3]{};
+        };
+
+        // Reads the colors of the two sub-blocks of an ETC1 block or of an ETC2 block in the individual or differential
+        // mode. Returns false for the other ETC2 modes, in which the differential colors overflow.
+        bool ReadEtcColors(const uint8_t* block, EtcColors& colors)
+        {
+            colors.Differential = (block[3] & 2) != 0;
+            colors.Horizontal = (block[3] & 1) != 0;
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                if (colors.Differential)
+                {
+                    const int delta{static_cast<int>(block[channel] & 7) - ((block[channel] & 4) != 0 ? 8 : 0)};
+                    colors.Base[channel] = block[channel] >> 3;
+                    colors.Other[channel] = colors.Base[channel] + delta;
+                    if (colors.Other[channel] < 0 || colors.Other[channel] > 31)
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    colors.Base[channel] = block[channel] >> 4;
+                    colors.Other[channel] = block[channel] & 15;
+                }
+            }
+            return true;
+        }
+
+        // ETC color: the colors and tables of two sub-blocks, side by side or one above the other, then a plane of most
+        // significant and a plane of least significant index bits, both by column in big endian order. Flipping a block
+        // whose sub-blocks are one above the other swaps them, which cannot be encoded when the difference of their
+        // colors is -4, or when the level is 3 pixels tall, unless both sub-blocks are the same.
+        bool CanFlipEtcBlock(const uint8_t* block, uint32_t rows)
+        {
+            EtcColors colors{};
+            if (!ReadEtcColors(block, colors))
+            {
+                return false;
+            }
+
+            const bool sameTables{(block[3] >> 5) == ((block[3] >> 2) & 7)};
+            const bool sameColors{std::equal(std::begin(colors.Base), std::end(colors.Base), std::begin(colors.Other))};
+            if (!colors.Horizontal || rows < 3 || (sameTables && sameColors))
+            {
+                return true;
+            }
+
+            if (rows != BLOCK_SIZE)
+            {
+                return false;
+            }
+
+            // The differences range from -4 to 3, so swapping the colors cannot encode a difference of 4.
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                if (colors.Differential && colors.Base[channel] - colors.Other[channel] > 3)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void FlipEtcBlock(uint8_t* block, uint32_t rows)
+        {
+            EtcColors colors{};
+            ReadEtcColors(block, colors);
+
+            const bool sameTables{(block[3] >> 5) == ((block[3] >> 2) & 7)};
+            const bool sameColors{std::equal(std::begin(colors.Base), std::end(colors.Base), std::begin(colors.Other))};
+            if (colors.Horizontal && rows == BLOCK_SIZE && !(sameTables && sameColors))
+            {
+                for (size_t channel = 0; channel < 3; ++channel)
+                {
+                    block[channel] = colors.Differential
+                        ? static_cast<uint8_t>((colors.Other[channel] << 3) | ((colors.Base[channel] - colors.Other[channel]) & 7))
+                        : static_cast<uint8_t>((colors.Other[channel] << 4) | colors.Base[channel]);
+                }
+
+                block[3] = static_cast<uint8_t>((((block[3] >> 2) & 7) << 5) | ((block[3] >> 5) << 2) | (block[3] & 3));
+            }
+
+            uint32_t indices{};
+            for (size_t byte = 4; byte < 8; ++byte)
+            {
+                indices = (indices << 8) | block[byte];
+            }
+
+            // The first pixel of a column is in its least significant bit.
+            for (uint32_t group = 0; group < 2 * BLOCK_SIZE; ++group)
+            {
+                indices = static_cast<uint32_t>(ReverseBitGroups(indices, group * BLOCK_SIZE, 1, rows));
+            }
+
+            for (size_t byte = 7; byte >= 4; --byte)
+            {
+                block[byte] = static_cast<uint8_t>(indices);
+                indices >>= 8;
+            }
+        }
+
+        // Calls `function` with every block of a level. Stops and returns false as soon as `function` does.
+        template<typename T, typename AverageT>
+        void Downsample(const T* source, T* destination, uint32_t width, uint32_t height, AverageT average)
+        {
+            const uint32_t outputWidth{std::max(width / 2, 1u)};
+            const uint32_t outputHeight{std::max(height / 2, 1u)};
+            for (uint32_t y = 0; y < outputHeight; ++y)
+            {
+                const T* row0{source + static_cast<size_t>(std::min(y * 2, height - 1)) * width * 4};
+                const T* row1{source + static_cast<size_t>(std::min(y * 2 + 1, height - 1)) * width * 4};
+                T* output{destination + static_cast<size_t>(y) * outputWidth * 4};
+                for (uint32_t x = 0; x < outputWidth; ++x)
+                {
+                    const size_t x0{std::min(x * 2, width - 1) * 4u};
+                    const size_t x1{std::min(x * 2 + 1, width - 1) * 4u};
+                    for (size_t channel = 0; channel < 4; ++channel)
+                    {
+                        output[x * 4 + channel] = average(row0[x0 + channel], row0[x1 + channel], row1[x0 + channel], row1[x1 + channel]);
+                    }
+                }
+            }
+        }
+
+        template<typename FunctionT>
+        bool ForEachBlock(gsl::span<uint8_t> image, size_t blockSize, FunctionT function)
+        {
+            for (size_t offset = 0; offset + blockSize <= image.size(); offset += blockSize)
+            {
+                if (!function(image.data() + offset))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    ScratchBuffer::ScratchBuffer(size_t size)
+        : m_size{size}
+    {
+        PooledBuffer buffer{AcquireBuffer(size)};
+        m_data = std::move(buffer.Data);
+        m_capacity = buffer.Capacity;
+    }
+
+    ScratchBuffer::~ScratchBuffer()
+    {
+        ReleaseBuffer({std::move(m_data), m_capacity});
+    }
+
+    void TrimScratchBuffers()
+    {
+        std::vector<PooledBuffer> freed{};
+        {
+            std::scoped_lock lock{g_scratchBuffersMutex};
+            freed.swap(g_scratchBuffers);
+            g_scratchBytes = 0;
+        }
+    }
+
+    size_t GetScratchBufferBytes()
+    {
+        std::scoped_lock lock{g_scratchBuffersMutex};
+        return g_scratchBytes;
+    }
+
+    uint8_t* ScratchBuffer::Data() const
+    {
+        return m_data.get();
+    }
+
+    size_t ScratchBuffer::Size() const
+    {
+        return m_size;
+    }
+
+    void FlipImage(gsl::span<uint8_t> image, uint32_t height)
+    {
+        // Rows are swapped through a small stack buffer so that no memory is allocated.
+        uint8_t buffer[FLIP_BUFFER_SIZE];
+
+        const size_t rowPitch{image.size() / height};
+        for (size_t row = 0; row < height / 2; row++)
+        {
+            uint8_t* front{image.data() + (row * rowPitch)};
+            uint8_t* back{image.data() + ((height - row - 1) * rowPitch)};
+            for (size_t offset = 0; offset < rowPitch; offset += FLIP_BUFFER_SIZE)
+            {
+                const size_t size{std::min(FLIP_BUFFER_SIZE, rowPitch - offset)};
+                std::memcpy(buffer, front + offset, size);
+                std::memcpy(front + offset, back + offset, size);
+                std::memcpy(back + offset, buffer, size);
+            }
+        }
+    }
+
+    bool CanFlipImage(bimg::TextureFormat::Enum format)
+    {
+        switch (format)
+        {
+            case bimg::TextureFormat::BC1:
+            case bimg::TextureFormat::BC3:
+            case bimg::TextureFormat::ETC1:
+            case bimg::TextureFormat::ETC2:
+            case bimg::TextureFormat::ETC2A:
+                return true;
+            default:
+                return !bimg::isCompressed(format);
+        }
+    }
+
+    bool FlipImage(gsl::span<uint8_t> image, bimg::TextureFormat::Enum format, uint32_t height)
+    {
+        if (!CanFlipImage(format))
+        {
+            return false;
+        }
+
+        if (!bimg::isCompressed(format))
+        {
+            FlipImage(image, height);
+            return true;
+        }
+
+        if (height > BLOCK_SIZE && height % BLOCK_SIZE != 0)
+        {
+            return false;
+        }
+
+        const uint32_t rows{std::min(height, BLOCK_SIZE)};
+        const size_t blockSize{bimg::getBlockInfo(format).blockSize};
+        const bool etc{format == bimg::TextureFormat::ETC1 || format == bimg::TextureFormat::ETC2 || format == bimg::TextureFormat::ETC2A};
+        const size_t colorOffset{format == bimg::TextureFormat::BC3 || format == bimg::TextureFormat::ETC2A ? 8u : 0u};
+
+        // Some ETC blocks cannot be flipped, so they are all checked before any is changed.
+        if (etc && !ForEachBlock(image, blockSize, [rows, colorOffset](const uint8_t* block) { return CanFlipEtcBlock(block + colorOffset, rows); }))
+        {
+            return false;
+        }
+
+        ForEachBlock(image, blockSize, [format, rows, colorOffset, etc](uint8_t* block) {
+            if (format == bimg::TextureFormat::BC3)
+            {
+                FlipBc3AlphaBlock(block, rows);
+            }
+            else if (format == bimg::TextureFormat::ETC2A)
+            {
+                FlipEacBlock(block, rows);
+            }
+
+            if (etc)
+            {
+                FlipEtcBlock(block + colorOffset, rows);
+            }
+            else
+            {
+                FlipBc1Block(block + colorOffset, rows);
+            }
+
+            return true;
+        });
+
+        // The rows of blocks are swapped like the rows of pixels of an uncompressed image.
+        if (height > BLOCK_SIZE)
+        {
+            FlipImage(image, height / BLOCK_SIZE);
+        }
+
+        return true;
+    }
+
+    bool CanDownsampleImage(bimg::TextureFormat::Enum format)
+    {
+        return format == bimg::TextureFormat::RGBA8 || format == bimg::TextureFormat::RGBA32F;
+    }
+
+    bimg::ImageContainer* DownsampleImage(bx::AllocatorI& allocator, const bimg::ImageContainer& image)
+    {
+        if (!CanDownsampleImage(image.m_format))
+        {
+            throw std::runtime_error{"Unsupported image format for downsampling."};
+        }
+
+        const uint32_t width{image.m_width};
+        const uint32_t height{image.m_height};
+        bimg::ImageContainer* output{bimg::imageAlloc(&allocator, image.m_format, static_cast<uint16_t>(std::max(width / 2, 1u)), static_cast<uint16_t>(std::max(height / 2, 1u)), 1, 1, false, false)};
+        output->m_hasAlpha = image.m_hasAlpha;
+
+        if (image.m_format == bimg::TextureFormat::RGBA8)
+        {
+            Downsample(static_cast<const uint8_t*>(image.m_data), static_cast<uint8_t*>(output->m_data), width, height, [](uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+                return static_cast<uint8_t>((a + b + c + d + 2) / 4);
+            });
+        }
+        else
+        {
+            Downsample(static_cast<const float*>(image.m_data), static_cast<float*>(output->m_data), width, height, [](float a, float b, float c, float d) {
+                return (a + b + c + d) * 0.25f;
+            });
+        }
+
+        return output;
+    }
+
+    void ReorientImage(gsl::span<uint32_t> image, uint32_t& width, uint32_t& height, bimg::Orientation::Enum orientation)
+    {
+        if (orientation == bimg::Orientation::R0)
+        {
+            return;
+        }
+
+        if (orientation == bimg::Orientation::VFlip)
+        {
+            FlipImage(gsl::make_span(reinterpret_cast<uint8_t*>(image.data()), image.size_bytes()), height);
+            return;
+        }
+
+        // The pixels are reoriented from a copy of the image back into it.
+        const ScratchBuffer scratch{image.size_bytes()};
+        std::memcpy(scratch.Data(), image.data(), image.size_bytes());
+        const auto* source{reinterpret_cast<const uint32_t*>(scratch.Data())};
+
+        switch (orientation)
+        {
+            case bimg::Orientation::R90:
+                Reorient<bimg::Orientation::R90>(source, image.data(), width, height);
+                break;
+            case bimg::Orientation::R180:
+                Reorient<bimg::Orientation::R180>(source, image.data(), width, height);
+                break;
+            case bimg::Orientation::R270:
+                Reorient<bimg::Orientation::R270>(source, image.data(), width, height);
+                break;
+            case bimg::Orientation::HFlip:
+                Reorient<bimg::Orientation::HFlip>(source, image.data(), width, height);
+                break;
+            case bimg::Orientation::HFlipR90:
+                Reorient<bimg::Orientation::HFlipR90>(source, image.data(), width, height);
+                break;
+            case bimg::Orientation::HFlipR270:
+                Reorient<bimg::Orientation::HFlipR270>(source, image.data(), width, height);
+                break;
+            default:
+                throw std::runtime_error{"Unexpected image orientation."};
+        }
+
+        if (IsTransposed(orientation))
+        {
+            std::swap(width, height);
+        }
+    }
+
+    void ExpandR8ToRGBA8(const uint8_t* source, uint8_t* destination, size_t pixelCount)
+    {
+        size_t index{0};
+
+#if IMAGE_OPS_SSE2
+        const __m128i alpha{_mm_set1_epi32(static_cast<int>(0xFF000000))};
+        for (; index + 16 <= pixelCount; index += 16)
+        {
+            const __m128i gray{_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index))};
+            const __m128i gray2Low{_mm_unpacklo_epi8(gray, gray)};
+            const __m128i gray2High{_mm_unpackhi_epi8(gray, gray)};
+
+            __m128i* output{reinterpret_cast<__m128i*>(destination + index * 4)};
+            _mm_storeu_si128(output + 0, _mm_or_si128(_mm_unpacklo_epi16(gray2Low, gray2Low), alpha));
+            _mm_storeu_si128(output + 1, _mm_or_si128(_mm_unpackhi_epi16(gray2Low, gray2Low), alpha));
+            _mm_storeu_si128(output + 2, _mm_or_si128(_mm_unpacklo_epi16(gray2High, gray2High), alpha));
+            _mm_storeu_si128(output + 3, _mm_or_si128(_mm_unpackhi_epi16(gray2High, gray2High), alpha));
+        }
+#elif IMAGE_OPS_NEON
+        const uint8x16_t alpha{vdupq_n_u8(0xFF)};
+        for (; index + 16 <= pixelCount; index += 16)
+        {
+            const uint8x16_t gray{vld1q_u8(source + index)};
+            vst4q_u8(destination + index * 4, (uint8x16x4_t{{gray, gray, gray, alpha}}));
+        }
+#endif
+
+        for (; index < pixelCount; ++index)
+        {
+            uint8_t* output{destination + index * 4};
+            output[0] = output[1] = output[2] = source[index];
+            output[3] = 0xFF;
+        }
+    }
+
+    void ExpandRG8ToRGBA8(const uint8_t* source, uint8_t* destination, size_t pixelCount)
+    {
+        size_t index{0};
+
+#if IMAGE_OPS_SSE2
+        const __m128i zero{_mm_setzero_si128()};
+        const __m128i grayMask{_mm_set1_epi32(0xFF)};
+        for (; index + 8 <= pixelCount; index += 8)
+        {
+            const __m128i pixels{_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * 2))};
+
+            __m128i* output{reinterpret_cast<__m128i*>(destination + index * 4)};
+            for (int half = 0; half < 2; ++half)
+            {
+                // Each 32-bit lane holds the gray value in its low byte and the alpha in the next one.
+                const __m128i values{half == 0 ? _mm_unpacklo_epi16(pixels, zero) : _mm_unpackhi_epi16(pixels, zero)};
+                const __m128i gray{_mm_and_si128(values, grayMask)};
+                const __m128i rgb{_mm_or_si128(_mm_or_si128(gray, _mm_slli_epi32(gray, 8)), _mm_slli_epi32(gray, 16))};
+                const __m128i alpha{_mm_slli_epi32(_mm_srli_epi32(values, 8), 24)};
+                _mm_storeu_si128(output + half, _mm_or_si128(rgb, alpha));
+            }
+        }
+#elif IMAGE_OPS_NEON
+        for (; index + 16 <= pixelCount; index += 16)
+        {
+            const uint8x16x2_t pixels{vld2q_u8(source + index * 2)};
+            vst4q_u8(destination + index * 4, (uint8x16x4_t{{pixels.val[0], pixels.val[0], pixels.val[0], pixels.val[1]}}));
+        }
+#endif
+
+        for (; index < pixelCount; ++index)
+        {
+            uint8_t* output{destination + index * 4};
+            output[0] = output[1] = output[2] = source[index * 2];
+            output[3] = source[index * 2 + 1];
+        }
+    }
+
+    void ExpandRGB8ToRGBA8(const uint8_t* source, uint8_t* destination, size_t pixelCount)
+    {
+        size_t index{0};
+
+#if IMAGE_OPS_NEON
+        const uint8x16_t alpha{vdupq_n_u8(0xFF)};
+        for (; index + 16 <= pixelCount; index += 16)
+        {
+            const uint8x16x3_t pixels{vld3q_u8(source + index * 3)};
+            vst4q_u8(destination + index * 4, (uint8x16x4_t{{pixels.val[0], pixels.val[1], pixels.val[2], alpha}}));
+        }
+#else
+        // Without a byte shuffle in the baseline instruction set, 4 pixels are moved as 3 words, except for the last
+        // pixels so that no more than the source is read.
+        for (; index + 5 <= pixelCount; index += 4)
+        {
+            uint32_t words[3];
+            std::memcpy(words, source + index * 3, sizeof(words));
+
+            const uint32_t output[4]{
+                words[0] | 0xFF000000u,
+                (words[0] >> 24) | (words[1] << 8) | 0xFF000000u,
+                (words[1] >> 16) | (words[2] << 16) | 0xFF000000u,
+                (words[2] >> 8) | 0xFF000000u,
+            };
+            std::memcpy(destination + index * 4, output, sizeof(output));
+        }
+#endif
+
+        for (; index < pixelCount; ++index)
+        {
+            const uint8_t* input{source + index * 3};
+            uint8_t* output{destination + index * 4};
+            output[0] = input[0];
+            output[1] = input[1];
+            output[2] = input[2];
+            output[3] = 0xFF;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <bimg/bimg.h>
+
+#include <gsl/gsl>
+
+#include <cstdint>
+#include <memory>
+
+namespace Babylon::ImageOps
+{
+    // Temporary memory for image data, taken from and returned to a pool shared by the threads that decode images so that
+    // decoding many images does not allocate a buffer for each of them. The contents are not initialized.
+    class ScratchBuffer final
+    {
+    public:
+        explicit ScratchBuffer(size_t size);
+        ~ScratchBuffer();
+
+        // No copy or move semantics
+        ScratchBuffer(const ScratchBuffer&) = delete;
+        ScratchBuffer(ScratchBuffer&&) = delete;
+
+        uint8_t* Data() const;
+        size_t Size() const;
+
+    private:
+        std::unique_ptr<uint8_t[]> m_data{};
+        size_t m_capacity{};
+        size_t m_size{};
+    };
+
+    // Frees the buffers kept by the scratch buffer pool, e.g. once no more images are loaded.
+    void TrimScratchBuffers();
+
+    // The size of the buffers kept by the scratch buffer pool.
+    size_t GetScratchBufferBytes();
+
+    // Flips the rows of an image in place.
+    void FlipImage(gsl::span<uint8_t> image, uint32_t height);
+
+    // Whether FlipImage can flip a level of the format: any uncompressed format, and the BC1, BC3, ETC1, ETC2 and ETC2A
+    // block compressed formats.
+    bool CanFlipImage(bimg::TextureFormat::Enum format);
+
+    // Flips the rows of a level of an image in place. Block compressed levels are flipped by block, so those taller than a
+    // block must be a whole number of blocks tall. Returns false, leaving the level unchanged, if it cannot be flipped,
+    // which can also happen for ETC levels with blocks that have no flipped encoding.
+    bool FlipImage(gsl::span<uint8_t> image, bimg::TextureFormat::Enum format, uint32_t height);
+
+    // Whether DownsampleImage can halve an image of the format: RGBA8 and RGBA32F.
+    bool CanDownsampleImage(bimg::TextureFormat::Enum format);
+
+    // Returns a new image of a single level at half the size of the first level of the image, down to 1 pixel, whose
+    // pixels are the average of blocks of 2x2 pixels. Generates the mips of an image one level at a time, where the last
+    // row or column of an odd size is dropped like bimg does.
+    bimg::ImageContainer* DownsampleImage(bx::AllocatorI& allocator, const bimg::ImageContainer& image);
+
+    // Rotates and flips an RGBA8 image in place so that its orientation becomes R0, swapping the width and height if needed.
+    void ReorientImage(gsl::span<uint32_t> image, uint32_t& width, uint32_t& height, bimg::Orientation::Enum orientation);
+
+    // Expand grayscale, grayscale with alpha, and RGB pixels to RGBA8. The destination holds 4 bytes per pixel and must not
+    // overlap the source.
+    void ExpandR8ToRGBA8(const uint8_t* source, uint8_t* destination, size_t pixelCount);
+    void ExpandRG8ToRGBA8(const uint8_t* source, uint8_t* destination, size_t pixelCount);
+    void ExpandRGB8ToRGBA8(const uint8_t* source, uint8_t* destination, size_t pixelCount);
+}
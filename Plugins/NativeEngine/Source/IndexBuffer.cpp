@@ -3,15 +3,24 @@
 
 namespace Babylon
 {
-    IndexBuffer::IndexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, uint16_t flags, bool dynamic)
+    IndexBuffer::IndexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, uint16_t flags, bool dynamic, bool referenceBytes)
         : m_deviceContext{deviceContext}
         , m_deviceID{deviceContext.GetDeviceId()}
-        , m_bytes{bytes.data(), bytes.data() + bytes.size()}
+        , m_bytes{deviceContext, bytes, referenceBytes && !dynamic}
         , m_flags{flags}
         , m_dynamic{dynamic}
     {
     }
 
+    IndexBuffer::IndexBuffer(Graphics::DeviceContext& deviceContext, uint16_t flags)
+        : m_deviceContext{deviceContext}
+        , m_deviceID{deviceContext.GetDeviceId()}
+        , m_bytes{deviceContext, {}, false}
+        , m_flags{flags}
+        , m_transient{true}
+    {
+    }
+
     IndexBuffer::~IndexBuffer()
     {
         Dispose();
@@ -36,7 +45,7 @@ namespace Babylon
             }
         }
 
-        m_bytes.clear();
+        m_bytes.Release();
 
         m_disposed = true;
     }
@@ -45,7 +54,7 @@ namespace Babylon
     {
         if (!m_dynamic)
         {
-            throw std::runtime_error{"Cannot update non-dynamic index buffer"};
+            throw std::runtime_error{m_transient ? "Cannot update transient index buffer" : "Cannot update non-dynamic index buffer"};
         }
 
         if (bgfx::isValid(m_dynamicHandle))
@@ -57,25 +66,41 @@ namespace Babylon
             const size_t byteStride = (m_flags & BGFX_BUFFER_INDEX32) ? 4 : 2;
             const size_t byteOffset = startIndex * byteStride;
 
-            if (byteOffset + bytes.size() > m_bytes.size())
+            if (byteOffset + bytes.size() > m_bytes.Size())
             {
                 throw std::runtime_error{"Failed to update index buffer: buffer overflow"};
             }
 
-            std::memcpy(m_bytes.data() + byteOffset, bytes.data(), bytes.size());
+            std::memcpy(m_bytes.MutableData() + byteOffset, bytes.data(), bytes.size());
         }
     }
 
-    void IndexBuffer::Build()
+    bool IndexBuffer::AllocateTransient(gsl::span<const uint8_t> bytes)
     {
-        if (!bgfx::isValid(m_handle))
+        const bool index32{(m_flags & BGFX_BUFFER_INDEX32) != 0};
+        const size_t byteStride{index32 ? 4u : 2u};
+        if (bytes.size() % byteStride != 0)
+        {
+            throw std::runtime_error{"Cannot allocate transient index buffer with a byte length not divisible by its index size"};
+        }
+
+        const uint32_t numIndices{static_cast<uint32_t>(bytes.size() / byteStride)};
+        if (bgfx::getAvailTransientIndexBuffer(numIndices, index32) < numIndices)
         {
-            auto releaseFn = [](void*, void* userData) {
-                delete reinterpret_cast<decltype(m_bytes)*>(userData);
-            };
+            return false;
+        }
+
+        bgfx::allocTransientIndexBuffer(&m_transientBuffer, numIndices, index32);
+        std::memcpy(m_transientBuffer.data, bytes.data(), bytes.size());
+        m_transientFrameNumber = m_deviceContext.GetFrameNumber();
+        return true;
+    }
 
-            auto* bytesPtr = new decltype(m_bytes){std::move(m_bytes)};
-            const bgfx::Memory* memory = bgfx::makeRef(bytesPtr->data(), static_cast<uint32_t>(bytesPtr->size()), releaseFn, bytesPtr);
+    void IndexBuffer::Build()
+    {
+        if (!m_transient && !bgfx::isValid(m_handle))
+        {
+            const bgfx::Memory* memory = m_bytes.MakeMemory(false);
 
             if (m_dynamic)
             {
@@ -95,7 +120,17 @@ namespace Babylon
 
     void IndexBuffer::Set(bgfx::Encoder* encoder, uint32_t firstIndex, uint32_t numIndices)
     {
-        if (m_dynamic)
+        if (m_transient)
+        {
+            // The memory of transient buffers is only valid for the frame it was allocated in.
+            if (m_transientBuffer.data == nullptr || m_transientFrameNumber != m_deviceContext.GetFrameNumber())
+            {
+                throw std::runtime_error{"Transient index buffer was not allocated in the current frame"};
+            }
+
+            encoder->setIndexBuffer(&m_transientBuffer, firstIndex, numIndices);
+        }
+        else if (m_dynamic)
         {
             encoder->setIndexBuffer(m_dynamicHandle, firstIndex, numIndices);
         }
@@ -104,4 +139,9 @@ namespace Babylon
             encoder->setIndexBuffer(m_handle, firstIndex, numIndices);
         }
     }
+
+    arcana::task<void, std::exception_ptr> IndexBuffer::WhenBytesReleased()
+    {
+        return m_bytes.WhenReferenceReleased();
+    }
 }
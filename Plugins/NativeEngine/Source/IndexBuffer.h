@@ -1,5 +1,7 @@
 #pragma once
 
+#include "GeometryData.h"
+
 #include <bgfx/bgfx.h>
 #include <napi/napi.h>
 #include <gsl/gsl>
@@ -16,7 +18,11 @@ namespace Babylon
     class IndexBuffer final
     {
     public:
-        IndexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, uint16_t flags, bool dynamic);
+        // Static buffers can reference the bytes instead of copying them, see GeometryData.
+        IndexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, uint16_t flags, bool dynamic, bool referenceBytes = false);
+
+        // Transient buffers have no data of their own, and draw from the memory allocated by AllocateTransient instead.
+        IndexBuffer(Graphics::DeviceContext& deviceContext, uint16_t flags);
         ~IndexBuffer();
 
         // No copy or move semantics
@@ -27,15 +33,21 @@ namespace Babylon
 
         void Update(gsl::span<const uint8_t> bytes, uint32_t startIndex);
 
+        // Allocates transient memory of the current frame for the indices of a transient buffer and copies them to it, so
+        // that the buffer draws them until the frame ends. Returns false if bgfx has no transient memory left this frame.
+        bool AllocateTransient(gsl::span<const uint8_t> bytes);
+
         void Build();
 
         void Set(bgfx::Encoder* encoder, uint32_t firstIndex, uint32_t numIndices);
 
+        arcana::task<void, std::exception_ptr> WhenBytesReleased();
+
     private:
         Graphics::DeviceContext& m_deviceContext;
         const uintptr_t m_deviceID{};
 
-        std::vector<uint8_t> m_bytes{};
+        GeometryData m_bytes;
         const uint16_t m_flags{};
         const bool m_dynamic{};
 
@@ -45,6 +57,10 @@ namespace Babylon
             bgfx::DynamicIndexBufferHandle m_dynamicHandle;
         };
 
+        const bool m_transient{};
+        bgfx::TransientIndexBuffer m_transientBuffer{};
+        uint64_t m_transientFrameNumber{};
+
         bool m_disposed{};
     };
 }
@@ -0,0 +1,109 @@
+#include "MurmurHash3.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Babylon
+{
+    namespace
+    {
+        uint64_t Rotl64(uint64_t value, int shift)
+        {
+            return (value << shift) | (value >> (64 - shift));
+        }
+
+        uint64_t FMix64(uint64_t value)
+        {
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdULL;
+            value ^= value >> 33;
+            value *= 0xc4ceb9fe1a85ec53ULL;
+            value ^= value >> 33;
+            return value;
+        }
+    }
+
+    std::pair<uint64_t, uint64_t> MurmurHash3(const void* key, size_t length, uint64_t seed)
+    {
+        constexpr uint64_t c1{0x87c37b91114253d5ULL};
+        constexpr uint64_t c2{0x4cf5ad432745937fULL};
+
+        const auto data{static_cast<const uint8_t*>(key)};
+        const size_t blockCount{length / 16};
+
+        uint64_t h1{seed};
+        uint64_t h2{seed};
+
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            uint64_t k1;
+            uint64_t k2;
+            std::memcpy(&k1, data + block * 16, sizeof(uint64_t));
+            std::memcpy(&k2, data + block * 16 + 8, sizeof(uint64_t));
+
+            k1 *= c1;
+            k1 = Rotl64(k1, 31);
+            k1 *= c2;
+            h1 ^= k1;
+
+            h1 = Rotl64(h1, 27);
+            h1 += h2;
+            h1 = h1 * 5 + 0x52dce729;
+
+            k2 *= c2;
+            k2 = Rotl64(k2, 33);
+            k2 *= c1;
+            h2 ^= k2;
+
+            h2 = Rotl64(h2, 31);
+            h2 += h1;
+            h2 = h2 * 5 + 0x38495ab5;
+        }
+
+        const uint8_t* tail{data + blockCount * 16};
+        const size_t tailLength{length & 15};
+
+        uint64_t k1{0};
+        uint64_t k2{0};
+
+        for (size_t index = tailLength; index > 8; --index)
+        {
+            k2 ^= static_cast<uint64_t>(tail[index - 1]) << ((index - 9) * 8);
+        }
+
+        if (tailLength > 8)
+        {
+            k2 *= c2;
+            k2 = Rotl64(k2, 33);
+            k2 *= c1;
+            h2 ^= k2;
+        }
+
+        for (size_t index = std::min<size_t>(tailLength, 8); index > 0; --index)
+        {
+            k1 ^= static_cast<uint64_t>(tail[index - 1]) << ((index - 1) * 8);
+        }
+
+        if (tailLength > 0)
+        {
+            k1 *= c1;
+            k1 = Rotl64(k1, 31);
+            k1 *= c2;
+            h1 ^= k1;
+        }
+
+        h1 ^= length;
+        h2 ^= length;
+
+        h1 += h2;
+        h2 += h1;
+
+        h1 = FMix64(h1);
+        h2 = FMix64(h2);
+
+        h1 += h2;
+        h2 += h1;
+
+        return {h1, h2};
+    }
+}
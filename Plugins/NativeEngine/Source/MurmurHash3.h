@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace Babylon
+{
+    // MurmurHash3 x64 128-bit variant, returned as the low and high 64 bits. MurmurHash3 was written by Austin Appleby
+    // and is placed in the public domain.
+    std::pair<uint64_t, uint64_t> MurmurHash3(const void* key, size_t length, uint64_t seed);
+}
@@ -4,6 +4,7 @@
 #include <napi/env.h>
 #include <gsl/gsl>
 #include <cassert>
+#include <vector>
 
 namespace Babylon
 {
@@ -52,6 +53,11 @@ namespace Babylon
                 return m_position < static_cast<size_t>(m_buffer.size());
             }
 
+            size_t SizeInBytes() const
+            {
+                return m_sizeInBytes;
+            }
+
             uint32_t ReadUint32()
             {
                 Validate<ValidationType::Uint32>(*this);
@@ -100,7 +106,7 @@ namespace Babylon
                 Validate<ValidationType::NativeData>(*this);
                 static_assert(sizeof(T) % 4 == 0);
                 auto span = gsl::make_span(reinterpret_cast<uint32_t*>(m_buffer.data() + m_position), sizeof(T) / 4);
-                m_position += sizeof(T) / 4;
+                Advance(sizeof(T) / 4);
                 return *reinterpret_cast<T*>(span.data());
             }
 
@@ -111,17 +117,39 @@ namespace Babylon
             }
 
         private:
+            const std::vector<gsl::span<uint32_t>>& m_chunks;
+            size_t m_chunkIndex{0};
             gsl::span<uint32_t> m_buffer{};
             size_t m_position{0};
+            const size_t m_sizeInBytes{0};
             const gsl::final_action<std::function<void()>> m_scopeGuard;
 
             friend class NativeDataStream;
 
             template<typename CallableT>
-            Reader(gsl::span<uint32_t> buffer, CallableT&& callable)
-                : m_buffer{buffer}
+            Reader(const std::vector<gsl::span<uint32_t>>& chunks, size_t sizeInBytes, CallableT&& callable)
+                : m_chunks{chunks}
+                , m_buffer{chunks.empty() ? gsl::span<uint32_t>{} : chunks.front()}
+                , m_sizeInBytes{sizeInBytes}
                 , m_scopeGuard{std::forward<CallableT>(callable)}
             {
+                NextChunk();
+            }
+
+            // Values are never split across chunks, so the reader only needs to move to the next chunk once the current one is exhausted.
+            void Advance(size_t count)
+            {
+                m_position += count;
+                NextChunk();
+            }
+
+            void NextChunk()
+            {
+                while (m_position >= static_cast<size_t>(m_buffer.size()) && m_chunkIndex + 1 < m_chunks.size())
+                {
+                    m_buffer = m_chunks[++m_chunkIndex];
+                    m_position = 0;
+                }
             }
 
             template<typename T>
@@ -129,7 +157,7 @@ namespace Babylon
             {
                 static_assert(sizeof(T) % 4 == 0);
                 T t{*reinterpret_cast<T*>(m_buffer.data() + m_position)};
-                m_position += sizeof(T) / 4;
+                Advance(sizeof(T) / 4);
                 return t;
             }
 
@@ -142,7 +170,7 @@ namespace Babylon
                 uint32_t length = Read<uint32_t>();
 
                 auto span = gsl::make_span<T>(reinterpret_cast<T*>(m_buffer.data() + m_position), length * (sizeof(T) / 4));
-                m_position += length;
+                Advance(length);
                 return span;
             }
         };
@@ -195,25 +223,125 @@ namespace Babylon
 
             const auto& buffer = info[0].As<Napi::ArrayBuffer>();
             const auto& length = info[1].ToNumber().Uint32Value();
+            if (length == 0)
+            {
+                return;
+            }
+
+            auto data = reinterpret_cast<uint32_t*>(buffer.Data());
 
-            auto span = gsl::make_span(reinterpret_cast<uint32_t*>(buffer.Data()), static_cast<ptrdiff_t>(length));
-            m_buffer.insert(m_buffer.end(), span.begin(), span.end());
+            // The JS side reuses its buffer as soon as this call returns, so the data has to be copied unless it is being written
+            // by the flush requested from GetReader or the caller guarantees the buffer is left untouched until the stream is read.
+            const bool retain{m_flushing || (info.Length() > 2 && info[2].ToBoolean().Value())};
+            if (retain)
+            {
+                m_retainedBuffers.push_back(Napi::Persistent(buffer));
+                m_chunks.push_back({data, 0, length});
+            }
+            else
+            {
+                // Consecutive copied chunks are contiguous in m_buffer and are merged into a single chunk.
+                if (m_chunks.empty() || m_chunks.back().Data != nullptr)
+                {
+                    m_chunks.push_back({nullptr, m_buffer.size(), 0});
+                }
+
+                m_buffer.insert(m_buffer.end(), data, data + length);
+                m_chunks.back().Length += length;
+            }
         }
 
         Reader GetReader()
         {
             assert(!m_locked);
-            m_requestFlushCallback.Call({});
+
+            {
+                m_flushing = true;
+                auto flushingGuard = gsl::finally([this]() { m_flushing = false; });
+                m_requestFlushCallback.Call({});
+            }
+
             m_locked = true;
-            return {m_buffer, [this]() {
+
+            size_t sizeInBytes{0};
+            for (const auto& chunk : m_chunks)
+            {
+                uint32_t* data{chunk.Data != nullptr ? chunk.Data : m_buffer.data() + chunk.Offset};
+                m_spans.push_back(gsl::make_span(data, static_cast<ptrdiff_t>(chunk.Length)));
+                sizeInBytes += chunk.Length * sizeof(uint32_t);
+            }
+
+            // Clearing keeps the capacity of the containers so that it is reused by the next frame.
+            return {m_spans, sizeInBytes, [this]() {
                         m_buffer.clear();
+                        m_chunks.clear();
+                        m_spans.clear();
+                        m_retainedBuffers.clear();
                         m_locked = false;
                     }};
         }
 
+        // Data moved out of a stream so that it can be read after the JS side resumes writing, e.g. on another thread.
+        // It must be cleared or reused on the JS thread since it holds references to JS buffers.
+        struct DetachedData
+        {
+            std::vector<uint32_t> Buffer{};
+            std::vector<Napi::Reference<Napi::ArrayBuffer>> RetainedBuffers{};
+            std::vector<gsl::span<uint32_t>> Chunks{};
+        };
+
+        void Detach(DetachedData& data)
+        {
+            assert(!m_locked);
+
+            // Data written by this flush is copied like any other write since the JS buffer is reused right after.
+            m_requestFlushCallback.Call({});
+
+            data.Chunks.clear();
+            data.RetainedBuffers.clear();
+            data.Buffer.clear();
+
+            // The chunks are moved rather than copied. Moving a vector keeps its data in place, so the chunks can be
+            // resolved after the move, and swapping hands the previously detached buffers back to the stream so that
+            // their capacity gets reused.
+            std::swap(data.Buffer, m_buffer);
+            std::swap(data.RetainedBuffers, m_retainedBuffers);
+
+            for (const auto& chunk : m_chunks)
+            {
+                uint32_t* chunkData{chunk.Data != nullptr ? chunk.Data : data.Buffer.data() + chunk.Offset};
+                data.Chunks.push_back(gsl::make_span(chunkData, static_cast<ptrdiff_t>(chunk.Length)));
+            }
+
+            m_chunks.clear();
+        }
+
+        static Reader GetReader(const DetachedData& data)
+        {
+            size_t sizeInBytes{0};
+            for (const auto& chunk : data.Chunks)
+            {
+                sizeInBytes += chunk.size() * sizeof(uint32_t);
+            }
+
+            return {data.Chunks, sizeInBytes, []() {}};
+        }
+
     private:
+        // A chunk either references a retained JS buffer in place or a range of m_buffer holding copied data.
+        struct Chunk
+        {
+            uint32_t* Data{};
+            size_t Offset{};
+            size_t Length{};
+        };
+
         std::vector<uint32_t> m_buffer{};
+        std::vector<Chunk> m_chunks{};
+        std::vector<gsl::span<uint32_t>> m_spans{};
+        std::vector<Napi::Reference<Napi::ArrayBuffer>> m_retainedBuffers{};
         Napi::FunctionReference m_requestFlushCallback{};
+        bool m_flushing{false};
         bool m_locked{false};
     };
 }
@@ -1,5 +1,7 @@
 #include "NativeEngine.h"
 #include "ShaderCompiler.h"
+#include "ShaderCompilerCommon.h"
+#include "ImageOps.h"
 
 #include <Babylon/Graphics/Texture.h>
 #include "JsConsoleLogger.h"
@@ -29,6 +31,10 @@
 #include <webp/decode.h>
 #endif
 
+#ifdef BASISU
+#include "TextureTranscoder.h"
+#endif
+
 namespace Babylon
 {
     namespace
@@ -60,6 +66,28 @@ namespace Babylon
             // clang-format on
         }
 
+        // Record types of COMMAND_SETUNIFORMS, each matching the payload of the single uniform command of the same name.
+        namespace UniformType
+        {
+            constexpr uint32_t INT = 0;
+            constexpr uint32_t INTARRAY = 1;
+            constexpr uint32_t INTARRAY2 = 2;
+            constexpr uint32_t INTARRAY3 = 3;
+            constexpr uint32_t INTARRAY4 = 4;
+            constexpr uint32_t FLOATARRAY = 5;
+            constexpr uint32_t FLOATARRAY2 = 6;
+            constexpr uint32_t FLOATARRAY3 = 7;
+            constexpr uint32_t FLOATARRAY4 = 8;
+            constexpr uint32_t MATRICES = 9;
+            constexpr uint32_t MATRIX2X2 = 10;
+            constexpr uint32_t MATRIX3X3 = 11;
+            constexpr uint32_t MATRIX = 12;
+            constexpr uint32_t FLOAT = 13;
+            constexpr uint32_t FLOAT2 = 14;
+            constexpr uint32_t FLOAT3 = 15;
+            constexpr uint32_t FLOAT4 = 16;
+        }
+
         namespace AlphaMode
         {
             constexpr uint64_t DISABLE = 0x0;
@@ -84,105 +112,34 @@ namespace Babylon
             return static_cast<bgfx::TextureFormat::Enum>(format);
         }
 
-        using TransformFn = void (*)(const uint8_t*, uint8_t*);
-        void TransformImage(const bimg::ImageContainer* src, bimg::ImageContainer* dst, TransformFn transformFn)
-        {
-            const uint8_t* srcData{static_cast<const uint8_t*>(src->m_data)};
-            const uint8_t srcBytesPerPixel{static_cast<uint8_t>(bimg::getBitsPerPixel(src->m_format) >> 3)};
-            const uint8_t* srcDataEnd{srcData + src->m_size};
-
-            uint8_t* dstData{static_cast<uint8_t*>(dst->m_data)};
-            const uint8_t dstBytesPerPixel{static_cast<uint8_t>(bimg::getBitsPerPixel(dst->m_format) >> 3)};
-            const uint8_t* dstDataEnd{dstData + dst->m_size};
-
-            while (srcData < srcDataEnd && dstData < dstDataEnd)
-            {
-                transformFn(srcData, dstData);
-                srcData += srcBytesPerPixel;
-                dstData += dstBytesPerPixel;
-            }
-        }
-
-        void FlipImage(gsl::span<uint8_t> image, uint32_t height)
+        // Expands an R8, RG8 or RGB8 image to RGBA8, freeing the original image.
+        bimg::ImageContainer* ExpandToRGBA8(bx::AllocatorI& allocator, bimg::ImageContainer* image)
         {
-            const size_t rowPitch{image.size() / height};
+            bimg::ImageContainer* oldImage{image};
+            image = bimg::imageAlloc(&allocator, bimg::TextureFormat::RGBA8, static_cast<uint16_t>(oldImage->m_width), static_cast<uint16_t>(oldImage->m_height), 1, 1, false, false);
+            image->m_orientation = oldImage->m_orientation;
 
-            std::vector<uint8_t> buffer(rowPitch);
-            for (size_t row = 0; row < height / 2; row++)
+            const auto* source{static_cast<const uint8_t*>(oldImage->m_data)};
+            auto* destination{static_cast<uint8_t*>(image->m_data)};
+            const size_t pixelCount{static_cast<size_t>(oldImage->m_width) * oldImage->m_height};
+            switch (oldImage->m_format)
             {
-                uint8_t* frontPtr{image.data() + (row * rowPitch)};
-                uint8_t* backPtr{image.data() + ((height - row - 1) * rowPitch)};
-
-                std::memcpy(buffer.data(), frontPtr, rowPitch);
-                std::memcpy(frontPtr, backPtr, rowPitch);
-                std::memcpy(backPtr, buffer.data(), rowPitch);
+                case bimg::TextureFormat::R8:
+                    ImageOps::ExpandR8ToRGBA8(source, destination, pixelCount);
+                    break;
+                case bimg::TextureFormat::RG8:
+                    ImageOps::ExpandRG8ToRGBA8(source, destination, pixelCount);
+                    break;
+                case bimg::TextureFormat::RGB8:
+                    ImageOps::ExpandRGB8ToRGBA8(source, destination, pixelCount);
+                    break;
+                default:
+                    bimg::imageFree(image);
+                    throw std::runtime_error{"Unexpected image format."};
             }
-        }
 
-        std::function<std::pair<uint32_t, uint32_t>(uint32_t x, uint32_t y)> GetPixelMapper(bimg::Orientation::Enum orientation, uint32_t width, uint32_t height)
-        {
-            // clang-format off
-            switch (orientation)
-            {
-                case bimg::Orientation::R0: return [](uint32_t x, uint32_t y) { return std::make_pair(x, y); };
-                case bimg::Orientation::R90: return [height](uint32_t x, uint32_t y) { return std::make_pair(height - y - 1, x); };
-                case bimg::Orientation::R180: return [width, height](uint32_t x, uint32_t y) { return std::make_pair(width - x - 1, height - y - 1); };
-                case bimg::Orientation::R270: return [width](uint32_t x, uint32_t y) { return std::make_pair(y, width - x - 1); };
-                case bimg::Orientation::HFlip: return [width](uint32_t x, uint32_t y) { return std::make_pair(width - x - 1, y); };
-                case bimg::Orientation::HFlipR90: return [width, height](uint32_t x, uint32_t y) { return std::make_pair(height - y - 1, width - x - 1); };
-                case bimg::Orientation::HFlipR270: return [](uint32_t x, uint32_t y) { return std::make_pair(y, x); };
-                case bimg::Orientation::VFlip: return [height](uint32_t x, uint32_t y) { return std::make_pair(x, height - y - 1); };
-                default: throw std::runtime_error{"Unexpected image orientation."};
-            }
-            // clang-format on
-        }
-
-        using RGBA8ImageData = gsl::span<uint32_t>;
-        void ReorientImage(RGBA8ImageData image, uint32_t& width, uint32_t& height, bimg::Orientation::Enum orientation)
-        {
-            // If the orientation is the default, nothing needs to be done.
-            if (orientation == bimg::Orientation::R0)
-            {
-                // No-op
-            }
-            // If we only need a vflip, use the more efficient FlipImage function.
-            else if (orientation == bimg::Orientation::VFlip)
-            {
-                FlipImage(gsl::make_span(reinterpret_cast<uint8_t*>(image.data()), image.size_bytes()), height);
-            }
-            // Otherwise we'll do a pixel by pixel transformation, using a temporary image buffer.
-            else if (orientation != bimg::Orientation::R0)
-            {
-                uint32_t newWidth = width;
-                uint32_t newHeight = height;
-
-                // If the orientation is 90 or 270, the final image width and height will be swapped.
-                if (orientation == bimg::Orientation::R90 || orientation == bimg::Orientation::R270 || orientation == bimg::Orientation::HFlipR90 || orientation == bimg::Orientation::HFlipR270)
-                {
-                    std::swap(newWidth, newHeight);
-                }
-
-                // Transform the pixels from the original image data to a temp image buffer.
-                std::vector<uint32_t> buffer(image.size());
-                auto mapPixel = GetPixelMapper(orientation, width, height);
-                for (uint32_t y = 0; y < height; y++)
-                {
-                    for (uint32_t x = 0; x < width; x++)
-                    {
-                        const RGBA8ImageData::size_type index = y * width + x;
-                        const std::pair<uint32_t, uint32_t> mappedPixel{mapPixel(x, y)};
-                        const RGBA8ImageData::size_type newIndex = mappedPixel.second * newWidth + mappedPixel.first;
-                        buffer[newIndex] = image[index];
-                    }
-                }
-
-                // Copy the temp image buffer over the original image data.
-                std::memcpy(image.data(), buffer.data(), image.size_bytes());
-
-                // Update the final width and height.
-                width = newWidth;
-                height = newHeight;
-            }
+            bimg::imageFree(oldImage);
+            return image;
         }
 
         bimg::ImageContainer* ParseImage(bx::AllocatorI& allocator, gsl::span<uint8_t> data)
@@ -215,15 +172,9 @@ namespace Babylon
             if (image->m_format == bimg::TextureFormat::R8 ||
                 image->m_format == bimg::TextureFormat::RG8)
             {
-                static const TransformFn UnpackR8{[](const uint8_t* src, uint8_t* dst) { dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 1; }};
-                static const TransformFn UnpackRG8{[](const uint8_t* src, uint8_t* dst) { dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; }};
-
                 // bimg loads grayscale textures with and without alpha as R8 and RG8 respectively.
                 // Unpack to RGB and RGBA such that RGB is the grayscale and the A is the alpha.
-                bimg::ImageContainer* oldImage{image};
-                image = bimg::imageAlloc(&allocator, bimg::TextureFormat::RGBA8, static_cast<uint16_t>(image->m_width), static_cast<uint16_t>(image->m_height), 1, 1, false, false);
-                TransformImage(oldImage, image, oldImage->m_format == bimg::TextureFormat::R8 ? UnpackR8 : UnpackRG8);
-                bimg::imageFree(oldImage);
+                image = ExpandToRGBA8(allocator, image);
             }
 
             // If the image has a non-zero orientation (e.g. via jpeg metadata), take this into account by updating the orientation of the underlying image data.
@@ -232,10 +183,7 @@ namespace Babylon
                 // Convert from RGB8 to RGBA8.
                 if (image->m_format == bimg::TextureFormat::RGB8)
                 {
-                    bimg::ImageContainer* oldImage{image};
-                    image = bimg::imageConvert(&allocator, bimg::TextureFormat::RGBA8, *image, false);
-                    image->m_orientation = oldImage->m_orientation;
-                    bimg::imageFree(oldImage);
+                    image = ExpandToRGBA8(allocator, image);
                 }
 
                 // If the image is RGBA8, update the image data according to the orientation.
@@ -243,14 +191,39 @@ namespace Babylon
                 if (image->m_format == bimg::TextureFormat::RGBA8)
                 {
                     assert(bimg::getBitsPerPixel(image->m_format) == sizeof(uint32_t) * 8);
-                    ReorientImage(gsl::make_span(static_cast<uint32_t*>(image->m_data), image->m_size / sizeof(uint32_t)), image->m_width, image->m_height, image->m_orientation);
+                    ImageOps::ReorientImage(gsl::make_span(static_cast<uint32_t*>(image->m_data), image->m_size / sizeof(uint32_t)), image->m_width, image->m_height, image->m_orientation);
                 }
             }
 
             return image;
         }
 
-        bimg::ImageContainer* PrepareImage(bx::AllocatorI& allocator, bimg::ImageContainer* image, bool invertY, bool srgb, bool generateMips)
+        // Whether the mips of a texture loaded from an image of the given format can be generated on the GPU.
+        bool CanGenerateMipsOnGpu(bimg::TextureFormat::Enum format, bool srgb)
+        {
+            return Graphics::Texture::CanGenerateMips(Cast(format), srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE);
+        }
+
+        // Converts the image to a format that mips can be generated for on the CPU.
+        bimg::ImageContainer* WidenForMips(bx::AllocatorI& allocator, bimg::ImageContainer* image)
+        {
+            if (image->m_format == bimg::TextureFormat::RGB8)
+            {
+                image = ExpandToRGBA8(allocator, image);
+            }
+            else if (image->m_format == bimg::TextureFormat::RGBA16F || image->m_format == bimg::TextureFormat::RGBA16 || image->m_format == bimg::TextureFormat::R16)
+            {
+                bimg::ImageContainer* oldImage{image};
+                image = bimg::imageConvert(&allocator, bimg::TextureFormat::RGBA32F, *image, false);
+                bimg::imageFree(oldImage);
+            }
+
+            return image;
+        }
+
+        // When gpuMips is true, the mips are left for the GPU to generate if it can, in which case the image keeps a single
+        // level and LoadTextureFromImage creates the texture for GenerateMips.
+        bimg::ImageContainer* PrepareImage(bx::AllocatorI& allocator, bimg::ImageContainer* image, bool invertY, bool srgb, bool generateMips, bool gpuMips = false)
         {
             assert(
                 image->m_format == bimg::TextureFormat::R16 ||
@@ -267,14 +240,21 @@ namespace Babylon
 
             if (bgfx::getCaps()->originBottomLeft ? invertY : !invertY)
             {
-                FlipImage({static_cast<uint8_t*>(image->m_data), image->m_size}, image->m_height);
+                ImageOps::FlipImage({static_cast<uint8_t*>(image->m_data), image->m_size}, image->m_height);
             }
 
             if (srgb && !bgfx::isTextureValid(1, false, 1, Cast(image->m_format), BGFX_TEXTURE_SRGB))
             {
-                bimg::ImageContainer* oldImage{image};
-                image = bimg::imageConvert(&allocator, bimg::TextureFormat::RGBA8, *image, false);
-                bimg::imageFree(oldImage);
+                if (image->m_format == bimg::TextureFormat::RGB8)
+                {
+                    image = ExpandToRGBA8(allocator, image);
+                }
+                else
+                {
+                    bimg::ImageContainer* oldImage{image};
+                    image = bimg::imageConvert(&allocator, bimg::TextureFormat::RGBA8, *image, false);
+                    bimg::imageFree(oldImage);
+                }
 
                 assert(bgfx::isTextureValid(1, false, 1, Cast(image->m_format), BGFX_TEXTURE_SRGB));
             }
@@ -283,38 +263,107 @@ namespace Babylon
             {
                 if (image->m_format == bimg::TextureFormat::RGB8)
                 {
-                    bimg::ImageContainer* oldImage{image};
-                    image = bimg::imageConvert(&allocator, bimg::TextureFormat::RGBA8, *image, false);
-                    bimg::imageFree(oldImage);
+                    image = ExpandToRGBA8(allocator, image);
                 }
-                else if (image->m_format == bimg::TextureFormat::RGBA16F || image->m_format == bimg::TextureFormat::RGBA16 || image->m_format == bimg::TextureFormat::R16)
+
+                // Generating the mips on the GPU only uploads the first level, and does not need to widen the format.
+                if (!gpuMips || !CanGenerateMipsOnGpu(image->m_format, srgb))
                 {
+                    image = WidenForMips(allocator, image);
+
                     bimg::ImageContainer* oldImage{image};
-                    image = bimg::imageConvert(&allocator, bimg::TextureFormat::RGBA32F, *image, false);
+                    image = bimg::imageGenerateMips(&allocator, *image);
                     bimg::imageFree(oldImage);
                 }
-
-                bimg::ImageContainer* oldImage{image};
-                image = bimg::imageGenerateMips(&allocator, *image);
-                bimg::imageFree(oldImage);
             }
 
             assert(image != nullptr);
             return image;
         }
 
-        void LoadTextureFromImage(Graphics::Texture* texture, bimg::ImageContainer* image, bool srgb)
+        bimg::ImageContainer* LoadImage(bx::AllocatorI& allocator, gsl::span<uint8_t> data, bool invertY, bool srgb, bool generateMips, bool gpuMips = false)
         {
-            if (texture->IsValid())
+#ifdef BASISU
+            // Supercompressed textures are transcoded straight to a format the GPU samples, rather than to RGBA8.
+            if (TextureTranscoder::IsKtx2(data))
             {
-                if (texture->Width() != image->m_width || texture->Height() != image->m_height)
+                return TextureTranscoder::TranscodeKtx2(allocator, data, invertY, srgb, generateMips);
+            }
+#endif
+
+            return PrepareImage(allocator, ParseImage(allocator, data), invertY, srgb, generateMips, gpuMips);
+        }
+
+        // Cube faces are sampled with the opposite vertical direction of 2D textures when the origin is at the bottom left,
+        // which is folded into the flip that LoadImage and PrepareImage make for invertY.
+        bool GetCubeFaceInvertY(bool invertY)
+        {
+            return bgfx::getCaps()->originBottomLeft ? !invertY : invertY;
+        }
+
+        // Streams an image loaded without generating its mips. When mips are requested for an image with a single level,
+        // they are generated one level at a time and each level is queued as soon as it is, so that the largest levels
+        // are uploaded while the smaller ones are generated.
+        arcana::task<void, std::exception_ptr> StreamImage(TextureStreamer& streamer, Graphics::Texture* texture, bimg::ImageContainer* image, bool srgb, bool generateMips)
+        {
+            auto& allocator{Graphics::DeviceContext::GetDefaultAllocator()};
+            if (generateMips && image->m_numMips == 1)
+            {
+                image = WidenForMips(allocator, image);
+            }
+
+            if (!generateMips || image->m_numMips > 1 || !ImageOps::CanDownsampleImage(image->m_format))
+            {
+                return streamer.Stream2D(texture, image, srgb);
+            }
+
+            uint8_t mipCount{1};
+            while ((std::max(image->m_width, image->m_height) >> mipCount) > 0)
+            {
+                ++mipCount;
+            }
+
+            const auto request{streamer.CreateRequest(texture, false, mipCount, srgb)};
+            try
+            {
+                for (uint8_t mip = 0; mip < mipCount; ++mip)
                 {
-                    throw std::runtime_error{"Cannot update texture from image of different size"};
+                    bimg::ImageContainer* nextImage{mip + 1 < mipCount ? ImageOps::DownsampleImage(allocator, *image) : nullptr};
+                    streamer.QueueImage(request, 0, mip, std::exchange(image, nextImage));
                 }
             }
-            else
+            catch (...)
+            {
+                if (image != nullptr)
+                {
+                    bimg::imageFree(image);
+                }
+
+                streamer.Fail(request, std::current_exception());
+            }
+
+            return streamer.WhenReady(request);
+        }
+
+        // Returns true if the mips of the texture must be generated with GenerateMips, which is the case when mips are
+        // requested, gpuMips is true, and the image was prepared with its mips left for the GPU.
+        bool LoadTextureFromImage(Graphics::Texture* texture, bimg::ImageContainer* image, bool srgb, bool generateMips = false, bool gpuMips = false)
+        {
+            const bool generateMipsOnGpu{generateMips && gpuMips && image->m_numMips == 1 && CanGenerateMipsOnGpu(image->m_format, srgb)};
+            const uint64_t flags{srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE};
+
+            if (texture->IsValid() && !texture->IsShared() && (texture->Width() != image->m_width || texture->Height() != image->m_height))
+            {
+                throw std::runtime_error{"Cannot update texture from image of different size"};
+            }
+
+            // Shared textures are created again rather than updated, which would change them for every texture sharing them.
+            if (generateMipsOnGpu)
+            {
+                texture->Create2DWithGeneratedMips(static_cast<uint16_t>(image->m_width), static_cast<uint16_t>(image->m_height), Cast(image->m_format), flags);
+            }
+            else if (!texture->IsValid() || texture->IsShared())
             {
-                uint64_t flags = srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE;
                 texture->Create2D(static_cast<uint16_t>(image->m_width), static_cast<uint16_t>(image->m_height), (image->m_numMips > 1), 1, Cast(image->m_format), flags);
             }
 
@@ -335,6 +384,35 @@ namespace Babylon
                     texture->Update2D(0, mip, 0, 0, static_cast<uint16_t>(imageMip.m_width), static_cast<uint16_t>(imageMip.m_height), mem);
                 }
             }
+
+            return generateMipsOnGpu;
+        }
+
+        // Returns the image without its largest levels, keeping at least the smallest one.
+        bimg::ImageContainer* DropLargestMips(bx::AllocatorI& allocator, bimg::ImageContainer* image, uint8_t count)
+        {
+            count = std::min(count, static_cast<uint8_t>(image->m_numMips - 1));
+            if (count == 0)
+            {
+                return image;
+            }
+
+            const auto width{static_cast<uint16_t>(std::max(image->m_width >> count, 1u))};
+            const auto height{static_cast<uint16_t>(std::max(image->m_height >> count, 1u))};
+            bimg::ImageContainer* result{bimg::imageAlloc(&allocator, image->m_format, width, height, 1, 1, false, true)};
+            for (uint8_t mip = 0; mip < result->m_numMips && mip + count < image->m_numMips; ++mip)
+            {
+                bimg::ImageMip source{};
+                bimg::ImageMip destination{};
+                if (bimg::imageGetRawData(*image, 0, mip + count, image->m_data, image->m_size, source) &&
+                    bimg::imageGetRawData(*result, 0, mip, result->m_data, result->m_size, destination))
+                {
+                    std::memcpy(const_cast<uint8_t*>(destination.m_data), source.m_data, std::min(source.m_size, destination.m_size));
+                }
+            }
+
+            bimg::imageFree(image);
+            return result;
         }
 
         void LoadCubeTextureFromImages(Graphics::Texture* texture, std::vector<bimg::ImageContainer*>& images, bool srgb)
@@ -343,7 +421,19 @@ namespace Babylon
             assert(firstImage->m_width == firstImage->m_height);
             uint32_t size{firstImage->m_width};
 
-            if (texture->IsValid())
+            // Faces transcoded from KTX2 can end up in different formats, for instance if only some of them have alpha, or
+            // with different levels if only some of them have mips.
+            if (std::any_of(images.begin(), images.end(), [firstImage](const bimg::ImageContainer* image) { return image->m_format != firstImage->m_format || image->m_numMips != firstImage->m_numMips; }))
+            {
+                for (bimg::ImageContainer* image : images)
+                {
+                    bimg::imageFree(image);
+                }
+
+                throw std::runtime_error{"Cube texture faces must have matching formats and levels."};
+            }
+
+            if (texture->IsValid() && !texture->IsShared())
             {
                 if (texture->Width() != size || texture->Height() != size)
                 {
@@ -368,16 +458,14 @@ namespace Babylon
                     {
                         bimg::ImageContainer* image{images[(side * numMips) + mip]};
 
-                        if (bgfx::getCaps()->originBottomLeft)
-                        {
-                            FlipImage({ static_cast<uint8_t*>(image->m_data), image->m_size }, image->m_height);
-                        }
-
                         bgfx::ReleaseFn releaseFn{[](void*, void* userData) {
                             bimg::imageFree(static_cast<bimg::ImageContainer*>(userData));
                         }};
 
-                        const bgfx::Memory* mem{bgfx::makeRef(image->m_data, image->m_size, releaseFn, image)};
+                        // Only the base level of each image is used, since every level is an image of its own.
+                        bimg::ImageMip imageMip{};
+                        bimg::imageGetRawData(*image, 0, 0, image->m_data, image->m_size, imageMip);
+                        const bgfx::Memory* mem{bgfx::makeRef(imageMip.m_data, imageMip.m_size, releaseFn, image)};
                         texture->UpdateCube(0, side, mip, 0, 0, static_cast<uint16_t>(image->m_width), static_cast<uint16_t>(image->m_height), mem);
                     }
                 }
@@ -392,11 +480,6 @@ namespace Babylon
                         bimg::ImageMip imageMip{};
                         if (bimg::imageGetRawData(*image, 0, mip, image->m_data, image->m_size, imageMip))
                         {
-                            if (bgfx::getCaps()->originBottomLeft)
-                            {
-                                FlipImage({ const_cast<uint8_t*>(imageMip.m_data), imageMip.m_size }, image->m_height);
-                            }
-
                             bgfx::ReleaseFn releaseFn{};
                             if (mip == image->m_numMips - 1)
                             {
@@ -430,6 +513,21 @@ namespace Babylon
             return BGFX_TEXTURE_NONE;
         }
 
+        size_t GetUniformElementSize(bgfx::UniformType::Enum type)
+        {
+            switch (type)
+            {
+                case bgfx::UniformType::Vec4:
+                    return 4;
+                case bgfx::UniformType::Mat3:
+                    return 9;
+                case bgfx::UniformType::Mat4:
+                    return 16;
+                default:
+                    return 1;
+            }
+        }
+
         using CommandFunctionPointerT = void (NativeEngine::*)(NativeDataStream::Reader&);
     }
 
@@ -633,11 +731,30 @@ namespace Babylon
                 StaticValue("STENCIL_OP_PASS_Z_DECRSAT", Napi::Number::From(env, BGFX_STENCIL_OP_PASS_Z_DECRSAT)),
                 StaticValue("STENCIL_OP_PASS_Z_INVERT", Napi::Number::From(env, BGFX_STENCIL_OP_PASS_Z_INVERT)),
 
+                StaticValue("UNIFORM_TYPE_INT", Napi::Number::From(env, UniformType::INT)),
+                StaticValue("UNIFORM_TYPE_INTARRAY", Napi::Number::From(env, UniformType::INTARRAY)),
+                StaticValue("UNIFORM_TYPE_INTARRAY2", Napi::Number::From(env, UniformType::INTARRAY2)),
+                StaticValue("UNIFORM_TYPE_INTARRAY3", Napi::Number::From(env, UniformType::INTARRAY3)),
+                StaticValue("UNIFORM_TYPE_INTARRAY4", Napi::Number::From(env, UniformType::INTARRAY4)),
+                StaticValue("UNIFORM_TYPE_FLOATARRAY", Napi::Number::From(env, UniformType::FLOATARRAY)),
+                StaticValue("UNIFORM_TYPE_FLOATARRAY2", Napi::Number::From(env, UniformType::FLOATARRAY2)),
+                StaticValue("UNIFORM_TYPE_FLOATARRAY3", Napi::Number::From(env, UniformType::FLOATARRAY3)),
+                StaticValue("UNIFORM_TYPE_FLOATARRAY4", Napi::Number::From(env, UniformType::FLOATARRAY4)),
+                StaticValue("UNIFORM_TYPE_MATRICES", Napi::Number::From(env, UniformType::MATRICES)),
+                StaticValue("UNIFORM_TYPE_MATRIX2X2", Napi::Number::From(env, UniformType::MATRIX2X2)),
+                StaticValue("UNIFORM_TYPE_MATRIX3X3", Napi::Number::From(env, UniformType::MATRIX3X3)),
+                StaticValue("UNIFORM_TYPE_MATRIX", Napi::Number::From(env, UniformType::MATRIX)),
+                StaticValue("UNIFORM_TYPE_FLOAT", Napi::Number::From(env, UniformType::FLOAT)),
+                StaticValue("UNIFORM_TYPE_FLOAT2", Napi::Number::From(env, UniformType::FLOAT2)),
+                StaticValue("UNIFORM_TYPE_FLOAT3", Napi::Number::From(env, UniformType::FLOAT3)),
+                StaticValue("UNIFORM_TYPE_FLOAT4", Napi::Number::From(env, UniformType::FLOAT4)),
+
                 StaticValue("COMMAND_DELETEVERTEXARRAY", Napi::FunctionPointer::Create(env, &NativeEngine::DeleteVertexArray)),
                 StaticValue("COMMAND_DELETEINDEXBUFFER", Napi::FunctionPointer::Create(env, &NativeEngine::DeleteIndexBuffer)),
                 StaticValue("COMMAND_DELETEVERTEXBUFFER", Napi::FunctionPointer::Create(env, &NativeEngine::DeleteVertexBuffer)),
                 StaticValue("COMMAND_SETPROGRAM", Napi::FunctionPointer::Create(env, &NativeEngine::SetProgram)),
                 StaticValue("COMMAND_DELETEPROGRAM", Napi::FunctionPointer::Create(env, &NativeEngine::DeleteProgram)),
+                StaticValue("COMMAND_SETUNIFORMS", Napi::FunctionPointer::Create(env, &NativeEngine::SetUniforms)),
                 StaticValue("COMMAND_SETMATRICES", Napi::FunctionPointer::Create(env, &NativeEngine::SetMatrices)),
                 StaticValue("COMMAND_SETMATRIX", Napi::FunctionPointer::Create(env, &NativeEngine::SetMatrix)),
                 StaticValue("COMMAND_SETMATRIX3X3", Napi::FunctionPointer::Create(env, &NativeEngine::SetMatrix3x3)),
@@ -691,10 +808,15 @@ namespace Babylon
                 InstanceMethod("createIndexBuffer", &NativeEngine::CreateIndexBuffer),
                 InstanceMethod("recordIndexBuffer", &NativeEngine::RecordIndexBuffer),
                 InstanceMethod("updateDynamicIndexBuffer", &NativeEngine::UpdateDynamicIndexBuffer),
+                InstanceMethod("createTransientIndexBuffer", &NativeEngine::CreateTransientIndexBuffer),
+                InstanceMethod("allocateTransientIndexBuffer", &NativeEngine::AllocateTransientIndexBuffer),
 
                 InstanceMethod("createVertexBuffer", &NativeEngine::CreateVertexBuffer),
                 InstanceMethod("recordVertexBuffer", &NativeEngine::RecordVertexBuffer),
                 InstanceMethod("updateDynamicVertexBuffer", &NativeEngine::UpdateDynamicVertexBuffer),
+                InstanceMethod("createTransientVertexBuffer", &NativeEngine::CreateTransientVertexBuffer),
+                InstanceMethod("allocateTransientVertexBuffer", &NativeEngine::AllocateTransientVertexBuffer),
+                InstanceMethod("setGeometryReferencesEnabled", &NativeEngine::SetGeometryReferencesEnabled),
 
                 InstanceMethod("createProgram", &NativeEngine::CreateProgram),
                 InstanceMethod("createProgramAsync", &NativeEngine::CreateProgramAsync),
@@ -712,6 +834,10 @@ namespace Babylon
                 InstanceMethod("getTextureHeight", &NativeEngine::GetTextureHeight),
                 InstanceMethod("deleteTexture", &NativeEngine::DeleteTexture),
                 InstanceMethod("readTexture", &NativeEngine::ReadTexture),
+                InstanceMethod("setTextureStreamingBudget", &NativeEngine::SetTextureStreamingBudget),
+                InstanceMethod("setTextureMemoryBudget", &NativeEngine::SetTextureMemoryBudget),
+                InstanceMethod("setTextureCacheEnabled", &NativeEngine::SetTextureCacheEnabled),
+                InstanceMethod("setReadTextureLatency", &NativeEngine::SetReadTextureLatency),
 
                 InstanceMethod("createImageBitmap", &NativeEngine::CreateImageBitmap),
                 InstanceMethod("resizeImageBitmap", &NativeEngine::ResizeImageBitmap),
@@ -756,6 +882,11 @@ namespace Babylon
             auto jsInfo = info[0].As<Napi::Object>();
             m_jsInfo.NonFloatVertexBuffers = jsInfo.Get("nonFloatVertexBuffers").As<Napi::Boolean>();
         }
+
+        if (m_deviceContext.GetThreadedCommandSubmission())
+        {
+            m_commandWorker = std::make_unique<CommandWorker>();
+        }
     }
 
     NativeEngine::~NativeEngine()
@@ -765,9 +896,24 @@ namespace Babylon
 
     void NativeEngine::Dispose()
     {
+        if (m_commandWorker)
+        {
+            try
+            {
+                m_commandWorker->Wait();
+            }
+            catch (const std::exception&)
+            {
+                // Errors from the last batch are irrelevant once the engine is disposed.
+            }
+        }
+
         m_deviceContext.SetRenderResetCallback(nullptr);
 
         m_cancellationSource->cancel();
+
+        // Images loaded by other engines take buffers from the pool again as they need them.
+        ImageOps::TrimScratchBuffers();
     }
 
     void NativeEngine::Dispose(const Napi::CallbackInfo& /*info*/)
@@ -785,7 +931,9 @@ namespace Babylon
 
     Napi::Value NativeEngine::CreateVertexArray(const Napi::CallbackInfo& info)
     {
-        VertexArray* vertexArray = new VertexArray{};
+        WaitForCommands(info.Env());
+
+        VertexArray* vertexArray = new VertexArray{m_deviceContext};
         return Napi::Pointer<VertexArray>::Create(info.Env(), vertexArray, Napi::NapiPointerDeleter(vertexArray));
     }
 
@@ -810,10 +958,26 @@ namespace Babylon
         const bool dynamic = info[4].As<Napi::Boolean>().Value();
 
         const uint16_t flags = (is32Bits ? BGFX_BUFFER_INDEX32 : 0);
-        IndexBuffer* indexBuffer = new IndexBuffer{m_deviceContext, gsl::make_span(static_cast<uint8_t*>(dataBuffer.Data()) + dataByteOffset, dataByteLength), flags, dynamic};
+        const bool referenceBytes = m_geometryReferencesEnabled && !dynamic;
+        IndexBuffer* indexBuffer = new IndexBuffer{m_deviceContext, gsl::make_span(static_cast<uint8_t*>(dataBuffer.Data()) + dataByteOffset, dataByteLength), flags, dynamic, referenceBytes};
+        if (referenceBytes)
+        {
+            ReferenceGeometryBytes(indexBuffer->WhenBytesReleased(), dataBuffer);
+        }
+
         return Napi::Pointer<IndexBuffer>::Create(info.Env(), indexBuffer, Napi::NapiPointerDeleter(indexBuffer));
     }
 
+    void NativeEngine::ReferenceGeometryBytes(arcana::task<void, std::exception_ptr> whenReleased, Napi::ArrayBuffer dataBuffer)
+    {
+        const auto id{m_nextGeometryReferenceId++};
+        m_geometryReferences.emplace(id, Napi::Persistent(dataBuffer));
+
+        whenReleased.then(m_runtimeScheduler, *m_cancellationSource, [this, id]() {
+            m_geometryReferences.erase(id);
+        });
+    }
+
     void NativeEngine::DeleteIndexBuffer(NativeDataStream::Reader& data)
     {
         data.ReadPointer<IndexBuffer>()->Dispose();
@@ -821,6 +985,8 @@ namespace Babylon
 
     void NativeEngine::RecordIndexBuffer(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         VertexArray* vertexArray = info[0].As<Napi::Pointer<VertexArray>>().Get();
         IndexBuffer* indexBuffer = info[1].As<Napi::Pointer<IndexBuffer>>().Get();
 
@@ -840,6 +1006,8 @@ namespace Babylon
 
     void NativeEngine::UpdateDynamicIndexBuffer(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         IndexBuffer* indexBuffer = info[0].As<Napi::Pointer<IndexBuffer>>().Get();
         const Napi::ArrayBuffer dataBuffer = info[1].As<Napi::ArrayBuffer>();
         const uint32_t dataByteOffset = info[2].As<Napi::Number>().Uint32Value();
@@ -860,6 +1028,36 @@ namespace Babylon
         }
     }
 
+    Napi::Value NativeEngine::CreateTransientIndexBuffer(const Napi::CallbackInfo& info)
+    {
+        const bool is32Bits = info[0].As<Napi::Boolean>().Value();
+
+        IndexBuffer* indexBuffer = new IndexBuffer{m_deviceContext, static_cast<uint16_t>(is32Bits ? BGFX_BUFFER_INDEX32 : 0)};
+        return Napi::Pointer<IndexBuffer>::Create(info.Env(), indexBuffer, Napi::NapiPointerDeleter(indexBuffer));
+    }
+
+    Napi::Value NativeEngine::AllocateTransientIndexBuffer(const Napi::CallbackInfo& info)
+    {
+        WaitForCommands(info.Env());
+
+        IndexBuffer* indexBuffer = info[0].As<Napi::Pointer<IndexBuffer>>().Get();
+        const Napi::ArrayBuffer dataBuffer = info[1].As<Napi::ArrayBuffer>();
+        const uint32_t dataByteOffset = info[2].As<Napi::Number>().Uint32Value();
+        const uint32_t dataByteLength = info[3].As<Napi::Number>().Uint32Value();
+
+        // Keep the frame from ending until the JavaScript that draws the indices has run.
+        GetUpdateToken();
+
+        try
+        {
+            return Napi::Boolean::New(info.Env(), indexBuffer->AllocateTransient(gsl::make_span(static_cast<uint8_t*>(dataBuffer.Data()) + dataByteOffset, dataByteLength)));
+        }
+        catch (const std::exception& ex)
+        {
+            throw Napi::Error::New(info.Env(), ex.what());
+        }
+    }
+
     Napi::Value NativeEngine::CreateVertexBuffer(const Napi::CallbackInfo& info)
     {
         const Napi::ArrayBuffer dataBuffer = info[0].As<Napi::ArrayBuffer>();
@@ -867,7 +1065,13 @@ namespace Babylon
         const uint32_t dataByteLength = info[2].As<Napi::Number>().Uint32Value();
         const bool dynamic = info[3].As<Napi::Boolean>().Value();
 
-        VertexBuffer* vertexBuffer = new VertexBuffer(m_deviceContext, gsl::make_span(static_cast<uint8_t*>(dataBuffer.Data()) + dataByteOffset, dataByteLength), dynamic);
+        const bool referenceBytes = m_geometryReferencesEnabled && !dynamic;
+        VertexBuffer* vertexBuffer = new VertexBuffer(m_deviceContext, gsl::make_span(static_cast<uint8_t*>(dataBuffer.Data()) + dataByteOffset, dataByteLength), dynamic, referenceBytes);
+        if (referenceBytes)
+        {
+            ReferenceGeometryBytes(vertexBuffer->WhenBytesReleased(), dataBuffer);
+        }
+
         return Napi::Pointer<VertexBuffer>::Create(info.Env(), vertexBuffer, Napi::NapiPointerDeleter(vertexBuffer));
     }
 
@@ -878,6 +1082,8 @@ namespace Babylon
 
     void NativeEngine::RecordVertexBuffer(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         VertexArray* vertexArray = info[0].As<Napi::Pointer<VertexArray>>().Get();
         VertexBuffer* vertexBuffer = info[1].As<Napi::Pointer<VertexBuffer>>().Get();
         const uint32_t location = info[2].As<Napi::Number>().Uint32Value();
@@ -927,6 +1133,8 @@ namespace Babylon
 
     void NativeEngine::UpdateDynamicVertexBuffer(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         VertexBuffer* vertexBuffer = info[0].As<Napi::Pointer<VertexBuffer>>().Get();
         const Napi::ArrayBuffer dataBuffer = info[1].As<Napi::ArrayBuffer>();
         const uint32_t dataByteOffset = info[2].As<Napi::Number>().Uint32Value();
@@ -947,76 +1155,71 @@ namespace Babylon
         }
     }
 
-    // Change VS output coordinate system
-    std::string NativeEngine::ProcessShaderCoordinates(const std::string& vertexSource)
+    Napi::Value NativeEngine::CreateTransientVertexBuffer(const Napi::CallbackInfo& info)
     {
-        const auto* caps = bgfx::getCaps();
-        // patching shader code to append clip space coordinates for the current rendering API
-        // Can be done with glslang shader traversal. Done with string patching for now.
-        if (!caps->homogeneousDepth)
+        const uint32_t byteStride = info[0].As<Napi::Number>().Uint32Value();
+        if (byteStride == 0 || byteStride > std::numeric_limits<uint16_t>::max())
         {
-            std::string patchedVertexSource;
-            const auto lastClosingCurly = vertexSource.find_last_of('}');
-            patchedVertexSource = vertexSource.substr(0, lastClosingCurly);
-
-            patchedVertexSource += "gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0; }";
-            return patchedVertexSource;
+            throw Napi::Error::New(info.Env(), "Transient vertex buffer byte stride must be between 1 and 65535");
         }
-        return vertexSource;
+
+        VertexBuffer* vertexBuffer = new VertexBuffer{m_deviceContext, byteStride};
+        return Napi::Pointer<VertexBuffer>::Create(info.Env(), vertexBuffer, Napi::NapiPointerDeleter(vertexBuffer));
     }
 
-    std::string ProcessSamplerFlip(const std::string& vertexSource)
+    Napi::Value NativeEngine::AllocateTransientVertexBuffer(const Napi::CallbackInfo& info)
     {
-        const auto* caps = bgfx::getCaps();
-        // for d3d, vulkan, metal, flip the texture sampling on vertical axis
-        if (!caps->originBottomLeft)
-        {
-            std::string patchedVertexSource = vertexSource;
+        WaitForCommands(info.Env());
 
-            static const std::string shaderNameDefineStr = "#define SHADER_NAME";
-            const auto shaderNameDefine = vertexSource.find(shaderNameDefineStr);
-            if (shaderNameDefine != std::string::npos)
-            {
-                static const auto textureSamplerFunctions = R"(
-                    highp vec2 flip(highp vec2 uv)
-                    {
-                        return vec2(uv.x, 1. - uv.y);
-                    }
-                    highp vec3 flip(highp vec3 uv)
-                    {
-                        return uv;
-                    }
-                    #define texture(x,y) texture(x, flip(y))
-                    #define textureLod(x,y,z) textureLod(x, flip(y), z)
-                    #define SHADER_NAME)";
+        VertexBuffer* vertexBuffer = info[0].As<Napi::Pointer<VertexBuffer>>().Get();
+        const Napi::ArrayBuffer dataBuffer = info[1].As<Napi::ArrayBuffer>();
+        const uint32_t dataByteOffset = info[2].As<Napi::Number>().Uint32Value();
+        const uint32_t dataByteLength = info[3].As<Napi::Number>().Uint32Value();
 
-                patchedVertexSource.replace(shaderNameDefine, shaderNameDefineStr.length(), textureSamplerFunctions);
-            }
-            return patchedVertexSource;
+        // Keep the frame from ending until the JavaScript that draws the vertices has run.
+        GetUpdateToken();
+
+        try
+        {
+            return Napi::Boolean::New(info.Env(), vertexBuffer->AllocateTransient(gsl::make_span(static_cast<uint8_t*>(dataBuffer.Data()) + dataByteOffset, dataByteLength)));
+        }
+        catch (const std::exception& ex)
+        {
+            throw Napi::Error::New(info.Env(), ex.what());
         }
-        return vertexSource;
     }
 
-    std::unique_ptr<ProgramData> NativeEngine::CreateProgramInternal(const std::string vertexSource, const std::string fragmentSource)
+    void NativeEngine::SetGeometryReferencesEnabled(const Napi::CallbackInfo& info)
+    {
+        m_geometryReferencesEnabled = info[0].As<Napi::Boolean>().Value();
+    }
+
+    ShaderCompiler::BgfxShaderInfo NativeEngine::CompileProgramShaders(ShaderCompiler& compiler, const std::string& vertexSource, const std::string& fragmentSource)
     {
-        arcana::trace_region region{"NativeEngine::CreateProgramInternal"};
-        const ShaderCompiler::BgfxShaderInfo* shaderInfo{};
-        ShaderCompiler::BgfxShaderInfo bgfxShaderInfo{};
         if (ShaderCacheImpl::GetImpl())
         {
-            shaderInfo = ShaderCacheImpl::GetImpl()->GetShader(vertexSource, fragmentSource);
+            if (const auto* shaderInfo{ShaderCacheImpl::GetImpl()->GetShader(vertexSource, fragmentSource)})
+            {
+                return *shaderInfo;
+            }
         }
 
-        if (!shaderInfo)
+        const auto* caps{bgfx::getCaps()};
+        auto bgfxShaderInfo{compiler.Compile(
+            ShaderCompilerCommon::ProcessShaderCoordinates(vertexSource, caps->homogeneousDepth),
+            ShaderCompilerCommon::ProcessSamplerFlip(fragmentSource, caps->originBottomLeft))};
+        if (ShaderCacheImpl::GetImpl())
         {
-            bgfxShaderInfo = m_shaderCompiler.Compile(ProcessShaderCoordinates(vertexSource), ProcessSamplerFlip(fragmentSource));
-            if (ShaderCacheImpl::GetImpl())
-            {
-                ShaderCacheImpl::GetImpl()->AddShader(vertexSource, fragmentSource, bgfxShaderInfo);
-            } 
-            shaderInfo = &bgfxShaderInfo;
+            ShaderCacheImpl::GetImpl()->AddShader(vertexSource, fragmentSource, bgfxShaderInfo);
         }
 
+        return bgfxShaderInfo;
+    }
+
+    std::unique_ptr<ProgramData> NativeEngine::CreateProgramInternal(const ShaderCompiler::BgfxShaderInfo& shaderInfo)
+    {
+        arcana::trace_region region{"NativeEngine::CreateProgramInternal"};
+
         static auto InitUniformInfos{
             [](bgfx::ShaderHandle shader, const std::unordered_map<std::string, uint8_t>& uniformStages, std::unordered_map<uint16_t, UniformInfo>& uniformInfos, std::unordered_map<std::string, uint16_t>& uniformNameToIndex) {
                 auto numUniforms = bgfx::getShaderUniforms(shader);
@@ -1030,20 +1233,22 @@ namespace Babylon
                     bgfx::getUniformInfo(uniforms[index], info);
                     auto itStage = uniformStages.find(info.name);
                     auto& handle = uniforms[index];
-                    uniformInfos.emplace(std::make_pair(handle.idx, UniformInfo{itStage == uniformStages.end() ? uint8_t{} : itStage->second, handle, info.num}));
+                    uniformInfos.emplace(std::make_pair(handle.idx, UniformInfo{itStage == uniformStages.end() ? uint8_t{} : itStage->second, handle, info.num, GetUniformElementSize(info.type)}));
                     uniformNameToIndex[info.name] = handleIndex;
                 }
             } };
 
         std::unique_ptr<ProgramData> program = std::make_unique<ProgramData>(m_deviceContext);
-        auto vertexShader = bgfx::createShader(bgfx::copy(shaderInfo->VertexBytes.data(), static_cast<uint32_t>(shaderInfo->VertexBytes.size())));
-        InitUniformInfos(vertexShader, shaderInfo->UniformStages, program->UniformInfos, program->UniformNameToIndex);
+        auto vertexShader = bgfx::createShader(bgfx::copy(shaderInfo.VertexBytes.data(), static_cast<uint32_t>(shaderInfo.VertexBytes.size())));
+        InitUniformInfos(vertexShader, shaderInfo.UniformStages, program->UniformInfos, program->UniformNameToIndex);
 
-        auto fragmentShader = bgfx::createShader(bgfx::copy(shaderInfo->FragmentBytes.data(), static_cast<uint32_t>(shaderInfo->FragmentBytes.size())));
-        InitUniformInfos(fragmentShader, shaderInfo->UniformStages, program->UniformInfos, program->UniformNameToIndex);
+        auto fragmentShader = bgfx::createShader(bgfx::copy(shaderInfo.FragmentBytes.data(), static_cast<uint32_t>(shaderInfo.FragmentBytes.size())));
+        InitUniformInfos(fragmentShader, shaderInfo.UniformStages, program->UniformInfos, program->UniformNameToIndex);
+
+        program->LayoutUniforms();
 
         program->Handle = bgfx::createProgram(vertexShader, fragmentShader, true);
-        program->VertexAttributeLocations = std::move(shaderInfo->VertexAttributeLocations);
+        program->VertexAttributeLocations = shaderInfo.VertexAttributeLocations;
 
         return program;
     }
@@ -1056,7 +1261,11 @@ namespace Babylon
         Napi::Value jsProgram = Napi::Pointer<ProgramData>::Create(info.Env(), program, Napi::NapiPointerDeleter(program));
         try
         {
-            *program = std::move(*CreateProgramInternal(vertexSource, fragmentSource));
+            const auto shaderInfo{m_shaderCompilationService->Compile(vertexSource, fragmentSource,
+                [vertexSource, fragmentSource](ShaderCompiler& compiler) {
+                    return CompileProgramShaders(compiler, vertexSource, fragmentSource);
+                })};
+            *program = std::move(*CreateProgramInternal(*shaderInfo));
         }
         catch (const std::exception& ex)
         {
@@ -1071,29 +1280,42 @@ namespace Babylon
         const std::string fragmentSource = info[1].As<Napi::String>().Utf8Value();
         const Napi::Function onSuccess = info[2].As<Napi::Function>();
         const Napi::Function onError = info[3].As<Napi::Function>();
+        // Optional priority, higher values are compiled first (e.g. for materials of visible meshes).
+        const int32_t priority = info[4].IsUndefined() ? 0 : info[4].As<Napi::Number>().Int32Value();
 
         ProgramData* program = new ProgramData{m_deviceContext};
         Napi::Value jsProgram = Napi::Pointer<ProgramData>::Create(info.Env(), program, Napi::NapiPointerDeleter(program));
 
-        arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource,
-            [this, vertexSource, fragmentSource, cancellationSource{m_cancellationSource}]() -> std::unique_ptr<ProgramData> {
-                return CreateProgramInternal(vertexSource, fragmentSource);
+        m_shaderCompilationService->CompileAsync(vertexSource, fragmentSource, priority,
+            [vertexSource, fragmentSource](ShaderCompiler& compiler) {
+                return CompileProgramShaders(compiler, vertexSource, fragmentSource);
             })
+            // The compilation service is shared with other engines and can outlive this one, so the program is created on
+            // the JavaScript thread where the engine cannot be disposed concurrently.
             .then(m_runtimeScheduler, *m_cancellationSource,
-                [program,
+                [this,
+                    program,
                     jsProgramRef{Napi::Persistent(jsProgram)},
                     onSuccessRef{Napi::Persistent(onSuccess)},
                     onErrorRef{Napi::Persistent(onError)},
-                    cancellationSource{m_cancellationSource}](const arcana::expected<std::unique_ptr<ProgramData>, std::exception_ptr>& result) {
+                    cancellationSource{m_cancellationSource}](const arcana::expected<ShaderCompilationService::ShaderInfoPtr, std::exception_ptr>& result) {
                     if (result.has_error())
                     {
                         onErrorRef.Call({Napi::Error::New(onErrorRef.Env(), result.error()).Value()});
+                        return;
+                    }
+
+                    try
+                    {
+                        *program = std::move(*CreateProgramInternal(*result.value()));
                     }
-                    else
+                    catch (const std::exception& ex)
                     {
-                        *program = std::move(*result.value());
-                        onSuccessRef.Call({});
+                        onErrorRef.Call({Napi::Error::New(onErrorRef.Env(), ex.what()).Value()});
+                        return;
                     }
+
+                    onSuccessRef.Call({});
                 });
 
         return jsProgram;
@@ -1101,6 +1323,8 @@ namespace Babylon
 
     Napi::Value NativeEngine::GetUniforms(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         const ProgramData* program = info[0].As<Napi::Pointer<ProgramData>>().Get();
         const Napi::Array names = info[1].As<Napi::Array>();
 
@@ -1177,7 +1401,13 @@ namespace Babylon
 
     void NativeEngine::DeleteProgram(NativeDataStream::Reader& data)
     {
-        data.ReadPointer<ProgramData>()->Dispose();
+        ProgramData* program{data.ReadPointer<ProgramData>()};
+        if (program == m_lastDrawProgram)
+        {
+            m_lastDrawProgram = nullptr;
+        }
+
+        program->Dispose();
     }
 
     void NativeEngine::SetZOffset(NativeDataStream::Reader& data)
@@ -1226,11 +1456,90 @@ namespace Babylon
         m_engineState |= blendMode;
     }
 
-    void NativeEngine::SetInt(NativeDataStream::Reader& data)
+    void NativeEngine::SetUniforms(NativeDataStream::Reader& data)
+    {
+        // Applies a block of (uniform, type, payload) records in a single command. The single uniform commands call their
+        // setter directly rather than going through the type dispatch.
+        const auto count{data.ReadUint32()};
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            const auto& uniformInfo{*data.ReadPointer<UniformInfo>()};
+            const auto type{data.ReadUint32()};
+            SetUniformValue(uniformInfo, type, data);
+        }
+    }
+
+    void NativeEngine::SetUniformValue(const UniformInfo& uniformInfo, uint32_t type, NativeDataStream::Reader& data)
+    {
+        switch (type)
+        {
+            case UniformType::INT:
+                SetIntValue(uniformInfo, data);
+                break;
+            case UniformType::INTARRAY:
+                SetIntArrayN<1>(uniformInfo, data);
+                break;
+            case UniformType::INTARRAY2:
+                SetIntArrayN<2>(uniformInfo, data);
+                break;
+            case UniformType::INTARRAY3:
+                SetIntArrayN<3>(uniformInfo, data);
+                break;
+            case UniformType::INTARRAY4:
+                SetIntArrayN<4>(uniformInfo, data);
+                break;
+            case UniformType::FLOATARRAY:
+                SetFloatArrayN<1>(uniformInfo, data);
+                break;
+            case UniformType::FLOATARRAY2:
+                SetFloatArrayN<2>(uniformInfo, data);
+                break;
+            case UniformType::FLOATARRAY3:
+                SetFloatArrayN<3>(uniformInfo, data);
+                break;
+            case UniformType::FLOATARRAY4:
+                SetFloatArrayN<4>(uniformInfo, data);
+                break;
+            case UniformType::MATRICES:
+                SetMatricesValue(uniformInfo, data);
+                break;
+            case UniformType::MATRIX2X2:
+                SetMatrixN<2>(uniformInfo, data);
+                break;
+            case UniformType::MATRIX3X3:
+                SetMatrixN<3>(uniformInfo, data);
+                break;
+            case UniformType::MATRIX:
+                SetMatrixN<4>(uniformInfo, data);
+                break;
+            case UniformType::FLOAT:
+                SetFloatN<1>(uniformInfo, data);
+                break;
+            case UniformType::FLOAT2:
+                SetFloatN<2>(uniformInfo, data);
+                break;
+            case UniformType::FLOAT3:
+                SetFloatN<3>(uniformInfo, data);
+                break;
+            case UniformType::FLOAT4:
+                SetFloatN<4>(uniformInfo, data);
+                break;
+            default:
+                throw std::runtime_error{"Invalid uniform type"};
+        }
+    }
+
+    void NativeEngine::SetIntValue(const UniformInfo& uniformInfo, NativeDataStream::Reader& data)
     {
-        const auto& uniformInfo{*data.ReadPointer<UniformInfo>()};
         const auto value{static_cast<float>(data.ReadInt32())};
-        m_currentProgram->SetUniform(uniformInfo.Handle, gsl::make_span(&value, 1));
+        m_currentProgram->SetUniform(uniformInfo, gsl::make_span(&value, 1));
+    }
+
+    void NativeEngine::SetMatricesValue(const UniformInfo& uniformInfo, NativeDataStream::Reader& data)
+    {
+        const auto matrices{data.ReadFloat32Array()};
+        assert(matrices.size() % 16 == 0);
+        m_currentProgram->SetUniform(uniformInfo, matrices, matrices.size() / 16);
     }
 
     template<int size, typename arrayType>
@@ -1248,13 +1557,12 @@ namespace Babylon
             m_scratch.insert(m_scratch.end(), values, values + 4);
         }
 
-        m_currentProgram->SetUniform(uniformInfo.Handle, m_scratch, elementLength / size);
+        m_currentProgram->SetUniform(uniformInfo, m_scratch, elementLength / size);
     }
 
     template<int size>
-    void NativeEngine::SetFloatN(NativeDataStream::Reader& data)
+    void NativeEngine::SetFloatN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data)
     {
-        const auto& uniformInfo = *data.ReadPointer<UniformInfo>();
         const float values[] = {
             data.ReadFloat32(),
             (size > 1) ? data.ReadFloat32() : 0.f,
@@ -1262,13 +1570,12 @@ namespace Babylon
             (size > 3) ? data.ReadFloat32() : 0.f,
         };
 
-        m_currentProgram->SetUniform(uniformInfo.Handle, values);
+        m_currentProgram->SetUniform(uniformInfo, values);
     }
 
     template<int size>
-    void NativeEngine::SetMatrixN(NativeDataStream::Reader& data)
+    void NativeEngine::SetMatrixN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data)
     {
-        const auto& uniformInfo{*data.ReadPointer<UniformInfo>()};
         const auto matrix{data.ReadFloat32Array()};
 
         assert(matrix.size() == size * size);
@@ -1284,113 +1591,111 @@ namespace Babylon
                     matrixValues[line * 4 + col] = matrix[index++];
                 }
             }
-            m_currentProgram->SetUniform(uniformInfo.Handle, matrixValues);
+            m_currentProgram->SetUniform(uniformInfo, matrixValues);
         }
         else
         {
-            m_currentProgram->SetUniform(uniformInfo.Handle, matrix);
+            m_currentProgram->SetUniform(uniformInfo, matrix);
         }
     }
 
     template<int size>
-    void NativeEngine::SetIntArrayN(NativeDataStream::Reader& data)
+    void NativeEngine::SetIntArrayN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data)
     {
-        const auto& uniformInfo{*data.ReadPointer<UniformInfo>()};
         const auto array{data.ReadInt32Array()};
         SetTypeArrayN<size>(uniformInfo, static_cast<uint32_t>(array.size()), array);
     }
 
+    template<int size>
+    void NativeEngine::SetFloatArrayN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data)
+    {
+        const auto array{data.ReadFloat32Array()};
+        SetTypeArrayN<size>(uniformInfo, static_cast<uint32_t>(array.size()), array);
+    }
+
+    void NativeEngine::SetInt(NativeDataStream::Reader& data)
+    {
+        SetIntValue(*data.ReadPointer<UniformInfo>(), data);
+    }
+
     void NativeEngine::SetIntArray(NativeDataStream::Reader& data)
     {
-        SetIntArrayN<1>(data);
+        SetIntArrayN<1>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetIntArray2(NativeDataStream::Reader& data)
     {
-        SetIntArrayN<2>(data);
+        SetIntArrayN<2>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetIntArray3(NativeDataStream::Reader& data)
     {
-        SetIntArrayN<3>(data);
+        SetIntArrayN<3>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetIntArray4(NativeDataStream::Reader& data)
     {
-        SetIntArrayN<4>(data);
-    }
-
-    template<int size>
-    void NativeEngine::SetFloatArrayN(NativeDataStream::Reader& data)
-    {
-        const auto& uniformInfo{*data.ReadPointer<UniformInfo>()};
-        const auto array{data.ReadFloat32Array()};
-        SetTypeArrayN<size>(uniformInfo, static_cast<uint32_t>(array.size()), array);
+        SetIntArrayN<4>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloatArray(NativeDataStream::Reader& data)
     {
-        SetFloatArrayN<1>(data);
+        SetFloatArrayN<1>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloatArray2(NativeDataStream::Reader& data)
     {
-        SetFloatArrayN<2>(data);
+        SetFloatArrayN<2>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloatArray3(NativeDataStream::Reader& data)
     {
-        SetFloatArrayN<3>(data);
+        SetFloatArrayN<3>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloatArray4(NativeDataStream::Reader& data)
     {
-        SetFloatArrayN<4>(data);
+        SetFloatArrayN<4>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetMatrices(NativeDataStream::Reader& data)
     {
-        auto& uniform{*data.ReadPointer<UniformInfo>()};
-        auto matrices{data.ReadFloat32Array()};
-
-        assert(matrices.size() % 16 == 0);
-
-        m_currentProgram->SetUniform(uniform.Handle, matrices, matrices.size() / 16);
+        SetMatricesValue(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetMatrix2x2(NativeDataStream::Reader& data)
     {
-        SetMatrixN<2>(data);
+        SetMatrixN<2>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetMatrix3x3(NativeDataStream::Reader& data)
     {
-        SetMatrixN<3>(data);
+        SetMatrixN<3>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetMatrix(NativeDataStream::Reader& data)
     {
-        SetMatrixN<4>(data);
+        SetMatrixN<4>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloat(NativeDataStream::Reader& data)
     {
-        SetFloatN<1>(data);
+        SetFloatN<1>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloat2(NativeDataStream::Reader& data)
     {
-        SetFloatN<2>(data);
+        SetFloatN<2>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloat3(NativeDataStream::Reader& data)
     {
-        SetFloatN<3>(data);
+        SetFloatN<3>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     void NativeEngine::SetFloat4(NativeDataStream::Reader& data)
     {
-        SetFloatN<4>(data);
+        SetFloatN<4>(*data.ReadPointer<UniformInfo>(), data);
     }
 
     Napi::Value NativeEngine::CreateTexture(const Napi::CallbackInfo& info)
@@ -1401,6 +1706,8 @@ namespace Babylon
 
     void NativeEngine::InitializeTexture(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         const auto texture = info[0].As<Napi::Pointer<Graphics::Texture>>().Get();
         const uint16_t width = static_cast<uint16_t>(info[1].As<Napi::Number>().Uint32Value());
         const uint16_t height = static_cast<uint16_t>(info[2].As<Napi::Number>().Uint32Value());
@@ -1435,13 +1742,41 @@ namespace Babylon
 
         const auto dataSpan = gsl::make_span(static_cast<uint8_t*>(data.ArrayBuffer().Data()) + data.ByteOffset(), data.ByteLength());
 
-        arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource,
-            [dataSpan, generateMips, invertY, srgb, texture, cancellationSource{m_cancellationSource}]() {
-                arcana::trace_region loadRegion{"NativeEngine::LoadTexture"};
-                bimg::ImageContainer* image{ParseImage(Graphics::DeviceContext::GetDefaultAllocator(), dataSpan)};
-                image = PrepareImage(Graphics::DeviceContext::GetDefaultAllocator(), image, invertY, srgb, generateMips);
-                LoadTextureFromImage(texture, image, srgb);
-            })
+        // Cached textures are shared, so they are neither streamed nor reloaded to stay within the texture memory budget.
+        if (m_textureCache.IsEnabled())
+        {
+            LoadCachedTexture(texture, {data}, false, invertY, srgb, generateMips, onSuccess, onError, [this, dataSpan, generateMips, invertY, srgb](Graphics::Texture* target) {
+                return LoadTextureAsync(target, dataSpan, generateMips, invertY, srgb);
+            });
+            return;
+        }
+
+        // Keeps the encoded data so that the texture can be reloaded at a lower or full resolution to stay within the
+        // texture memory budget, unless the data kept for other textures already reaches its limit.
+        if (m_deviceContext.GetTextureMemoryBudget() > 0 && m_deviceContext.AddTextureReloadSource(dataSpan.size()))
+        {
+            const auto source{std::make_shared<TextureReloadSource>(m_deviceContext, dataSpan, generateMips, invertY, srgb)};
+            texture->SetReloadCallback([this, source](Graphics::Texture& reloadedTexture, uint8_t skippedMips) {
+                ReloadTexture(reloadedTexture, source, skippedMips);
+            });
+        }
+
+        arcana::task<void, std::exception_ptr> loadTask{};
+        if (m_textureStreamer.GetBudget() > 0)
+        {
+            loadTask = arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource,
+                [this, dataSpan, generateMips, invertY, srgb, texture, cancellationSource{m_cancellationSource}]() {
+                    arcana::trace_region loadRegion{"NativeEngine::LoadTexture"};
+                    bimg::ImageContainer* image{LoadImage(Graphics::DeviceContext::GetDefaultAllocator(), dataSpan, invertY, srgb, false)};
+                    return StreamImage(m_textureStreamer, texture, image, srgb, generateMips);
+                });
+        }
+        else
+        {
+            loadTask = LoadTextureAsync(texture, dataSpan, generateMips, invertY, srgb);
+        }
+
+        loadTask
             .then(m_runtimeScheduler, *m_cancellationSource, [dataRef{Napi::Persistent(data)}, onSuccessRef{Napi::Persistent(onSuccess)}, onErrorRef{Napi::Persistent(onError)}, cancellationSource{m_cancellationSource}](arcana::expected<void, std::exception_ptr> result) {
                 if (result.has_error())
                 {
@@ -1454,6 +1789,141 @@ namespace Babylon
             });
     }
 
+    arcana::task<void, std::exception_ptr> NativeEngine::LoadTextureAsync(Graphics::Texture* target, gsl::span<uint8_t> data, bool generateMips, bool invertY, bool srgb)
+    {
+        // Generating the mips on the GPU creates the texture again, which is only done from the thread pool for
+        // textures that are not in use yet.
+        const bool gpuMips{!target->IsValid() || target->IsShared()};
+        return arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource,
+            [data, generateMips, invertY, srgb, gpuMips, target, cancellationSource{m_cancellationSource}]() {
+                arcana::trace_region loadRegion{"NativeEngine::LoadTexture"};
+                bimg::ImageContainer* image{LoadImage(Graphics::DeviceContext::GetDefaultAllocator(), data, invertY, srgb, generateMips, gpuMips)};
+                return LoadTextureFromImage(target, image, srgb, generateMips, gpuMips);
+            })
+            .then(m_runtimeScheduler, *m_cancellationSource, [this, target, cancellationSource{m_cancellationSource}](bool generateMipsOnGpu) {
+                if (generateMipsOnGpu)
+                {
+                    WaitForCommands(Env());
+                    target->GenerateMips(*GetUpdateToken().GetEncoder());
+                }
+            });
+    }
+
+    void NativeEngine::LoadCachedTexture(Graphics::Texture* texture, const std::vector<Napi::TypedArray>& data, bool cube, bool invertY, bool srgb, bool generateMips, Napi::Function onSuccess, Napi::Function onError, std::function<arcana::task<void, std::exception_ptr>(Graphics::Texture*)> load)
+    {
+        std::vector<gsl::span<const uint8_t>> images{};
+        const auto dataRefs{std::make_shared<std::vector<Napi::Reference<Napi::TypedArray>>>()};
+        for (const auto& typedArray : data)
+        {
+            images.emplace_back(static_cast<const uint8_t*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset(), typedArray.ByteLength());
+            dataRefs->push_back(Napi::Persistent(typedArray));
+        }
+
+        const auto onSuccessRef{std::make_shared<Napi::FunctionReference>(Napi::Persistent(onSuccess))};
+        const auto onErrorRef{std::make_shared<Napi::FunctionReference>(Napi::Persistent(onError))};
+
+        // Hashing large images takes long enough that it is done on the thread pool.
+        arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource, [images, cube, invertY, srgb, generateMips]() {
+            arcana::trace_region hashRegion{"NativeEngine::HashTexture"};
+            return TextureCache::MakeKey(images, cube, invertY, srgb, generateMips);
+        })
+            .then(m_runtimeScheduler, *m_cancellationSource, [this, texture, dataRefs, load{std::move(load)}, onSuccessRef, onErrorRef, cancellationSource{m_cancellationSource}](arcana::expected<TextureCache::Key, std::exception_ptr> key) {
+                if (key.has_error())
+                {
+                    onErrorRef->Call({});
+                    return;
+                }
+
+                // The cache may have been disabled while the images were hashed.
+                const auto result{m_textureCache.Acquire(key.value(), CreateTextureCacheCallback(texture, onSuccessRef, onErrorRef))};
+                if (result == TextureCache::AcquireResult::Cached)
+                {
+                    return;
+                }
+
+                const auto cachedTexture{result == TextureCache::AcquireResult::Load ? std::make_shared<Graphics::Texture>(m_deviceContext) : nullptr};
+                load(cachedTexture ? cachedTexture.get() : texture)
+                    .then(m_runtimeScheduler, *m_cancellationSource, [this, key{key.value()}, cachedTexture, dataRefs, onSuccessRef, onErrorRef, cancellationSource{m_cancellationSource}](arcana::expected<void, std::exception_ptr> result) {
+                        if (cachedTexture)
+                        {
+                            m_textureCache.Complete(key, result.has_error() ? nullptr : cachedTexture);
+                        }
+                        else if (result.has_error())
+                        {
+                            onErrorRef->Call({});
+                        }
+                        else
+                        {
+                            onSuccessRef->Call({});
+                        }
+                    });
+            });
+    }
+
+    TextureCache::Callback NativeEngine::CreateTextureCacheCallback(Graphics::Texture* texture, std::shared_ptr<Napi::FunctionReference> onSuccessRef, std::shared_ptr<Napi::FunctionReference> onErrorRef)
+    {
+        // The callback is called from within the load on a hit, so it completes the load later like the other loads.
+        return [this, texture, onSuccessRef, onErrorRef](const TextureCache::TexturePtr& cachedTexture) {
+            arcana::make_task(m_runtimeScheduler, *m_cancellationSource, [this, texture, cachedTexture, onSuccessRef, onErrorRef, cancellationSource{m_cancellationSource}]() {
+                if (!cachedTexture)
+                {
+                    onErrorRef->Call({});
+                    return;
+                }
+
+                WaitForCommands(Env());
+                texture->AttachShared(cachedTexture);
+                onSuccessRef->Call({});
+            });
+        };
+    }
+
+    NativeEngine::TextureReloadSource::TextureReloadSource(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> data, bool generateMips, bool invertY, bool srgb)
+        : Context{deviceContext}
+        , Data{data.begin(), data.end()}
+        , GenerateMips{generateMips}
+        , InvertY{invertY}
+        , Srgb{srgb}
+    {
+    }
+
+    NativeEngine::TextureReloadSource::~TextureReloadSource()
+    {
+        Context.RemoveTextureReloadSource(Data.size());
+    }
+
+    void NativeEngine::ReloadTexture(Graphics::Texture& texture, std::weak_ptr<TextureReloadSource> source, uint8_t skippedMips)
+    {
+        // The source is owned by the reload callback of the texture, so it expires once the texture is destroyed or loaded again.
+        arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource, [source, skippedMips]() -> bimg::ImageContainer* {
+            arcana::trace_region reloadRegion{"NativeEngine::ReloadTexture"};
+            const auto lockedSource{source.lock()};
+            if (!lockedSource)
+            {
+                return nullptr;
+            }
+
+            bimg::ImageContainer* image{LoadImage(Graphics::DeviceContext::GetDefaultAllocator(), lockedSource->Data, lockedSource->InvertY, lockedSource->Srgb, lockedSource->GenerateMips)};
+            return DropLargestMips(Graphics::DeviceContext::GetDefaultAllocator(), image, skippedMips);
+        })
+            .then(m_runtimeScheduler, *m_cancellationSource, [this, &texture, source, cancellationSource{m_cancellationSource}](bimg::ImageContainer* image) {
+                const auto lockedSource{source.lock()};
+                if (!lockedSource || !texture.IsValid())
+                {
+                    if (image != nullptr)
+                    {
+                        bimg::imageFree(image);
+                    }
+
+                    return;
+                }
+
+                WaitForCommands(Env());
+                texture.Dispose();
+                LoadTextureFromImage(&texture, image, lockedSource->Srgb);
+            });
+    }
+
     void NativeEngine::CopyTexture(NativeDataStream::Reader& data)
     {
         bgfx::Encoder* encoder = GetUpdateToken().GetEncoder();
@@ -1466,6 +1936,8 @@ namespace Babylon
 
     void NativeEngine::LoadRawTexture(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         const auto texture{info[0].As<Napi::Pointer<Graphics::Texture>>().Get()};
         const auto data{info[1].As<Napi::TypedArray>()};
         const auto width{static_cast<uint16_t>(info[2].As<Napi::Number>().Uint32Value())};
@@ -1480,13 +1952,21 @@ namespace Babylon
             throw Napi::Error::New(Env(), "The data size does not match width, height, and format");
         }
 
+        // Textures that are already valid are updated in place, so their mips are generated on the CPU.
+        const bool gpuMips{!texture->IsValid() || texture->IsShared()};
+
         bimg::ImageContainer* image{bimg::imageAlloc(&Graphics::DeviceContext::GetDefaultAllocator(), format, width, height, 1, 1, false, false, bytes)};
-        image = PrepareImage(Graphics::DeviceContext::GetDefaultAllocator(), image, invertY, false, generateMips);
-        LoadTextureFromImage(texture, image, false);
+        image = PrepareImage(Graphics::DeviceContext::GetDefaultAllocator(), image, invertY, false, generateMips, gpuMips);
+        if (LoadTextureFromImage(texture, image, false, generateMips, gpuMips))
+        {
+            texture->GenerateMips(*GetUpdateToken().GetEncoder());
+        }
     }
 
     void NativeEngine::LoadRawTexture2DArray(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         const auto texture{info[0].As<Napi::Pointer<Graphics::Texture>>().Get()};
         const auto data = info[1].As<Napi::TypedArray>();
         const auto width{static_cast<uint16_t>(info[2].As<Napi::Number>().Uint32Value())};
@@ -1540,24 +2020,34 @@ namespace Babylon
         const auto onSuccess{info[5].As<Napi::Function>()};
         const auto onError{info[6].As<Napi::Function>()};
 
-        std::array<Napi::Reference<Napi::TypedArray>, 6> dataRefs;
-        std::array<arcana::task<bimg::ImageContainer*, std::exception_ptr>, 6> tasks;
+        std::array<gsl::span<uint8_t>, 6> dataSpans;
         for (uint32_t face = 0; face < data.Length(); face++)
         {
             const auto typedArray{data[face].As<Napi::TypedArray>()};
-            const auto dataSpan{gsl::make_span(static_cast<uint8_t*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset(), typedArray.ByteLength())};
-            dataRefs[face] = Napi::Persistent(typedArray);
-            tasks[face] = arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource, [dataSpan, invertY, generateMips, srgb]() {
-                bimg::ImageContainer* image{ParseImage(Graphics::DeviceContext::GetDefaultAllocator(), dataSpan)};
-                image = PrepareImage(Graphics::DeviceContext::GetDefaultAllocator(), image, invertY, srgb, generateMips);
-                return image;
+            dataSpans[face] = gsl::make_span(static_cast<uint8_t*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset(), typedArray.ByteLength());
+        }
+
+        if (m_textureCache.IsEnabled())
+        {
+            std::vector<Napi::TypedArray> typedArrays{};
+            for (uint32_t face = 0; face < data.Length(); face++)
+            {
+                typedArrays.push_back(data[face].As<Napi::TypedArray>());
+            }
+
+            LoadCachedTexture(texture, typedArrays, true, invertY, srgb, generateMips, onSuccess, onError, [this, dataSpans, generateMips, invertY, srgb](Graphics::Texture* target) {
+                return LoadCubeTextureAsync(target, dataSpans, generateMips, invertY, srgb);
             });
+            return;
         }
 
-        arcana::when_all(gsl::make_span(tasks))
-            .then(arcana::inline_scheduler, *m_cancellationSource, [texture, srgb, cancellationSource{m_cancellationSource}](std::vector<bimg::ImageContainer*> images) {
-                LoadCubeTextureFromImages(texture, images, srgb);
-            })
+        std::array<Napi::Reference<Napi::TypedArray>, 6> dataRefs;
+        for (uint32_t face = 0; face < data.Length(); face++)
+        {
+            dataRefs[face] = Napi::Persistent(data[face].As<Napi::TypedArray>());
+        }
+
+        LoadCubeTextureAsync(texture, dataSpans, generateMips, invertY, srgb)
             .then(m_runtimeScheduler, *m_cancellationSource, [dataRefs{std::move(dataRefs)}, onSuccessRef{Napi::Persistent(onSuccess)}, onErrorRef{Napi::Persistent(onError)}, cancellationSource{m_cancellationSource}](arcana::expected<void, std::exception_ptr> result) {
                 if (result.has_error())
                 {
@@ -1570,6 +2060,23 @@ namespace Babylon
             });
     }
 
+    arcana::task<void, std::exception_ptr> NativeEngine::LoadCubeTextureAsync(Graphics::Texture* target, const std::array<gsl::span<uint8_t>, 6>& data, bool generateMips, bool invertY, bool srgb)
+    {
+        std::array<arcana::task<bimg::ImageContainer*, std::exception_ptr>, 6> tasks;
+        for (uint32_t face = 0; face < data.size(); face++)
+        {
+            const auto dataSpan{data[face]};
+            tasks[face] = arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource, [dataSpan, invertY, generateMips, srgb]() {
+                return LoadImage(Graphics::DeviceContext::GetDefaultAllocator(), dataSpan, GetCubeFaceInvertY(invertY), srgb, generateMips);
+            });
+        }
+
+        return arcana::when_all(gsl::make_span(tasks))
+            .then(arcana::inline_scheduler, *m_cancellationSource, [target, srgb, cancellationSource{m_cancellationSource}](std::vector<bimg::ImageContainer*> images) {
+                LoadCubeTextureFromImages(target, images, srgb);
+            });
+    }
+
     void NativeEngine::LoadCubeTextureWithMips(const Napi::CallbackInfo& info)
     {
         const auto texture = info[0].As<Napi::Pointer<Graphics::Texture>>().Get();
@@ -1580,6 +2087,12 @@ namespace Babylon
         const auto onError{info[5].As<Napi::Function>()};
 
         const auto numMips{static_cast<size_t>(data.Length())};
+        if (m_textureStreamer.GetBudget() > 0)
+        {
+            StreamCubeTextureWithMips(texture, data, invertY, srgb, onSuccess, onError);
+            return;
+        }
+
         std::vector<Napi::Reference<Napi::TypedArray>> dataRefs(6 * numMips);
         std::vector<arcana::task<bimg::ImageContainer*, std::exception_ptr>> tasks(6 * numMips);
         for (uint32_t mip = 0; mip < numMips; mip++)
@@ -1591,9 +2104,7 @@ namespace Babylon
                 const auto dataSpan = gsl::make_span(static_cast<uint8_t*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset(), typedArray.ByteLength());
                 dataRefs[(face * numMips) + mip] = Napi::Persistent(typedArray);
                 tasks[(face * numMips) + mip] = arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource, [dataSpan, invertY, srgb]() {
-                    bimg::ImageContainer* image{ParseImage(Graphics::DeviceContext::GetDefaultAllocator(), dataSpan)};
-                    image = PrepareImage(Graphics::DeviceContext::GetDefaultAllocator(), image, invertY, srgb, false);
-                    return image;
+                    return LoadImage(Graphics::DeviceContext::GetDefaultAllocator(), dataSpan, GetCubeFaceInvertY(invertY), srgb, false);
                 });
             }
         }
@@ -1614,6 +2125,55 @@ namespace Babylon
             });
     }
 
+    void NativeEngine::StreamCubeTextureWithMips(Graphics::Texture* texture, Napi::Array data, bool invertY, bool srgb, Napi::Function onSuccess, Napi::Function onError)
+    {
+        const auto numMips{static_cast<size_t>(data.Length())};
+        const auto request{m_textureStreamer.CreateRequest(texture, true, static_cast<uint8_t>(numMips), srgb)};
+
+        // Each face of each level is queued for upload as soon as it is decoded, so the smallest levels can be ready
+        // before the largest ones are decoded.
+        std::vector<Napi::Reference<Napi::TypedArray>> dataRefs(6 * numMips);
+        std::vector<arcana::task<void, std::exception_ptr>> tasks(6 * numMips);
+        for (uint32_t mip = 0; mip < numMips; mip++)
+        {
+            const auto faceData = data[mip].As<Napi::Array>();
+            for (uint32_t face = 0; face < 6; face++)
+            {
+                const auto typedArray = faceData[face].As<Napi::TypedArray>();
+                const auto dataSpan = gsl::make_span(static_cast<uint8_t*>(typedArray.ArrayBuffer().Data()) + typedArray.ByteOffset(), typedArray.ByteLength());
+                dataRefs[(face * numMips) + mip] = Napi::Persistent(typedArray);
+                tasks[(face * numMips) + mip] = arcana::make_task(arcana::threadpool_scheduler, *m_cancellationSource,
+                    [this, dataSpan, invertY, srgb, request, face, mip, cancellationSource{m_cancellationSource}]() {
+                        bimg::ImageContainer* image{LoadImage(Graphics::DeviceContext::GetDefaultAllocator(), dataSpan, GetCubeFaceInvertY(invertY), srgb, false)};
+                        m_textureStreamer.QueueImage(request, static_cast<uint8_t>(face), static_cast<uint8_t>(mip), image);
+                    })
+                    .then(arcana::inline_scheduler, *m_cancellationSource, [this, request, cancellationSource{m_cancellationSource}](arcana::expected<void, std::exception_ptr> result) {
+                        if (result.has_error())
+                        {
+                            m_textureStreamer.Fail(request, result.error());
+                        }
+                    });
+            }
+        }
+
+        m_textureStreamer.WhenReady(request)
+            .then(m_runtimeScheduler, *m_cancellationSource, [onSuccessRef{Napi::Persistent(onSuccess)}, onErrorRef{Napi::Persistent(onError)}, cancellationSource{m_cancellationSource}](arcana::expected<void, std::exception_ptr> result) {
+                if (result.has_error())
+                {
+                    onErrorRef.Call({});
+                }
+                else
+                {
+                    onSuccessRef.Call({});
+                }
+            });
+
+        // The data must outlive the decoding of the largest levels, which can still be running once the texture is ready.
+        arcana::when_all(gsl::make_span(tasks))
+            .then(m_runtimeScheduler, *m_cancellationSource, [dataRefs{std::move(dataRefs)}, cancellationSource{m_cancellationSource}](arcana::expected<void, std::exception_ptr>) {
+            });
+    }
+
     Napi::Value NativeEngine::GetTextureWidth(const Napi::CallbackInfo& info)
     {
         const Graphics::Texture* texture = info[0].As<Napi::Pointer<Graphics::Texture>>().Get();
@@ -1686,7 +2246,8 @@ namespace Babylon
         bgfx::Encoder* encoder = GetUpdateToken().GetEncoder();
 
         const UniformInfo* uniformInfo = data.ReadPointer<UniformInfo>();
-        const Graphics::Texture* texture = data.ReadPointer<Graphics::Texture>();
+        Graphics::Texture* texture = data.ReadPointer<Graphics::Texture>();
+        texture->MarkUsed(m_deviceContext.GetFrameNumber());
 
         encoder->setTexture(uniformInfo->Stage, uniformInfo->Handle, texture->Handle(), texture->SamplerFlags());
     }
@@ -1708,13 +2269,37 @@ namespace Babylon
 
     void NativeEngine::DeleteTexture(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         Graphics::Texture* texture = info[0].As<Napi::Pointer<Graphics::Texture>>().Get();
-        m_deviceContext.RemoveTexture(texture->Handle());
+        m_textureStreamer.Cancel(texture);
         texture->Dispose();
     }
 
+    void NativeEngine::SetTextureStreamingBudget(const Napi::CallbackInfo& info)
+    {
+        m_textureStreamer.SetBudget(static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()));
+    }
+
+    void NativeEngine::SetTextureMemoryBudget(const Napi::CallbackInfo& info)
+    {
+        m_deviceContext.SetTextureMemoryBudget(static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()));
+    }
+
+    void NativeEngine::SetTextureCacheEnabled(const Napi::CallbackInfo& info)
+    {
+        m_textureCache.SetEnabled(info[0].As<Napi::Boolean>().Value());
+    }
+
+    void NativeEngine::SetReadTextureLatency(const Napi::CallbackInfo& info)
+    {
+        m_stagingTexturePool.SetLatency(info[0].As<Napi::Number>().Uint32Value());
+    }
+
     Napi::Value NativeEngine::ReadTexture(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         const Napi::Env env{info.Env()};
 
         Graphics::Texture* texture{info[0].As<Napi::Pointer<Graphics::Texture>>().Get()};
@@ -1761,76 +2346,75 @@ namespace Babylon
         else
         {
             bgfx::TextureHandle sourceTextureHandle{texture->Handle()};
-            auto tempTexture = std::make_shared<bool>(false);
+            auto stagingTexture = std::make_shared<bool>(false);
 
             // If the image needs to be cropped (not starting at 0, or less than full width/height (accounting for requested mip level)),
-            // or if the texture was not created with the BGFX_TEXTURE_READ_BACK flag, then blit it to a temp texture.
+            // or if the texture was not created with the BGFX_TEXTURE_READ_BACK flag, then blit it to a staging texture.
             if (x != 0 || y != 0 || width != (texture->Width() >> mipLevel) || height != (texture->Height() >> mipLevel) || (texture->Flags() & BGFX_TEXTURE_READ_BACK) == 0)
             {
-                const bgfx::TextureHandle blitTextureHandle{bgfx::createTexture2D(width, height, /*hasMips*/ false, /*numLayers*/ 1, sourceTextureFormat, BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK)};
+                const bgfx::TextureHandle blitTextureHandle{m_stagingTexturePool.Acquire(width, height, sourceTextureFormat)};
                 bgfx::Encoder* encoder{GetUpdateToken().GetEncoder()};
                 encoder->blit(static_cast<uint16_t>(bgfx::getCaps()->limits.maxViews - 1), blitTextureHandle, /*dstMip*/ 0, /*dstX*/ 0, /*dstY*/ 0, /*dstZ*/ 0, sourceTextureHandle, mipLevel, x, y, /*srcZ*/ 0, width, height, /*depth*/ 0);
 
                 sourceTextureHandle = blitTextureHandle;
-                *tempTexture = true;
+                *stagingTexture = true;
 
                 // The requested mip level was blitted, so the source texture now has just one mip, so reset the mip level to 0.
                 mipLevel = 0;
             }
 
-            // Allocate a buffer to store the source pixel data.
-            std::vector<uint8_t> textureBuffer(sourceTextureInfo.storageSize);
+            // Returns the staging texture to the pool once it is read.
+            // TODO: Handle properly handle stale handles after BGFX shutdown
+            auto releaseStagingTexture{[this, stagingTexture, sourceTextureHandle, width, height, sourceTextureFormat]() {
+                if (*stagingTexture && !m_cancellationSource->cancelled())
+                {
+                    m_stagingTexturePool.Release(sourceTextureHandle, width, height, sourceTextureFormat);
+                }
+
+                *stagingTexture = false;
+            }};
+
+            // The pixels are read and converted into pooled buffers, and copied into the JS ArrayBuffer on the JS thread,
+            // where its data is looked up again since the ArrayBuffer can be detached while the read is in progress.
+            const bool convert{targetTextureInfo.format != sourceTextureInfo.format};
+            const auto sourceBuffer{std::make_shared<ImageOps::ScratchBuffer>(sourceTextureInfo.storageSize)};
+            const auto targetBuffer{convert ? std::make_shared<ImageOps::ScratchBuffer>(targetTextureInfo.storageSize) : sourceBuffer};
 
             // Read the source texture.
-            m_deviceContext.ReadTextureAsync(sourceTextureHandle, textureBuffer, mipLevel)
-                .then(arcana::inline_scheduler, *m_cancellationSource, [textureBuffer{std::move(textureBuffer)}, sourceTextureInfo, targetTextureInfo]() mutable {
+            m_deviceContext.ReadTextureAsync(sourceTextureHandle, {sourceBuffer->Data(), sourceBuffer->Size()}, mipLevel)
+                .then(arcana::inline_scheduler, *m_cancellationSource, [sourceBuffer, targetBuffer, sourceTextureInfo, targetTextureInfo]() {
                     // If the source texture format does not match the target texture format, convert it.
-                    if (targetTextureInfo.format != sourceTextureInfo.format)
+                    if (targetBuffer != sourceBuffer)
                     {
-                        std::vector<uint8_t> convertedTextureBuffer(targetTextureInfo.storageSize);
-                        if (!bimg::imageConvert(&Graphics::DeviceContext::GetDefaultAllocator(), convertedTextureBuffer.data(), bimg::TextureFormat::Enum(targetTextureInfo.format), textureBuffer.data(), bimg::TextureFormat::Enum(sourceTextureInfo.format), sourceTextureInfo.width, sourceTextureInfo.height, /*depth*/ 1))
+                        if (!bimg::imageConvert(&Graphics::DeviceContext::GetDefaultAllocator(), targetBuffer->Data(), bimg::TextureFormat::Enum(targetTextureInfo.format), sourceBuffer->Data(), bimg::TextureFormat::Enum(sourceTextureInfo.format), sourceTextureInfo.width, sourceTextureInfo.height, /*depth*/ 1))
                         {
                             throw std::runtime_error{"Texture conversion to RBGA8 failed."};
                         }
-                        textureBuffer = convertedTextureBuffer;
                     }
 
-                    // Ensure the final texture buffer has the expected size.
-                    assert(textureBuffer.size() == targetTextureInfo.storageSize);
-
                     // Flip the image vertically if needed.
                     if (bgfx::getCaps()->originBottomLeft)
                     {
-                        FlipImage(textureBuffer, targetTextureInfo.height);
+                        ImageOps::FlipImage({targetBuffer->Data(), targetBuffer->Size()}, targetTextureInfo.height);
                     }
-
-                    return textureBuffer;
                 })
-                .then(m_runtimeScheduler, *m_cancellationSource, [this, bufferRef{Napi::Persistent(buffer)}, bufferOffset, deferred, tempTexture, sourceTextureHandle](std::vector<uint8_t> textureBuffer) mutable {
-                    // Double check the destination buffer length. This is redundant with prior checks, but we'll be extra sure before the memcpy.
-                    assert(bufferRef.Value().ByteLength() - bufferOffset >= textureBuffer.size());
-
-                    // Copy the pixel data into the JS ArrayBuffer.
-                    uint8_t* buffer{static_cast<uint8_t*>(bufferRef.Value().Data())};
-                    std::memcpy(buffer + bufferOffset, textureBuffer.data(), textureBuffer.size());
+                .then(m_runtimeScheduler, *m_cancellationSource, [bufferRef{Napi::Persistent(buffer)}, bufferOffset, targetBuffer, deferred, releaseStagingTexture]() {
+                    // Return the staging texture before resolving the promise, so that a read started from the
+                    // continuation can reuse it.
+                    releaseStagingTexture();
 
-                    // Dispose of the texture handle before resolving the promise.
-                    // TODO: Handle properly handle stale handles after BGFX shutdown
-                    if (*tempTexture && !m_cancellationSource->cancelled())
+                    const auto outputBuffer{bufferRef.Value()};
+                    if (outputBuffer.ByteLength() < bufferOffset + targetBuffer->Size())
                     {
-                        bgfx::destroy(sourceTextureHandle);
-                        *tempTexture = false;
+                        throw std::runtime_error{"Provided buffer was detached or resized while the texture was read."};
                     }
 
-                    deferred.Resolve(bufferRef.Value());
+                    std::memcpy(static_cast<uint8_t*>(outputBuffer.Data()) + bufferOffset, targetBuffer->Data(), targetBuffer->Size());
+                    deferred.Resolve(outputBuffer);
                 })
-                .then(m_runtimeScheduler, arcana::cancellation::none(), [this, env, deferred, tempTexture, sourceTextureHandle](const arcana::expected<void, std::exception_ptr>& result) {
-                    // Dispose of the texture handle if not yet disposed.
-                    // TODO: Handle properly handle stale handles after BGFX shutdown
-                    if (*tempTexture && !m_cancellationSource->cancelled())
-                    {
-                        bgfx::destroy(sourceTextureHandle);
-                    }
+                .then(m_runtimeScheduler, arcana::cancellation::none(), [env, deferred, releaseStagingTexture](const arcana::expected<void, std::exception_ptr>& result) {
+                    // Return the staging texture if not yet returned.
+                    releaseStagingTexture();
 
                     if (result.has_error())
                     {
@@ -1844,6 +2428,8 @@ namespace Babylon
 
     Napi::Value NativeEngine::CreateFrameBuffer(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         Graphics::Texture* texture = info[0].IsNull() ? nullptr : info[0].As<Napi::Pointer<Graphics::Texture>>().Get();
         const uint16_t width = static_cast<uint16_t>(info[1].As<Napi::Number>().Uint32Value());
         const uint16_t height = static_cast<uint16_t>(info[2].As<Napi::Number>().Uint32Value());
@@ -2065,6 +2651,8 @@ namespace Babylon
 
     void NativeEngine::SetHardwareScalingLevel(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         const auto level = info[0].As<Napi::Number>().FloatValue();
         m_deviceContext.SetHardwareScalingLevel(level);
     }
@@ -2242,6 +2830,8 @@ namespace Babylon
 
     void NativeEngine::SetCommandDataStream(const Napi::CallbackInfo& info)
     {
+        WaitForCommands(info.Env());
+
         // TODO: This should be moved to the constructor once multi-update is available.
         Napi::Object jsCommandStream = info[0].ToObject();
         m_commandStream = Napi::ObjectWrap<NativeDataStream>::Unwrap(jsCommandStream.Get("_nativeDataStream").As<Napi::Object>());
@@ -2251,10 +2841,27 @@ namespace Babylon
     {
         try
         {
-            NativeDataStream::Reader reader = m_commandStream->GetReader();
-            while (reader.CanRead())
+            if (m_commandWorker)
             {
-                std::invoke(reader.ReadPointer<CommandFunctionPointerT>(), this, reader);
+                // Only one batch is in flight at a time. Its data is detached from the stream since the JS side
+                // resumes writing as soon as this returns, and it holds its own update token so the frame cannot
+                // end before the worker is done encoding.
+                m_commandWorker->Wait();
+                m_commandStream->Detach(m_commandBatch);
+                m_commandStreamStats.Bytes += NativeDataStream::GetReader(m_commandBatch).SizeInBytes();
+                m_commandBatchUpdateToken.emplace(m_update.GetUpdateToken());
+
+                m_commandWorker->Run([this]() {
+                    auto releaseUpdateToken{gsl::finally([this]() { m_commandBatchUpdateToken.reset(); })};
+                    NativeDataStream::Reader reader{NativeDataStream::GetReader(m_commandBatch)};
+                    ExecuteCommands(reader);
+                });
+            }
+            else
+            {
+                NativeDataStream::Reader reader = m_commandStream->GetReader();
+                m_commandStreamStats.Bytes += reader.SizeInBytes();
+                ExecuteCommands(reader);
             }
         }
         catch (const std::exception& exception)
@@ -2263,6 +2870,35 @@ namespace Babylon
         }
     }
 
+    void NativeEngine::ExecuteCommands(NativeDataStream::Reader& reader)
+    {
+        // A submit may start a new frame or run on a different encoder, so the uniforms of the first draw are always sent.
+        m_lastDrawProgram = nullptr;
+        m_lastDrawEncoder = nullptr;
+
+        while (reader.CanRead())
+        {
+            std::invoke(reader.ReadPointer<CommandFunctionPointerT>(), this, reader);
+            ++m_commandStreamStats.Commands;
+        }
+    }
+
+    // Must be called before touching state that commands in flight on the worker thread may use.
+    void NativeEngine::WaitForCommands(Napi::Env env)
+    {
+        if (m_commandWorker)
+        {
+            try
+            {
+                m_commandWorker->Wait();
+            }
+            catch (const std::exception& exception)
+            {
+                throw Napi::Error::New(env, exception);
+            }
+        }
+    }
+
     void NativeEngine::PopulateFrameStats(const Napi::CallbackInfo& info)
     {
         const auto updateToken{m_update.GetUpdateToken()};
@@ -2271,6 +2907,39 @@ namespace Babylon
         const double gpuTimeNs = (stats->gpuTimeEnd - stats->gpuTimeBegin) * toGpuNs;
         Napi::Object jsStatsObject = info[0].As<Napi::Object>();
         jsStatsObject.Set("gpuTimeNs", gpuTimeNs);
+        jsStatsObject.Set("commandBufferBytes", static_cast<double>(m_lastFrameCommandStreamStats.Bytes));
+        jsStatsObject.Set("commandCount", static_cast<double>(m_lastFrameCommandStreamStats.Commands));
+        jsStatsObject.Set("drawCount", static_cast<double>(m_lastFrameCommandStreamStats.Draws));
+        jsStatsObject.Set("uniformSubmitCount", static_cast<double>(m_lastFrameCommandStreamStats.UniformsSubmitted));
+        jsStatsObject.Set("uniformSkipCount", static_cast<double>(m_lastFrameCommandStreamStats.UniformsSkipped));
+
+        // The compilation service is shared by all engines, so these stats cover the whole process.
+        const auto shaderStats{m_shaderCompilationService->GetStats()};
+        jsStatsObject.Set("shaderCompileQueueDepth", static_cast<double>(shaderStats.QueueDepth));
+        jsStatsObject.Set("shaderCompileCount", static_cast<double>(shaderStats.CompileCount));
+        jsStatsObject.Set("shaderCompileDeduplicatedCount", static_cast<double>(shaderStats.DeduplicatedCount));
+        jsStatsObject.Set("shaderCompileTotalMs", shaderStats.TotalCompileTime.count());
+        jsStatsObject.Set("shaderCompileMaxMs", shaderStats.MaxCompileTime.count());
+        jsStatsObject.Set("shaderCompileWaitTotalMs", shaderStats.TotalWaitTime.count());
+
+        jsStatsObject.Set("textureStreamingPendingBytes", static_cast<double>(m_textureStreamer.GetPendingBytes()));
+
+        const auto textureMemoryStats{m_deviceContext.GetTextureMemoryStats()};
+        jsStatsObject.Set("textureCount", static_cast<double>(textureMemoryStats.TextureCount));
+        jsStatsObject.Set("textureMemoryBytes", static_cast<double>(textureMemoryStats.TotalBytes));
+        jsStatsObject.Set("textureMemoryRenderTargetBytes", static_cast<double>(textureMemoryStats.RenderTargetBytes));
+        jsStatsObject.Set("textureMemorySampledBytes", static_cast<double>(textureMemoryStats.SampledBytes));
+        jsStatsObject.Set("textureMemoryCubeBytes", static_cast<double>(textureMemoryStats.CubeBytes));
+        jsStatsObject.Set("textureMemoryBudgetBytes", static_cast<double>(textureMemoryStats.BudgetBytes));
+        jsStatsObject.Set("textureDowngradedCount", static_cast<double>(textureMemoryStats.DowngradedCount));
+        jsStatsObject.Set("textureReloadSourceBytes", static_cast<double>(textureMemoryStats.ReloadSourceBytes));
+
+        jsStatsObject.Set("geometryResidentBytes", static_cast<double>(m_deviceContext.GetGeometryResidentBytes()));
+
+        const auto textureCacheStats{m_textureCache.GetStats()};
+        jsStatsObject.Set("textureCacheHits", static_cast<double>(textureCacheStats.Hits));
+        jsStatsObject.Set("textureCacheMisses", static_cast<double>(textureCacheStats.Misses));
+        jsStatsObject.Set("textureCacheEntries", static_cast<double>(textureCacheStats.Entries));
     }
 
     void NativeEngine::DrawInternal(bgfx::Encoder* encoder, uint32_t fillMode)
@@ -2317,11 +2986,15 @@ namespace Babylon
             }
         }
 
-        for (const auto& it : m_currentProgram->Uniforms)
-        {
-            const ProgramData::UniformValue& value = it.second;
-            encoder->setUniform({it.first}, value.Data.data(), value.ElementLength);
-        }
+        // bgfx applies uniform values in submission order since every view is sequential and view ids only increase within
+        // a frame, so values submitted by the previous draw are still in effect unless the program or the encoder changed.
+        const bool submitAllUniforms{m_currentProgram != m_lastDrawProgram || encoder != m_lastDrawEncoder};
+        const auto submitResult{m_currentProgram->SubmitUniforms(*encoder, submitAllUniforms)};
+        ++m_commandStreamStats.Draws;
+        m_commandStreamStats.UniformsSubmitted += submitResult.Submitted;
+        m_commandStreamStats.UniformsSkipped += submitResult.Skipped;
+        m_lastDrawProgram = m_currentProgram;
+        m_lastDrawEncoder = encoder;
 
         auto& boundFrameBuffer = GetBoundFrameBuffer(*encoder);
         if (boundFrameBuffer.HasDepth())
@@ -2341,6 +3014,11 @@ namespace Babylon
 
     Graphics::UpdateToken& NativeEngine::GetUpdateToken()
     {
+        if (m_commandWorker && m_commandWorker->IsWorkerThread())
+        {
+            return m_commandBatchUpdateToken.value();
+        }
+
         if (!m_updateToken)
         {
             m_updateToken.emplace(m_update.GetUpdateToken());
@@ -2382,6 +3060,9 @@ namespace Babylon
             return arcana::make_task(m_runtimeScheduler, *m_cancellationSource, [this, updateToken{m_update.GetUpdateToken()}, cancellationSource{m_cancellationSource}]() {
                 m_requestAnimationFrameCallbacksScheduled = false;
 
+                WaitForCommands(Env());
+                m_lastFrameCommandStreamStats = std::exchange(m_commandStreamStats, {});
+
                 arcana::trace_region scheduleRegion{"NativeEngine::ScheduleRequestAnimationFrameCallbacks invoke JS callbacks"};
                 auto callbacks{std::move(m_requestAnimationFrameCallbacks)};
                 for (auto& callback : callbacks)
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "CommandWorker.h"
 #include "NativeDataStream.h"
 #include "PerFrameValue.h"
+#include "ShaderCompilationService.h"
 #include "ShaderCompiler.h"
+#include "StagingTexturePool.h"
+#include "TextureCache.h"
+#include "TextureStreamer.h"
 #include "VertexArray.h"
 
 #include <Babylon/JsRuntime.h>
@@ -22,22 +27,32 @@
 #include <gsl/gsl>
 
 #include <arcana/threading/cancellation.h>
+#include <array>
+#include <cstring>
+#include <functional>
 #include <unordered_map>
 
 namespace Babylon
 {
     struct UniformInfo final
     {
-        UniformInfo(uint8_t stage, bgfx::UniformHandle handle, size_t maxElementLength)
+        UniformInfo(uint8_t stage, bgfx::UniformHandle handle, size_t maxElementLength, size_t elementSize)
             : Stage{stage}
             , Handle{handle}
             , MaxElementLength{maxElementLength}
+            , ElementSize{elementSize}
         {
         }
 
         uint8_t Stage{};
         bgfx::UniformHandle Handle{bgfx::kInvalidHandle};
         size_t MaxElementLength{};
+
+        // Number of floats per element, as consumed by bgfx::Encoder::setUniform.
+        size_t ElementSize{};
+
+        // Index of the uniform's value in ProgramData::Uniforms.
+        size_t Slot{};
     };
 
     struct ProgramData final
@@ -56,6 +71,7 @@ namespace Babylon
         ProgramData(ProgramData&& other) noexcept
             : Handle{other.Handle}
             , Uniforms{std::move(other.Uniforms)}
+            , UniformData{std::move(other.UniformData)}
             , UniformNameToIndex{std::move(other.UniformNameToIndex)}
             , UniformInfos{std::move(other.UniformInfos)}
             , VertexAttributeLocations{std::move(other.VertexAttributeLocations)}
@@ -70,6 +86,7 @@ namespace Babylon
             Handle = std::move(other.Handle);
             other.Handle = BGFX_INVALID_HANDLE;
             Uniforms = std::move(other.Uniforms);
+            UniformData = std::move(other.UniformData);
             UniformNameToIndex = std::move(other.UniformNameToIndex);
             UniformInfos = std::move(other.UniformInfos);
             VertexAttributeLocations = std::move(other.VertexAttributeLocations);
@@ -94,30 +111,110 @@ namespace Babylon
 
         struct UniformValue
         {
-            std::vector<float> Data{};
+            bgfx::UniformHandle Handle{bgfx::kInvalidHandle};
+            size_t Offset{};
+            size_t ElementSize{};
+            size_t MaxElementLength{};
             uint16_t ElementLength{};
+            bool Dirty{};
         };
 
-        std::unordered_map<uint16_t, UniformValue> Uniforms{};
+        // Uniform values live in a single arena laid out once from UniformInfos when the program is created.
+        // Each value carries a dirty bit so that only values that changed since the last submit are sent to bgfx.
+        std::vector<UniformValue> Uniforms{};
+        std::vector<float> UniformData{};
         std::unordered_map<std::string, uint16_t> UniformNameToIndex{};
         std::unordered_map<uint16_t, UniformInfo> UniformInfos{};
         std::unordered_map<std::string, uint32_t> VertexAttributeLocations{};
         uintptr_t DeviceID;
         Graphics::DeviceContext& DeviceContext;
 
-        void SetUniform(bgfx::UniformHandle handle, gsl::span<const float> data, size_t elementLength = 1)
+        void LayoutUniforms()
+        {
+            Uniforms.clear();
+            Uniforms.reserve(UniformInfos.size());
+
+            size_t size{0};
+            for (auto& it : UniformInfos)
+            {
+                UniformInfo& info{it.second};
+                info.Slot = Uniforms.size();
+                Uniforms.push_back({info.Handle, size, info.ElementSize, info.MaxElementLength});
+                size += info.ElementSize * info.MaxElementLength;
+            }
+
+            UniformData.assign(size, 0.0f);
+        }
+
+        void SetUniform(const UniformInfo& uniformInfo, gsl::span<const float> data, size_t elementLength = 1)
+        {
+            UniformValue* value{FindUniform(uniformInfo)};
+            if (value == nullptr)
+            {
+                return;
+            }
+
+            const auto newElementLength{static_cast<uint16_t>(std::min(value->MaxElementLength, elementLength))};
+            const size_t count{std::min(data.size(), value->ElementSize * value->MaxElementLength)};
+            float* destination{UniformData.data() + value->Offset};
+
+            if (value->ElementLength != newElementLength || std::memcmp(destination, data.data(), count * sizeof(float)) != 0)
+            {
+                std::memcpy(destination, data.data(), count * sizeof(float));
+                value->ElementLength = newElementLength;
+                value->Dirty = true;
+            }
+        }
+
+        struct SubmitUniformsResult
         {
-            UniformValue& value = Uniforms[handle.idx];
+            size_t Submitted{};
+            size_t Skipped{};
+        };
+
+        // Submits the uniform values that changed since the last call, or all of the values that have been set when forced.
+        // Returns how many of the values that have been set were submitted and how many were skipped as unchanged.
+        SubmitUniformsResult SubmitUniforms(bgfx::Encoder& encoder, bool force)
+        {
+            SubmitUniformsResult result{};
+            for (auto& value : Uniforms)
+            {
+                if (value.ElementLength == 0)
+                {
+                    continue;
+                }
+
+                if (value.Dirty || force)
+                {
+                    encoder.setUniform(value.Handle, UniformData.data() + value.Offset, value.ElementLength);
+                    value.Dirty = false;
+                    ++result.Submitted;
+                }
+                else
+                {
+                    ++result.Skipped;
+                }
+            }
+
+            return result;
+        }
 
-            const auto itUniformInfo{UniformInfos.find(handle.idx)};
+    private:
+        UniformValue* FindUniform(const UniformInfo& uniformInfo)
+        {
+            // The uniform info normally belongs to this program, but fall back to a lookup by handle in case it does not.
+            if (uniformInfo.Slot < Uniforms.size() && Uniforms[uniformInfo.Slot].Handle.idx == uniformInfo.Handle.idx)
+            {
+                return &Uniforms[uniformInfo.Slot];
+            }
 
-            if (itUniformInfo != UniformInfos.end())
+            const auto itUniformInfo{UniformInfos.find(uniformInfo.Handle.idx)};
+            if (itUniformInfo != UniformInfos.end() && itUniformInfo->second.Slot < Uniforms.size())
             {
-                elementLength = std::min(itUniformInfo->second.MaxElementLength, elementLength);
+                return &Uniforms[itUniformInfo->second.Slot];
             }
 
-            value.Data.assign(data.begin(), data.end());
-            value.ElementLength = static_cast<uint16_t>(elementLength);
+            return nullptr;
         }
     };
 
@@ -145,11 +242,17 @@ namespace Babylon
         void DeleteIndexBuffer(NativeDataStream::Reader& data);
         void RecordIndexBuffer(const Napi::CallbackInfo& info);
         void UpdateDynamicIndexBuffer(const Napi::CallbackInfo& info);
+        Napi::Value CreateTransientIndexBuffer(const Napi::CallbackInfo& info);
+        Napi::Value AllocateTransientIndexBuffer(const Napi::CallbackInfo& info);
         Napi::Value CreateVertexBuffer(const Napi::CallbackInfo& info);
         void DeleteVertexBuffer(NativeDataStream::Reader& data);
         void RecordVertexBuffer(const Napi::CallbackInfo& info);
         void UpdateDynamicVertexBuffer(const Napi::CallbackInfo& info);
-        std::unique_ptr<ProgramData> CreateProgramInternal(const std::string vertexSource, const std::string fragmentSource);
+        Napi::Value CreateTransientVertexBuffer(const Napi::CallbackInfo& info);
+        Napi::Value AllocateTransientVertexBuffer(const Napi::CallbackInfo& info);
+        void SetGeometryReferencesEnabled(const Napi::CallbackInfo& info);
+        static ShaderCompiler::BgfxShaderInfo CompileProgramShaders(ShaderCompiler& compiler, const std::string& vertexSource, const std::string& fragmentSource);
+        std::unique_ptr<ProgramData> CreateProgramInternal(const ShaderCompiler::BgfxShaderInfo& shaderInfo);
         Napi::Value CreateProgram(const Napi::CallbackInfo& info);
         Napi::Value CreateProgramAsync(const Napi::CallbackInfo& info);
         Napi::Value GetUniforms(const Napi::CallbackInfo& info);
@@ -164,6 +267,7 @@ namespace Babylon
         void SetColorWrite(NativeDataStream::Reader& data);
         void SetBlendMode(NativeDataStream::Reader& data);
         void SetMatrix(NativeDataStream::Reader& data);
+        void SetUniforms(NativeDataStream::Reader& data);
         void SetInt(NativeDataStream::Reader& data);
         void SetIntArray(NativeDataStream::Reader& data);
         void SetIntArray2(NativeDataStream::Reader& data);
@@ -183,11 +287,41 @@ namespace Babylon
         Napi::Value CreateTexture(const Napi::CallbackInfo& info);
         void InitializeTexture(const Napi::CallbackInfo& info);
         void LoadTexture(const Napi::CallbackInfo& info);
+
+        // Encoded data kept for textures that can be reloaded to stay within the texture memory budget, which is
+        // accounted for by the device context from the time it is reserved with AddTextureReloadSource.
+        struct TextureReloadSource
+        {
+            TextureReloadSource(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> data, bool generateMips, bool invertY, bool srgb);
+            ~TextureReloadSource();
+
+            // No copy or move semantics
+            TextureReloadSource(const TextureReloadSource&) = delete;
+            TextureReloadSource(TextureReloadSource&&) = delete;
+
+            Graphics::DeviceContext& Context;
+            std::vector<uint8_t> Data;
+            const bool GenerateMips;
+            const bool InvertY;
+            const bool Srgb;
+        };
+
+        void ReloadTexture(Graphics::Texture& texture, std::weak_ptr<TextureReloadSource> source, uint8_t skippedMips);
+        arcana::task<void, std::exception_ptr> LoadTextureAsync(Graphics::Texture* target, gsl::span<uint8_t> data, bool generateMips, bool invertY, bool srgb);
+
+        // Loads a texture through the texture cache once the images are hashed on the thread pool. The texture is attached
+        // to the cached one, or load is called to load a texture into the cache, or into the texture itself if the key is
+        // the one of different images.
+        void LoadCachedTexture(Graphics::Texture* texture, const std::vector<Napi::TypedArray>& data, bool cube, bool invertY, bool srgb, bool generateMips, Napi::Function onSuccess, Napi::Function onError, std::function<arcana::task<void, std::exception_ptr>(Graphics::Texture*)> load);
+        TextureCache::Callback CreateTextureCacheCallback(Graphics::Texture* texture, std::shared_ptr<Napi::FunctionReference> onSuccessRef, std::shared_ptr<Napi::FunctionReference> onErrorRef);
+
         void CopyTexture(NativeDataStream::Reader& data);
         void LoadRawTexture(const Napi::CallbackInfo& info);
         void LoadRawTexture2DArray(const Napi::CallbackInfo& info);
         void LoadCubeTexture(const Napi::CallbackInfo& info);
+        arcana::task<void, std::exception_ptr> LoadCubeTextureAsync(Graphics::Texture* target, const std::array<gsl::span<uint8_t>, 6>& data, bool generateMips, bool invertY, bool srgb);
         void LoadCubeTextureWithMips(const Napi::CallbackInfo& info);
+        void StreamCubeTextureWithMips(Graphics::Texture* texture, Napi::Array data, bool invertY, bool srgb, Napi::Function onSuccess, Napi::Function onError);
         Napi::Value GetTextureWidth(const Napi::CallbackInfo& info);
         Napi::Value GetTextureHeight(const Napi::CallbackInfo& info);
         void SetTextureSampling(NativeDataStream::Reader& data);
@@ -197,6 +331,10 @@ namespace Babylon
         void UnsetTexture(NativeDataStream::Reader& data);
         void DiscardAllTextures(NativeDataStream::Reader& data);
         void DeleteTexture(const Napi::CallbackInfo& info);
+        void SetTextureStreamingBudget(const Napi::CallbackInfo& info);
+        void SetTextureMemoryBudget(const Napi::CallbackInfo& info);
+        void SetTextureCacheEnabled(const Napi::CallbackInfo& info);
+        void SetReadTextureLatency(const Napi::CallbackInfo& info);
         Napi::Value ReadTexture(const Napi::CallbackInfo& info);
         Napi::Value CreateFrameBuffer(const Napi::CallbackInfo& info);
         void DeleteFrameBuffer(NativeDataStream::Reader& data);
@@ -221,19 +359,21 @@ namespace Babylon
         void SetCommandDataStream(const Napi::CallbackInfo& info);
         void SubmitCommands(const Napi::CallbackInfo& info);
         void PopulateFrameStats(const Napi::CallbackInfo& info);
+        void ExecuteCommands(NativeDataStream::Reader& reader);
+        void WaitForCommands(Napi::Env env);
         void DrawInternal(bgfx::Encoder* encoder, uint32_t fillMode);
 
-        std::string ProcessShaderCoordinates(const std::string& vertexSource);
-
         Graphics::UpdateToken& GetUpdateToken();
         Graphics::FrameBuffer& GetBoundFrameBuffer(bgfx::Encoder& encoder);
 
         std::shared_ptr<arcana::cancellation_source> m_cancellationSource{};
 
-        ShaderCompiler m_shaderCompiler{};
-
         ProgramData* m_currentProgram{nullptr};
 
+        // The program and encoder used by the last draw. Uniform values are only submitted incrementally while both stay the same.
+        ProgramData* m_lastDrawProgram{nullptr};
+        bgfx::Encoder* m_lastDrawEncoder{nullptr};
+
         JsRuntime& m_runtime;
         Graphics::DeviceContext& m_deviceContext;
         Graphics::Update m_update;
@@ -242,26 +382,44 @@ namespace Babylon
 
         std::optional<Graphics::UpdateToken> m_updateToken{};
 
+        TextureStreamer m_textureStreamer{m_deviceContext};
+        TextureCache m_textureCache{};
+        StagingTexturePool m_stagingTexturePool{m_deviceContext};
+
+        // When enabled, static vertex and index buffers reference the data of their ArrayBuffer until it is uploaded
+        // instead of copying it, so the ArrayBuffer must not be modified meanwhile.
+        bool m_geometryReferencesEnabled{};
+
+        // Keeps the ArrayBuffer that a buffer references alive until the buffer releases it, which happens once bgfx has
+        // uploaded it or the buffer is disposed, or until the engine is destroyed.
+        void ReferenceGeometryBytes(arcana::task<void, std::exception_ptr> whenReleased, Napi::ArrayBuffer dataBuffer);
+        std::unordered_map<uint64_t, Napi::Reference<Napi::ArrayBuffer>> m_geometryReferences{};
+        uint64_t m_nextGeometryReferenceId{};
+
         void ScheduleRequestAnimationFrameCallbacks();
         bool m_requestAnimationFrameCallbacksScheduled{};
 
         uint64_t m_engineState{BGFX_STATE_DEFAULT};
         uint32_t m_stencilState{BGFX_STENCIL_TEST_ALWAYS | BGFX_STENCIL_FUNC_REF(0) | BGFX_STENCIL_FUNC_RMASK(0xFF) | BGFX_STENCIL_OP_FAIL_S_KEEP | BGFX_STENCIL_OP_FAIL_Z_KEEP | BGFX_STENCIL_OP_PASS_Z_REPLACE};
 
+        void SetUniformValue(const UniformInfo& uniformInfo, uint32_t type, NativeDataStream::Reader& data);
+        void SetIntValue(const UniformInfo& uniformInfo, NativeDataStream::Reader& data);
+        void SetMatricesValue(const UniformInfo& uniformInfo, NativeDataStream::Reader& data);
+
         template<int size, typename arrayType>
         void SetTypeArrayN(const UniformInfo& uniformInfo, const uint32_t elementLength, const arrayType& array);
 
         template<int size>
-        void SetIntArrayN(NativeDataStream::Reader& data);
+        void SetIntArrayN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data);
 
         template<int size>
-        void SetFloatArrayN(NativeDataStream::Reader& data);
+        void SetFloatArrayN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data);
 
         template<int size>
-        void SetFloatN(NativeDataStream::Reader& data);
+        void SetFloatN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data);
 
         template<int size>
-        void SetMatrixN(NativeDataStream::Reader& data);
+        void SetMatrixN(const UniformInfo& uniformInfo, NativeDataStream::Reader& data);
 
         // Scratch vector used for data alignment.
         std::vector<float> m_scratch{};
@@ -276,10 +434,32 @@ namespace Babylon
         // TODO: This should be changed to a non-owning ref once multi-update is available.
         NativeDataStream* m_commandStream{};
 
+        // Amount of command stream data submitted during the current and the previous frame.
+        struct CommandStreamStats
+        {
+            size_t Bytes{};
+            size_t Commands{};
+            size_t Draws{};
+            size_t UniformsSubmitted{};
+            size_t UniformsSkipped{};
+        };
+
+        CommandStreamStats m_commandStreamStats{};
+        CommandStreamStats m_lastFrameCommandStreamStats{};
+
+        // State used to execute commands on a worker thread when threaded command submission is enabled.
+        // The batch data and update token are owned by the worker until WaitForCommands returns.
+        NativeDataStream::DetachedData m_commandBatch{};
+        std::optional<Graphics::UpdateToken> m_commandBatchUpdateToken{};
+        std::unique_ptr<CommandWorker> m_commandWorker{};
+
         // Information from the JS side used for backwards compatibility.
         struct
         {
             bool NonFloatVertexBuffers{};
         } m_jsInfo;
+
+        // Shared by all engines of the process. Compilations do not reference the engine, so they can outlive it.
+        std::shared_ptr<ShaderCompilationService> m_shaderCompilationService{ShaderCompilationService::GetShared()};
     };
 }
@@ -2,140 +2,556 @@
 #include <map>
 #include "ShaderCompiler.h"
 #include "ShaderCache.h"
+#include "MurmurHash3.h"
+
+#include <bgfx/bgfx.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <stdexcept>
 
 namespace
 {
-    void SaveString(std::ofstream& stream, const std::string& string)
+    // Cache files start with a header followed by an index of the entries written by the last full serialization and
+    // their data. Entries added afterwards are appended to the end of the file as self-describing records.
+    constexpr uint32_t CACHE_MAGIC{0x43534E42}; // "BNSC"
+    constexpr uint32_t RECORD_MAGIC{0x52534E42}; // "BNSR"
+    constexpr uint32_t CACHE_VERSION{2};
+    constexpr uint32_t MANIFEST_MAGIC{0x4D534E42}; // "BNSM"
+    constexpr uint32_t MANIFEST_VERSION{2};
+    constexpr uint32_t MANIFEST_HOMOGENEOUS_DEPTH{1 << 0};
+    constexpr uint32_t MANIFEST_ORIGIN_BOTTOM_LEFT{1 << 1};
+
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t IndexCount;
+        uint32_t Reserved;
+    };
+
+    struct IndexEntry
+    {
+        uint64_t HashLow;
+        uint64_t HashHigh;
+        uint64_t Offset;
+        uint32_t Size;
+        uint32_t Reserved;
+    };
+
+    struct RecordHeader
+    {
+        uint32_t Magic;
+        uint32_t Size;
+        uint64_t HashLow;
+        uint64_t HashHigh;
+    };
+
+    static_assert(sizeof(FileHeader) == 16);
+    static_assert(sizeof(IndexEntry) == 32);
+    static_assert(sizeof(RecordHeader) == 24);
+
+    // The compiled shader bytes depend on the graphics API targeted by the shader compiler.
+    constexpr std::string_view GRAPHICS_API_NAME{
+#if defined(D3D11)
+        "D3D11"
+#elif defined(D3D12)
+        "D3D12"
+#elif defined(METAL)
+        "Metal"
+#elif defined(VULKAN)
+        "Vulkan"
+#elif defined(OPENGL)
+        "OpenGL"
+#else
+        "Unknown"
+#endif
+    };
+
+    template<typename T>
+    void AppendValue(std::vector<uint8_t>& data, const T& value)
+    {
+        const auto bytes{reinterpret_cast<const uint8_t*>(&value)};
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void AppendString(std::vector<uint8_t>& data, const std::string& string)
+    {
+        AppendValue(data, static_cast<uint32_t>(string.size()));
+        data.insert(data.end(), string.begin(), string.end());
+    }
+
+    void AppendBytes(std::vector<uint8_t>& data, const std::vector<uint8_t>& bytes)
+    {
+        AppendValue(data, static_cast<uint32_t>(bytes.size()));
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    class PayloadReader
+    {
+    public:
+        PayloadReader(const std::vector<uint8_t>& data)
+            : m_data{data}
+        {
+        }
+
+        template<typename T>
+        T ReadValue()
+        {
+            T value;
+            std::memcpy(&value, Read(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string ReadString()
+        {
+            const auto size{ReadValue<uint32_t>()};
+            const auto bytes{reinterpret_cast<const char*>(Read(size))};
+            return {bytes, bytes + size};
+        }
+
+        std::vector<uint8_t> ReadBytes()
+        {
+            const auto size{ReadValue<uint32_t>()};
+            const auto bytes{Read(size)};
+            return {bytes, bytes + size};
+        }
+
+    private:
+        const uint8_t* Read(size_t size)
+        {
+            if (m_data.size() - m_position < size)
+            {
+                throw std::runtime_error{"Shader cache entry is corrupt"};
+            }
+
+            const uint8_t* data{m_data.data() + m_position};
+            m_position += size;
+            return data;
+        }
+
+        const std::vector<uint8_t>& m_data;
+        size_t m_position{0};
+    };
+
+    std::vector<uint8_t> EncodeShaderInfo(const Babylon::ShaderCompiler::BgfxShaderInfo& infos)
+    {
+        std::vector<uint8_t> data{};
+        AppendBytes(data, infos.VertexBytes);
+        AppendBytes(data, infos.FragmentBytes);
+
+        AppendValue(data, static_cast<uint32_t>(infos.VertexAttributeLocations.size()));
+        for (auto& attributeLocation : infos.VertexAttributeLocations)
+        {
+            AppendString(data, attributeLocation.first);
+            AppendValue(data, attributeLocation.second);
+        }
+
+        AppendValue(data, static_cast<uint32_t>(infos.UniformStages.size()));
+        for (auto& uniformStages : infos.UniformStages)
+        {
+            AppendString(data, uniformStages.first);
+            AppendValue(data, uniformStages.second);
+        }
+
+        return data;
+    }
+
+    Babylon::ShaderCompiler::BgfxShaderInfo DecodeShaderInfo(const std::vector<uint8_t>& data)
     {
-        uint32_t stringSize{static_cast<uint32_t>(string.size())};
-        stream.write(reinterpret_cast<const char*>(&stringSize), sizeof(uint32_t));
-        stream.write(reinterpret_cast<const char*>(string.data()), string.size());
+        PayloadReader reader{data};
+
+        Babylon::ShaderCompiler::BgfxShaderInfo infos{};
+        infos.VertexBytes = reader.ReadBytes();
+        infos.FragmentBytes = reader.ReadBytes();
+
+        const auto vertexAttributeLocationCount{reader.ReadValue<uint32_t>()};
+        for (uint32_t vertexAttributeLocation = 0; vertexAttributeLocation < vertexAttributeLocationCount; vertexAttributeLocation++)
+        {
+            std::string locationName{reader.ReadString()};
+            infos.VertexAttributeLocations[locationName] = reader.ReadValue<uint32_t>();
+        }
+
+        const auto stageCount{reader.ReadValue<uint32_t>()};
+        for (uint32_t stage = 0; stage < stageCount; stage++)
+        {
+            std::string stageName{reader.ReadString()};
+            infos.UniformStages[stageName] = reader.ReadValue<uint8_t>();
+        }
+
+        return infos;
     }
 
-    void LoadString(std::ifstream& stream, std::string& string)
+    std::optional<std::vector<uint8_t>> ReadPayload(std::istream& stream, uint64_t offset, uint32_t size)
     {
-        uint32_t stringSize;
-        stream.read(reinterpret_cast<char*>(&stringSize), sizeof(uint32_t));
-        string.resize(stringSize);
-        stream.read(string.data(), stringSize);
+        std::vector<uint8_t> data(size);
+        stream.clear();
+        stream.seekg(static_cast<std::streamoff>(offset));
+        stream.read(reinterpret_cast<char*>(data.data()), size);
+        if (!stream)
+        {
+            return {};
+        }
+
+        return data;
+    }
+
+    // Reads the locations of the entries of a cache file, from its index and from the records appended after it. Offsets
+    // are relative to the start of the stream. Returns false if the stream does not hold a valid cache file and sets
+    // `complete` to false if the file ends with a partially written record.
+    template<typename CallableT>
+    bool ReadEntryLocations(std::istream& stream, bool& complete, CallableT&& callback)
+    {
+        stream.seekg(0, std::ios::end);
+        const auto streamSize{static_cast<uint64_t>(stream.tellg())};
+        stream.seekg(0);
+
+        FileHeader header{};
+        stream.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+        if (!stream || header.Magic != CACHE_MAGIC || header.Version != CACHE_VERSION)
+        {
+            return false;
+        }
+
+        // The index and every entry must fit in the stream, which is checked without overflowing before anything is
+        // allocated or read, so that a corrupt file is treated as invalid.
+        if (header.IndexCount > (streamSize - sizeof(FileHeader)) / sizeof(IndexEntry))
+        {
+            return false;
+        }
+
+        std::vector<IndexEntry> index(header.IndexCount);
+        stream.read(reinterpret_cast<char*>(index.data()), index.size() * sizeof(IndexEntry));
+        if (!stream)
+        {
+            return false;
+        }
+
+        if (std::any_of(index.begin(), index.end(), [streamSize](const IndexEntry& entry) { return entry.Offset > streamSize || entry.Size > streamSize - entry.Offset; }))
+        {
+            return false;
+        }
+
+        uint64_t end{sizeof(FileHeader) + index.size() * sizeof(IndexEntry)};
+        for (const auto& entry : index)
+        {
+            callback(entry.HashLow, entry.HashHigh, entry.Offset, entry.Size);
+            end = std::max(end, entry.Offset + entry.Size);
+        }
+
+        complete = true;
+        while (end < streamSize)
+        {
+            RecordHeader record{};
+            stream.seekg(static_cast<std::streamoff>(end));
+            stream.read(reinterpret_cast<char*>(&record), sizeof(RecordHeader));
+
+            const uint64_t offset{end + sizeof(RecordHeader)};
+            if (!stream || record.Magic != RECORD_MAGIC || offset > streamSize || record.Size > streamSize - offset)
+            {
+                complete = false;
+                break;
+            }
+
+            callback(record.HashLow, record.HashHigh, offset, record.Size);
+            end = offset + record.Size;
+        }
+
+        stream.clear();
+        return true;
     }
 }
 
 namespace Babylon
 {
-    static const uint32_t CACHE_VERSION = 1;
+    ShaderCacheImpl::ShaderHash ShaderCacheImpl::Hash(std::string_view vertexSource, std::string_view fragmentSource)
+    {
+        static const uint64_t seed{[]() {
+            const std::string environment{std::string{GRAPHICS_API_NAME} + ":" + std::to_string(ShaderCompiler::VERSION)};
+            return MurmurHash3(environment.data(), environment.size(), 0).first;
+        }()};
+
+        const auto vertexHash{MurmurHash3(vertexSource.data(), vertexSource.size(), seed)};
+        const auto fragmentHash{MurmurHash3(fragmentSource.data(), fragmentSource.size(), seed)};
+        const uint64_t hashes[]{vertexHash.first, vertexHash.second, fragmentHash.first, fragmentHash.second};
+        const auto hash{MurmurHash3(hashes, sizeof(hashes), seed)};
+        return {hash.first, hash.second};
+    }
 
     uint32_t ShaderCacheImpl::Serialize(std::ofstream& stream)
     {
-        uint32_t cacheVersion{CACHE_VERSION};
-        stream.write(reinterpret_cast<const char*>(&cacheVersion), sizeof(uint32_t));
-        uint32_t cacheSize{static_cast<uint32_t>(Cache.size())};
-        stream.write(reinterpret_cast<const char*>(&cacheSize), sizeof(uint32_t));
-        for (auto& entry : Cache)
-        {
-            stream.write(reinterpret_cast<const char*>(&entry.first), sizeof(ShaderHash));
-            const auto& infos = entry.second;
-            uint32_t vertexBytes{static_cast<uint32_t>(infos.VertexBytes.size())};
-            stream.write(reinterpret_cast<const char*>(&vertexBytes), sizeof(uint32_t));
-            stream.write((const char*)infos.VertexBytes.data(), infos.VertexBytes.size());
-
-            uint32_t fragmentBytes{static_cast<uint32_t>(infos.FragmentBytes.size())};
-            stream.write(reinterpret_cast<const char*>(&fragmentBytes), sizeof(uint32_t));
-            stream.write((const char*)infos.FragmentBytes.data(), infos.FragmentBytes.size());
-
-            uint32_t vertexAttributeLocationCount{static_cast<uint32_t>(infos.VertexAttributeLocations.size())};
-            stream.write(reinterpret_cast<const char*>(&vertexAttributeLocationCount), sizeof(uint32_t));
-            for (auto& attributeLocation : infos.VertexAttributeLocations)
+        std::scoped_lock lock{Mutex};
+        return WriteEntries(stream);
+    }
+
+    uint32_t ShaderCacheImpl::WriteEntries(std::ostream& stream)
+    {
+        std::vector<std::vector<uint8_t>> payloads{};
+        std::vector<IndexEntry> index{};
+        payloads.reserve(Cache.size());
+        index.reserve(Cache.size());
+
+        uint64_t offset{sizeof(FileHeader) + Cache.size() * sizeof(IndexEntry)};
+        for (auto& [hash, entry] : Cache)
+        {
+            std::optional<std::vector<uint8_t>> payload{};
+            if (entry.Info)
             {
-                SaveString(stream, attributeLocation.first);
-                stream.write(reinterpret_cast<const char*>(&attributeLocation.second), sizeof(uint32_t));
+                payload = EncodeShaderInfo(*entry.Info);
+            }
+            else
+            {
+                payload = ReadPayload(File, entry.Offset, entry.Size);
             }
 
-            uint32_t stageCount{static_cast<uint32_t>(infos.UniformStages.size())};
-            stream.write(reinterpret_cast<const char*>(&stageCount), sizeof(uint32_t));
-            for (auto& uniformStages : infos.UniformStages)
+            if (payload)
             {
-                SaveString(stream, uniformStages.first);
-                stream.write(reinterpret_cast<const char*>(&uniformStages.second), sizeof(uint8_t));
+                index.push_back({hash.low, hash.high, offset, static_cast<uint32_t>(payload->size()), 0});
+                offset += payload->size();
+                payloads.push_back(std::move(*payload));
             }
         }
-        return cacheSize;
+
+        const FileHeader header{CACHE_MAGIC, CACHE_VERSION, static_cast<uint32_t>(index.size()), 0};
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        stream.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(IndexEntry));
+        for (const auto& payload : payloads)
+        {
+            stream.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+        }
+
+        return static_cast<uint32_t>(index.size());
     }
 
     uint32_t ShaderCacheImpl::Deserialize(std::ifstream& stream)
     {
-        uint32_t cacheVersion;
-        stream.read(reinterpret_cast<char*>(&cacheVersion), sizeof(uint32_t));
-        if (cacheVersion != CACHE_VERSION)
+        std::scoped_lock lock{Mutex};
+
+        std::vector<std::pair<ShaderHash, std::pair<uint64_t, uint32_t>>> locations{};
+        bool complete{};
+        if (!ReadEntryLocations(stream, complete, [&locations](uint64_t low, uint64_t high, uint64_t offset, uint32_t size) {
+                locations.push_back({{low, high}, {offset, size}});
+            }))
         {
             return 0;
         }
 
-        uint32_t cacheSize;
-        stream.read(reinterpret_cast<char*>(&cacheSize), sizeof(uint32_t));
-        for (unsigned int i = 0; i < cacheSize; i++)
-        {
-            ShaderHash hash;
-            stream.read(reinterpret_cast<char*>(&hash), sizeof(ShaderHash));
-            ShaderCompiler::BgfxShaderInfo infos;
-            uint32_t vertexBytes;
-            stream.read(reinterpret_cast<char*>(&vertexBytes), sizeof(uint32_t));
-            infos.VertexBytes.resize(vertexBytes);
-            stream.read(reinterpret_cast<char*>(infos.VertexBytes.data()), infos.VertexBytes.size());
-            uint32_t fragmentBytes;
-            stream.read(reinterpret_cast<char*>(&fragmentBytes), sizeof(uint32_t));
-            infos.FragmentBytes.resize(fragmentBytes);
-            stream.read(reinterpret_cast<char*>(infos.FragmentBytes.data()), infos.FragmentBytes.size());
-
-            uint32_t vertexAttributeLocationCount;
-            stream.read(reinterpret_cast<char*>(&vertexAttributeLocationCount), sizeof(uint32_t));
-            for (unsigned int vertexAttributeLocation = 0; vertexAttributeLocation < vertexAttributeLocationCount; vertexAttributeLocation++)
+        uint32_t cacheSize{0};
+        for (const auto& [hash, location] : locations)
+        {
+            const auto payload{ReadPayload(stream, location.first, location.second)};
+            if (!payload)
             {
-                std::string locationName;
-                LoadString(stream, locationName);
-                uint32_t locationIndex;
-                stream.read(reinterpret_cast<char*>(&locationIndex), sizeof(uint32_t));
-                infos.VertexAttributeLocations[locationName] = locationIndex;
+                break;
             }
 
-            uint32_t stageCount;
-            stream.read(reinterpret_cast<char*>(&stageCount), sizeof(uint32_t));
-            for (unsigned int stage = 0; stage < stageCount; stage++)
+            Cache.try_emplace(hash, Entry{DecodeShaderInfo(*payload)});
+            ++cacheSize;
+        }
+
+        return cacheSize;
+    }
+
+    uint32_t ShaderCacheImpl::Open(const std::string& path)
+    {
+        std::scoped_lock lock{Mutex};
+
+        // Entries still only located in the previously opened file are loaded before it is closed.
+        LoadEntries();
+
+        File.close();
+        AppendFile.close();
+
+        File.open(path, std::ios::binary);
+        bool complete{};
+        std::set<ShaderHash> fileHashes{};
+        const bool valid{File.is_open() && ReadEntryLocations(File, complete, [this, &fileHashes](uint64_t low, uint64_t high, uint64_t offset, uint32_t size) {
+            Cache.try_emplace({low, high}, Entry{{}, offset, size});
+            fileHashes.insert({low, high});
+        })};
+
+        if (!valid || !complete)
+        {
+            // Rewrite files that are missing, were written by an incompatible version or end with a partially written
+            // record, which would hide any record appended after it.
+            LoadEntries();
+
+            File.close();
+
+            std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+            WriteEntries(stream);
+            stream.close();
+
+            File.open(path, std::ios::binary);
+            AppendFile.open(path, std::ios::binary | std::ios::app);
+        }
+        else
+        {
+            // Shaders that were already cached in memory but are missing from the file are appended to it.
+            AppendFile.open(path, std::ios::binary | std::ios::app);
+            for (const auto& [hash, entry] : Cache)
             {
-                std::string stageName;
-                LoadString(stream, stageName);
-                uint8_t stageIndex;
-                stream.read(reinterpret_cast<char*>(&stageIndex), sizeof(uint8_t));
-                infos.UniformStages[stageName] = stageIndex;
+                if (entry.Info && fileHashes.count(hash) == 0)
+                {
+                    Append(hash, EncodeShaderInfo(*entry.Info));
+                }
             }
+        }
+
+        return static_cast<uint32_t>(Cache.size());
+    }
 
-            Cache[hash] = infos;
+    void ShaderCacheImpl::RecordMisses(const std::string& manifestPath)
+    {
+        std::scoped_lock lock{Mutex};
+
+        MissManifest.close();
+        RecordedMisses.clear();
+
+        // The header of a new manifest is written with the first miss, once the renderer caps are known.
+        MissManifestEmpty = std::ifstream{manifestPath, std::ios::binary | std::ios::ate}.tellg() <= 0;
+        MissManifest.open(manifestPath, std::ios::binary | std::ios::app);
+    }
+
+    void ShaderCacheImpl::WriteManifestHeader(std::ostream& stream, bool homogeneousDepth, bool originBottomLeft)
+    {
+        const uint32_t flags{(homogeneousDepth ? MANIFEST_HOMOGENEOUS_DEPTH : 0) | (originBottomLeft ? MANIFEST_ORIGIN_BOTTOM_LEFT : 0)};
+        const uint32_t header[]{MANIFEST_MAGIC, MANIFEST_VERSION, flags};
+        stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+
+    void ShaderCacheImpl::WriteManifestEntry(std::ostream& stream, std::string_view vertexSource, std::string_view fragmentSource)
+    {
+        for (const auto source : {vertexSource, fragmentSource})
+        {
+            const auto size{static_cast<uint32_t>(source.size())};
+            stream.write(reinterpret_cast<const char*>(&size), sizeof(uint32_t));
+            stream.write(source.data(), source.size());
         }
-        return cacheSize;
+    }
+
+    ShaderCacheImpl::Manifest ShaderCacheImpl::ReadManifest(std::istream& stream)
+    {
+        uint32_t header[3]{};
+        stream.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!stream || header[0] != MANIFEST_MAGIC || header[1] != MANIFEST_VERSION)
+        {
+            throw std::runtime_error{"Invalid shader manifest"};
+        }
+
+        Manifest manifest{};
+        manifest.HomogeneousDepth = (header[2] & MANIFEST_HOMOGENEOUS_DEPTH) != 0;
+        manifest.OriginBottomLeft = (header[2] & MANIFEST_ORIGIN_BOTTOM_LEFT) != 0;
+
+        const auto readSource{[&stream](std::string& source) {
+            uint32_t size{};
+            stream.read(reinterpret_cast<char*>(&size), sizeof(uint32_t));
+            source.resize(stream ? size : 0);
+            stream.read(source.data(), source.size());
+            return static_cast<bool>(stream);
+        }};
+
+        // A truncated entry at the end of the manifest is ignored, it was being written when the app exited.
+        std::pair<std::string, std::string> program{};
+        while (stream.peek() != std::char_traits<char>::eof() && readSource(program.first) && readSource(program.second))
+        {
+            manifest.Programs.push_back(std::move(program));
+        }
+
+        return manifest;
+    }
+
+    bool ShaderCacheImpl::LoadEntry(Entry& entry)
+    {
+        if (entry.Info)
+        {
+            return true;
+        }
+
+        const auto payload{ReadPayload(File, entry.Offset, entry.Size)};
+        if (!payload)
+        {
+            return false;
+        }
+
+        try
+        {
+            entry.Info.emplace(DecodeShaderInfo(*payload));
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+
+    void ShaderCacheImpl::LoadEntries()
+    {
+        for (auto iter = Cache.begin(); iter != Cache.end();)
+        {
+            iter = LoadEntry(iter->second) ? std::next(iter) : Cache.erase(iter);
+        }
+    }
+
+    void ShaderCacheImpl::Append(const ShaderHash& hash, const std::vector<uint8_t>& data)
+    {
+        const RecordHeader record{RECORD_MAGIC, static_cast<uint32_t>(data.size()), hash.low, hash.high};
+        AppendFile.write(reinterpret_cast<const char*>(&record), sizeof(RecordHeader));
+        AppendFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+        AppendFile.flush();
     }
 
     const ShaderCompiler::BgfxShaderInfo* ShaderCacheImpl::GetShader(std::string_view vertexSource, std::string_view fragmentSource)
     {
-        const ShaderHash hash{
-            std::hash<std::string_view>{}(vertexSource),
-            std::hash<std::string_view>{}(fragmentSource)};
+        const ShaderHash hash{Hash(vertexSource, fragmentSource)};
+
+        std::scoped_lock lock{Mutex};
         const auto iter{Cache.find(hash)};
         if (iter == Cache.end())
         {
+            if (MissManifest.is_open() && RecordedMisses.insert(hash).second)
+            {
+                if (MissManifestEmpty)
+                {
+                    // Misses are only looked up while compiling for the initialized renderer.
+                    const auto* caps{bgfx::getCaps()};
+                    WriteManifestHeader(MissManifest, caps->homogeneousDepth, caps->originBottomLeft);
+                    MissManifestEmpty = false;
+                }
+
+                WriteManifestEntry(MissManifest, vertexSource, fragmentSource);
+                MissManifest.flush();
+            }
+
+            return nullptr;
+        }
+
+        auto& entry{iter->second};
+        if (!LoadEntry(entry))
+        {
+            // Treat unreadable entries as misses so the shader is compiled and cached again.
+            Cache.erase(iter);
             return nullptr;
         }
-        return &iter->second;
+
+        return &entry.Info.value();
     }
 
     void ShaderCacheImpl::AddShader(std::string_view vertexSource, std::string_view fragmentSource, ShaderCompiler::BgfxShaderInfo shaderInfo)
     {
-        const ShaderHash hash{
-            std::hash<std::string_view>{}(vertexSource),
-            std::hash<std::string_view>{}(fragmentSource)};
+        const ShaderHash hash{Hash(vertexSource, fragmentSource)};
+
+        std::scoped_lock lock{Mutex};
         const auto iter{Cache.find(hash)};
         if (iter == Cache.end())
         {
-            Cache[hash] = shaderInfo;
+            if (AppendFile.is_open())
+            {
+                Append(hash, EncodeShaderInfo(shaderInfo));
+            }
+
+            Cache.emplace(hash, Entry{std::move(shaderInfo)});
         }
     }
 
@@ -184,5 +600,24 @@ namespace Babylon
             }
             return impl->Deserialize(stream);
         }
+
+        uint32_t Open(const std::string& path)
+        {
+            auto impl = ShaderCacheImpl::GetImpl();
+            if (!impl)
+            {
+                return 0;
+            }
+            return impl->Open(path);
+        }
+
+        void RecordMisses(const std::string& manifestPath)
+        {
+            auto impl = ShaderCacheImpl::GetImpl();
+            if (impl)
+            {
+                impl->RecordMisses(manifestPath);
+            }
+        }
     }
-}
\ No newline at end of file
+}
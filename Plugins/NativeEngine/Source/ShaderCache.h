@@ -3,6 +3,12 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
 
 namespace Babylon
 {
@@ -16,22 +22,60 @@ namespace Babylon
 
         uint32_t Serialize(std::ofstream& stream);
         uint32_t Deserialize(std::ifstream& stream);
+        uint32_t Open(const std::string& path);
+        void RecordMisses(const std::string& manifestPath);
 
         static ShaderCacheImpl* GetImpl();
 
+        // Manifests list the (vertex, fragment) sources of programs to compile ahead of time, along with the caps of the
+        // renderer they were recorded with, which change how the sources are patched before they are compiled.
+        struct Manifest
+        {
+            bool HomogeneousDepth{};
+            bool OriginBottomLeft{};
+            std::vector<std::pair<std::string, std::string>> Programs{};
+        };
+
+        static void WriteManifestHeader(std::ostream& stream, bool homogeneousDepth, bool originBottomLeft);
+        static void WriteManifestEntry(std::ostream& stream, std::string_view vertexSource, std::string_view fragmentSource);
+        static Manifest ReadManifest(std::istream& stream);
+
     private:
+        // 128-bit content hash of a program's sources, the targeted graphics API and the shader compiler version.
         struct ShaderHash
         {
-            size_t vertexHash;
-            size_t fragmentHash;
+            uint64_t low;
+            uint64_t high;
             bool operator < (const ShaderHash& other) const {
-                if (vertexHash < other.vertexHash || (vertexHash == other.vertexHash && fragmentHash < other.fragmentHash))
-                    return true;
-                return false;
+                return high < other.high || (high == other.high && low < other.low);
             }
         };
-        std::map<ShaderHash, ShaderCompiler::BgfxShaderInfo> Cache{};
+
+        // Entries read from a cache file only hold the location of their data until they are first requested.
+        struct Entry
+        {
+            std::optional<ShaderCompiler::BgfxShaderInfo> Info{};
+            uint64_t Offset{};
+            uint32_t Size{};
+        };
+
+        static ShaderHash Hash(std::string_view vertexSource, std::string_view fragmentSource);
+        uint32_t WriteEntries(std::ostream& stream);
+        void Append(const ShaderHash& hash, const std::vector<uint8_t>& data);
+
+        // Loads the data of an entry from the opened file, returns false if it cannot be read or is corrupt.
+        bool LoadEntry(Entry& entry);
+        // Loads the data of all entries from the opened file, dropping the ones that cannot be loaded.
+        void LoadEntries();
+
+        std::mutex Mutex{};
+        std::map<ShaderHash, Entry> Cache{};
+        std::ifstream File{};
+        std::ofstream AppendFile{};
+        std::ofstream MissManifest{};
+        bool MissManifestEmpty{};
+        std::set<ShaderHash> RecordedMisses{};
         static inline std::unique_ptr<ShaderCacheImpl> Instance{};
         friend void ShaderCache::Enabled(bool enabled);
     };
-}
\ No newline at end of file
+}
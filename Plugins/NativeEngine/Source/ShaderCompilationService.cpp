@@ -0,0 +1,244 @@
+#include "ShaderCompilationService.h"
+
+#include <arcana/tracing/trace_region.h>
+
+#include <algorithm>
+#include <system_error>
+
+namespace Babylon
+{
+    ShaderCompilationService::ShaderCompilationService(size_t threadCount)
+        : m_maxThreadCount{std::max<size_t>(threadCount, 1)}
+    {
+        m_threads.reserve(m_maxThreadCount);
+    }
+
+    ShaderCompilationService::~ShaderCompilationService()
+    {
+        std::vector<arcana::task_completion_source<ShaderInfoPtr, std::exception_ptr>> waiters{};
+
+        {
+            std::scoped_lock lock{m_mutex};
+            m_exit = true;
+
+            // Jobs that have not started yet are abandoned. Jobs that are compiling complete before the threads exit.
+            for (const auto& job : m_queue)
+            {
+                waiters.insert(waiters.end(), job->Waiters.begin(), job->Waiters.end());
+                m_pending.erase(job->Sources);
+            }
+
+            m_queue.clear();
+        }
+
+        m_queueCondition.notify_all();
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+
+        for (auto& waiter : waiters)
+        {
+            waiter.complete(arcana::make_unexpected(std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::operation_canceled)))));
+        }
+    }
+
+    arcana::task<ShaderCompilationService::ShaderInfoPtr, std::exception_ptr> ShaderCompilationService::CompileAsync(std::string vertexSource, std::string fragmentSource, int32_t priority, CompileFunction compile)
+    {
+        arcana::task_completion_source<ShaderInfoPtr, std::exception_ptr> completionSource{};
+
+        {
+            std::scoped_lock lock{m_mutex};
+
+            Key sources{std::move(vertexSource), std::move(fragmentSource)};
+            const auto it{m_pending.find(sources)};
+            if (it != m_pending.end())
+            {
+                const auto& job{it->second};
+                ++m_stats.DeduplicatedCount;
+
+                // Promote the queued job if the new request is more urgent.
+                if (priority > job->Priority && m_queue.erase(job) > 0)
+                {
+                    job->Priority = priority;
+                    m_queue.insert(job);
+                }
+
+                job->Waiters.push_back(completionSource);
+                return completionSource.as_task();
+            }
+
+            auto job{std::make_shared<Job>()};
+            job->Sources = std::move(sources);
+            job->Compile = std::move(compile);
+            job->Priority = priority;
+            job->Sequence = m_nextSequence++;
+            job->QueueTime = Clock::now();
+            job->Waiters.push_back(completionSource);
+
+            m_pending.emplace(job->Sources, job);
+            m_queue.insert(std::move(job));
+
+            if (m_queue.size() > m_idleThreadCount && m_threads.size() < m_maxThreadCount)
+            {
+                m_threads.emplace_back([this]() { ThreadProc(); });
+            }
+        }
+
+        m_queueCondition.notify_one();
+        return completionSource.as_task();
+    }
+
+    ShaderCompilationService::ShaderInfoPtr ShaderCompilationService::Compile(std::string vertexSource, std::string fragmentSource, CompileFunction compile)
+    {
+        std::unique_lock lock{m_mutex};
+
+        Key sources{std::move(vertexSource), std::move(fragmentSource)};
+        std::shared_ptr<Job> job{};
+
+        const auto it{m_pending.find(sources)};
+        if (it != m_pending.end())
+        {
+            job = it->second;
+            ++m_stats.DeduplicatedCount;
+
+            if (m_queue.erase(job) > 0)
+            {
+                // No worker has started the job yet, so run it here rather than waiting for one to pick it up.
+                Run(job, lock);
+            }
+            else
+            {
+                m_doneCondition.wait(lock, [&job]() { return job->Done; });
+            }
+        }
+        else
+        {
+            job = std::make_shared<Job>();
+            job->Sources = std::move(sources);
+            job->Compile = std::move(compile);
+            job->Sequence = m_nextSequence++;
+            job->QueueTime = Clock::now();
+
+            m_pending.emplace(job->Sources, job);
+            Run(job, lock);
+        }
+
+        if (job->Error)
+        {
+            std::rethrow_exception(job->Error);
+        }
+
+        return job->Result;
+    }
+
+    ShaderCompilationService::Stats ShaderCompilationService::GetStats() const
+    {
+        std::scoped_lock lock{m_mutex};
+        Stats stats{m_stats};
+        stats.QueueDepth = m_queue.size();
+        return stats;
+    }
+
+    size_t ShaderCompilationService::DefaultThreadCount()
+    {
+        // Leave cores for the JavaScript, render and thread pool threads.
+        return std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+    }
+
+    std::shared_ptr<ShaderCompilationService> ShaderCompilationService::GetShared()
+    {
+        static std::mutex mutex{};
+        static std::weak_ptr<ShaderCompilationService> shared{};
+
+        std::scoped_lock lock{mutex};
+        auto service{shared.lock()};
+        if (!service)
+        {
+            service = std::make_shared<ShaderCompilationService>();
+            shared = service;
+        }
+
+        return service;
+    }
+
+    void ShaderCompilationService::Run(const std::shared_ptr<Job>& job, std::unique_lock<std::mutex>& lock)
+    {
+        const auto startTime{Clock::now()};
+        lock.unlock();
+
+        ShaderInfoPtr result{};
+        std::exception_ptr error{};
+
+        try
+        {
+            arcana::trace_region region{"ShaderCompilationService::Run"};
+            result = std::make_shared<const ShaderCompiler::BgfxShaderInfo>(job->Compile(GetThreadCompiler()));
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        const auto endTime{Clock::now()};
+
+        lock.lock();
+
+        const std::chrono::duration<double, std::milli> compileTime{endTime - startTime};
+        ++m_stats.CompileCount;
+        m_stats.TotalCompileTime += compileTime;
+        m_stats.MaxCompileTime = std::max(m_stats.MaxCompileTime, compileTime);
+        m_stats.TotalWaitTime += startTime - job->QueueTime;
+
+        job->Result = result;
+        job->Error = error;
+        job->Done = true;
+        job->Compile = {};
+        m_pending.erase(job->Sources);
+
+        auto waiters{std::move(job->Waiters)};
+
+        lock.unlock();
+
+        m_doneCondition.notify_all();
+        for (auto& waiter : waiters)
+        {
+            if (error)
+            {
+                waiter.complete(arcana::make_unexpected(error));
+            }
+            else
+            {
+                waiter.complete(result);
+            }
+        }
+
+        lock.lock();
+    }
+
+    void ShaderCompilationService::ThreadProc()
+    {
+        std::unique_lock lock{m_mutex};
+        while (true)
+        {
+            ++m_idleThreadCount;
+            m_queueCondition.wait(lock, [this]() { return m_exit || !m_queue.empty(); });
+            --m_idleThreadCount;
+            if (m_exit)
+            {
+                return;
+            }
+
+            auto job{*m_queue.begin()};
+            m_queue.erase(m_queue.begin());
+            Run(job, lock);
+        }
+    }
+
+    ShaderCompiler& ShaderCompilationService::GetThreadCompiler()
+    {
+        // glslang keeps its intermediate state in thread local storage, so each thread gets its own compiler.
+        thread_local ShaderCompiler compiler{};
+        return compiler;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "ShaderCompiler.h"
+
+#include <arcana/threading/task.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Babylon
+{
+    // Compiles shaders on a bounded pool of worker threads, each with its own compiler state. Threads are started on
+    // demand, up to the given count. Requests for a program that is already queued or compiling share the result of the
+    // pending compilation, and queued requests with a higher priority are compiled first.
+    class ShaderCompilationService final
+    {
+    public:
+        using ShaderInfoPtr = std::shared_ptr<const ShaderCompiler::BgfxShaderInfo>;
+        using CompileFunction = std::function<ShaderCompiler::BgfxShaderInfo(ShaderCompiler&)>;
+
+        struct Stats
+        {
+            size_t QueueDepth{};
+            size_t CompileCount{};
+            size_t DeduplicatedCount{};
+            std::chrono::duration<double, std::milli> TotalCompileTime{};
+            std::chrono::duration<double, std::milli> MaxCompileTime{};
+            std::chrono::duration<double, std::milli> TotalWaitTime{};
+        };
+
+        explicit ShaderCompilationService(size_t threadCount = DefaultThreadCount());
+        ~ShaderCompilationService();
+
+        // No copy or move semantics
+        ShaderCompilationService(const ShaderCompilationService&) = delete;
+        ShaderCompilationService(ShaderCompilationService&&) = delete;
+
+        // Queues the compilation of the program identified by the given sources. The compile function is called on a
+        // worker thread with that thread's compiler, once for all of the pending requests for the same sources.
+        arcana::task<ShaderInfoPtr, std::exception_ptr> CompileAsync(std::string vertexSource, std::string fragmentSource, int32_t priority, CompileFunction compile);
+
+        // Compiles the program on the calling thread, or waits for the pending compilation of the same sources to
+        // complete if a worker thread has already started it.
+        ShaderInfoPtr Compile(std::string vertexSource, std::string fragmentSource, CompileFunction compile);
+
+        Stats GetStats() const;
+
+        static size_t DefaultThreadCount();
+
+        // Returns the service shared by all engines of the process, which is created on first use with the default
+        // thread count and destroyed once no engine references it anymore.
+        static std::shared_ptr<ShaderCompilationService> GetShared();
+
+    private:
+        using Key = std::pair<std::string, std::string>;
+        using Clock = std::chrono::steady_clock;
+
+        struct Job
+        {
+            Key Sources{};
+            CompileFunction Compile{};
+            int32_t Priority{};
+            uint64_t Sequence{};
+            Clock::time_point QueueTime{};
+            bool Done{};
+            ShaderInfoPtr Result{};
+            std::exception_ptr Error{};
+            std::vector<arcana::task_completion_source<ShaderInfoPtr, std::exception_ptr>> Waiters{};
+        };
+
+        struct JobOrder
+        {
+            bool operator()(const std::shared_ptr<Job>& left, const std::shared_ptr<Job>& right) const
+            {
+                return left->Priority > right->Priority || (left->Priority == right->Priority && left->Sequence < right->Sequence);
+            }
+        };
+
+        void Run(const std::shared_ptr<Job>& job, std::unique_lock<std::mutex>& lock);
+        void ThreadProc();
+
+        static ShaderCompiler& GetThreadCompiler();
+
+        mutable std::mutex m_mutex{};
+        std::condition_variable m_queueCondition{};
+        std::condition_variable m_doneCondition{};
+        std::set<std::shared_ptr<Job>, JobOrder> m_queue{};
+        std::map<Key, std::shared_ptr<Job>> m_pending{};
+        uint64_t m_nextSequence{};
+        Stats m_stats{};
+        bool m_exit{};
+
+        const size_t m_maxThreadCount{};
+        size_t m_idleThreadCount{};
+        std::vector<std::thread> m_threads{};
+    };
+}
@@ -17,6 +17,9 @@ namespace Babylon
     class ShaderCompiler final
     {
     public:
+        // Increment when changes alter the generated shader bytes so cached shaders are compiled again.
+        static constexpr uint32_t VERSION{1};
+
         ShaderCompiler();
         ~ShaderCompiler();
 
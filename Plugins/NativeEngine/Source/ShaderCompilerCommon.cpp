@@ -263,4 +263,52 @@ namespace Babylon::ShaderCompilerCommon
 
         return bgfxShaderInfo;
     }
+
+    // Change VS output coordinate system
+    std::string ProcessShaderCoordinates(const std::string& vertexSource, bool homogeneousDepth)
+    {
+        // patching shader code to append clip space coordinates for the current rendering API
+        // Can be done with glslang shader traversal. Done with string patching for now.
+        if (!homogeneousDepth)
+        {
+            std::string patchedVertexSource;
+            const auto lastClosingCurly = vertexSource.find_last_of('}');
+            patchedVertexSource = vertexSource.substr(0, lastClosingCurly);
+
+            patchedVertexSource += "gl_Position.z = (gl_Position.z + gl_Position.w) / 2.0; }";
+            return patchedVertexSource;
+        }
+        return vertexSource;
+    }
+
+    std::string ProcessSamplerFlip(const std::string& fragmentSource, bool originBottomLeft)
+    {
+        // for d3d, vulkan, metal, flip the texture sampling on vertical axis
+        if (!originBottomLeft)
+        {
+            std::string patchedFragmentSource = fragmentSource;
+
+            static const std::string shaderNameDefineStr = "#define SHADER_NAME";
+            const auto shaderNameDefine = fragmentSource.find(shaderNameDefineStr);
+            if (shaderNameDefine != std::string::npos)
+            {
+                static const auto textureSamplerFunctions = R"(
+                    highp vec2 flip(highp vec2 uv)
+                    {
+                        return vec2(uv.x, 1. - uv.y);
+                    }
+                    highp vec3 flip(highp vec3 uv)
+                    {
+                        return uv;
+                    }
+                    #define texture(x,y) texture(x, flip(y))
+                    #define textureLod(x,y,z) textureLod(x, flip(y), z)
+                    #define SHADER_NAME)";
+
+                patchedFragmentSource.replace(shaderNameDefine, shaderNameDefineStr.length(), textureSamplerFunctions);
+            }
+            return patchedFragmentSource;
+        }
+        return fragmentSource;
+    }
 }
@@ -69,4 +69,9 @@ namespace Babylon::ShaderCompilerCommon
     };
 
     ShaderCompiler::BgfxShaderInfo CreateBgfxShader(ShaderInfo vertexShaderInfo, ShaderInfo fragmentShaderInfo);
+
+    // Patch the shader sources from Babylon.js for the conventions of the renderer (bgfx caps homogeneousDepth and
+    // originBottomLeft) before they are compiled.
+    std::string ProcessShaderCoordinates(const std::string& vertexSource, bool homogeneousDepth);
+    std::string ProcessSamplerFlip(const std::string& fragmentSource, bool originBottomLeft);
 }
@@ -0,0 +1,117 @@
+#include "StagingTexturePool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Babylon
+{
+    namespace
+    {
+        // Textures kept for reuse across all sizes and formats, beyond which the least recently released are destroyed.
+        constexpr size_t MAX_POOLED_TEXTURES{16};
+    }
+
+    StagingTexturePool::StagingTexturePool(Graphics::DeviceContext& deviceContext)
+        : m_deviceContext{deviceContext}
+        , m_deviceID{deviceContext.GetDeviceId()}
+    {
+    }
+
+    StagingTexturePool::~StagingTexturePool()
+    {
+        Clear();
+    }
+
+    void StagingTexturePool::SetLatency(uint32_t frames)
+    {
+        m_latency = frames;
+
+        // Drop the textures beyond the new latency, least recently released first.
+        std::deque<Entry> textures{};
+        for (auto it = m_textures.rbegin(); it != m_textures.rend(); ++it)
+        {
+            const auto count{std::count_if(textures.begin(), textures.end(), [&](const Entry& entry) { return entry.Key == it->Key; })};
+            if (static_cast<uint32_t>(count) < m_latency)
+            {
+                textures.push_front(*it);
+            }
+            else
+            {
+                Destroy(it->Handle);
+            }
+        }
+
+        m_textures = std::move(textures);
+    }
+
+    uint32_t StagingTexturePool::GetLatency() const
+    {
+        return m_latency;
+    }
+
+    bgfx::TextureHandle StagingTexturePool::Acquire(uint16_t width, uint16_t height, bgfx::TextureFormat::Enum format)
+    {
+        // The textures of a device that was reset are already gone.
+        if (m_deviceID != m_deviceContext.GetDeviceId())
+        {
+            m_textures.clear();
+            m_deviceID = m_deviceContext.GetDeviceId();
+        }
+
+        const TextureKey key{width, height, format};
+
+        // Take the most recently released texture, so that the textures of sizes no longer read age out of the pool.
+        const auto it{std::find_if(m_textures.rbegin(), m_textures.rend(), [&](const Entry& entry) { return entry.Key == key; })};
+        if (it != m_textures.rend())
+        {
+            const bgfx::TextureHandle handle{it->Handle};
+            m_textures.erase(std::next(it).base());
+            return handle;
+        }
+
+        const bgfx::TextureHandle handle{bgfx::createTexture2D(width, height, /*hasMips*/ false, /*numLayers*/ 1, format, BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK)};
+        if (!bgfx::isValid(handle))
+        {
+            throw std::runtime_error{"Failed to create texture"};
+        }
+
+        return handle;
+    }
+
+    void StagingTexturePool::Release(bgfx::TextureHandle handle, uint16_t width, uint16_t height, bgfx::TextureFormat::Enum format)
+    {
+        const TextureKey key{width, height, format};
+        const auto count{std::count_if(m_textures.begin(), m_textures.end(), [&](const Entry& entry) { return entry.Key == key; })};
+        if (static_cast<uint32_t>(count) >= m_latency)
+        {
+            Destroy(handle);
+            return;
+        }
+
+        m_textures.push_back({key, handle});
+        if (m_textures.size() > MAX_POOLED_TEXTURES)
+        {
+            Destroy(m_textures.front().Handle);
+            m_textures.pop_front();
+        }
+    }
+
+    void StagingTexturePool::Clear()
+    {
+        for (const auto& entry : m_textures)
+        {
+            Destroy(entry.Handle);
+        }
+
+        m_textures.clear();
+    }
+
+    void StagingTexturePool::Destroy(bgfx::TextureHandle handle) const
+    {
+        // Textures of a device that was reset are already gone.
+        if (m_deviceID == m_deviceContext.GetDeviceId())
+        {
+            bgfx::destroy(handle);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Babylon/Graphics/DeviceContext.h>
+
+#include <bgfx/bgfx.h>
+
+#include <deque>
+#include <tuple>
+
+namespace Babylon
+{
+    // Reuses the read back textures that ReadTexture blits to, rather than creating and destroying one for every read.
+    // Used from the JavaScript thread only.
+    class StagingTexturePool final
+    {
+    public:
+        // The number of frames bgfx takes to read a texture back.
+        static constexpr uint32_t DEFAULT_LATENCY{2};
+
+        explicit StagingTexturePool(Graphics::DeviceContext& deviceContext);
+        ~StagingTexturePool();
+
+        // No copy or move semantics
+        StagingTexturePool(const StagingTexturePool&) = delete;
+        StagingTexturePool(StagingTexturePool&&) = delete;
+
+        // Number of textures of each size and format kept for reuse, which is the number of reads of that size that can
+        // be in flight without creating a texture. Reading back every frame needs as many as the frames a read takes.
+        void SetLatency(uint32_t frames);
+        uint32_t GetLatency() const;
+
+        bgfx::TextureHandle Acquire(uint16_t width, uint16_t height, bgfx::TextureFormat::Enum format);
+
+        // Returns a texture once its read is complete, which destroys it if enough textures of its size are kept.
+        void Release(bgfx::TextureHandle handle, uint16_t width, uint16_t height, bgfx::TextureFormat::Enum format);
+
+        void Clear();
+
+    private:
+        using TextureKey = std::tuple<uint16_t, uint16_t, bgfx::TextureFormat::Enum>;
+
+        struct Entry
+        {
+            TextureKey Key{};
+            bgfx::TextureHandle Handle{bgfx::kInvalidHandle};
+        };
+
+        void Destroy(bgfx::TextureHandle handle) const;
+
+        Graphics::DeviceContext& m_deviceContext;
+        uintptr_t m_deviceID{};
+        uint32_t m_latency{DEFAULT_LATENCY};
+
+        // Textures available for reuse, least recently released first.
+        std::deque<Entry> m_textures{};
+    };
+}
@@ -0,0 +1,111 @@
+#include "TextureCache.h"
+#include "MurmurHash3.h"
+
+namespace Babylon
+{
+    void TextureCache::SetEnabled(bool enabled)
+    {
+        m_enabled = enabled;
+        if (!enabled)
+        {
+            // Loads in progress keep their entries so that their callbacks are still called.
+            for (auto it = m_entries.begin(); it != m_entries.end();)
+            {
+                it = it->second.Loading ? std::next(it) : m_entries.erase(it);
+            }
+        }
+    }
+
+    bool TextureCache::IsEnabled() const
+    {
+        return m_enabled;
+    }
+
+    TextureCache::Key TextureCache::MakeKey(gsl::span<const gsl::span<const uint8_t>> images, bool cube, bool invertY, bool srgb, bool generateMips)
+    {
+        std::pair<uint64_t, uint64_t> hash{0, 0};
+        size_t size{0};
+        for (const auto& image : images)
+        {
+            // Each image is seeded with the hash of the previous ones, so that the faces of a cube are hashed in order.
+            hash = MurmurHash3(image.data(), image.size(), hash.first ^ hash.second);
+            size += image.size();
+        }
+
+        return {hash.first, hash.second, size, cube, invertY, srgb, generateMips};
+    }
+
+    TextureCache::AcquireResult TextureCache::Acquire(const Key& key, Callback callback)
+    {
+        if (!m_enabled)
+        {
+            return AcquireResult::LoadUncached;
+        }
+
+        auto& entry{m_entries[key]};
+        if (entry.Loading)
+        {
+            ++m_hits;
+            entry.Callbacks.push_back(std::move(callback));
+            return AcquireResult::Cached;
+        }
+
+        if (const auto texture{entry.Texture.lock()})
+        {
+            ++m_hits;
+            callback(texture);
+            return AcquireResult::Cached;
+        }
+
+        ++m_misses;
+        entry.Loading = true;
+        entry.Callbacks.push_back(std::move(callback));
+        return AcquireResult::Load;
+    }
+
+    void TextureCache::Complete(const Key& key, TexturePtr texture)
+    {
+        auto it{m_entries.find(key)};
+        if (it == m_entries.end())
+        {
+            return;
+        }
+
+        const auto callbacks{std::move(it->second.Callbacks)};
+        if (texture && m_enabled)
+        {
+            it->second.Texture = texture;
+            it->second.Loading = false;
+            it->second.Callbacks.clear();
+        }
+        else
+        {
+            m_entries.erase(it);
+        }
+
+        // Drop the entries whose textures have been released.
+        for (auto entry = m_entries.begin(); entry != m_entries.end();)
+        {
+            entry = !entry->second.Loading && entry->second.Texture.expired() ? m_entries.erase(entry) : std::next(entry);
+        }
+
+        for (const auto& callback : callbacks)
+        {
+            callback(texture);
+        }
+    }
+
+    TextureCache::Stats TextureCache::GetStats() const
+    {
+        size_t entries{0};
+        for (const auto& [key, entry] : m_entries)
+        {
+            if (!entry.Loading && !entry.Texture.expired())
+            {
+                ++entries;
+            }
+        }
+
+        return {m_hits, m_misses, entries};
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Babylon/Graphics/Texture.h>
+
+#include <gsl/gsl>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace Babylon
+{
+    // Shares the textures loaded from identical encoded images with identical load options. Images are identified by the
+    // 128-bit hash and total size of their bytes, without keeping a copy of them. Entries only hold weak references, so a
+    // texture is released once none of the textures attached to it use it anymore. Used from the JavaScript thread only,
+    // except for MakeKey.
+    class TextureCache final
+    {
+    public:
+        using TexturePtr = std::shared_ptr<Graphics::Texture>;
+
+        // Called with the loaded texture, or with null if it failed to load.
+        using Callback = std::function<void(const TexturePtr&)>;
+
+        // 128-bit hash and total size of the encoded images, then whether they are the faces of a cube, invertY, srgb
+        // and generateMips.
+        using Key = std::tuple<uint64_t, uint64_t, size_t, bool, bool, bool, bool>;
+
+        enum class AcquireResult
+        {
+            // The callback is called with the cached texture, right away if it is loaded or once it is.
+            Cached,
+
+            // The caller must load the texture and pass it to Complete.
+            Load,
+
+            // The cache is disabled. The caller must load the texture without passing it to Complete, and the callback is
+            // not called.
+            LoadUncached,
+        };
+
+        struct Stats
+        {
+            size_t Hits{};
+            size_t Misses{};
+            size_t Entries{};
+        };
+
+        // Disabled by default. Disabling the cache drops its entries, but not the textures still attached to them.
+        void SetEnabled(bool enabled);
+        bool IsEnabled() const;
+
+        // Hashes the images, which takes long enough for large images that it should be done on the thread pool.
+        static Key MakeKey(gsl::span<const gsl::span<const uint8_t>> images, bool cube, bool invertY, bool srgb, bool generateMips);
+
+        // Looks up the texture loaded from the images the key was made from.
+        AcquireResult Acquire(const Key& key, Callback callback);
+        void Complete(const Key& key, TexturePtr texture);
+
+        Stats GetStats() const;
+
+    private:
+        struct Entry
+        {
+            std::weak_ptr<Graphics::Texture> Texture{};
+            bool Loading{};
+            std::vector<Callback> Callbacks{};
+        };
+
+        bool m_enabled{};
+        std::map<Key, Entry> m_entries{};
+        size_t m_hits{};
+        size_t m_misses{};
+    };
+}
@@ -0,0 +1,433 @@
+#include "TextureStreamer.h"
+
+#include <arcana/threading/task_schedulers.h>
+#include <arcana/tracing/trace_region.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace Babylon
+{
+    struct TextureStreamer::Request
+    {
+        Graphics::Texture* Texture{};
+        uint8_t FaceCount{};
+        uint8_t MipCount{};
+        bool Srgb{};
+        uint64_t Sequence{};
+
+        // Set from the first image queued.
+        bool Described{};
+        uint16_t Width{};
+        uint16_t Height{};
+        bimg::TextureFormat::Enum Format{bimg::TextureFormat::Unknown};
+
+        // Levels from ReadyMip to the smallest one must be uploaded for the texture to be ready. When ReadyMip is not 0,
+        // the texture is first created with those levels only, and all of the levels are uploaded again to the full
+        // texture, which replaces it once complete.
+        uint8_t ReadyMip{};
+        size_t ReadyRemaining{};
+        size_t Remaining{};
+
+        bool Created{};
+        bgfx::TextureHandle FullTexture{bgfx::kInvalidHandle};
+        bool Completed{};
+        bool Cancelled{};
+        arcana::task_completion_source<void, std::exception_ptr> Ready{};
+    };
+
+    TextureStreamer::TextureStreamer(Graphics::DeviceContext& deviceContext)
+        : m_deviceContext{deviceContext}
+    {
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        m_cancellationSource->cancel();
+
+        std::scoped_lock lock{m_mutex};
+        const auto requests{m_requests};
+        for (const auto& request : requests)
+        {
+            RemoveLocked(request);
+        }
+    }
+
+    void TextureStreamer::SetBudget(size_t bytesPerFrame)
+    {
+        m_budget = bytesPerFrame;
+    }
+
+    size_t TextureStreamer::GetBudget() const
+    {
+        return m_budget;
+    }
+
+    size_t TextureStreamer::GetPendingBytes() const
+    {
+        std::scoped_lock lock{m_mutex};
+        return m_pendingBytes;
+    }
+
+    arcana::task<void, std::exception_ptr> TextureStreamer::Stream2D(Graphics::Texture* texture, bimg::ImageContainer* image, bool srgb)
+    {
+        const auto imagePtr{MakeImagePtr(image)};
+
+        auto request{std::make_shared<Request>()};
+        request->Texture = texture;
+        request->FaceCount = 1;
+        request->MipCount = image->m_numMips;
+        request->Srgb = srgb;
+
+        {
+            std::scoped_lock lock{m_mutex};
+            request->Sequence = m_nextSequence++;
+            Describe(*request, *image, 0);
+            m_requests.push_back(request);
+        }
+
+        for (uint8_t mip = 0; mip < image->m_numMips; ++mip)
+        {
+            QueueLevel(request, 0, mip, imagePtr, mip);
+        }
+
+        return WhenReady(request);
+    }
+
+    std::shared_ptr<TextureStreamer::Request> TextureStreamer::CreateRequest(Graphics::Texture* texture, bool cubeMap, uint8_t mipCount, bool srgb)
+    {
+        auto request{std::make_shared<Request>()};
+        request->Texture = texture;
+        request->FaceCount = cubeMap ? 6 : 1;
+        request->MipCount = mipCount;
+        request->Srgb = srgb;
+
+        std::scoped_lock lock{m_mutex};
+        request->Sequence = m_nextSequence++;
+        m_requests.push_back(request);
+        return request;
+    }
+
+    void TextureStreamer::QueueImage(const std::shared_ptr<Request>& request, uint8_t side, uint8_t mip, bimg::ImageContainer* image)
+    {
+        const auto imagePtr{MakeImagePtr(image)};
+
+        {
+            std::scoped_lock lock{m_mutex};
+            if (!request->Described)
+            {
+                Describe(*request, *image, mip);
+            }
+
+            if (image->m_numMips != 1 || image->m_format != request->Format ||
+                image->m_width != static_cast<uint32_t>(std::max(request->Width >> mip, 1)) ||
+                image->m_height != static_cast<uint32_t>(std::max(request->Height >> mip, 1)))
+            {
+                throw std::runtime_error{"Texture faces and levels must have matching sizes and formats."};
+            }
+        }
+
+        QueueLevel(request, side, mip, imagePtr, 0);
+    }
+
+    arcana::task<void, std::exception_ptr> TextureStreamer::WhenReady(const std::shared_ptr<Request>& request) const
+    {
+        return request->Ready.as_task();
+    }
+
+    void TextureStreamer::Fail(const std::shared_ptr<Request>& request, std::exception_ptr error)
+    {
+        bool complete{false};
+
+        {
+            std::scoped_lock lock{m_mutex};
+            complete = !request->Completed;
+            request->Completed = true;
+            request->Cancelled = true;
+            RemoveLocked(request);
+        }
+
+        if (complete)
+        {
+            request->Ready.complete(arcana::make_unexpected(error));
+        }
+    }
+
+    void TextureStreamer::Cancel(Graphics::Texture* texture)
+    {
+        std::vector<std::shared_ptr<Request>> cancelled{};
+
+        {
+            std::scoped_lock lock{m_mutex};
+
+            const auto requests{m_requests};
+            for (const auto& request : requests)
+            {
+                if (request->Texture == texture)
+                {
+                    request->Cancelled = true;
+                    RemoveLocked(request);
+
+                    if (!std::exchange(request->Completed, true))
+                    {
+                        cancelled.push_back(request);
+                    }
+                }
+            }
+        }
+
+        for (const auto& request : cancelled)
+        {
+            request->Ready.complete(arcana::make_unexpected(std::make_exception_ptr(std::system_error(std::make_error_code(std::errc::operation_canceled)))));
+        }
+    }
+
+    void TextureStreamer::QueueLevel(const std::shared_ptr<Request>& request, uint8_t side, uint8_t mip, const ImagePtr& image, uint8_t imageMip)
+    {
+        bimg::ImageMip level{};
+        if (!bimg::imageGetRawData(*image, 0, imageMip, image->m_data, image->m_size, level))
+        {
+            throw std::runtime_error{"Failed to get image level."};
+        }
+
+        std::scoped_lock lock{m_mutex};
+        if (request->Cancelled)
+        {
+            return;
+        }
+
+        const Upload upload{request, image, level.m_data, level.m_size, static_cast<uint16_t>(level.m_width), static_cast<uint16_t>(level.m_height), side, mip};
+        if (mip >= request->ReadyMip)
+        {
+            m_pendingBytes += upload.Size;
+            m_queue.emplace(UploadKey{false, request->Sequence, -static_cast<int>(mip), side}, upload);
+        }
+
+        if (request->ReadyMip > 0)
+        {
+            Upload fullUpload{upload};
+            fullUpload.Full = true;
+            m_pendingBytes += fullUpload.Size;
+            m_queue.emplace(UploadKey{true, request->Sequence, -static_cast<int>(mip), side}, std::move(fullUpload));
+        }
+
+        if (!m_tickScheduled)
+        {
+            ScheduleTickLocked(false);
+        }
+    }
+
+    void TextureStreamer::RemoveLocked(const std::shared_ptr<Request>& request)
+    {
+        for (auto it = m_queue.begin(); it != m_queue.end();)
+        {
+            if (it->second.Owner == request)
+            {
+                m_pendingBytes -= it->second.Size;
+                it = m_queue.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (bgfx::isValid(request->FullTexture))
+        {
+            bgfx::destroy(request->FullTexture);
+            request->FullTexture = BGFX_INVALID_HANDLE;
+        }
+
+        m_requests.erase(std::remove(m_requests.begin(), m_requests.end(), request), m_requests.end());
+    }
+
+    void TextureStreamer::ScheduleTickLocked(bool nextFrame)
+    {
+        m_tickScheduled = true;
+
+        // The before render dispatcher runs work until it has none left, so work queued while it ticks would run in the
+        // same frame. The after render dispatcher defers the next tick to the next frame.
+        if (nextFrame)
+        {
+            arcana::make_task(m_deviceContext.AfterRenderScheduler(), *m_cancellationSource, [this, cancellationSource{m_cancellationSource}]() {
+                arcana::make_task(m_deviceContext.BeforeRenderScheduler(), *m_cancellationSource, [this, cancellationSource]() {
+                    Tick();
+                });
+            });
+        }
+        else
+        {
+            arcana::make_task(m_deviceContext.BeforeRenderScheduler(), *m_cancellationSource, [this, cancellationSource{m_cancellationSource}]() {
+                Tick();
+            });
+        }
+    }
+
+    void TextureStreamer::Tick()
+    {
+        arcana::trace_region tickRegion{"TextureStreamer::Tick"};
+
+        std::vector<std::shared_ptr<Request>> readyRequests{};
+        std::vector<std::pair<std::shared_ptr<Request>, std::exception_ptr>> failedRequests{};
+
+        {
+            // Uploads happen under the lock so that Cancel cannot return, and the texture be disposed, while one is running.
+            std::scoped_lock lock{m_mutex};
+            m_tickScheduled = false;
+
+            const size_t budget{m_budget};
+            size_t bytes{0};
+            while (!m_queue.empty())
+            {
+                auto it{m_queue.begin()};
+                if (bytes > 0 && budget != 0 && bytes + it->second.Size > budget)
+                {
+                    break;
+                }
+
+                Upload upload{std::move(it->second)};
+                bytes += upload.Size;
+                m_pendingBytes -= upload.Size;
+                m_queue.erase(it);
+
+                auto& request{*upload.Owner};
+                try
+                {
+                    auto& texture{*request.Texture};
+                    const auto format{static_cast<bgfx::TextureFormat::Enum>(request.Format)};
+                    const uint64_t flags{request.Srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE};
+
+                    if (upload.Full && !bgfx::isValid(request.FullTexture))
+                    {
+                        const bool hasMips{request.MipCount > 1};
+                        request.FullTexture = request.FaceCount == 6
+                                                  ? bgfx::createTextureCube(request.Width, hasMips, 1, format, flags)
+                                                  : bgfx::createTexture2D(request.Width, request.Height, hasMips, 1, format, flags | BGFX_TEXTURE_BLIT_DST);
+                        if (!bgfx::isValid(request.FullTexture))
+                        {
+                            throw std::runtime_error{"Failed to create texture"};
+                        }
+                    }
+                    else if (!upload.Full && !request.Created)
+                    {
+                        const uint16_t width{static_cast<uint16_t>(std::max(request.Width >> request.ReadyMip, 1))};
+                        const uint16_t height{static_cast<uint16_t>(std::max(request.Height >> request.ReadyMip, 1))};
+                        const bool hasMips{request.MipCount - request.ReadyMip > 1};
+                        if (!texture.IsValid() || texture.Width() != width || texture.Height() != height || texture.HasMips() != hasMips || texture.Format() != format || texture.IsCubeMap() != (request.FaceCount == 6))
+                        {
+                            if (request.FaceCount == 6)
+                            {
+                                texture.CreateCube(width, hasMips, 1, format, flags);
+                            }
+                            else
+                            {
+                                texture.Create2D(width, height, hasMips, 1, format, flags);
+                            }
+                        }
+
+                        request.Created = true;
+                    }
+
+                    bgfx::ReleaseFn releaseFn{[](void*, void* userData) {
+                        delete static_cast<ImagePtr*>(userData);
+                    }};
+
+                    const bgfx::Memory* memory{bgfx::makeRef(upload.Data, upload.Size, releaseFn, new ImagePtr{upload.Image})};
+                    if (upload.Full)
+                    {
+                        if (request.FaceCount == 6)
+                        {
+                            bgfx::updateTextureCube(request.FullTexture, 0, upload.Side, upload.Mip, 0, 0, upload.Width, upload.Height, memory);
+                        }
+                        else
+                        {
+                            bgfx::updateTexture2D(request.FullTexture, 0, upload.Mip, 0, 0, upload.Width, upload.Height, memory);
+                        }
+                    }
+                    else
+                    {
+                        // The texture starts at ReadyMip, until it is replaced by the full texture.
+                        const uint8_t mip{static_cast<uint8_t>(upload.Mip - request.ReadyMip)};
+                        if (request.FaceCount == 6)
+                        {
+                            texture.UpdateCube(0, upload.Side, mip, 0, 0, upload.Width, upload.Height, memory);
+                        }
+                        else
+                        {
+                            texture.Update2D(0, mip, 0, 0, upload.Width, upload.Height, memory);
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    request.Cancelled = true;
+                    RemoveLocked(upload.Owner);
+                    if (!std::exchange(request.Completed, true))
+                    {
+                        failedRequests.emplace_back(upload.Owner, std::current_exception());
+                    }
+
+                    continue;
+                }
+
+                if (!upload.Full && --request.ReadyRemaining == 0 && !std::exchange(request.Completed, true))
+                {
+                    readyRequests.push_back(upload.Owner);
+                }
+
+                if (--request.Remaining == 0)
+                {
+                    // The reduced texture is replaced once all of the levels of the full texture are uploaded.
+                    if (bgfx::isValid(request.FullTexture))
+                    {
+                        const auto format{static_cast<bgfx::TextureFormat::Enum>(request.Format)};
+                        const uint64_t flags{request.Srgb ? BGFX_TEXTURE_SRGB : BGFX_TEXTURE_NONE};
+                        request.Texture->Attach(std::exchange(request.FullTexture, BGFX_INVALID_HANDLE), true, request.Width, request.Height, request.MipCount > 1, 1, format, flags, request.FaceCount == 6);
+                    }
+
+                    RemoveLocked(upload.Owner);
+                }
+            }
+
+            if (!m_queue.empty())
+            {
+                ScheduleTickLocked(true);
+            }
+        }
+
+        for (auto& request : readyRequests)
+        {
+            request->Ready.complete();
+        }
+
+        for (auto& [request, error] : failedRequests)
+        {
+            request->Ready.complete(arcana::make_unexpected(error));
+        }
+    }
+
+    void TextureStreamer::Describe(Request& request, const bimg::ImageContainer& image, uint8_t mip)
+    {
+        request.Described = true;
+        request.Width = static_cast<uint16_t>(image.m_width << mip);
+        request.Height = static_cast<uint16_t>(image.m_height << mip);
+        request.Format = image.m_format;
+
+        const uint16_t size{std::max(request.Width, request.Height)};
+        request.ReadyMip = 0;
+        while (request.ReadyMip + 1 < request.MipCount && (size >> request.ReadyMip) > READY_SIZE)
+        {
+            ++request.ReadyMip;
+        }
+
+        request.ReadyRemaining = static_cast<size_t>(request.FaceCount) * (request.MipCount - request.ReadyMip);
+        request.Remaining = request.ReadyRemaining + (request.ReadyMip > 0 ? static_cast<size_t>(request.FaceCount) * request.MipCount : 0);
+    }
+
+    TextureStreamer::ImagePtr TextureStreamer::MakeImagePtr(bimg::ImageContainer* image)
+    {
+        return {image, [](bimg::ImageContainer* container) { bimg::imageFree(container); }};
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Babylon/Graphics/DeviceContext.h>
+#include <Babylon/Graphics/Texture.h>
+
+#include <arcana/threading/cancellation.h>
+#include <arcana/threading/task.h>
+
+#include <bimg/bimg.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace Babylon
+{
+    // Uploads texture levels over several frames, smallest first, without exceeding a byte budget per frame. The uploads
+    // run on the render thread, from the before render scheduler of the device context. Textures larger than READY_SIZE
+    // are first created without their largest levels, so that no level is sampled before it is uploaded, and are replaced
+    // by a texture with all of their levels once those are uploaded too.
+    class TextureStreamer final
+    {
+    public:
+        struct Request;
+
+        // Textures are ready to be used once all of their levels up to this size are uploaded.
+        static constexpr uint16_t READY_SIZE{256};
+
+        explicit TextureStreamer(Graphics::DeviceContext& deviceContext);
+        ~TextureStreamer();
+
+        // No copy or move semantics
+        TextureStreamer(const TextureStreamer&) = delete;
+        TextureStreamer(TextureStreamer&&) = delete;
+
+        // Bytes uploaded per frame, or 0 to disable streaming. One level is uploaded per frame even if it is larger.
+        void SetBudget(size_t bytesPerFrame);
+        size_t GetBudget() const;
+
+        // Bytes queued but not uploaded yet.
+        size_t GetPendingBytes() const;
+
+        // Streams all of the levels of the image into the texture, which takes ownership of the image.
+        arcana::task<void, std::exception_ptr> Stream2D(Graphics::Texture* texture, bimg::ImageContainer* image, bool srgb);
+
+        // Starts streaming a texture with a full mip chain whose levels, and faces for cube textures, are produced
+        // separately. Each of them is queued with QueueImage once it is available, in any order, and the request takes
+        // ownership of the image.
+        std::shared_ptr<Request> CreateRequest(Graphics::Texture* texture, bool cubeMap, uint8_t mipCount, bool srgb);
+        void QueueImage(const std::shared_ptr<Request>& request, uint8_t side, uint8_t mip, bimg::ImageContainer* image);
+
+        // Completes once the texture is ready, or with the error passed to Fail.
+        arcana::task<void, std::exception_ptr> WhenReady(const std::shared_ptr<Request>& request) const;
+        void Fail(const std::shared_ptr<Request>& request, std::exception_ptr error);
+
+        // Drops the pending uploads of the texture, which must be called before it is disposed.
+        void Cancel(Graphics::Texture* texture);
+
+    private:
+        using ImagePtr = std::shared_ptr<bimg::ImageContainer>;
+
+        struct Upload
+        {
+            std::shared_ptr<Request> Owner{};
+            ImagePtr Image{};
+            const uint8_t* Data{};
+            uint32_t Size{};
+            uint16_t Width{};
+            uint16_t Height{};
+            uint8_t Side{};
+            uint8_t Mip{};
+
+            // Whether the level goes to the texture with all of the levels, which replaces the reduced one once complete.
+            bool Full{};
+        };
+
+        // Uploads needed for a texture to be ready come first, then older requests, then smaller levels.
+        using UploadKey = std::tuple<bool, uint64_t, int, uint8_t>;
+
+        void QueueLevel(const std::shared_ptr<Request>& request, uint8_t side, uint8_t mip, const ImagePtr& image, uint8_t imageMip);
+        void RemoveLocked(const std::shared_ptr<Request>& request);
+        void ScheduleTickLocked(bool nextFrame);
+        void Tick();
+
+        static void Describe(Request& request, const bimg::ImageContainer& image, uint8_t mip);
+
+        static ImagePtr MakeImagePtr(bimg::ImageContainer* image);
+
+        Graphics::DeviceContext& m_deviceContext;
+        std::atomic<size_t> m_budget{};
+
+        mutable std::mutex m_mutex{};
+        std::map<UploadKey, Upload> m_queue{};
+        size_t m_pendingBytes{};
+        std::vector<std::shared_ptr<Request>> m_requests{};
+        uint64_t m_nextSequence{};
+        bool m_tickScheduled{};
+
+        std::shared_ptr<arcana::cancellation_source> m_cancellationSource{std::make_shared<arcana::cancellation_source>()};
+    };
+}
@@ -0,0 +1,151 @@
+#include "TextureTranscoder.h"
+#include "ImageOps.h"
+
+#include <arcana/tracing/trace_region.h>
+
+#include <bgfx/bgfx.h>
+
+#include <basisu_transcoder.h>
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace Babylon::TextureTranscoder
+{
+    namespace
+    {
+        constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER{0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+        struct TargetFormat
+        {
+            basist::transcoder_texture_format TranscoderFormat;
+            bimg::TextureFormat::Enum ImageFormat;
+        };
+
+        constexpr TargetFormat RGBA8_FORMAT{basist::transcoder_texture_format::cTFRGBA32, bimg::TextureFormat::RGBA8};
+
+        bool IsSupported(bimg::TextureFormat::Enum format, bool srgb)
+        {
+            const uint16_t formatCaps{bgfx::getCaps()->formats[static_cast<bgfx::TextureFormat::Enum>(format)]};
+            return (formatCaps & (srgb ? BGFX_CAPS_FORMAT_TEXTURE_2D_SRGB : BGFX_CAPS_FORMAT_TEXTURE_2D)) != 0;
+        }
+
+        // Formats that ImageOps cannot flip are skipped when the image must be flipped.
+        TargetFormat SelectTargetFormat(bool hasAlpha, bool srgb, bool flip)
+        {
+            using basist::transcoder_texture_format;
+
+            // ETC1 is a subset of ETC2, and is more widely supported.
+            const std::array<TargetFormat, 4> compressedFormats{{
+                {transcoder_texture_format::cTFASTC_4x4_RGBA, bimg::TextureFormat::ASTC4x4},
+                {transcoder_texture_format::cTFBC7_RGBA, bimg::TextureFormat::BC7},
+                hasAlpha ? TargetFormat{transcoder_texture_format::cTFETC2_RGBA, bimg::TextureFormat::ETC2A} : TargetFormat{transcoder_texture_format::cTFETC1_RGB, bimg::TextureFormat::ETC1},
+                hasAlpha ? TargetFormat{transcoder_texture_format::cTFBC3_RGBA, bimg::TextureFormat::BC3} : TargetFormat{transcoder_texture_format::cTFBC1_RGB, bimg::TextureFormat::BC1},
+            }};
+
+            for (const auto& format : compressedFormats)
+            {
+                if (IsSupported(format.ImageFormat, srgb) && (!flip || ImageOps::CanFlipImage(format.ImageFormat)))
+                {
+                    return format;
+                }
+            }
+
+            return RGBA8_FORMAT;
+        }
+
+        // Returns null if a level cannot be flipped, which can happen for some ETC blocks.
+        bimg::ImageContainer* Transcode(bx::AllocatorI& allocator, basist::ktx2_transcoder& transcoder, TargetFormat target, bool flip)
+        {
+            const auto width{static_cast<uint16_t>(transcoder.get_width())};
+            const auto height{static_cast<uint16_t>(transcoder.get_height())};
+
+            // bgfx textures either have a single level or the full chain, so partial chains only keep the base level.
+            const bool hasMips{transcoder.get_levels() > 1 && transcoder.get_levels() == bimg::imageGetNumMips(target.ImageFormat, width, height)};
+
+            bimg::ImageContainer* image{bimg::imageAlloc(&allocator, target.ImageFormat, width, height, 1, 1, false, hasMips)};
+            const uint32_t bytesPerBlockOrPixel{basist::basis_get_bytes_per_block_or_pixel(target.TranscoderFormat)};
+
+            for (uint8_t level = 0; level < image->m_numMips; ++level)
+            {
+                bimg::ImageMip imageMip{};
+                if (!bimg::imageGetRawData(*image, 0, level, image->m_data, image->m_size, imageMip) ||
+                    !transcoder.transcode_image_level(level, 0, 0, const_cast<uint8_t*>(imageMip.m_data), imageMip.m_size / bytesPerBlockOrPixel, target.TranscoderFormat))
+                {
+                    bimg::imageFree(image);
+                    throw std::runtime_error{"Failed to transcode KTX2 texture."};
+                }
+
+                if (flip && !ImageOps::FlipImage({const_cast<uint8_t*>(imageMip.m_data), imageMip.m_size}, target.ImageFormat, imageMip.m_height))
+                {
+                    bimg::imageFree(image);
+                    return nullptr;
+                }
+            }
+
+            return image;
+        }
+
+        void InitializeTranscoder()
+        {
+            static const bool initialized{[]() {
+                basist::basisu_transcoder_init();
+                return true;
+            }()};
+
+            (void)initialized;
+        }
+    }
+
+    bool IsKtx2(gsl::span<const uint8_t> data)
+    {
+        return data.size() >= KTX2_IDENTIFIER.size() && std::memcmp(data.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) == 0;
+    }
+
+    bimg::ImageContainer* TranscodeKtx2(bx::AllocatorI& allocator, gsl::span<const uint8_t> data, bool invertY, bool srgb, bool generateMips)
+    {
+        arcana::trace_region transcodeRegion{"TextureTranscoder::TranscodeKtx2"};
+
+        InitializeTranscoder();
+
+        basist::ktx2_transcoder transcoder{};
+        if (!transcoder.init(data.data(), static_cast<uint32_t>(data.size())))
+        {
+            throw std::runtime_error{"Failed to parse KTX2 texture."};
+        }
+
+        if (!transcoder.is_etc1s() && !transcoder.is_uastc())
+        {
+            throw std::runtime_error{"KTX2 texture is not Basis Universal supercompressed."};
+        }
+
+        if (transcoder.get_layers() > 1 || transcoder.get_faces() != 1)
+        {
+            throw std::runtime_error{"KTX2 texture arrays and cube maps are not supported, cube textures must be loaded from a KTX2 texture per face."};
+        }
+
+        if (!transcoder.start_transcoding())
+        {
+            throw std::runtime_error{"Failed to start transcoding KTX2 texture."};
+        }
+
+        // Same as the images decoded by bimg, see PrepareImage in NativeEngine.cpp.
+        const bool flip{bgfx::getCaps()->originBottomLeft ? invertY : !invertY};
+
+        bimg::ImageContainer* image{Transcode(allocator, transcoder, SelectTargetFormat(transcoder.get_has_alpha(), srgb, flip), flip)};
+        if (image == nullptr)
+        {
+            image = Transcode(allocator, transcoder, RGBA8_FORMAT, flip);
+        }
+
+        if (generateMips && image->m_numMips == 1 && image->m_format == bimg::TextureFormat::RGBA8)
+        {
+            bimg::ImageContainer* oldImage{image};
+            image = bimg::imageGenerateMips(&allocator, *image);
+            bimg::imageFree(oldImage);
+        }
+
+        return image;
+    }
+}
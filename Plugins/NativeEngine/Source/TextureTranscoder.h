@@ -0,0 +1,16 @@
+#pragma once
+
+#include <bimg/bimg.h>
+#include <bx/allocator.h>
+
+#include <gsl/gsl>
+
+namespace Babylon::TextureTranscoder
+{
+    bool IsKtx2(gsl::span<const uint8_t> data);
+
+    // Transcodes a KTX2 texture with an ETC1S or UASTC payload to the best format the renderer can sample (ASTC, BC7,
+    // ETC2, BC3/BC1 or RGBA8, in that order), and flips it for invertY like the images that bimg decodes. When it must be
+    // flipped, only the formats that ImageOps::FlipImage can flip are considered.
+    bimg::ImageContainer* TranscodeKtx2(bx::AllocatorI& allocator, gsl::span<const uint8_t> data, bool invertY, bool srgb, bool generateMips);
+}
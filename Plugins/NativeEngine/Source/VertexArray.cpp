@@ -1,9 +1,23 @@
 #include "VertexArray.h"
+#include "VertexLayoutCache.h"
+#include <algorithm>
 #include <cassert>
 #include "Babylon/Graphics/DeviceContext.h"
 
 namespace Babylon
 {
+    namespace
+    {
+        // bgfx binds instance data to the vec4 registers i_data0 to i_data4 (BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT). This is the
+        // limit that was already enforced, it cannot be raised without changing bgfx.
+        constexpr uint32_t MAX_INSTANCE_DATA_REGISTERS{5};
+    }
+
+    VertexArray::VertexArray(Graphics::DeviceContext& deviceContext)
+        : m_deviceContext{deviceContext}
+    {
+    }
+
     VertexArray::~VertexArray()
     {
         Dispose();
@@ -17,8 +31,10 @@ namespace Babylon
         }
 
         m_indexBuffer = nullptr;
+        ReleaseStreams();
         m_vertexBufferRecords.clear();
         m_vertexBufferInstances.clear();
+        m_instanceBuffer.Dispose();
 
         m_disposed = true;
     }
@@ -48,29 +64,34 @@ namespace Babylon
                 throw std::runtime_error{"Instancing is not supported"};
             }
 
-            // bgfx allows instancing on at most 4 vec4 attributes
-            if (m_vertexBufferInstances.size() > 4)
+            vertexBuffer->UseAsInstanceSource();
+            m_vertexBufferInstances[attrib] = {vertexBuffer, byteOffset, byteStride, static_cast<uint16_t>(sizeof(float) * numElements)};
+
+            // Each instance attribute takes one vec4 register.
+            if (m_vertexBufferInstances.size() > MAX_INSTANCE_DATA_REGISTERS)
             {
-                throw std::runtime_error{"Number of vertex buffer instances greater than 4 is not supported"};
+                m_vertexBufferInstances.erase(attrib);
+                throw std::runtime_error{"Number of vertex buffer instances greater than " + std::to_string(MAX_INSTANCE_DATA_REGISTERS) + " is not supported"};
             }
-
-            m_vertexBufferInstances[attrib] = {vertexBuffer, byteOffset, byteStride, static_cast<uint16_t>(sizeof(float) * numElements)};
         }
         else
         {
             vertexBuffer->Build(byteStride);
 
-            bgfx::VertexLayout layout{};
-            layout.begin();
-            layout.add(attrib, static_cast<uint8_t>(numElements), attribType, normalized);
-            layout.m_stride = static_cast<uint16_t>(byteStride);
-            layout.m_offset[attrib] = static_cast<uint16_t>(byteOffset % byteStride);
-            layout.end();
-
-            if (!m_vertexBufferRecords.try_emplace(attrib, vertexBuffer, byteOffset / byteStride, bgfx::createVertexLayout(layout)).second)
+            if (!m_vertexBufferRecords.try_emplace(attrib, VertexBufferRecord{vertexBuffer, byteOffset, byteStride, numElements, attribType, normalized}).second)
             {
                 throw std::runtime_error{"Multiple vertex buffers with the same attribute cannot be recorded"};
             }
+
+            try
+            {
+                BuildStreams();
+            }
+            catch (...)
+            {
+                m_vertexBufferRecords.erase(attrib);
+                throw;
+            }
         }
     }
 
@@ -88,16 +109,79 @@ namespace Babylon
         const bool instancingSupported = 0 != (BGFX_CAPS_INSTANCING & bgfx::getCaps()->supported);
         if (!m_vertexBufferInstances.empty() && instancingSupported)
         {
-            bgfx::InstanceDataBuffer instanceDataBuffer{};
-            VertexBuffer::BuildInstanceDataBuffer(instanceDataBuffer, m_vertexBufferInstances, instanceCount);
-            encoder->setInstanceDataBuffer(&instanceDataBuffer);
+            m_instanceBuffer.Set(encoder, m_vertexBufferInstances, instanceCount);
         }
 
         uint8_t stream = 0;
-        for (const auto& pair : m_vertexBufferRecords)
+        for (const auto& vertexStream : m_vertexStreams)
         {
-            auto& record{pair.second};
-            record.Buffer->Set(encoder, stream++, record.Offset + startVertex, numVertices, record.LayoutHandle);
+            vertexStream.Buffer->Set(encoder, stream++, vertexStream.StartVertex + startVertex, numVertices, vertexStream.LayoutHandle);
         }
     }
+
+    void VertexArray::BuildStreams()
+    {
+        // Interleaved attributes have the same vertex buffer, stride and first vertex, and only differ by their offset
+        // within a vertex, so they make a single layout.
+        std::vector<std::vector<std::pair<bgfx::Attrib::Enum, const VertexBufferRecord*>>> groups{};
+        for (const auto& [attrib, record] : m_vertexBufferRecords)
+        {
+            auto group{std::find_if(groups.begin(), groups.end(), [&record = record](const auto& group) {
+                const auto& first{*group.front().second};
+                return first.Buffer == record.Buffer && first.ByteStride == record.ByteStride && first.ByteOffset / first.ByteStride == record.ByteOffset / record.ByteStride;
+            })};
+
+            if (group == groups.end())
+            {
+                group = groups.emplace(groups.end());
+            }
+
+            group->emplace_back(attrib, &record);
+        }
+
+        // The layouts are acquired before the previous ones are released, so that the layouts they share are kept. The
+        // streams are swapped once built, and those left are released, which are the new ones if building them failed.
+        std::vector<VertexStream> vertexStreams{};
+        uintptr_t vertexStreamsDeviceId{m_deviceContext.GetDeviceId()};
+        auto releaseStreams{gsl::finally([this, &vertexStreams, &vertexStreamsDeviceId]() {
+            for (const auto& vertexStream : vertexStreams)
+            {
+                VertexLayoutCache::Release(m_deviceContext, vertexStreamsDeviceId, vertexStream.LayoutHash);
+            }
+        })};
+
+        for (const auto& group : groups)
+        {
+            const auto& first{*group.front().second};
+
+            bgfx::VertexLayout layout{};
+            layout.begin();
+            for (const auto& [attrib, record] : group)
+            {
+                layout.add(attrib, static_cast<uint8_t>(record->NumElements), record->Type, record->Normalized);
+            }
+
+            layout.m_stride = static_cast<uint16_t>(first.ByteStride);
+            for (const auto& [attrib, record] : group)
+            {
+                layout.m_offset[attrib] = static_cast<uint16_t>(record->ByteOffset % record->ByteStride);
+            }
+            layout.end();
+
+            vertexStreams.push_back({first.Buffer, first.ByteOffset / first.ByteStride, VertexLayoutCache::Acquire(m_deviceContext, layout), layout.m_hash});
+        }
+
+        std::swap(m_vertexStreams, vertexStreams);
+        std::swap(m_streamsDeviceId, vertexStreamsDeviceId);
+    }
+
+    void VertexArray::ReleaseStreams()
+    {
+        for (const auto& vertexStream : m_vertexStreams)
+        {
+            VertexLayoutCache::Release(m_deviceContext, m_streamsDeviceId, vertexStream.LayoutHash);
+        }
+
+        m_vertexStreams.clear();
+    }
 }
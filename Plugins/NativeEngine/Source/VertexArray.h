@@ -4,13 +4,19 @@
 #include "VertexBuffer.h"
 #include <set>
 #include <map>
+#include <vector>
 
 namespace Babylon
 {
+    namespace Graphics
+    {
+        class DeviceContext;
+    }
+
     class VertexArray final
     {
     public:
-        VertexArray() = default;
+        explicit VertexArray(Graphics::DeviceContext& deviceContext);
         ~VertexArray();
 
         VertexArray(const VertexArray&) = delete;
@@ -25,25 +31,40 @@ namespace Babylon
         void SetVertexBuffers(bgfx::Encoder* encoder, uint32_t startVertex, uint32_t numVertices, uint32_t instanceCount = 0);
 
     private:
+        // Attributes are bound in streams of the attributes that share a vertex buffer, stride and first vertex, which
+        // are built again as each attribute is recorded so that their layouts are not created while drawing.
+        void BuildStreams();
+        void ReleaseStreams();
+
+        Graphics::DeviceContext& m_deviceContext;
+
         IndexBuffer* m_indexBuffer{};
 
         struct VertexBufferRecord
         {
             VertexBuffer* Buffer{};
-            const uint32_t Offset{};
-            const bgfx::VertexLayoutHandle LayoutHandle{};
-
-            VertexBufferRecord(VertexBuffer* buffer, const uint32_t offset, bgfx::VertexLayoutHandle layoutHandle)
-                : Buffer{buffer}
-                , Offset{offset}
-                , LayoutHandle{layoutHandle}
-            {
-            }
+            uint32_t ByteOffset{};
+            uint32_t ByteStride{};
+            uint32_t NumElements{};
+            bgfx::AttribType::Enum Type{};
+            bool Normalized{};
         };
 
         std::map<bgfx::Attrib::Enum, VertexBufferRecord> m_vertexBufferRecords{};
 
+        struct VertexStream
+        {
+            VertexBuffer* Buffer{};
+            uint32_t StartVertex{};
+            bgfx::VertexLayoutHandle LayoutHandle{bgfx::kInvalidHandle};
+            uint32_t LayoutHash{};
+        };
+
+        std::vector<VertexStream> m_vertexStreams{};
+        uintptr_t m_streamsDeviceId{};
+
         std::map<bgfx::Attrib::Enum, VertexBuffer::InstanceInfo> m_vertexBufferInstances;
+        InstanceBuffer m_instanceBuffer{};
 
         bool m_disposed{};
     };
@@ -1,17 +1,42 @@
 #include "VertexBuffer.h"
 #include "Babylon/Graphics/DeviceContext.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <limits>
 
 namespace Babylon
 {
-    VertexBuffer::VertexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, bool dynamic)
+    namespace
+    {
+        constexpr size_t MAX_TRACKED_UPDATES{16};
+
+        std::atomic<uint64_t> s_nextId{1};
+    }
+
+    VertexBuffer::VertexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, bool dynamic, bool referenceBytes)
         : m_deviceContext{deviceContext}
         , m_deviceId{m_deviceContext.GetDeviceId()}
-        , m_bytes{bytes.data(), bytes.data() + bytes.size()}
+        , m_id{s_nextId++}
+        , m_bytes{deviceContext, bytes, referenceBytes && !dynamic}
         , m_dynamic{dynamic}
     {
     }
 
+    VertexBuffer::VertexBuffer(Graphics::DeviceContext& deviceContext, uint32_t byteStride)
+        : m_deviceContext{deviceContext}
+        , m_deviceId{m_deviceContext.GetDeviceId()}
+        , m_id{s_nextId++}
+        , m_bytes{deviceContext, {}, false}
+        , m_byteStride{byteStride}
+        , m_transient{true}
+    {
+        if (m_byteStride == 0 || m_byteStride > std::numeric_limits<uint16_t>::max())
+        {
+            throw std::runtime_error{"Transient vertex buffer byte stride must be between 1 and 65535"};
+        }
+    }
+
     VertexBuffer::~VertexBuffer()
     {
         Dispose();
@@ -36,7 +61,7 @@ namespace Babylon
             }
         }
 
-        m_bytes.clear();
+        m_bytes.Release();
 
         m_disposed = true;
     }
@@ -45,7 +70,7 @@ namespace Babylon
     {
         if (!m_dynamic)
         {
-            throw std::runtime_error{"Cannot update non-dynamic vertex buffer"};
+            throw std::runtime_error{m_transient ? "Cannot update transient vertex buffer" : "Cannot update non-dynamic vertex buffer"};
         }
 
         if (bgfx::isValid(m_dynamicHandle))
@@ -59,16 +84,75 @@ namespace Babylon
             }
 
             bgfx::update(m_dynamicHandle, startVertex, bgfx::copy(bytes.data(), static_cast<uint32_t>(bytes.size())));
+
+            if (!m_instanceSource)
+            {
+                return;
+            }
         }
-        else
+
+        if (byteOffset + bytes.size() > m_bytes.Size())
+        {
+            throw std::runtime_error{"Cannot update vertex buffer due to buffer overflow"};
+        }
+
+        std::memcpy(m_bytes.MutableData() + byteOffset, bytes.data(), bytes.size());
+
+        m_updates.push_back({++m_version, byteOffset, byteOffset + bytes.size()});
+        if (m_updates.size() > MAX_TRACKED_UPDATES)
+        {
+            m_updates.pop_front();
+        }
+    }
+
+    bool VertexBuffer::AllocateTransient(gsl::span<const uint8_t> bytes)
+    {
+        if (bytes.size() % m_byteStride != 0)
+        {
+            throw std::runtime_error{"Cannot allocate transient vertex buffer with a byte length not divisible by its byte stride"};
+        }
+
+        const uint32_t numVertices{static_cast<uint32_t>(bytes.size() / m_byteStride)};
+
+        bgfx::VertexLayout layout;
+        layout.begin();
+        layout.m_stride = static_cast<uint16_t>(m_byteStride);
+        layout.end();
+
+        if (bgfx::getAvailTransientVertexBuffer(numVertices, layout) < numVertices)
+        {
+            return false;
+        }
+
+        bgfx::allocTransientVertexBuffer(&m_transientBuffer, numVertices, layout);
+        std::memcpy(m_transientBuffer.data, bytes.data(), bytes.size());
+        m_transientFrameNumber = m_deviceContext.GetFrameNumber();
+        return true;
+    }
+
+    std::pair<size_t, size_t> VertexBuffer::GetUpdatedRange(uint64_t version) const
+    {
+        if (version == m_version)
+        {
+            return {0, 0};
+        }
+
+        if (m_updates.empty() || m_updates.front().Version > version + 1)
         {
-            if (byteOffset + bytes.size() > m_bytes.size())
+            return {0, m_bytes.Size()};
+        }
+
+        std::pair<size_t, size_t> range{std::numeric_limits<size_t>::max(), 0};
+        for (const auto& update : m_updates)
+        {
+            if (update.Version > version)
             {
-                throw std::runtime_error{"Cannot update vertex buffer due to buffer overflow"};
+                range.first = std::min(range.first, update.Begin);
+                range.second = std::max(range.second, update.End);
             }
-
-            std::memcpy(m_bytes.data() + byteOffset, bytes.data(), bytes.size());
         }
+
+        return range;
     }
 
     void VertexBuffer::Build(uint32_t byteStride)
@@ -82,14 +166,9 @@ namespace Babylon
             throw std::runtime_error{"Attributes of a vertex buffer must have the same byte stride"};
         }
 
-        if (!bgfx::isValid(m_handle))
+        if (!m_transient && !bgfx::isValid(m_handle))
         {
-            auto releaseFn = [](void*, void* userData) {
-                delete reinterpret_cast<decltype(m_bytes)*>(userData);
-            };
-
-            auto* bytesPtr = new decltype(m_bytes){std::move(m_bytes)};
-            const bgfx::Memory* memory = bgfx::makeRef(bytesPtr->data(), static_cast<uint32_t>(bytesPtr->size()), releaseFn, bytesPtr);
+            const bgfx::Memory* memory = m_bytes.MakeMemory(m_instanceSource);
 
             bgfx::VertexLayout layout;
             layout.begin();
@@ -114,7 +193,17 @@ namespace Babylon
 
     void VertexBuffer::Set(bgfx::Encoder* encoder, uint8_t stream, uint32_t startVertex, uint32_t numVertices, bgfx::VertexLayoutHandle layout)
     {
-        if (m_dynamic)
+        if (m_transient)
+        {
+            // The memory of transient buffers is only valid for the frame it was allocated in.
+            if (m_transientBuffer.data == nullptr || m_transientFrameNumber != m_deviceContext.GetFrameNumber())
+            {
+                throw std::runtime_error{"Transient vertex buffer was not allocated in the current frame"};
+            }
+
+            encoder->setVertexBuffer(stream, &m_transientBuffer, startVertex, numVertices, layout);
+        }
+        else if (m_dynamic)
         {
             encoder->setVertexBuffer(stream, m_dynamicHandle, startVertex, numVertices, layout);
         }
@@ -124,25 +213,46 @@ namespace Babylon
         }
     }
 
-    void VertexBuffer::BuildInstanceDataBuffer(bgfx::InstanceDataBuffer& instanceDataBuffer, const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances, uint32_t instanceCount)
+    void VertexBuffer::UseAsInstanceSource()
+    {
+        if (m_transient)
+        {
+            throw std::runtime_error{"Cannot use a transient vertex buffer as per-instance data"};
+        }
+
+        if (!m_instanceSource && bgfx::isValid(m_handle))
+        {
+            throw std::runtime_error{"Cannot use a vertex buffer as per-instance data once it was used as per-vertex data"};
+        }
+
+        m_instanceSource = true;
+    }
+
+    arcana::task<void, std::exception_ptr> VertexBuffer::WhenBytesReleased()
+    {
+        return m_bytes.WhenReferenceReleased();
+    }
+
+    uint32_t VertexBuffer::GetInstanceCount(const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances)
+    {
+        const auto& info{instances.begin()->second};
+        return static_cast<uint32_t>(info.Buffer->m_bytes.Size()) / info.Stride;
+    }
+
+    uint16_t VertexBuffer::GetInstanceStride(const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances)
     {
         uint16_t instanceStride{};
         for (auto& pair : instances)
         {
-            if (instanceCount == 0)
-            {
-                const auto* vertexBuffer{pair.second.Buffer};
-                instanceCount = static_cast<uint32_t>(vertexBuffer->m_bytes.size()) / pair.second.Stride;
-            }
-
             instanceStride += static_cast<uint16_t>(pair.second.ElementSize);
         }
 
-        // Create instance datas. Instance Data Buffer is transient.
-        bgfx::allocInstanceDataBuffer(&instanceDataBuffer, instanceCount, instanceStride);
+        return instanceStride;
+    }
 
-        // Copy instance data.
-        uint8_t* data{instanceDataBuffer.data};
+    void VertexBuffer::CopyInstanceData(uint8_t* destination, const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances, uint32_t firstInstance, uint32_t instanceCount)
+    {
+        const uint16_t instanceStride{GetInstanceStride(instances)};
         uint32_t offset{};
 
         // Reverse because bgfx is also reversed: https://github.com/bkaradzic/bgfx/blob/4581f14cd481bad1e0d6292f0dd0a6e298c2ee18/src/renderer_d3d11.cpp#L2701
@@ -153,12 +263,136 @@ namespace Babylon
 #endif
         {
             const auto& element{iter->second};
-            const auto* source{element.Buffer->m_bytes.data()};
+            const auto* source{element.Buffer->m_bytes.Data()};
             for (uint32_t instance = 0; instance < instanceCount; instance++)
             {
-                std::memcpy(data + instance * instanceStride + offset, source + instance * element.Stride + element.Offset, element.ElementSize);
+                std::memcpy(destination + instance * instanceStride + offset, source + (firstInstance + instance) * element.Stride + element.Offset, element.ElementSize);
+            }
+            offset += element.ElementSize;
+        }
+    }
+
+    void VertexBuffer::BuildInstanceDataBuffer(bgfx::InstanceDataBuffer& instanceDataBuffer, const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances, uint32_t instanceCount)
+    {
+        if (instanceCount == 0)
+        {
+            instanceCount = GetInstanceCount(instances);
+        }
+
+        // Create instance datas. Instance Data Buffer is transient.
+        bgfx::allocInstanceDataBuffer(&instanceDataBuffer, instanceCount, GetInstanceStride(instances));
+
+        // Copy instance data.
+        CopyInstanceData(instanceDataBuffer.data, instances, 0, instanceDataBuffer.num);
+    }
+
+    InstanceBuffer::~InstanceBuffer()
+    {
+        Dispose();
+    }
+
+    void InstanceBuffer::Dispose()
+    {
+        if (bgfx::isValid(m_handle) && m_deviceId == m_deviceContext->GetDeviceId())
+        {
+            bgfx::destroy(m_handle);
+        }
+
+        m_handle = BGFX_INVALID_HANDLE;
+        m_instanceCount = 0;
+        m_sources.clear();
+    }
+
+    void InstanceBuffer::Set(bgfx::Encoder* encoder, const std::map<bgfx::Attrib::Enum, VertexBuffer::InstanceInfo>& instances, uint32_t instanceCount)
+    {
+        if (instanceCount == 0)
+        {
+            instanceCount = VertexBuffer::GetInstanceCount(instances);
+        }
+
+        if (instanceCount == 0)
+        {
+            return;
+        }
+
+        auto& deviceContext{instances.begin()->second.Buffer->m_deviceContext};
+        const uint64_t frameNumber{deviceContext.GetFrameNumber()};
+
+        bool recreate{!bgfx::isValid(m_handle) || m_deviceId != deviceContext.GetDeviceId() || instanceCount > m_instanceCount || m_sources.size() != instances.size()};
+        uint32_t firstDirtyInstance{std::numeric_limits<uint32_t>::max()};
+        uint32_t lastDirtyInstance{0};
+
+        auto source{m_sources.begin()};
+        for (auto iter = instances.begin(); !recreate && iter != instances.end(); ++iter, ++source)
+        {
+            const auto& info{iter->second};
+            // Compare ids rather than pointers, a buffer allocated at the address of a disposed source is a different source.
+            if (info.Buffer->m_id != source->BufferId || info.Offset != source->Info.Offset || info.Stride != source->Info.Stride || info.ElementSize != source->Info.ElementSize)
+            {
+                recreate = true;
+                break;
+            }
+
+            // Convert the updated bytes of the source buffer to the range of instances whose element overlaps them.
+            const auto [begin, end] = info.Buffer->GetUpdatedRange(source->Version);
+            if (begin < end && end > info.Offset)
+            {
+                const size_t first{begin > info.Offset + info.ElementSize ? (begin - info.Offset - info.ElementSize) / info.Stride + 1 : 0};
+                const size_t last{(end - info.Offset - 1) / info.Stride + 1};
+                firstDirtyInstance = std::min(firstDirtyInstance, static_cast<uint32_t>(first));
+                lastDirtyInstance = std::max(lastDirtyInstance, static_cast<uint32_t>(std::min<size_t>(last, m_instanceCount)));
+            }
+        }
+
+        if (!recreate && firstDirtyInstance < lastDirtyInstance && m_lastFrameNumber == frameNumber)
+        {
+            // The buffer was already drawn from in this frame, and bgfx applies buffer updates before any draw of the
+            // frame, so use a transient copy of the data for this draw. The persistent buffer is updated next frame.
+            bgfx::InstanceDataBuffer instanceDataBuffer{};
+            VertexBuffer::BuildInstanceDataBuffer(instanceDataBuffer, instances, instanceCount);
+            encoder->setInstanceDataBuffer(&instanceDataBuffer);
+            return;
+        }
+
+        const uint16_t instanceStride{VertexBuffer::GetInstanceStride(instances)};
+
+        if (recreate)
+        {
+            Dispose();
+
+            bgfx::VertexLayout layout;
+            layout.begin();
+            layout.m_stride = instanceStride;
+            layout.end();
+
+            m_handle = bgfx::createDynamicVertexBuffer(instanceCount, layout);
+            if (!bgfx::isValid(m_handle))
+            {
+                throw std::runtime_error{"Failed to create instance buffer"};
             }
-            offset += iter->second.ElementSize;
+
+            m_deviceContext = &deviceContext;
+            m_deviceId = deviceContext.GetDeviceId();
+            m_instanceCount = instanceCount;
+            firstDirtyInstance = 0;
+            lastDirtyInstance = instanceCount;
+        }
+
+        if (firstDirtyInstance < lastDirtyInstance)
+        {
+            const uint32_t count{lastDirtyInstance - firstDirtyInstance};
+            const bgfx::Memory* memory{bgfx::alloc(count * instanceStride)};
+            VertexBuffer::CopyInstanceData(memory->data, instances, firstDirtyInstance, count);
+            bgfx::update(m_handle, firstDirtyInstance, memory);
         }
+
+        m_sources.clear();
+        for (const auto& pair : instances)
+        {
+            m_sources.push_back({pair.second, pair.second.Buffer->m_id, pair.second.Buffer->m_version});
+        }
+
+        m_lastFrameNumber = frameNumber;
+        encoder->setInstanceDataBuffer(m_handle, 0, instanceCount);
     }
 }
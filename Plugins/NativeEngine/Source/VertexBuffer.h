@@ -1,11 +1,16 @@
 #pragma once
 
+#include "GeometryData.h"
+
 #include <bgfx/bgfx.h>
 #include <napi/napi.h>
 #include <gsl/gsl>
+#include <deque>
 #include <list>
 #include <map>
 #include <optional>
+#include <utility>
+#include <vector>
 
 namespace Babylon
 {
@@ -17,7 +22,12 @@ namespace Babylon
     class VertexBuffer final
     {
     public:
-        VertexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, bool dynamic);
+        // Static buffers can reference the bytes instead of copying them, see GeometryData.
+        VertexBuffer(Graphics::DeviceContext& deviceContext, gsl::span<const uint8_t> bytes, bool dynamic, bool referenceBytes = false);
+
+        // Transient buffers have no data of their own, and draw from the memory allocated by AllocateTransient instead. The
+        // byte stride must fit the 16 bits of a bgfx vertex layout.
+        VertexBuffer(Graphics::DeviceContext& deviceContext, uint32_t byteStride);
         ~VertexBuffer();
 
         // No copy or move semantics
@@ -28,10 +38,25 @@ namespace Babylon
 
         void Update(gsl::span<const uint8_t> bytes, size_t byteOffset);
 
+        // Allocates transient memory of the current frame for the vertices of a transient buffer and copies them to it, so
+        // that the buffer draws them until the frame ends. Returns false if bgfx has no transient memory left this frame.
+        bool AllocateTransient(gsl::span<const uint8_t> bytes);
+
         void Build(uint32_t byteStride);
 
         void Set(bgfx::Encoder* encoder, uint8_t stream, uint32_t startVertex, uint32_t numVertices, bgfx::VertexLayoutHandle layout);
 
+        // Instance data is copied from the bytes on the CPU, which are then kept once the buffer is built.
+        void UseAsInstanceSource();
+
+        arcana::task<void, std::exception_ptr> WhenBytesReleased();
+
+        // Identifies the buffer for the lifetime of the process, unlike its address which can be reused once it is freed.
+        uint64_t GetId() const
+        {
+            return m_id;
+        }
+
         struct InstanceInfo
         {
             VertexBuffer* Buffer{};
@@ -40,15 +65,37 @@ namespace Babylon
             uint32_t ElementSize{};
         };
 
+        static uint32_t GetInstanceCount(const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances);
+        static uint16_t GetInstanceStride(const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances);
+        static void CopyInstanceData(uint8_t* destination, const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances, uint32_t firstInstance, uint32_t instanceCount);
         static void BuildInstanceDataBuffer(bgfx::InstanceDataBuffer& instanceDataBuffer, const std::map<bgfx::Attrib::Enum, InstanceInfo>& instances, uint32_t instanceCount);
 
     private:
+        friend class InstanceBuffer;
+
+        // Returns the byte range of the CPU data written by the updates made after the given version, or the whole
+        // buffer if the updates are no longer tracked.
+        std::pair<size_t, size_t> GetUpdatedRange(uint64_t version) const;
+
         Graphics::DeviceContext& m_deviceContext;
         const uintptr_t m_deviceId{};
+        const uint64_t m_id{};
 
-        std::vector<uint8_t> m_bytes{};
+        struct UpdateRecord
+        {
+            uint64_t Version{};
+            size_t Begin{};
+            size_t End{};
+        };
+
+        // Recent updates of the CPU data, used to only copy the changed range of instance data.
+        std::deque<UpdateRecord> m_updates{};
+        uint64_t m_version{};
+
+        GeometryData m_bytes;
         const bool m_dynamic{};
         uint32_t m_byteStride{};
+        bool m_instanceSource{};
 
         union
         {
@@ -56,6 +103,42 @@ namespace Babylon
             bgfx::DynamicVertexBufferHandle m_dynamicHandle;
         };
 
+        const bool m_transient{};
+        bgfx::TransientVertexBuffer m_transientBuffer{};
+        uint64_t m_transientFrameNumber{};
+
         bool m_disposed{};
     };
+
+    // Per-instance attributes interleaved into a dynamic vertex buffer that persists across draws, so that instance data
+    // is only copied again for the instances whose source vertex buffer data changed.
+    class InstanceBuffer final
+    {
+    public:
+        InstanceBuffer() = default;
+        ~InstanceBuffer();
+
+        // No copy or move semantics
+        InstanceBuffer(const InstanceBuffer&) = delete;
+        InstanceBuffer(InstanceBuffer&&) = delete;
+
+        void Dispose();
+
+        void Set(bgfx::Encoder* encoder, const std::map<bgfx::Attrib::Enum, VertexBuffer::InstanceInfo>& instances, uint32_t instanceCount);
+
+    private:
+        struct Source
+        {
+            VertexBuffer::InstanceInfo Info{};
+            uint64_t BufferId{};
+            uint64_t Version{};
+        };
+
+        Graphics::DeviceContext* m_deviceContext{};
+        uintptr_t m_deviceId{};
+        bgfx::DynamicVertexBufferHandle m_handle{bgfx::kInvalidHandle};
+        uint32_t m_instanceCount{};
+        std::vector<Source> m_sources{};
+        uint64_t m_lastFrameNumber{};
+    };
 };
@@ -0,0 +1,56 @@
+#include "VertexLayoutCache.h"
+#include <Babylon/Graphics/DeviceContext.h>
+
+#include <stdexcept>
+
+namespace Babylon
+{
+    std::mutex VertexLayoutCache::s_mutex{};
+    std::map<std::pair<uintptr_t, uint32_t>, VertexLayoutCache::Entry> VertexLayoutCache::s_entries{};
+
+    bgfx::VertexLayoutHandle VertexLayoutCache::Acquire(Graphics::DeviceContext& deviceContext, const bgfx::VertexLayout& layout)
+    {
+        std::scoped_lock lock{s_mutex};
+
+        auto& entry{s_entries[{deviceContext.GetDeviceId(), layout.m_hash}]};
+        if (entry.References == 0)
+        {
+            entry.Handle = bgfx::createVertexLayout(layout);
+            if (!bgfx::isValid(entry.Handle))
+            {
+                s_entries.erase({deviceContext.GetDeviceId(), layout.m_hash});
+                throw std::runtime_error{"Failed to create vertex layout"};
+            }
+        }
+
+        ++entry.References;
+        return entry.Handle;
+    }
+
+    void VertexLayoutCache::Release(Graphics::DeviceContext& deviceContext, uintptr_t deviceId, uint32_t hash)
+    {
+        std::scoped_lock lock{s_mutex};
+
+        auto it{s_entries.find({deviceId, hash})};
+        if (it == s_entries.end() || --it->second.References != 0)
+        {
+            return;
+        }
+
+        // Handles of a previous device were already destroyed with it.
+        if (deviceId == deviceContext.GetDeviceId())
+        {
+            bgfx::destroy(it->second.Handle);
+        }
+
+        s_entries.erase(it);
+    }
+
+    uint32_t VertexLayoutCache::GetReferences(const Graphics::DeviceContext& deviceContext, uint32_t hash)
+    {
+        std::scoped_lock lock{s_mutex};
+
+        const auto it{s_entries.find({deviceContext.GetDeviceId(), hash})};
+        return it == s_entries.end() ? 0 : it->second.References;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <bgfx/bgfx.h>
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace Babylon
+{
+    namespace Graphics
+    {
+        class DeviceContext;
+    }
+
+    // Shares one bgfx vertex layout handle between all the identical vertex layouts of a device, since bgfx has a small
+    // fixed number of them. Handles are reference counted and destroyed once no vertex array uses them anymore.
+    class VertexLayoutCache final
+    {
+    public:
+        // Returns the handle of the layout, creating it if no other vertex array uses an identical layout.
+        static bgfx::VertexLayoutHandle Acquire(Graphics::DeviceContext& deviceContext, const bgfx::VertexLayout& layout);
+
+        // Releases a handle acquired for the device with the given id and the layout with the given hash.
+        static void Release(Graphics::DeviceContext& deviceContext, uintptr_t deviceId, uint32_t hash);
+
+        // The number of vertex arrays of the device that use the layout with the given hash.
+        static uint32_t GetReferences(const Graphics::DeviceContext& deviceContext, uint32_t hash);
+
+    private:
+        struct Entry
+        {
+            bgfx::VertexLayoutHandle Handle{bgfx::kInvalidHandle};
+            uint32_t References{};
+        };
+
+        static std::mutex s_mutex;
+
+        // Keyed by device id, then layout hash.
+        static std::map<std::pair<uintptr_t, uint32_t>, Entry> s_entries;
+    };
+}
@@ -0,0 +1,174 @@
+#include "DracoDecoder.h"
+
+#include <draco/compression/decode.h>
+
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    namespace
+    {
+        template<typename T>
+        void ConvertAttribute(const draco::PointAttribute& attribute, uint32_t vertexCount, uint32_t componentType, bool normalized, DracoAttribute& result)
+        {
+            result.Size = attribute.num_components();
+            result.ByteStride = (result.Size * static_cast<uint32_t>(sizeof(T)) + 3) & ~3u;
+            result.ComponentType = componentType;
+            result.Normalized = normalized;
+            result.Data.resize(static_cast<size_t>(vertexCount) * result.ByteStride);
+
+            for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                auto* data{reinterpret_cast<T*>(result.Data.data() + static_cast<size_t>(vertex) * result.ByteStride)};
+                if (!attribute.ConvertValue<T>(attribute.mapped_index(draco::PointIndex{vertex}), data))
+                {
+                    throw std::runtime_error{"Failed to decode Draco mesh: cannot convert attribute " + result.Kind};
+                }
+            }
+        }
+
+        // Keeps the component type of the attribute if vertex buffers support it, and converts it to floats otherwise.
+        DracoAttribute DecodeAttribute(const draco::PointAttribute& attribute, uint32_t vertexCount, std::string kind)
+        {
+            DracoAttribute result{};
+            result.Kind = std::move(kind);
+
+            switch (attribute.data_type())
+            {
+                case draco::DT_INT8:
+                    ConvertAttribute<int8_t>(attribute, vertexCount, COMPONENT_TYPE_BYTE, attribute.normalized(), result);
+                    break;
+                case draco::DT_UINT8:
+                    ConvertAttribute<uint8_t>(attribute, vertexCount, COMPONENT_TYPE_UNSIGNED_BYTE, attribute.normalized(), result);
+                    break;
+                case draco::DT_INT16:
+                    ConvertAttribute<int16_t>(attribute, vertexCount, COMPONENT_TYPE_SHORT, attribute.normalized(), result);
+                    break;
+                case draco::DT_UINT16:
+                    ConvertAttribute<uint16_t>(attribute, vertexCount, COMPONENT_TYPE_UNSIGNED_SHORT, attribute.normalized(), result);
+                    break;
+                default:
+                    // Normalized values are already mapped to [0, 1] or [-1, 1] by the conversion.
+                    ConvertAttribute<float>(attribute, vertexCount, COMPONENT_TYPE_FLOAT, false, result);
+                    break;
+            }
+
+            return result;
+        }
+
+        // The vertex buffer kind of an attribute without a glTF name, or an empty string for the ones that are not decoded.
+        std::string GetDefaultKind(const draco::PointAttribute& attribute, uint32_t& texCoordCount)
+        {
+            switch (attribute.attribute_type())
+            {
+                case draco::GeometryAttribute::POSITION:
+                    return "position";
+                case draco::GeometryAttribute::NORMAL:
+                    return "normal";
+                case draco::GeometryAttribute::COLOR:
+                    return "color";
+                case draco::GeometryAttribute::TEX_COORD:
+                    return ++texCoordCount == 1 ? "uv" : "uv" + std::to_string(texCoordCount);
+                default:
+                    return {};
+            }
+        }
+
+        template<typename IndexT>
+        void DecodeIndices(const draco::Mesh& mesh, std::vector<IndexT>& indices)
+        {
+            indices.resize(static_cast<size_t>(mesh.num_faces()) * 3);
+            for (uint32_t face = 0; face < mesh.num_faces(); ++face)
+            {
+                const auto& vertices{mesh.face(draco::FaceIndex{face})};
+                for (size_t corner = 0; corner < 3; ++corner)
+                {
+                    indices[face * 3 + corner] = static_cast<IndexT>(vertices[corner].value());
+                }
+            }
+        }
+    }
+
+    DracoMesh DecodeDraco(const uint8_t* data, size_t size, const std::vector<std::pair<std::string, uint32_t>>& attributes)
+    {
+        draco::DecoderBuffer buffer{};
+        buffer.Init(reinterpret_cast<const char*>(data), size);
+
+        auto geometryType{draco::Decoder::GetEncodedGeometryType(&buffer)};
+        if (!geometryType.ok())
+        {
+            throw std::runtime_error{std::string{"Failed to decode Draco mesh: "} + geometryType.status().error_msg()};
+        }
+
+        // Meshes are decoded as such to get their faces, and anything else as a point cloud.
+        draco::Decoder decoder{};
+        std::unique_ptr<draco::PointCloud> pointCloud{};
+        if (geometryType.value() == draco::TRIANGULAR_MESH)
+        {
+            auto mesh{decoder.DecodeMeshFromBuffer(&buffer)};
+            if (!mesh.ok())
+            {
+                throw std::runtime_error{std::string{"Failed to decode Draco mesh: "} + mesh.status().error_msg()};
+            }
+
+            pointCloud = std::move(mesh).value();
+        }
+        else
+        {
+            auto points{decoder.DecodePointCloudFromBuffer(&buffer)};
+            if (!points.ok())
+            {
+                throw std::runtime_error{std::string{"Failed to decode Draco mesh: "} + points.status().error_msg()};
+            }
+
+            pointCloud = std::move(points).value();
+        }
+
+        DracoMesh result{};
+        result.VertexCount = pointCloud->num_points();
+
+        if (geometryType.value() == draco::TRIANGULAR_MESH)
+        {
+            const auto& mesh{static_cast<const draco::Mesh&>(*pointCloud)};
+            if (result.VertexCount <= std::numeric_limits<uint16_t>::max() + 1u)
+            {
+                DecodeIndices(mesh, result.Indices16);
+            }
+            else
+            {
+                DecodeIndices(mesh, result.Indices32);
+            }
+        }
+
+        if (attributes.empty())
+        {
+            uint32_t texCoordCount{0};
+            for (int32_t index = 0; index < pointCloud->num_attributes(); ++index)
+            {
+                const auto& attribute{*pointCloud->attribute(index)};
+                auto kind{GetDefaultKind(attribute, texCoordCount)};
+                if (!kind.empty())
+                {
+                    result.Attributes.push_back(DecodeAttribute(attribute, result.VertexCount, std::move(kind)));
+                }
+            }
+        }
+        else
+        {
+            for (const auto& [kind, uniqueId] : attributes)
+            {
+                const auto* attribute{pointCloud->GetAttributeByUniqueId(uniqueId)};
+                if (attribute == nullptr)
+                {
+                    throw std::runtime_error{"Failed to decode Draco mesh: missing attribute " + kind};
+                }
+
+                result.Attributes.push_back(DecodeAttribute(*attribute, result.VertexCount, kind));
+            }
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    // WebGL component types, which Babylon.js vertex buffers use.
+    constexpr uint32_t COMPONENT_TYPE_BYTE{5120};
+    constexpr uint32_t COMPONENT_TYPE_UNSIGNED_BYTE{5121};
+    constexpr uint32_t COMPONENT_TYPE_SHORT{5122};
+    constexpr uint32_t COMPONENT_TYPE_UNSIGNED_SHORT{5123};
+    constexpr uint32_t COMPONENT_TYPE_FLOAT{5126};
+
+    // A decoded attribute with `Size` components per vertex, one vertex every `ByteStride` bytes. Vertices are padded with
+    // zeros to a multiple of 4 bytes, which vertex buffers require.
+    struct DracoAttribute
+    {
+        std::string Kind{};
+        std::vector<std::byte> Data{};
+        uint32_t Size{};
+        uint32_t ByteStride{};
+
+        // One of the component types above.
+        uint32_t ComponentType{};
+        bool Normalized{};
+    };
+
+    // Only one of the index vectors is used: 16-bit indices when every vertex can be indexed by them, and none for point
+    // clouds.
+    struct DracoMesh
+    {
+        std::vector<uint16_t> Indices16{};
+        std::vector<uint32_t> Indices32{};
+        uint32_t VertexCount{};
+        std::vector<DracoAttribute> Attributes{};
+    };
+
+    // Decodes a Draco mesh or point cloud. `attributes` maps vertex buffer kinds to the unique ids of the attributes to
+    // decode, as in the KHR_draco_mesh_compression glTF extension. When it is empty, the position, normal, color and
+    // texture coordinate attributes are decoded.
+    DracoMesh DecodeDraco(const uint8_t* data, size_t size, const std::vector<std::pair<std::string, uint32_t>>& attributes);
+}
@@ -0,0 +1,185 @@
+// This file is compiled with AVX2 and FMA code generation. Nothing in it may run before the CPU has been checked for
+// support of both, so it only exposes InitializeAvx2Kernels, which Kernels.cpp calls after that check.
+
+#include "Kernels.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    namespace
+    {
+        // Loads x, y and z without reading past them.
+        __m128 Load3(const float* data)
+        {
+            return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(data)), _mm_load_ss(data + 2));
+        }
+
+        void Store3(float* data, __m128 value)
+        {
+            _mm_storel_pi(reinterpret_cast<__m64*>(data), value);
+            _mm_store_ss(data + 2, _mm_movehl_ps(value, value));
+        }
+
+        // Loads 4 floats from each of two addresses, the first in the low lane.
+        __m256 Load4x2(const float* low, const float* high)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+        }
+
+        __m256 Broadcast4(const float* data)
+        {
+            return _mm256_broadcast_ps(reinterpret_cast<const __m128*>(data));
+        }
+
+        __m256 Set2(float low, float high)
+        {
+            return _mm256_setr_ps(low, low, low, low, high, high, high, high);
+        }
+
+        // Transforms a vector in each lane by the matrix whose columns are in the corresponding lanes of the arguments.
+        __m256 Transform(__m256 column0, __m256 column1, __m256 column2, __m256 column3, __m256 x, __m256 y, __m256 z)
+        {
+            return _mm256_fmadd_ps(column0, x, _mm256_fmadd_ps(column1, y, _mm256_fmadd_ps(column2, z, column3)));
+        }
+
+        __m256 DivideByW(__m256 value)
+        {
+            return _mm256_div_ps(value, _mm256_permute_ps(value, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+
+        template<bool Coordinates>
+        void TransformVectors(float* data, size_t count, size_t stride, const float* m)
+        {
+            const __m256 column0{Broadcast4(m)};
+            const __m256 column1{Broadcast4(m + 4)};
+            const __m256 column2{Broadcast4(m + 8)};
+            const __m256 column3{Coordinates ? Broadcast4(m + 12) : _mm256_setzero_ps()};
+
+            size_t index{0};
+            for (; index + 2 <= count; index += 2, data += stride * 2)
+            {
+                float* next{data + stride};
+                __m256 result{Transform(column0, column1, column2, column3, Set2(data[0], next[0]), Set2(data[1], next[1]), Set2(data[2], next[2]))};
+                if constexpr (Coordinates)
+                {
+                    result = DivideByW(result);
+                }
+
+                Store3(data, _mm256_castps256_ps128(result));
+                Store3(next, _mm256_extractf128_ps(result, 1));
+            }
+
+            if (index < count)
+            {
+                __m256 result{Transform(column0, column1, column2, column3, _mm256_set1_ps(data[0]), _mm256_set1_ps(data[1]), _mm256_set1_ps(data[2]))};
+                if constexpr (Coordinates)
+                {
+                    result = DivideByW(result);
+                }
+
+                Store3(data, _mm256_castps256_ps128(result));
+            }
+        }
+
+        void ExtractMinAndMax(const float* positions, size_t count, size_t stride, float* minimum, float* maximum)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            __m256 minimumValue{_mm256_castps128_ps256(Load3(minimum))};
+            __m256 maximumValue{_mm256_castps128_ps256(Load3(maximum))};
+            minimumValue = _mm256_insertf128_ps(minimumValue, _mm256_castps256_ps128(minimumValue), 1);
+            maximumValue = _mm256_insertf128_ps(maximumValue, _mm256_castps256_ps128(maximumValue), 1);
+
+            // Every vector but the last is followed by at least one more float, so it can be loaded with 4 lanes.
+            size_t index{0};
+            for (; index + 2 < count; index += 2, positions += stride * 2)
+            {
+                const __m256 position{Load4x2(positions, positions + stride)};
+                minimumValue = _mm256_min_ps(minimumValue, position);
+                maximumValue = _mm256_max_ps(maximumValue, position);
+            }
+
+            __m128 minimum4{_mm_min_ps(_mm256_castps256_ps128(minimumValue), _mm256_extractf128_ps(minimumValue, 1))};
+            __m128 maximum4{_mm_max_ps(_mm256_castps256_ps128(maximumValue), _mm256_extractf128_ps(maximumValue, 1))};
+            for (; index < count; ++index, positions += stride)
+            {
+                const __m128 position{Load3(positions)};
+                minimum4 = _mm_min_ps(minimum4, position);
+                maximum4 = _mm_max_ps(maximum4, position);
+            }
+
+            Store3(minimum, minimum4);
+            Store3(maximum, maximum4);
+        }
+
+        // Adds the influences of a vertex two at a time, one per 128-bit lane.
+        __m256 AccumulateInfluences(__m256 result, const float* matrices, const float* indices, const float* weights, bool normals, __m256 x, __m256 y, __m256 z)
+        {
+            for (size_t influence = 0; influence < 4; influence += 2)
+            {
+                float weight0{weights[influence]};
+                float weight1{weights[influence + 1]};
+                const bool used0{weight0 > 0.0f};
+                const bool used1{weight1 > 0.0f};
+                if (!used0 && !used1)
+                {
+                    continue;
+                }
+
+                // The index of an unused influence may be out of range, so it borrows the matrix of the other one.
+                const float* m0{matrices + static_cast<size_t>(indices[used0 ? influence : influence + 1]) * 16};
+                const float* m1{matrices + static_cast<size_t>(indices[used1 ? influence + 1 : influence]) * 16};
+                weight0 = used0 ? weight0 : 0.0f;
+                weight1 = used1 ? weight1 : 0.0f;
+
+                const __m256 column3{normals ? _mm256_setzero_ps() : Load4x2(m0 + 12, m1 + 12)};
+                const __m256 transformed{Transform(Load4x2(m0, m1), Load4x2(m0 + 4, m1 + 4), Load4x2(m0 + 8, m1 + 8), column3, x, y, z)};
+                result = _mm256_fmadd_ps(transformed, Set2(weight0, weight1), result);
+            }
+
+            return result;
+        }
+
+        void ApplySkeleton(float* data, size_t count, bool normals, const SkinningData& skinning)
+        {
+            for (size_t index = 0; index < count; ++index, data += 3)
+            {
+                const __m256 x{_mm256_set1_ps(data[0])};
+                const __m256 y{_mm256_set1_ps(data[1])};
+                const __m256 z{_mm256_set1_ps(data[2])};
+
+                __m256 result{AccumulateInfluences(_mm256_setzero_ps(), skinning.Matrices, skinning.Indices + index * 4, skinning.Weights + index * 4, normals, x, y, z)};
+                if (skinning.IndicesExtra != nullptr && skinning.WeightsExtra != nullptr)
+                {
+                    result = AccumulateInfluences(result, skinning.Matrices, skinning.IndicesExtra + index * 4, skinning.WeightsExtra + index * 4, normals, x, y, z);
+                }
+
+                __m128 sum{_mm_add_ps(_mm256_castps256_ps128(result), _mm256_extractf128_ps(result, 1))};
+                if (!normals)
+                {
+                    sum = _mm_div_ps(sum, _mm_permute_ps(sum, _MM_SHUFFLE(3, 3, 3, 3)));
+                }
+
+                Store3(data, sum);
+            }
+        }
+    }
+
+    void InitializeAvx2Kernels(Kernels& kernels)
+    {
+        // Indexed extraction is bound by the gathers, so it keeps the baseline kernels.
+        kernels.Name = "AVX2";
+        kernels.TransformCoordinates = TransformVectors<true>;
+        kernels.TransformNormals = TransformVectors<false>;
+        kernels.ExtractMinAndMax = ExtractMinAndMax;
+        kernels.ApplySkeleton = ApplySkeleton;
+    }
+}
+
+#endif
@@ -0,0 +1,473 @@
+#include "Kernels.h"
+
+#include <algorithm>
+#include <optional>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NATIVE_OPTIMIZATIONS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define NATIVE_OPTIMIZATIONS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if NATIVE_OPTIMIZATIONS_AVX2
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+#if NATIVE_OPTIMIZATIONS_AVX2
+    // Defined in Kernels.AVX2.cpp, which is the only file compiled with AVX2 code generation.
+    void InitializeAvx2Kernels(Kernels& kernels);
+#endif
+
+    namespace
+    {
+        namespace Scalar
+        {
+            void TransformCoordinates(float* data, size_t count, size_t stride, const float* m)
+            {
+                for (size_t index = 0; index < count; ++index, data += stride)
+                {
+                    const auto x{data[0]}, y{data[1]}, z{data[2]};
+                    const auto rx{x * m[0] + y * m[4] + z * m[8] + m[12]};
+                    const auto ry{x * m[1] + y * m[5] + z * m[9] + m[13]};
+                    const auto rz{x * m[2] + y * m[6] + z * m[10] + m[14]};
+                    const auto rw{1 / (x * m[3] + y * m[7] + z * m[11] + m[15])};
+
+                    data[0] = rx * rw;
+                    data[1] = ry * rw;
+                    data[2] = rz * rw;
+                }
+            }
+
+            void TransformNormals(float* data, size_t count, size_t stride, const float* m)
+            {
+                for (size_t index = 0; index < count; ++index, data += stride)
+                {
+                    const auto x{data[0]}, y{data[1]}, z{data[2]};
+
+                    data[0] = x * m[0] + y * m[4] + z * m[8];
+                    data[1] = x * m[1] + y * m[5] + z * m[9];
+                    data[2] = x * m[2] + y * m[6] + z * m[10];
+                }
+            }
+
+            void ExtractMinAndMax(const float* positions, size_t count, size_t stride, float* minimum, float* maximum)
+            {
+                for (size_t index = 0; index < count; ++index, positions += stride)
+                {
+                    for (size_t component = 0; component < 3; ++component)
+                    {
+                        minimum[component] = std::min(minimum[component], positions[component]);
+                        maximum[component] = std::max(maximum[component], positions[component]);
+                    }
+                }
+            }
+
+            template<typename IndexT>
+            void ExtractMinAndMaxIndexed(const float* positions, const IndexT* indices, size_t count, float* minimum, float* maximum)
+            {
+                for (size_t index = 0; index < count; ++index)
+                {
+                    const float* position{positions + static_cast<size_t>(indices[index]) * 3};
+                    for (size_t component = 0; component < 3; ++component)
+                    {
+                        minimum[component] = std::min(minimum[component], position[component]);
+                        maximum[component] = std::max(maximum[component], position[component]);
+                    }
+                }
+            }
+
+            // Transforming the vector by each bone matrix and blending the results is equivalent to transforming it
+            // by the blended matrix, and avoids building a 4x4 matrix per vertex.
+            void AccumulateInfluences(const float* matrices, const float* indices, const float* weights, bool normals, float x, float y, float z, float* result)
+            {
+                for (size_t influence = 0; influence < 4; ++influence)
+                {
+                    const float weight{weights[influence]};
+                    if (weight > 0.0f)
+                    {
+                        const float* m{matrices + static_cast<size_t>(indices[influence]) * 16};
+                        const float w{normals ? 0.0f : 1.0f};
+                        result[0] += weight * (x * m[0] + y * m[4] + z * m[8] + w * m[12]);
+                        result[1] += weight * (x * m[1] + y * m[5] + z * m[9] + w * m[13]);
+                        result[2] += weight * (x * m[2] + y * m[6] + z * m[10] + w * m[14]);
+                        result[3] += weight * (x * m[3] + y * m[7] + z * m[11] + w * m[15]);
+                    }
+                }
+            }
+
+            void ApplySkeleton(float* data, size_t count, bool normals, const SkinningData& skinning)
+            {
+                for (size_t index = 0; index < count; ++index, data += 3)
+                {
+                    float result[4]{};
+                    AccumulateInfluences(skinning.Matrices, skinning.Indices + index * 4, skinning.Weights + index * 4, normals, data[0], data[1], data[2], result);
+                    if (skinning.IndicesExtra != nullptr && skinning.WeightsExtra != nullptr)
+                    {
+                        AccumulateInfluences(skinning.Matrices, skinning.IndicesExtra + index * 4, skinning.WeightsExtra + index * 4, normals, data[0], data[1], data[2], result);
+                    }
+
+                    const float scale{normals ? 1.0f : 1.0f / result[3]};
+                    data[0] = result[0] * scale;
+                    data[1] = result[1] * scale;
+                    data[2] = result[2] * scale;
+                }
+            }
+        }
+
+#if NATIVE_OPTIMIZATIONS_SSE2
+        namespace Baseline
+        {
+            // Loads x, y and z without reading past them.
+            __m128 Load3(const float* data)
+            {
+                return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(data)), _mm_load_ss(data + 2));
+            }
+
+            void Store3(float* data, __m128 value)
+            {
+                _mm_storel_pi(reinterpret_cast<__m64*>(data), value);
+                _mm_store_ss(data + 2, _mm_movehl_ps(value, value));
+            }
+
+            __m128 Transform(const float* m, float x, float y, float z, bool translate)
+            {
+                __m128 result{_mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(x))};
+                result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(y)));
+                result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(z)));
+                return translate ? _mm_add_ps(result, _mm_loadu_ps(m + 12)) : result;
+            }
+
+            __m128 DivideByW(__m128 value)
+            {
+                return _mm_div_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 3, 3)));
+            }
+
+            void TransformCoordinates(float* data, size_t count, size_t stride, const float* m)
+            {
+                for (size_t index = 0; index < count; ++index, data += stride)
+                {
+                    Store3(data, DivideByW(Transform(m, data[0], data[1], data[2], true)));
+                }
+            }
+
+            void TransformNormals(float* data, size_t count, size_t stride, const float* m)
+            {
+                for (size_t index = 0; index < count; ++index, data += stride)
+                {
+                    Store3(data, Transform(m, data[0], data[1], data[2], false));
+                }
+            }
+
+            void ExtractMinAndMax(const float* positions, size_t count, size_t stride, float* minimum, float* maximum)
+            {
+                if (count == 0)
+                {
+                    return;
+                }
+
+                __m128 minimumValue{Load3(minimum)};
+                __m128 maximumValue{Load3(maximum)};
+
+                // Every vector but the last is followed by at least one more float, so it can be loaded with 4 lanes.
+                for (size_t index = 0; index < count - 1; ++index, positions += stride)
+                {
+                    const __m128 position{_mm_loadu_ps(positions)};
+                    minimumValue = _mm_min_ps(minimumValue, position);
+                    maximumValue = _mm_max_ps(maximumValue, position);
+                }
+
+                const __m128 position{Load3(positions)};
+                Store3(minimum, _mm_min_ps(minimumValue, position));
+                Store3(maximum, _mm_max_ps(maximumValue, position));
+            }
+
+            template<typename IndexT>
+            void ExtractMinAndMaxIndexed(const float* positions, const IndexT* indices, size_t count, float* minimum, float* maximum)
+            {
+                __m128 minimumValue{Load3(minimum)};
+                __m128 maximumValue{Load3(maximum)};
+
+                for (size_t index = 0; index < count; ++index)
+                {
+                    const __m128 position{Load3(positions + static_cast<size_t>(indices[index]) * 3)};
+                    minimumValue = _mm_min_ps(minimumValue, position);
+                    maximumValue = _mm_max_ps(maximumValue, position);
+                }
+
+                Store3(minimum, minimumValue);
+                Store3(maximum, maximumValue);
+            }
+
+            __m128 AccumulateInfluences(__m128 result, const float* matrices, const float* indices, const float* weights, bool normals, float x, float y, float z)
+            {
+                for (size_t influence = 0; influence < 4; ++influence)
+                {
+                    const float weight{weights[influence]};
+                    if (weight > 0.0f)
+                    {
+                        const float* m{matrices + static_cast<size_t>(indices[influence]) * 16};
+                        result = _mm_add_ps(result, _mm_mul_ps(Transform(m, x, y, z, !normals), _mm_set1_ps(weight)));
+                    }
+                }
+
+                return result;
+            }
+
+            void ApplySkeleton(float* data, size_t count, bool normals, const SkinningData& skinning)
+            {
+                for (size_t index = 0; index < count; ++index, data += 3)
+                {
+                    const float x{data[0]}, y{data[1]}, z{data[2]};
+
+                    __m128 result{AccumulateInfluences(_mm_setzero_ps(), skinning.Matrices, skinning.Indices + index * 4, skinning.Weights + index * 4, normals, x, y, z)};
+                    if (skinning.IndicesExtra != nullptr && skinning.WeightsExtra != nullptr)
+                    {
+                        result = AccumulateInfluences(result, skinning.Matrices, skinning.IndicesExtra + index * 4, skinning.WeightsExtra + index * 4, normals, x, y, z);
+                    }
+
+                    Store3(data, normals ? result : DivideByW(result));
+                }
+            }
+        }
+#elif NATIVE_OPTIMIZATIONS_NEON
+        namespace Baseline
+        {
+            // Loads x, y and z without reading past them.
+            float32x4_t Load3(const float* data)
+            {
+                return vcombine_f32(vld1_f32(data), vld1_dup_f32(data + 2));
+            }
+
+            void Store3(float* data, float32x4_t value)
+            {
+                vst1_f32(data, vget_low_f32(value));
+                vst1q_lane_f32(data + 2, value, 2);
+            }
+
+            float32x4_t Transform(const float* m, float x, float y, float z, bool translate)
+            {
+                float32x4_t result{translate ? vld1q_f32(m + 12) : vdupq_n_f32(0.0f)};
+                result = vmlaq_n_f32(result, vld1q_f32(m), x);
+                result = vmlaq_n_f32(result, vld1q_f32(m + 4), y);
+                return vmlaq_n_f32(result, vld1q_f32(m + 8), z);
+            }
+
+            float32x4_t DivideByW(float32x4_t value)
+            {
+                return vmulq_n_f32(value, 1.0f / vgetq_lane_f32(value, 3));
+            }
+
+            void TransformCoordinates(float* data, size_t count, size_t stride, const float* m)
+            {
+                for (size_t index = 0; index < count; ++index, data += stride)
+                {
+                    Store3(data, DivideByW(Transform(m, data[0], data[1], data[2], true)));
+                }
+            }
+
+            void TransformNormals(float* data, size_t count, size_t stride, const float* m)
+            {
+                for (size_t index = 0; index < count; ++index, data += stride)
+                {
+                    Store3(data, Transform(m, data[0], data[1], data[2], false));
+                }
+            }
+
+            void ExtractMinAndMax(const float* positions, size_t count, size_t stride, float* minimum, float* maximum)
+            {
+                if (count == 0)
+                {
+                    return;
+                }
+
+                float32x4_t minimumValue{Load3(minimum)};
+                float32x4_t maximumValue{Load3(maximum)};
+
+                // Every vector but the last is followed by at least one more float, so it can be loaded with 4 lanes.
+                for (size_t index = 0; index < count - 1; ++index, positions += stride)
+                {
+                    const float32x4_t position{vld1q_f32(positions)};
+                    minimumValue = vminq_f32(minimumValue, position);
+                    maximumValue = vmaxq_f32(maximumValue, position);
+                }
+
+                const float32x4_t position{Load3(positions)};
+                Store3(minimum, vminq_f32(minimumValue, position));
+                Store3(maximum, vmaxq_f32(maximumValue, position));
+            }
+
+            template<typename IndexT>
+            void ExtractMinAndMaxIndexed(const float* positions, const IndexT* indices, size_t count, float* minimum, float* maximum)
+            {
+                float32x4_t minimumValue{Load3(minimum)};
+                float32x4_t maximumValue{Load3(maximum)};
+
+                for (size_t index = 0; index < count; ++index)
+                {
+                    const float32x4_t position{Load3(positions + static_cast<size_t>(indices[index]) * 3)};
+                    minimumValue = vminq_f32(minimumValue, position);
+                    maximumValue = vmaxq_f32(maximumValue, position);
+                }
+
+                Store3(minimum, minimumValue);
+                Store3(maximum, maximumValue);
+            }
+
+            float32x4_t AccumulateInfluences(float32x4_t result, const float* matrices, const float* indices, const float* weights, bool normals, float x, float y, float z)
+            {
+                for (size_t influence = 0; influence < 4; ++influence)
+                {
+                    const float weight{weights[influence]};
+                    if (weight > 0.0f)
+                    {
+                        const float* m{matrices + static_cast<size_t>(indices[influence]) * 16};
+                        result = vmlaq_n_f32(result, Transform(m, x, y, z, !normals), weight);
+                    }
+                }
+
+                return result;
+            }
+
+            void ApplySkeleton(float* data, size_t count, bool normals, const SkinningData& skinning)
+            {
+                for (size_t index = 0; index < count; ++index, data += 3)
+                {
+                    const float x{data[0]}, y{data[1]}, z{data[2]};
+
+                    float32x4_t result{AccumulateInfluences(vdupq_n_f32(0.0f), skinning.Matrices, skinning.Indices + index * 4, skinning.Weights + index * 4, normals, x, y, z)};
+                    if (skinning.IndicesExtra != nullptr && skinning.WeightsExtra != nullptr)
+                    {
+                        result = AccumulateInfluences(result, skinning.Matrices, skinning.IndicesExtra + index * 4, skinning.WeightsExtra + index * 4, normals, x, y, z);
+                    }
+
+                    Store3(data, normals ? result : DivideByW(result));
+                }
+            }
+        }
+#endif
+
+#if NATIVE_OPTIMIZATIONS_AVX2
+        bool IsAvx2Supported()
+        {
+            constexpr uint32_t FMA_BIT{1u << 12};
+            constexpr uint32_t OSXSAVE_BIT{1u << 27};
+            constexpr uint32_t AVX_BIT{1u << 28};
+            constexpr uint32_t AVX2_BIT{1u << 5};
+
+#if defined(_MSC_VER)
+            int registers[4]{};
+            __cpuid(registers, 0);
+            if (registers[0] < 7)
+            {
+                return false;
+            }
+
+            __cpuid(registers, 1);
+            const auto features{static_cast<uint32_t>(registers[2])};
+            if ((features & (FMA_BIT | OSXSAVE_BIT | AVX_BIT)) != (FMA_BIT | OSXSAVE_BIT | AVX_BIT))
+            {
+                return false;
+            }
+
+            // The OS must save the YMM registers on context switches.
+            const auto xcr0{_xgetbv(0)};
+
+            __cpuidex(registers, 7, 0);
+            const auto extendedFeatures{static_cast<uint32_t>(registers[1])};
+#else
+            unsigned int eax{}, ebx{}, ecx{}, edx{};
+            if (__get_cpuid_max(0, nullptr) < 7 || !__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            {
+                return false;
+            }
+
+            if ((ecx & (FMA_BIT | OSXSAVE_BIT | AVX_BIT)) != (FMA_BIT | OSXSAVE_BIT | AVX_BIT))
+            {
+                return false;
+            }
+
+            // The OS must save the YMM registers on context switches.
+            uint32_t xcr0Low{}, xcr0High{};
+            __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+            const uint64_t xcr0{(static_cast<uint64_t>(xcr0High) << 32) | xcr0Low};
+
+            __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+            const auto extendedFeatures{static_cast<uint32_t>(ebx)};
+#endif
+            return (xcr0 & 0x6) == 0x6 && (extendedFeatures & AVX2_BIT) != 0;
+        }
+#endif
+    }
+
+    const Kernels& GetScalarKernels()
+    {
+        static const Kernels kernels{
+            "Scalar",
+            Scalar::TransformCoordinates,
+            Scalar::TransformNormals,
+            Scalar::ExtractMinAndMax,
+            Scalar::ExtractMinAndMaxIndexed<uint16_t>,
+            Scalar::ExtractMinAndMaxIndexed<uint32_t>,
+            Scalar::ApplySkeleton,
+        };
+
+        return kernels;
+    }
+
+    const Kernels& GetBaselineKernels()
+    {
+#if NATIVE_OPTIMIZATIONS_SSE2 || NATIVE_OPTIMIZATIONS_NEON
+        static const Kernels kernels{
+#if NATIVE_OPTIMIZATIONS_SSE2
+            "SSE2",
+#else
+            "NEON",
+#endif
+            Baseline::TransformCoordinates,
+            Baseline::TransformNormals,
+            Baseline::ExtractMinAndMax,
+            Baseline::ExtractMinAndMaxIndexed<uint16_t>,
+            Baseline::ExtractMinAndMaxIndexed<uint32_t>,
+            Baseline::ApplySkeleton,
+        };
+
+        return kernels;
+#else
+        return GetScalarKernels();
+#endif
+    }
+
+    const Kernels* GetAvx2Kernels()
+    {
+#if NATIVE_OPTIMIZATIONS_AVX2
+        static const std::optional<Kernels> kernels{[]() -> std::optional<Kernels> {
+            if (!IsAvx2Supported())
+            {
+                return {};
+            }
+
+            Kernels avx2Kernels{GetBaselineKernels()};
+            InitializeAvx2Kernels(avx2Kernels);
+            return avx2Kernels;
+        }()};
+
+        return kernels ? &kernels.value() : nullptr;
+#else
+        return nullptr;
+#endif
+    }
+
+    const Kernels& GetKernels()
+    {
+        static const Kernels& kernels{GetAvx2Kernels() != nullptr ? *GetAvx2Kernels() : GetBaselineKernels()};
+        return kernels;
+    }
+}
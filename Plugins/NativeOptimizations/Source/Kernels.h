@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    // Matrices are 16 floats in Babylon.js (column-major, translation in elements 12 to 14) order.
+    struct SkinningData
+    {
+        const float* Matrices{};
+        const float* Indices{};
+        const float* Weights{};
+
+        // Optional influences 5 to 8, both null when the mesh has none.
+        const float* IndicesExtra{};
+        const float* WeightsExtra{};
+    };
+
+    // Math kernels working on raw typed array data. Vectors are read from the first 3 floats of every `stride` floats.
+    struct Kernels
+    {
+        const char* Name{};
+
+        void (*TransformCoordinates)(float* data, size_t count, size_t stride, const float* matrix){};
+        void (*TransformNormals)(float* data, size_t count, size_t stride, const float* matrix){};
+
+        // Expands `minimum` and `maximum` (3 floats each) to include the vectors.
+        void (*ExtractMinAndMax)(const float* positions, size_t count, size_t stride, float* minimum, float* maximum){};
+        void (*ExtractMinAndMaxIndexed16)(const float* positions, const uint16_t* indices, size_t count, float* minimum, float* maximum){};
+        void (*ExtractMinAndMaxIndexed32)(const float* positions, const uint32_t* indices, size_t count, float* minimum, float* maximum){};
+
+        // Transforms `count` vec3 by the weighted sum of their bone matrices, as coordinates or as normals.
+        void (*ApplySkeleton)(float* data, size_t count, bool normals, const SkinningData& skinning){};
+    };
+
+    const Kernels& GetScalarKernels();
+
+    // Kernels for the instruction set baseline of the target (SSE2 or NEON), or the scalar kernels if there is none.
+    const Kernels& GetBaselineKernels();
+
+    // Kernels using AVX2 and FMA, or null if they are not built for the target or not supported by the CPU.
+    const Kernels* GetAvx2Kernels();
+
+    // The fastest kernels supported by the CPU, selected on first use.
+    const Kernels& GetKernels();
+}
@@ -0,0 +1,130 @@
+#include "MeshOptimizer.h"
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    namespace
+    {
+        constexpr uint32_t INVALID_INDEX{~0u};
+
+        // meshoptimizer only asserts that its inputs are valid, so they are checked before any of it runs.
+        void CheckIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+        {
+            if (indexCount % 3 != 0)
+            {
+                throw std::runtime_error{"Index count must be a multiple of 3."};
+            }
+
+            if (std::any_of(indices, indices + indexCount, [vertexCount](uint32_t index) { return index >= vertexCount; }))
+            {
+                throw std::runtime_error{"Index is out of the range of vertices."};
+            }
+        }
+
+        size_t GetPositionByteStride(size_t positionStride)
+        {
+            if (positionStride < 3 || positionStride > MAX_POSITION_STRIDE)
+            {
+                throw std::runtime_error{"Position stride must be between 3 and 64."};
+            }
+
+            return positionStride * sizeof(float);
+        }
+    }
+
+    float AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+    {
+        CheckIndices(indices, indexCount, vertexCount);
+
+        if (indexCount == 0)
+        {
+            return 0;
+        }
+
+        // Warps and primitive groups of unbounded size leave a plain FIFO cache.
+        constexpr unsigned int unbounded{std::numeric_limits<unsigned int>::max()};
+        return meshopt_analyzeVertexCache(indices, indexCount, vertexCount, static_cast<unsigned int>(cacheSize), unbounded, unbounded).acmr;
+    }
+
+    void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+    {
+        CheckIndices(indices, indexCount, vertexCount);
+
+        meshopt_optimizeVertexCache(destination, indices, indexCount, vertexCount);
+    }
+
+    void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold)
+    {
+        CheckIndices(indices, indexCount, vertexCount);
+
+        meshopt_optimizeOverdraw(destination, indices, indexCount, positions, vertexCount, GetPositionByteStride(positionStride), threshold);
+    }
+
+    size_t OptimizeVertexFetch(uint32_t* indices, size_t indexCount, uint32_t* remap, size_t vertexCount)
+    {
+        CheckIndices(indices, indexCount, vertexCount);
+
+        const size_t usedVertexCount{meshopt_optimizeVertexFetchRemap(remap, indices, indexCount, vertexCount)};
+        meshopt_remapIndexBuffer(indices, indices, indexCount, remap);
+        return usedVertexCount;
+    }
+
+    void RemapVertexBuffer(uint8_t* data, size_t vertexCount, size_t byteStride, const uint32_t* remap)
+    {
+        // Every used vertex must move to a distinct index in range, which is checked before any of them moves.
+        std::vector<bool> targets(vertexCount);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            if (remap[vertex] != INVALID_INDEX)
+            {
+                if (remap[vertex] >= vertexCount)
+                {
+                    throw std::runtime_error{"Remapped vertex is out of the range of vertices."};
+                }
+
+                if (targets[remap[vertex]])
+                {
+                    throw std::runtime_error{"Remapped vertices must not share an index."};
+                }
+
+                targets[remap[vertex]] = true;
+            }
+        }
+
+        const std::vector<uint8_t> source(data, data + vertexCount * byteStride);
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            if (remap[vertex] != INVALID_INDEX)
+            {
+                std::memcpy(data + remap[vertex] * byteStride, source.data() + vertex * byteStride, byteStride);
+            }
+        }
+    }
+
+    bool NarrowIndices(uint16_t* destination, const uint32_t* indices, size_t indexCount)
+    {
+        if (std::any_of(indices, indices + indexCount, [](uint32_t index) { return index > UINT16_MAX; }))
+        {
+            return false;
+        }
+
+        std::transform(indices, indices + indexCount, destination, [](uint32_t index) { return static_cast<uint16_t>(index); });
+        return true;
+    }
+
+    std::vector<uint32_t> Simplify(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError)
+    {
+        CheckIndices(indices, indexCount, vertexCount);
+
+        std::vector<uint32_t> result(indexCount);
+        const size_t resultCount{meshopt_simplify(result.data(), indices, indexCount, positions, vertexCount, GetPositionByteStride(positionStride), targetIndexCount, targetError, meshopt_SimplifyLockBorder, nullptr)};
+        result.resize(resultCount);
+        return result;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    // Mesh processing on triangle lists, built on meshoptimizer. Positions are read from the first 3 floats of every
+    // `positionStride` floats, and every index must be less than `vertexCount`. Functions writing to `destination` allow
+    // it to be `indices`. Invalid inputs throw before anything is written.
+
+    // meshoptimizer reads vertex positions with a stride of at most 256 bytes.
+    constexpr size_t MAX_POSITION_STRIDE{64};
+
+    // Average number of vertices transformed per triangle with a FIFO post-transform cache of `cacheSize` vertices.
+    float AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize);
+
+    // Reorders the triangles so that consecutive ones share as many vertices as possible.
+    void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    // Reorders clusters of triangles from a vertex cache optimized index buffer so that the ones facing outwards are drawn
+    // first, which lets depth testing reject more of the pixels behind them. Clusters are only split where this makes
+    // the vertex cache efficiency worse by at most `threshold` times (1.05 keeps it within 5%).
+    void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, float threshold);
+
+    // Renumbers the vertices in the order in which the indices first use them, so that vertex data is fetched linearly,
+    // and rewrites the indices. `remap` receives the new index of every vertex, or ~0u for the unused ones. Returns the
+    // number of used vertices.
+    size_t OptimizeVertexFetch(uint32_t* indices, size_t indexCount, uint32_t* remap, size_t vertexCount);
+
+    // Moves every vertex of `byteStride` bytes to the index given by `remap`, dropping the unused ones. Works in place.
+    // Used vertices must be remapped to distinct indices less than `vertexCount`.
+    void RemapVertexBuffer(uint8_t* data, size_t vertexCount, size_t byteStride, const uint32_t* remap);
+
+    // Copies the indices as 16-bit values, and returns false without writing anything if one of them does not fit.
+    bool NarrowIndices(uint16_t* destination, const uint32_t* indices, size_t indexCount);
+
+    // Collapses edges until at most `targetIndexCount` indices remain or any further collapse would move the surface more
+    // than `targetError` relative to the size of the mesh. The result indexes the same vertices. Vertices on open borders
+    // are never moved, and attribute seams, where several vertices share a position, are kept so that the result does
+    // not crack.
+    std::vector<uint32_t> Simplify(const uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError);
+}
@@ -0,0 +1,115 @@
+#include "MeshoptDecoder.h"
+
+#include <meshoptimizer.h>
+
+#include <limits>
+#include <stdexcept>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    MeshoptMode ParseMeshoptMode(const std::string& mode)
+    {
+        if (mode == "ATTRIBUTES")
+        {
+            return MeshoptMode::Attributes;
+        }
+        else if (mode == "TRIANGLES")
+        {
+            return MeshoptMode::Triangles;
+        }
+        else if (mode == "INDICES")
+        {
+            return MeshoptMode::Indices;
+        }
+
+        throw std::runtime_error{"Unsupported meshopt mode " + mode};
+    }
+
+    MeshoptFilter ParseMeshoptFilter(const std::string& filter)
+    {
+        if (filter.empty() || filter == "NONE")
+        {
+            return MeshoptFilter::None;
+        }
+        else if (filter == "OCTAHEDRAL")
+        {
+            return MeshoptFilter::Octahedral;
+        }
+        else if (filter == "QUATERNION")
+        {
+            return MeshoptFilter::Quaternion;
+        }
+        else if (filter == "EXPONENTIAL")
+        {
+            return MeshoptFilter::Exponential;
+        }
+
+        throw std::runtime_error{"Unsupported meshopt filter " + filter};
+    }
+
+    size_t GetMeshoptDecodedSize(size_t count, size_t stride, MeshoptMode mode, MeshoptFilter filter)
+    {
+        // The strides allowed by the extension.
+        const bool validStride{mode == MeshoptMode::Attributes ? stride > 0 && stride <= 256 && stride % 4 == 0 : stride == 2 || stride == 4};
+        const bool validFilter{filter == MeshoptFilter::None ||
+                               (mode == MeshoptMode::Attributes &&
+                                   ((filter == MeshoptFilter::Octahedral && (stride == 4 || stride == 8)) ||
+                                       (filter == MeshoptFilter::Quaternion && stride == 8) ||
+                                       filter == MeshoptFilter::Exponential))};
+        if (!validStride || !validFilter)
+        {
+            throw std::runtime_error{"Failed to decode meshopt buffer: invalid stride or filter"};
+        }
+
+        if (mode == MeshoptMode::Triangles && count % 3 != 0)
+        {
+            throw std::runtime_error{"Failed to decode meshopt buffer: triangle index count must be a multiple of 3"};
+        }
+
+        if (count > std::numeric_limits<size_t>::max() / stride)
+        {
+            throw std::runtime_error{"Failed to decode meshopt buffer: count is too large"};
+        }
+
+        return count * stride;
+    }
+
+    void DecodeMeshopt(uint8_t* destination, size_t count, size_t stride, const uint8_t* source, size_t sourceSize, MeshoptMode mode, MeshoptFilter filter)
+    {
+        GetMeshoptDecodedSize(count, stride, mode, filter);
+
+        int result{-1};
+        switch (mode)
+        {
+            case MeshoptMode::Attributes:
+                result = meshopt_decodeVertexBuffer(destination, count, stride, source, sourceSize);
+                break;
+            case MeshoptMode::Triangles:
+                result = meshopt_decodeIndexBuffer(destination, count, stride, source, sourceSize);
+                break;
+            case MeshoptMode::Indices:
+                result = meshopt_decodeIndexSequence(destination, count, stride, source, sourceSize);
+                break;
+        }
+
+        if (result != 0)
+        {
+            throw std::runtime_error{"Failed to decode meshopt buffer: error " + std::to_string(result)};
+        }
+
+        switch (filter)
+        {
+            case MeshoptFilter::None:
+                break;
+            case MeshoptFilter::Octahedral:
+                meshopt_decodeFilterOct(destination, count, stride);
+                break;
+            case MeshoptFilter::Quaternion:
+                meshopt_decodeFilterQuat(destination, count, stride);
+                break;
+            case MeshoptFilter::Exponential:
+                meshopt_decodeFilterExp(destination, count, stride);
+                break;
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    // Modes and filters of buffer views compressed with the EXT_meshopt_compression glTF extension.
+    enum class MeshoptMode
+    {
+        Attributes,
+        Triangles,
+        Indices,
+    };
+
+    enum class MeshoptFilter
+    {
+        None,
+        Octahedral,
+        Quaternion,
+        Exponential,
+    };
+
+    // Parse the names used by the extension, such as "ATTRIBUTES" or "OCTAHEDRAL".
+    MeshoptMode ParseMeshoptMode(const std::string& mode);
+    MeshoptFilter ParseMeshoptFilter(const std::string& filter);
+
+    // Checks the arguments of DecodeMeshopt, which the decoders only assert, and returns the `count * stride` bytes that
+    // `destination` must hold.
+    size_t GetMeshoptDecodedSize(size_t count, size_t stride, MeshoptMode mode, MeshoptFilter filter);
+
+    // Decodes `count` elements of `stride` bytes into `destination`, which must hold `count * stride` bytes.
+    void DecodeMeshopt(uint8_t* destination, size_t count, size_t stride, const uint8_t* source, size_t sourceSize, MeshoptMode mode, MeshoptFilter filter);
+}
@@ -1,96 +1,119 @@
 #include <Babylon/Plugins/NativeOptimizations.h>
 #include <Babylon/JsRuntime.h>
-#include <optional>
+#include <Babylon/JsRuntimeScheduler.h>
+
+#include "Kernels.h"
+#include "MeshOptimizer.h"
+#include "Parallel.h"
+
+#ifdef DRACO
+#include "DracoDecoder.h"
+#endif
+
+#ifdef MESHOPT
+#include "MeshoptDecoder.h"
+#endif
+
+#include <arcana/threading/task.h>
+#include <arcana/threading/task_schedulers.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace
 {
-    void MatrixScaleAdd(const float inputMatrix[16], float scale, float outputMatrix[16])
+    using Babylon::Plugins::NativeOptimizations::GetChunkCount;
+    using Babylon::Plugins::NativeOptimizations::GetChunkRange;
+    using Babylon::Plugins::NativeOptimizations::GetKernels;
+    using Babylon::Plugins::NativeOptimizations::NarrowIndices;
+    using Babylon::Plugins::NativeOptimizations::OptimizeOverdraw;
+    using Babylon::Plugins::NativeOptimizations::OptimizeVertexCache;
+    using Babylon::Plugins::NativeOptimizations::OptimizeVertexFetch;
+    using Babylon::Plugins::NativeOptimizations::ParallelFor;
+    using Babylon::Plugins::NativeOptimizations::RemapVertexBuffer;
+    using Babylon::Plugins::NativeOptimizations::Simplify;
+    using Babylon::Plugins::NativeOptimizations::SkinningData;
+
+#ifdef DRACO
+    using Babylon::Plugins::NativeOptimizations::COMPONENT_TYPE_BYTE;
+    using Babylon::Plugins::NativeOptimizations::COMPONENT_TYPE_SHORT;
+    using Babylon::Plugins::NativeOptimizations::COMPONENT_TYPE_UNSIGNED_BYTE;
+    using Babylon::Plugins::NativeOptimizations::COMPONENT_TYPE_UNSIGNED_SHORT;
+    using Babylon::Plugins::NativeOptimizations::DecodeDraco;
+    using Babylon::Plugins::NativeOptimizations::DracoMesh;
+#endif
+
+#ifdef MESHOPT
+    using Babylon::Plugins::NativeOptimizations::DecodeMeshopt;
+    using Babylon::Plugins::NativeOptimizations::GetMeshoptDecodedSize;
+    using Babylon::Plugins::NativeOptimizations::ParseMeshoptFilter;
+    using Babylon::Plugins::NativeOptimizations::ParseMeshoptMode;
+#endif
+
+    void CheckRange(const Napi::TypedArray& array, size_t end)
     {
-        for (size_t i = 0; i < 16; ++i)
+        if (end > array.ElementLength())
         {
-            outputMatrix[i] += inputMatrix[i] * scale;
+            throw std::runtime_error{"TypedArray range is out of bounds."};
         }
     }
 
-    void MatrixTransformNormal(const float matrix[16], float &x, float &y, float &z)
+    void GetVector3(const Napi::Object& vector, float result[3])
     {
-        float rx = x * matrix[0] + y * matrix[4] + z * matrix[8];
-        float ry = x * matrix[1] + y * matrix[5] + z * matrix[9];
-        float rz = x * matrix[2] + y * matrix[6] + z * matrix[10];
-
-        x = rx;
-        y = ry;
-        z = rz;
+        result[0] = vector.Get("_x").As<Napi::Number>().FloatValue();
+        result[1] = vector.Get("_y").As<Napi::Number>().FloatValue();
+        result[2] = vector.Get("_z").As<Napi::Number>().FloatValue();
     }
 
-    void MatrixTransformCoordinates(const float matrix[16], float& x, float& y, float& z)
+    void SetVector3(Napi::Object vector, const float value[3])
     {
-        float rx = x * matrix[0] + y * matrix[4] + z * matrix[8] + matrix[12];
-        float ry = x * matrix[1] + y * matrix[5] + z * matrix[9] + matrix[13];
-        float rz = x * matrix[2] + y * matrix[6] + z * matrix[10] + matrix[14];
-        float rw = 1.0f / (x * matrix[3] + y * matrix[7] + z * matrix[11] + matrix[15]);
+        vector.Set("_x", value[0]);
+        vector.Set("_y", value[1]);
+        vector.Set("_z", value[2]);
+    }
 
-        x = rx * rw;
-        y = ry * rw;
-        z = rz * rw;
+    const float* GetMatrix(const Napi::CallbackInfo& info, size_t argument)
+    {
+        const auto m{info[argument].As<Napi::Object>().Get("_m").As<Napi::Float32Array>()};
+        CheckRange(m, 16);
+        return m.Data();
     }
 
-    void TransformVector3Coordinates(const Napi::CallbackInfo& info)
+    template<typename TransformT>
+    void TransformVectors(const Napi::CallbackInfo& info, size_t stride, TransformT transform)
     {
-        auto coordinates{info[0].As<Napi::Float32Array>()};
-        const auto transform{info[1].As<Napi::Object>()};
-        const auto m{transform.Get("_m").As<Napi::Float32Array>()};
+        auto vectors{info[0].As<Napi::Float32Array>()};
+        const auto m{GetMatrix(info, 1)};
         const auto offset{info[2].As<Napi::Number>().Uint32Value()};
         const auto length{info[3].As<Napi::Number>().Uint32Value()};
 
-        for (size_t index = offset; index < offset + length; index += 3)
+        const size_t count{(static_cast<size_t>(length) + stride - 1) / stride};
+        if (count > 0)
         {
-            const auto x{coordinates[index]}, y{coordinates[index + 1]}, z{coordinates[index + 2]};
-            const auto rx{x * m[0U] + y * m[4U] + z * m[8U] + m[12U]};
-            const auto ry{x * m[1U] + y * m[5U] + z * m[9U] + m[13U]};
-            const auto rz{x * m[2U] + y * m[6U] + z * m[10U] + m[14U]};
-            const auto rw{1 / (x * m[3U] + y * m[7U] + z * m[11U] + m[15U])};
-
-            coordinates[index + 0] = rx * rw;
-            coordinates[index + 1] = ry * rw;
-            coordinates[index + 2] = rz * rw;
+            CheckRange(vectors, offset + (count - 1) * stride + 3);
+            transform(vectors.Data() + offset, count, stride, m);
         }
     }
 
-    void TransformVector3Normals(const Napi::CallbackInfo& info)
+    void TransformVector3Coordinates(const Napi::CallbackInfo& info)
     {
-        auto normals{info[0].As<Napi::Float32Array>()};
-        const auto transform{info[1].As<Napi::Object>()};
-        const auto m{transform.Get("_m").As<Napi::Float32Array>()};
-        const auto offset{info[2].As<Napi::Number>().Uint32Value()};
-        const auto length{info[3].As<Napi::Number>().Uint32Value()};
-
-        for (size_t index = offset; index < offset + length; index += 3)
-        {
-            const auto x{normals[index]}, y{normals[index + 1]}, z{normals[index + 2]};
+        TransformVectors(info, 3, GetKernels().TransformCoordinates);
+    }
 
-            normals[index + 0] = x * m[0U] + y * m[4U] + z * m[8U];
-            normals[index + 1] = x * m[1U] + y * m[5U] + z * m[9U];
-            normals[index + 2] = x * m[2U] + y * m[6U] + z * m[10U];
-        }
+    void TransformVector3Normals(const Napi::CallbackInfo& info)
+    {
+        TransformVectors(info, 3, GetKernels().TransformNormals);
     }
 
     void TransformVector4Normals(const Napi::CallbackInfo& info)
     {
-        auto normals{info[0].As<Napi::Float32Array>()};
-        const auto transform{info[1].As<Napi::Object>()};
-        const auto m{transform.Get("_m").As<Napi::Float32Array>()};
-        const auto offset{info[2].As<Napi::Number>().Uint32Value()};
-        const auto length{info[3].As<Napi::Number>().Uint32Value()};
-
-        for (size_t index = offset; index < offset + length; index += 4)
-        {
-            const auto x{normals[index]}, y{normals[index + 1]}, z{normals[index + 2]};
-
-            normals[index + 0] = x * m[0U] + y * m[4U] + z * m[8U];
-            normals[index + 1] = x * m[1U] + y * m[5U] + z * m[9U];
-            normals[index + 2] = x * m[2U] + y * m[6U] + z * m[10U];
-        }
+        TransformVectors(info, 4, GetKernels().TransformNormals);
     }
 
     template<typename IndexT>
@@ -128,37 +151,44 @@ namespace
         }
     }
 
-    template<typename IndexT>
-    void ExtractMinAndMaxIndexedT(const Napi::Float32Array positions, const Napi::TypedArrayOf<IndexT> indices, uint32_t indexStart, uint32_t indexCount, Napi::Object minVector, Napi::Object maxVector)
+    // Ranges smaller than these are not worth splitting across threads.
+    constexpr size_t BOUNDS_GRAIN_SIZE{64 * 1024};
+    constexpr size_t SKINNING_GRAIN_SIZE{4 * 1024};
+
+    using ExtractFunction = std::function<void(size_t begin, size_t end, float* minimum, float* maximum)>;
+
+    // Extracts the bounds of chunks of the range in parallel and merges them into `minimum` and `maximum`.
+    void ParallelExtractMinAndMax(size_t count, float* minimum, float* maximum, const ExtractFunction& extract)
     {
-        auto minX{minVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto minY{minVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto minZ{minVector.Get("_z").As<Napi::Number>().FloatValue()};
-        auto maxX{maxVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto maxY{maxVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto maxZ{maxVector.Get("_z").As<Napi::Number>().FloatValue()};
+        const size_t chunkCount{GetChunkCount(count, BOUNDS_GRAIN_SIZE)};
 
-        for (auto index = indexStart; index < indexStart + indexCount; index++)
+        std::vector<float> bounds(chunkCount * 6);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
         {
-            const auto offset{static_cast<size_t>(indices[index] * 3)};
-            const auto x{positions[offset]};
-            const auto y{positions[offset + 1]};
-            const auto z{positions[offset + 2]};
-
-            minX = std::min(minX, x);
-            minY = std::min(minY, y);
-            minZ = std::min(minZ, z);
-            maxX = std::max(maxX, x);
-            maxY = std::max(maxY, y);
-            maxZ = std::max(maxZ, z);
+            std::copy(minimum, minimum + 3, &bounds[chunk * 6]);
+            std::copy(maximum, maximum + 3, &bounds[chunk * 6 + 3]);
         }
 
-        minVector.Set("_x", minX);
-        minVector.Set("_y", minY);
-        minVector.Set("_z", minZ);
-        maxVector.Set("_x", maxX);
-        maxVector.Set("_y", maxY);
-        maxVector.Set("_z", maxZ);
+        ParallelFor(count, BOUNDS_GRAIN_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            extract(begin, end, &bounds[chunk * 6], &bounds[chunk * 6 + 3]);
+        });
+
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            for (size_t component = 0; component < 3; ++component)
+            {
+                minimum[component] = std::min(minimum[component], bounds[chunk * 6 + component]);
+                maximum[component] = std::max(maximum[component], bounds[chunk * 6 + 3 + component]);
+            }
+        }
+    }
+
+    template<typename IndexT>
+    void ExtractMinAndMaxIndexedT(void (*kernel)(const float*, const IndexT*, size_t, float*, float*), const float* positions, const IndexT* indices, size_t count, float* minimum, float* maximum)
+    {
+        ParallelExtractMinAndMax(count, minimum, maximum, [=](size_t begin, size_t end, float* chunkMinimum, float* chunkMaximum) {
+            kernel(positions, indices + begin, end - begin, chunkMinimum, chunkMaximum);
+        });
     }
 
     void ExtractMinAndMaxIndexed(const Napi::CallbackInfo& info)
@@ -170,22 +200,34 @@ namespace
         auto minVector{info[4].As<Napi::Object>()};
         auto maxVector{info[5].As<Napi::Object>()};
 
+        CheckRange(indices, static_cast<size_t>(indexStart) + indexCount);
+
+        float minimum[3], maximum[3];
+        GetVector3(minVector, minimum);
+        GetVector3(maxVector, maximum);
+
+        const auto& kernels{GetKernels()};
         if (indices.TypedArrayType() == napi_typedarray_type::napi_int32_array)
         {
-            ExtractMinAndMaxIndexedT<int32_t>(positions, indices.As<Napi::Int32Array>(), indexStart, indexCount, minVector, maxVector);
+            // Valid indices are never negative, so they have the same representation as unsigned integers.
+            const auto data{reinterpret_cast<const uint32_t*>(indices.As<Napi::Int32Array>().Data())};
+            ExtractMinAndMaxIndexedT(kernels.ExtractMinAndMaxIndexed32, positions.Data(), data + indexStart, indexCount, minimum, maximum);
         }
         else if (indices.TypedArrayType() == napi_typedarray_type::napi_uint32_array)
         {
-            ExtractMinAndMaxIndexedT<uint32_t>(positions, indices.As<Napi::Uint32Array>(), indexStart, indexCount, minVector, maxVector);
+            ExtractMinAndMaxIndexedT(kernels.ExtractMinAndMaxIndexed32, positions.Data(), indices.As<Napi::Uint32Array>().Data() + indexStart, indexCount, minimum, maximum);
         }
         else if (indices.TypedArrayType() == napi_typedarray_type::napi_uint16_array)
         {
-            ExtractMinAndMaxIndexedT<uint16_t>(positions, indices.As<Napi::Uint16Array>(), indexStart, indexCount, minVector, maxVector);
+            ExtractMinAndMaxIndexedT(kernels.ExtractMinAndMaxIndexed16, positions.Data(), indices.As<Napi::Uint16Array>().Data() + indexStart, indexCount, minimum, maximum);
         }
         else
         {
             throw std::runtime_error{"Indices TypedArray element type was unexpected."};
         }
+
+        SetVector3(minVector, minimum);
+        SetVector3(maxVector, maximum);
     }
 
     void ExtractMinAndMax(const Napi::CallbackInfo& info)
@@ -197,37 +239,50 @@ namespace
         auto minVector{info[4].As<Napi::Object>()};
         auto maxVector{info[5].As<Napi::Object>()};
 
-        auto minX{minVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto minY{minVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto minZ{minVector.Get("_z").As<Napi::Number>().FloatValue()};
-        auto maxX{maxVector.Get("_x").As<Napi::Number>().FloatValue()};
-        auto maxY{maxVector.Get("_y").As<Napi::Number>().FloatValue()};
-        auto maxZ{maxVector.Get("_z").As<Napi::Number>().FloatValue()};
+        float minimum[3], maximum[3];
+        GetVector3(minVector, minimum);
+        GetVector3(maxVector, maximum);
 
-        for (auto index = start, offset = start * stride; index < start + count; index++, offset += stride)
+        if (count > 0)
         {
-            const auto x{positions[offset]};
-            const auto y{positions[offset + 1]};
-            const auto z{positions[offset + 2]};
-
-            minX = std::min(minX, x);
-            minY = std::min(minY, y);
-            minZ = std::min(minZ, z);
-            maxX = std::max(maxX, x);
-            maxY = std::max(maxY, y);
-            maxZ = std::max(maxZ, z);
+            CheckRange(positions, (static_cast<size_t>(start) + count - 1) * stride + 3);
+
+            const auto kernel{GetKernels().ExtractMinAndMax};
+            const float* data{positions.Data() + static_cast<size_t>(start) * stride};
+            ParallelExtractMinAndMax(count, minimum, maximum, [=](size_t begin, size_t end, float* chunkMinimum, float* chunkMaximum) {
+                kernel(data + begin * stride, end - begin, stride, chunkMinimum, chunkMaximum);
+            });
         }
 
-        minVector.Set("_x", minX);
-        minVector.Set("_y", minY);
-        minVector.Set("_z", minZ);
-        maxVector.Set("_x", maxX);
-        maxVector.Set("_y", maxY);
-        maxVector.Set("_z", maxZ);
+        SetVector3(minVector, minimum);
+        SetVector3(maxVector, maximum);
     }
 
-    // Ported from `applySkeleton` function in abstractMesh.ts
-    void ApplySkeleton(const Napi::CallbackInfo& info)
+    struct SkinningArguments
+    {
+        float* Data{};
+        size_t Count{};
+        bool Normals{};
+        SkinningData Skinning{};
+
+        // The arrays that the pointers above point into.
+        std::vector<Napi::Float32Array> Arrays{};
+    };
+
+    // The kernels index the matrices with every influence that has a positive weight, so those must refer to a bone of the
+    // skeleton. Checked for all vertices before any of them is skinned.
+    void CheckInfluences(const float* indices, const float* weights, size_t count, size_t boneCount)
+    {
+        for (size_t influence = 0; influence < count * 4; ++influence)
+        {
+            if (weights[influence] > 0.0f && !(indices[influence] >= 0.0f && indices[influence] < static_cast<float>(boneCount)))
+            {
+                throw std::runtime_error{"Matrix index is out of the skeleton bounds."};
+            }
+        }
+    }
+
+    SkinningArguments GetSkinningArguments(const Napi::CallbackInfo& info)
     {
         auto data = info[0].As<Napi::Float32Array>();
         const auto kind = info[1].As<Napi::String>().Utf8Value();
@@ -235,44 +290,442 @@ namespace
         const auto matricesIndicesData = info[3].As<Napi::Float32Array>();
         const auto matricesWeightsData = info[4].As<Napi::Float32Array>();
 
-        std::optional<Napi::Float32Array> matricesIndicesExtraData;
-        if (!info[5].IsNull())
+        const size_t count{data.ElementLength() / 3};
+        const size_t boneCount{skeletonMatrices.ElementLength() / 16};
+        CheckRange(matricesIndicesData, count * 4);
+        CheckRange(matricesWeightsData, count * 4);
+        CheckInfluences(matricesIndicesData.Data(), matricesWeightsData.Data(), count, boneCount);
+
+        SkinningArguments arguments{data.Data(), count, kind == "normal", {skeletonMatrices.Data(), matricesIndicesData.Data(), matricesWeightsData.Data()}};
+        arguments.Arrays = {data, skeletonMatrices, matricesIndicesData, matricesWeightsData};
+
+        if (!info[5].IsNull() && !info[6].IsNull())
         {
-            matricesIndicesExtraData = info[5].As<Napi::Float32Array>();
-        };
+            const auto matricesIndicesExtraData = info[5].As<Napi::Float32Array>();
+            const auto matricesWeightsExtraData = info[6].As<Napi::Float32Array>();
+            CheckRange(matricesIndicesExtraData, count * 4);
+            CheckRange(matricesWeightsExtraData, count * 4);
+            CheckInfluences(matricesIndicesExtraData.Data(), matricesWeightsExtraData.Data(), count, boneCount);
+
+            arguments.Skinning.IndicesExtra = matricesIndicesExtraData.Data();
+            arguments.Skinning.WeightsExtra = matricesWeightsExtraData.Data();
+            arguments.Arrays.push_back(matricesIndicesExtraData);
+            arguments.Arrays.push_back(matricesWeightsExtraData);
+        }
 
-        std::optional<Napi::Float32Array> matricesWeightsExtraData;
-        if (!info[6].IsNull())
+        return arguments;
+    }
+
+    void ApplySkeletonRange(const SkinningArguments& arguments, size_t begin, size_t end)
+    {
+        SkinningData skinning{arguments.Skinning};
+        skinning.Indices += begin * 4;
+        skinning.Weights += begin * 4;
+        if (skinning.IndicesExtra != nullptr && skinning.WeightsExtra != nullptr)
         {
-            matricesWeightsExtraData = info[6].As<Napi::Float32Array>();
+            skinning.IndicesExtra += begin * 4;
+            skinning.WeightsExtra += begin * 4;
         }
 
-        auto matrixTransform = kind == "normal" ? MatrixTransformNormal : MatrixTransformCoordinates;
+        GetKernels().ApplySkeleton(arguments.Data + begin * 3, end - begin, arguments.Normals, skinning);
+    }
 
-        for (size_t index = 0, matWeightIdx = 0; index < data.ElementLength(); index += 3, matWeightIdx += 4)
+    // Ported from `applySkeleton` function in abstractMesh.ts
+    void ApplySkeleton(const Napi::CallbackInfo& info)
+    {
+        const auto arguments{GetSkinningArguments(info)};
+        ParallelFor(arguments.Count, SKINNING_GRAIN_SIZE, [&arguments](size_t, size_t begin, size_t end) {
+            ApplySkeletonRange(arguments, begin, end);
+        });
+    }
+
+    // Same as ApplySkeleton, but returns a promise instead of blocking the JavaScript thread, so that several meshes can
+    // be skinned at once. None of the arrays may be modified or read until the promise resolves.
+    Napi::Value ApplySkeletonAsync(const Napi::CallbackInfo& info)
+    {
+        auto env{info.Env()};
+        auto deferred{Napi::Promise::Deferred::New(env)};
+
+        auto arguments{std::make_shared<SkinningArguments>(GetSkinningArguments(info))};
+
+        std::vector<Napi::Reference<Napi::Float32Array>> references{};
+        for (const auto& array : arguments->Arrays)
         {
-            float finalMatrix[16]{};
+            references.push_back(Napi::Persistent(array));
+        }
 
-            for (size_t inf = 0; inf < 4; ++inf) {
-                float weight = matricesWeightsData[matWeightIdx + inf];
-                if (weight > 0.0f) {
-                    MatrixScaleAdd(&skeletonMatrices[static_cast<size_t>(matricesIndicesData[matWeightIdx + inf] * 16.0f)], weight, finalMatrix);
-                }
-            }
-            if (matricesIndicesExtraData.has_value() && matricesWeightsExtraData.has_value()) {
-                const auto& indices = matricesIndicesExtraData.value();
-                const auto& weights = matricesWeightsExtraData.value();
-                for (size_t inf = 0; inf < 4; ++inf) {
-                    float weight = weights[matWeightIdx + inf];
-                    if (weight > 0.0f) {
-                        MatrixScaleAdd(&skeletonMatrices[static_cast<size_t>(indices[matWeightIdx + inf] * 16.0f)], weight, finalMatrix);
+        // The worker threads only use the raw pointers, since JavaScript values can only be touched on the JavaScript thread.
+        arguments->Arrays.clear();
+
+        const size_t chunkCount{GetChunkCount(arguments->Count, SKINNING_GRAIN_SIZE)};
+        std::vector<arcana::task<void, std::exception_ptr>> tasks{};
+        tasks.reserve(chunkCount);
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            const auto [begin, end] = GetChunkRange(arguments->Count, chunkCount, chunk);
+            tasks.push_back(arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation_source::none(), [arguments, begin = begin, end = end]() {
+                ApplySkeletonRange(*arguments, begin, end);
+            }));
+        }
+
+        auto runtimeScheduler{std::make_shared<Babylon::JsRuntimeScheduler>(Babylon::JsRuntime::GetFromJavaScript(env))};
+        arcana::when_all(gsl::make_span(tasks))
+            .then(*runtimeScheduler, arcana::cancellation_source::none(),
+                [runtimeScheduler, deferred, env, references{std::move(references)}](const arcana::expected<void, std::exception_ptr>& result) {
+                    if (result.has_error())
+                    {
+                        deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                        return;
+                    }
+
+                    deferred.Resolve(env.Undefined());
+                });
+
+        return deferred.Promise();
+    }
+
+    // Keeps the vertex cache efficiency within 5% of the vertex cache optimized order.
+    constexpr float DEFAULT_OVERDRAW_THRESHOLD{1.05f};
+
+    // Runs `work` on the thread pool, then resolves the returned promise on the JavaScript thread with the value that
+    // `resolve` makes from the result of `work`, if any. The arrays are kept alive until then, and must not be used meanwhile
+    // since the thread pool reads and writes their data.
+    template<typename WorkT, typename ResolveT>
+    Napi::Value RunAsync(Napi::Env env, const std::vector<Napi::TypedArray>& arrays, WorkT work, ResolveT resolve)
+    {
+        using ResultT = std::invoke_result_t<WorkT>;
+
+        auto deferred{Napi::Promise::Deferred::New(env)};
+
+        std::vector<Napi::Reference<Napi::TypedArray>> references{};
+        for (const auto& array : arrays)
+        {
+            references.push_back(Napi::Persistent(array));
+        }
+
+        auto runtimeScheduler{std::make_shared<Babylon::JsRuntimeScheduler>(Babylon::JsRuntime::GetFromJavaScript(env))};
+        arcana::make_task(arcana::threadpool_scheduler, arcana::cancellation_source::none(), std::move(work))
+            .then(*runtimeScheduler, arcana::cancellation_source::none(),
+                [runtimeScheduler, deferred, env, references{std::move(references)}, resolve{std::move(resolve)}](const arcana::expected<ResultT, std::exception_ptr>& result) {
+                    if (result.has_error())
+                    {
+                        deferred.Reject(Napi::Error::New(env, result.error()).Value());
+                        return;
+                    }
+
+                    if constexpr (std::is_void_v<ResultT>)
+                    {
+                        deferred.Resolve(resolve(env));
+                    }
+                    else
+                    {
+                        deferred.Resolve(resolve(env, result.value()));
+                    }
+                });
+
+        return deferred.Promise();
+    }
+
+    // The data of an index TypedArray, which the thread pool can use without touching the JavaScript value.
+    struct IndexData
+    {
+        void* Data{};
+        size_t Count{};
+        bool Is16Bits{};
+    };
+
+    IndexData GetIndexData(const Napi::TypedArray& indices)
+    {
+        auto* data{static_cast<uint8_t*>(indices.ArrayBuffer().Data()) + indices.ByteOffset()};
+
+        // Valid indices are never negative, so they have the same representation as unsigned integers.
+        if (indices.TypedArrayType() == napi_typedarray_type::napi_int32_array || indices.TypedArrayType() == napi_typedarray_type::napi_uint32_array)
+        {
+            return {data, indices.ElementLength(), false};
+        }
+        else if (indices.TypedArrayType() == napi_typedarray_type::napi_uint16_array)
+        {
+            return {data, indices.ElementLength(), true};
+        }
+
+        throw std::runtime_error{"Indices TypedArray element type was unexpected."};
+    }
+
+    // Calls `function` with the indices as 32-bit values, and writes them back if they were widened from 16-bit ones.
+    template<typename FunctionT>
+    void UpdateIndices32(const IndexData& indices, FunctionT function)
+    {
+        if (!indices.Is16Bits)
+        {
+            function(static_cast<uint32_t*>(indices.Data));
+            return;
+        }
+
+        auto* data{static_cast<uint16_t*>(indices.Data)};
+        std::vector<uint32_t> indices32(data, data + indices.Count);
+        function(indices32.data());
+        std::transform(indices32.begin(), indices32.end(), data, [](uint32_t index) { return static_cast<uint16_t>(index); });
+    }
+
+    // Number of vertices whose first 3 floats are in the positions array.
+    size_t GetVertexCount(const Napi::Float32Array& positions, uint32_t positionStride)
+    {
+        if (positionStride < 3 || positionStride > Babylon::Plugins::NativeOptimizations::MAX_POSITION_STRIDE)
+        {
+            throw std::runtime_error{"Position stride must be between 3 and 64."};
+        }
+
+        return positions.ElementLength() < 3 ? 0 : (positions.ElementLength() - 3) / positionStride + 1;
+    }
+
+    // Reorders the triangles of `indices` in place for the vertex cache, then for overdraw. `positions` is read from the
+    // first 3 floats of every `positionStride` floats.
+    Napi::Value OptimizeIndicesAsync(const Napi::CallbackInfo& info)
+    {
+        const auto indices{info[0].As<Napi::TypedArray>()};
+        const auto positions{info[1].As<Napi::Float32Array>()};
+        const auto positionStride{info[2].As<Napi::Number>().Uint32Value()};
+        const auto threshold{info[3].IsUndefined() ? DEFAULT_OVERDRAW_THRESHOLD : info[3].As<Napi::Number>().FloatValue()};
+
+        const auto indexData{GetIndexData(indices)};
+        const auto vertexCount{GetVertexCount(positions, positionStride)};
+
+        return RunAsync(info.Env(), {indices, positions},
+            [indexData, positionData{positions.Data()}, positionStride, vertexCount, threshold]() {
+                UpdateIndices32(indexData, [&](uint32_t* data) {
+                    OptimizeVertexCache(data, data, indexData.Count, vertexCount);
+                    OptimizeOverdraw(data, data, indexData.Count, positionData, positionStride, vertexCount, threshold);
+                });
+            },
+            [](Napi::Env env) { return env.Undefined(); });
+    }
+
+    // Renumbers the vertices of `indices` in place in the order in which they are first used, and fills the `remap`
+    // Uint32Array, which has an element per vertex, with the new index of each vertex (0xFFFFFFFF for unused ones).
+    // Resolves with the number of used vertices.
+    Napi::Value OptimizeVertexFetchAsync(const Napi::CallbackInfo& info)
+    {
+        const auto indices{info[0].As<Napi::TypedArray>()};
+        auto remap{info[1].As<Napi::Uint32Array>()};
+
+        const auto indexData{GetIndexData(indices)};
+
+        return RunAsync(info.Env(), {indices, remap},
+            [indexData, remapData{remap.Data()}, vertexCount{remap.ElementLength()}]() {
+                size_t usedVertexCount{0};
+                UpdateIndices32(indexData, [&](uint32_t* data) {
+                    usedVertexCount = OptimizeVertexFetch(data, indexData.Count, remapData, vertexCount);
+                });
+                return usedVertexCount;
+            },
+            [](Napi::Env env, size_t usedVertexCount) { return Napi::Value::From(env, static_cast<double>(usedVertexCount)); });
+    }
+
+    // Moves the vertices of `byteStride` bytes of `data` in place as given by a `remap` from optimizeVertexFetchAsync,
+    // so that the used vertices are packed at the start of `data`.
+    Napi::Value RemapVertexBufferAsync(const Napi::CallbackInfo& info)
+    {
+        const auto data{info[0].As<Napi::TypedArray>()};
+        const auto byteStride{info[1].As<Napi::Number>().Uint32Value()};
+        const auto remap{info[2].As<Napi::Uint32Array>()};
+
+        const size_t vertexCount{remap.ElementLength()};
+        if (data.ByteLength() < vertexCount * byteStride)
+        {
+            throw std::runtime_error{"TypedArray range is out of bounds."};
+        }
+
+        return RunAsync(info.Env(), {data, remap},
+            [bytes{static_cast<uint8_t*>(data.ArrayBuffer().Data()) + data.ByteOffset()}, vertexCount, byteStride, remapData{remap.Data()}]() {
+                RemapVertexBuffer(bytes, vertexCount, byteStride, remapData);
+            },
+            [](Napi::Env env) { return env.Undefined(); });
+    }
+
+    // Resolves with a Uint16Array copy of 32-bit `indices` if all of them fit in 16 bits, or with `indices` otherwise.
+    Napi::Value NarrowIndicesAsync(const Napi::CallbackInfo& info)
+    {
+        const auto indices{info[0].As<Napi::TypedArray>()};
+        const auto indexData{GetIndexData(indices)};
+
+        return RunAsync(info.Env(), {indices},
+            [indexData]() {
+                std::shared_ptr<std::vector<uint16_t>> narrowed{};
+                if (!indexData.Is16Bits)
+                {
+                    narrowed = std::make_shared<std::vector<uint16_t>>(indexData.Count);
+                    if (!NarrowIndices(narrowed->data(), static_cast<const uint32_t*>(indexData.Data), indexData.Count))
+                    {
+                        narrowed.reset();
                     }
                 }
-            }
+                return narrowed;
+            },
+            [indicesRef{Napi::Persistent(indices)}](Napi::Env env, const std::shared_ptr<std::vector<uint16_t>>& narrowed) -> Napi::Value {
+                if (!narrowed)
+                {
+                    return indicesRef.Value();
+                }
 
-            matrixTransform(finalMatrix, data[index], data[index + 1], data[index + 2]);
+                auto result{Napi::Uint16Array::New(env, narrowed->size())};
+                std::copy(narrowed->begin(), narrowed->end(), result.Data());
+                return result;
+            });
+    }
+
+    // Resolves with a new index array of the same vertices, with at most `targetIndexCount` indices unless that would
+    // move the surface by more than `targetError` relative to the size of the mesh. The array is a Uint16Array for
+    // 16-bit `indices` and a Uint32Array otherwise.
+    Napi::Value SimplifyAsync(const Napi::CallbackInfo& info)
+    {
+        const auto indices{info[0].As<Napi::TypedArray>()};
+        const auto positions{info[1].As<Napi::Float32Array>()};
+        const auto positionStride{info[2].As<Napi::Number>().Uint32Value()};
+        const auto targetIndexCount{info[3].As<Napi::Number>().Uint32Value()};
+        const auto targetError{info[4].As<Napi::Number>().FloatValue()};
+
+        const auto indexData{GetIndexData(indices)};
+        const auto vertexCount{GetVertexCount(positions, positionStride)};
+
+        return RunAsync(info.Env(), {indices, positions},
+            [indexData, positionData{positions.Data()}, positionStride, vertexCount, targetIndexCount, targetError]() {
+                std::vector<uint32_t> indices32{};
+                if (indexData.Is16Bits)
+                {
+                    const auto* data{static_cast<const uint16_t*>(indexData.Data)};
+                    indices32.assign(data, data + indexData.Count);
+                }
+
+                const auto* data{indexData.Is16Bits ? indices32.data() : static_cast<const uint32_t*>(indexData.Data)};
+                return std::make_shared<std::vector<uint32_t>>(Simplify(data, indexData.Count, positionData, positionStride, vertexCount, targetIndexCount, targetError));
+            },
+            [is16Bits{indexData.Is16Bits}](Napi::Env env, const std::shared_ptr<std::vector<uint32_t>>& simplified) -> Napi::Value {
+                if (is16Bits)
+                {
+                    auto result{Napi::Uint16Array::New(env, simplified->size())};
+                    std::transform(simplified->begin(), simplified->end(), result.Data(), [](uint32_t index) { return static_cast<uint16_t>(index); });
+                    return result;
+                }
+
+                auto result{Napi::Uint32Array::New(env, simplified->size())};
+                std::copy(simplified->begin(), simplified->end(), result.Data());
+                return result;
+            });
+    }
+
+    // An ArrayBuffer over data owned by the result of a thread pool task, which it keeps alive until garbage collected.
+    template<typename OwnerT>
+    Napi::ArrayBuffer CreateArrayBuffer(Napi::Env env, void* data, size_t byteLength, std::shared_ptr<OwnerT> owner)
+    {
+        if (byteLength == 0)
+        {
+            return Napi::ArrayBuffer::New(env, 0);
         }
+
+        return Napi::ArrayBuffer::New(env, data, byteLength, [owner{std::move(owner)}](Napi::Env, void*) {});
+    }
+
+#ifdef DRACO
+    Napi::TypedArray CreateAttributeArray(Napi::Env env, uint32_t componentType, Napi::ArrayBuffer arrayBuffer)
+    {
+        switch (componentType)
+        {
+            case COMPONENT_TYPE_BYTE:
+                return Napi::Int8Array::New(env, arrayBuffer.ByteLength(), arrayBuffer, 0);
+            case COMPONENT_TYPE_UNSIGNED_BYTE:
+                return Napi::Uint8Array::New(env, arrayBuffer.ByteLength(), arrayBuffer, 0);
+            case COMPONENT_TYPE_SHORT:
+                return Napi::Int16Array::New(env, arrayBuffer.ByteLength() / sizeof(int16_t), arrayBuffer, 0);
+            case COMPONENT_TYPE_UNSIGNED_SHORT:
+                return Napi::Uint16Array::New(env, arrayBuffer.ByteLength() / sizeof(uint16_t), arrayBuffer, 0);
+            default:
+                return Napi::Float32Array::New(env, arrayBuffer.ByteLength() / sizeof(float), arrayBuffer, 0);
+        }
+    }
+
+    // Decodes a Draco compressed mesh and resolves with its data in the shape of the MeshData of the Babylon.js Draco
+    // decoder: `{ indices, attributes: [{ kind, data, size, byteOffset, byteStride, normalized }], totalVertices }`.
+    // The optional second argument maps vertex buffer kinds to Draco attribute unique ids, as in the glTF extension.
+    Napi::Value DecodeDracoMeshAsync(const Napi::CallbackInfo& info)
+    {
+        const auto data{info[0].As<Napi::TypedArray>()};
+
+        std::vector<std::pair<std::string, uint32_t>> attributes{};
+        if (info.Length() > 1 && info[1].IsObject())
+        {
+            const auto jsAttributes{info[1].As<Napi::Object>()};
+            const auto kinds{jsAttributes.GetPropertyNames()};
+            for (uint32_t index = 0; index < kinds.Length(); ++index)
+            {
+                const auto kind{kinds.Get(index).As<Napi::String>()};
+                attributes.emplace_back(kind.Utf8Value(), jsAttributes.Get(kind).As<Napi::Number>().Uint32Value());
+            }
+        }
+
+        return RunAsync(info.Env(), {data},
+            [bytes{static_cast<const uint8_t*>(data.ArrayBuffer().Data()) + data.ByteOffset()}, size{data.ByteLength()}, attributes{std::move(attributes)}]() {
+                return std::make_shared<DracoMesh>(DecodeDraco(bytes, size, attributes));
+            },
+            [](Napi::Env env, const std::shared_ptr<DracoMesh>& mesh) -> Napi::Value {
+                auto result{Napi::Object::New(env)};
+
+                if (!mesh->Indices16.empty())
+                {
+                    const auto byteLength{mesh->Indices16.size() * sizeof(uint16_t)};
+                    result.Set("indices", Napi::Uint16Array::New(env, mesh->Indices16.size(), CreateArrayBuffer(env, mesh->Indices16.data(), byteLength, mesh), 0));
+                }
+                else if (!mesh->Indices32.empty())
+                {
+                    const auto byteLength{mesh->Indices32.size() * sizeof(uint32_t)};
+                    result.Set("indices", Napi::Uint32Array::New(env, mesh->Indices32.size(), CreateArrayBuffer(env, mesh->Indices32.data(), byteLength, mesh), 0));
+                }
+
+                auto jsAttributes{Napi::Array::New(env, mesh->Attributes.size())};
+                for (uint32_t index = 0; index < mesh->Attributes.size(); ++index)
+                {
+                    auto& attribute{mesh->Attributes[index]};
+                    const auto arrayBuffer{CreateArrayBuffer(env, attribute.Data.data(), attribute.Data.size(), mesh)};
+                    const auto array{CreateAttributeArray(env, attribute.ComponentType, arrayBuffer)};
+
+                    auto jsAttribute{Napi::Object::New(env)};
+                    jsAttribute.Set("kind", attribute.Kind);
+                    jsAttribute.Set("data", array);
+                    jsAttribute.Set("size", attribute.Size);
+                    jsAttribute.Set("byteOffset", 0);
+                    jsAttribute.Set("byteStride", attribute.ByteStride);
+                    jsAttribute.Set("normalized", attribute.Normalized);
+                    jsAttributes.Set(index, jsAttribute);
+                }
+
+                result.Set("attributes", jsAttributes);
+                result.Set("totalVertices", mesh->VertexCount);
+                return result;
+            });
+    }
+#endif
+
+#ifdef MESHOPT
+    // Decodes a buffer view compressed with the EXT_meshopt_compression glTF extension, with the arguments of
+    // MeshoptCompression.decodeGltfBufferAsync in Babylon.js, and resolves with a Uint8Array of `count * stride` bytes.
+    Napi::Value DecodeMeshoptAsync(const Napi::CallbackInfo& info)
+    {
+        const auto source{info[0].As<Napi::TypedArray>()};
+        const auto count{info[1].As<Napi::Number>().Uint32Value()};
+        const auto stride{info[2].As<Napi::Number>().Uint32Value()};
+        const auto mode{ParseMeshoptMode(info[3].As<Napi::String>().Utf8Value())};
+        const auto filter{ParseMeshoptFilter(info[4].IsUndefined() ? std::string{} : info[4].As<Napi::String>().Utf8Value())};
+
+        return RunAsync(info.Env(), {source},
+            [bytes{static_cast<const uint8_t*>(source.ArrayBuffer().Data()) + source.ByteOffset()}, size{source.ByteLength()}, count, stride, mode, filter]() {
+                auto decoded{std::make_shared<std::vector<uint8_t>>(GetMeshoptDecodedSize(count, stride, mode, filter))};
+                DecodeMeshopt(decoded->data(), count, stride, bytes, size, mode, filter);
+                return decoded;
+            },
+            [](Napi::Env env, const std::shared_ptr<std::vector<uint8_t>>& decoded) -> Napi::Value {
+                return Napi::Uint8Array::New(env, decoded->size(), CreateArrayBuffer(env, decoded->data(), decoded->size(), decoded), 0);
+            });
     }
+#endif
 }
 
 namespace Babylon::Plugins::NativeOptimizations
@@ -281,11 +734,25 @@ namespace Babylon::Plugins::NativeOptimizations
     {
         auto nativeObject{JsRuntime::NativeObject::GetFromJavaScript(env)};
         nativeObject.Set("_ApplySkeleton", Napi::Function::New(env, ApplySkeleton, "_ApplySkeleton"));
+        nativeObject.Set("_ApplySkeletonAsync", Napi::Function::New(env, ApplySkeletonAsync, "_ApplySkeletonAsync"));
         nativeObject.Set("_TransformVector3Coordinates", Napi::Function::New(env, TransformVector3Coordinates, "_TransformVector3Coordinates"));
         nativeObject.Set("_TransformVector3Normals", Napi::Function::New(env, TransformVector3Normals, "_TransformVector3Normals"));
         nativeObject.Set("_TransformVector4Normals", Napi::Function::New(env, TransformVector4Normals, "_TransformVector4Normals"));
         nativeObject.Set("_FlipFaces", Napi::Function::New(env, FlipFaces, "_FlipFaces"));
         nativeObject.Set("extractMinAndMaxIndexed", Napi::Function::New(env, ExtractMinAndMaxIndexed, "extractMinAndMaxIndexed"));
         nativeObject.Set("extractMinAndMax", Napi::Function::New(env, ExtractMinAndMax, "extractMinAndMax"));
+        nativeObject.Set("optimizeIndicesAsync", Napi::Function::New(env, OptimizeIndicesAsync, "optimizeIndicesAsync"));
+        nativeObject.Set("optimizeVertexFetchAsync", Napi::Function::New(env, OptimizeVertexFetchAsync, "optimizeVertexFetchAsync"));
+        nativeObject.Set("remapVertexBufferAsync", Napi::Function::New(env, RemapVertexBufferAsync, "remapVertexBufferAsync"));
+        nativeObject.Set("narrowIndicesAsync", Napi::Function::New(env, NarrowIndicesAsync, "narrowIndicesAsync"));
+        nativeObject.Set("simplifyAsync", Napi::Function::New(env, SimplifyAsync, "simplifyAsync"));
+
+#ifdef DRACO
+        nativeObject.Set("decodeDracoMeshAsync", Napi::Function::New(env, DecodeDracoMeshAsync, "decodeDracoMeshAsync"));
+#endif
+
+#ifdef MESHOPT
+        nativeObject.Set("decodeMeshoptAsync", Napi::Function::New(env, DecodeMeshoptAsync, "decodeMeshoptAsync"));
+#endif
     }
 }
@@ -0,0 +1,104 @@
+#include "Parallel.h"
+
+#include <arcana/threading/task_schedulers.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    size_t GetChunkCount(size_t count, size_t grainSize)
+    {
+        const size_t threadCount{std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+        return std::clamp<size_t>(count / std::max<size_t>(grainSize, 1), 1, threadCount);
+    }
+
+    std::pair<size_t, size_t> GetChunkRange(size_t count, size_t chunkCount, size_t chunk)
+    {
+        const size_t size{count / chunkCount};
+        const size_t remainder{count % chunkCount};
+        const size_t begin{chunk * size + std::min(chunk, remainder)};
+        return {begin, begin + size + (chunk < remainder ? 1 : 0)};
+    }
+
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t chunk, size_t begin, size_t end)>& function)
+    {
+        const size_t chunkCount{GetChunkCount(count, grainSize)};
+        if (chunkCount == 1)
+        {
+            function(0, 0, count);
+            return;
+        }
+
+        // Chunks are claimed by whichever thread gets to them first, so the calling thread never waits for a chunk that
+        // the thread pool has not started, only for the ones that pool threads are running. The state is shared with the
+        // pool tasks, since those that start after every chunk has been claimed may run after this function returns.
+        struct State
+        {
+            const std::function<void(size_t chunk, size_t begin, size_t end)>* Function{};
+            size_t Count{};
+            size_t ChunkCount{};
+            std::atomic<size_t> NextChunk{0};
+
+            std::mutex Mutex{};
+            std::condition_variable Condition{};
+            size_t Remaining{};
+            std::exception_ptr Error{};
+        };
+
+        const auto state{std::make_shared<State>()};
+        state->Function = &function;
+        state->Count = count;
+        state->ChunkCount = chunkCount;
+        state->Remaining = chunkCount;
+
+        const auto runChunks{[](State& state) {
+            for (size_t chunk{state.NextChunk++}; chunk < state.ChunkCount; chunk = state.NextChunk++)
+            {
+                std::exception_ptr chunkError{};
+                try
+                {
+                    const auto [begin, end] = GetChunkRange(state.Count, state.ChunkCount, chunk);
+                    (*state.Function)(chunk, begin, end);
+                }
+                catch (...)
+                {
+                    chunkError = std::current_exception();
+                }
+
+                std::scoped_lock lock{state.Mutex};
+                if (chunkError && !state.Error)
+                {
+                    state.Error = chunkError;
+                }
+
+                if (--state.Remaining == 0)
+                {
+                    state.Condition.notify_one();
+                }
+            }
+        }};
+
+        for (size_t helper = 1; helper < chunkCount; ++helper)
+        {
+            arcana::threadpool_scheduler([state, runChunks]() {
+                runChunks(*state);
+            });
+        }
+
+        runChunks(*state);
+
+        std::unique_lock lock{state->Mutex};
+        state->Condition.wait(lock, [&state]() { return state->Remaining == 0; });
+
+        if (state->Error)
+        {
+            std::rethrow_exception(state->Error);
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace Babylon::Plugins::NativeOptimizations
+{
+    // Number of chunks to split `count` items into: at most one per hardware thread, and at least `grainSize` items each.
+    size_t GetChunkCount(size_t count, size_t grainSize);
+
+    // The [begin, end) item range of a chunk, with the remainder spread over the first chunks.
+    std::pair<size_t, size_t> GetChunkRange(size_t count, size_t chunkCount, size_t chunk);
+
+    // Calls `function` for every chunk of `count` items, on the thread pool and on the calling thread, and returns once all
+    // of them have completed. Rethrows the first exception thrown by a chunk. The calling thread runs every chunk that the
+    // thread pool has not started yet, so a busy thread pool does not block it.
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t chunk, size_t begin, size_t end)>& function);
+}